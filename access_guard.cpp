@@ -0,0 +1,301 @@
+#include <cerrno>
+#include <climits>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <poll.h>
+#include <sys/fanotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "access_guard.h"
+#include "ansi_color.h"
+#include "file_scanner.h"
+#include "json_log_writer.h"
+#include "mapped_file.h"
+#include "util.h"
+
+std::atomic<bool> CAccessGuard::m_bStopGuard(false);
+
+static void AccessGuardSignalHandler(int signal) {
+    if (signal == SIGINT || signal == SIGTERM) {
+        CAccessGuard::m_bStopGuard = true;
+    }
+}
+
+ST_AccessRequest::~ST_AccessRequest() {
+    close(Fd);
+}
+
+CAccessGuard::CAccessGuard(const std::string& mountPath, bool guardAllOpens, int workerCount, int scanType, int timeoutMs)
+    : m_strMountPath(mountPath), m_bGuardAllOpens(guardAllOpens), m_nWorkerCount(workerCount > 0 ? workerCount : 1),
+      m_nScanType(scanType), m_nTimeoutMs(timeoutMs > 0 ? timeoutMs : ACCESS_SCAN_TIMEOUT_MS), m_fanotifyFd(-1),
+      m_engineManager(YARA_RULES_PATH, HASH_LIST_PATH), m_ullCacheHits(0), m_ullTimeouts(0), m_ullSkipped(0) {}
+
+CAccessGuard::~CAccessGuard() {
+    if (m_fanotifyFd != -1) {
+        close(m_fanotifyFd);
+    }
+}
+
+// 권한 이벤트는 FAN_CLASS_CONTENT 그룹에서만 받을 수 있으며 CAP_SYS_ADMIN이 필요
+// FAN_OPEN_EXEC_PERM을 지원하지 않는 커널(5.0 미만)에서는 모든 열기를 검사하는 FAN_OPEN_PERM으로 대체
+int CAccessGuard::InitFanotify() {
+    m_fanotifyFd = fanotify_init(FAN_CLASS_CONTENT | FAN_CLOEXEC | FAN_NONBLOCK, O_RDONLY | O_LARGEFILE | O_CLOEXEC);
+    if (m_fanotifyFd == -1) {
+        PrintError("fanotify_init failed: " + std::string(strerror(errno)) + " (requires root)");
+        return ERROR_ACCESS_DENIED;
+    }
+
+    uint64_t ullMask = m_bGuardAllOpens ? FAN_OPEN_PERM : FAN_OPEN_EXEC_PERM;
+    if (fanotify_mark(m_fanotifyFd, FAN_MARK_ADD | FAN_MARK_MOUNT, ullMask, AT_FDCWD, m_strMountPath.c_str()) == -1) {
+        if (errno != EINVAL || m_bGuardAllOpens) {
+            PrintError("fanotify_mark failed on " + m_strMountPath + ": " + strerror(errno));
+            return ERROR_CANNOT_OPEN_DIRECTORY;
+        }
+        std::cout << COLOR_YELLOW << "[+] FAN_OPEN_EXEC_PERM is not supported, guarding every open instead." << COLOR_RESET << "\n";
+        m_bGuardAllOpens = true;
+        if (fanotify_mark(m_fanotifyFd, FAN_MARK_ADD | FAN_MARK_MOUNT, FAN_OPEN_PERM, AT_FDCWD, m_strMountPath.c_str()) == -1) {
+            PrintError("fanotify_mark failed on " + m_strMountPath + ": " + strerror(errno));
+            return ERROR_CANNOT_OPEN_DIRECTORY;
+        }
+    }
+    return SUCCESS_CODE;
+}
+
+int CAccessGuard::Run() {
+    int nResult = m_engineManager.Load();
+    if (nResult != SUCCESS_CODE) {
+        PrintErrorMessage(nResult, HASH_LIST_PATH);
+        return nResult;
+    }
+    m_engineManager.StartWatching();
+
+    nResult = InitFanotify();
+    if (nResult != SUCCESS_CODE) {
+        return nResult;
+    }
+
+    struct sigaction action = {};
+    action.sa_handler = AccessGuardSignalHandler;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    for (int i = 0; i < m_nWorkerCount; i++) {
+        m_vecWorkers.emplace_back(&CAccessGuard::RunWorker, this);
+    }
+    std::cout << COLOR_GREEN << "[+] On-access scanning " << (m_bGuardAllOpens ? "opens" : "executions") << " on " << m_strMountPath
+              << " (" << m_nWorkerCount << " workers, fail-open after " << m_nTimeoutMs << " ms)" << COLOR_RESET << "\n";
+
+    alignas(struct fanotify_event_metadata) char buffer[BUFFER_SIZE];
+    while (!m_bStopGuard) {
+        struct pollfd pfd = {m_fanotifyFd, POLLIN, 0};
+        int nReady = poll(&pfd, 1, ACCESS_EXPIRE_CHECK_MS);
+        if (nReady > 0 && (pfd.revents & POLLIN)) {
+            ssize_t length;
+            while ((length = read(m_fanotifyFd, buffer, sizeof(buffer))) > 0) {
+                auto* metadata = reinterpret_cast<struct fanotify_event_metadata*>(buffer);
+                for (; FAN_EVENT_OK(metadata, length); metadata = FAN_EVENT_NEXT(metadata, length)) {
+                    if (metadata->vers != FANOTIFY_METADATA_VERSION || metadata->fd == FAN_NOFD) {
+                        continue;
+                    }
+                    if (metadata->mask & (FAN_OPEN_PERM | FAN_OPEN_EXEC_PERM)) {
+                        HandleEvent(metadata->fd, metadata->pid);
+                    } else {
+                        close(metadata->fd);
+                    }
+                }
+            }
+        }
+        ExpireRequests();
+    }
+
+    m_cv.notify_all();
+    for (std::thread& worker : m_vecWorkers) {
+        worker.join();
+    }
+    // 종료 시 대기 중인 요청은 모두 허용하여 프로세스가 멈추지 않도록 함
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& request : m_vecInFlight) {
+            Respond(*request, true);
+        }
+        m_vecInFlight.clear();
+        m_queRequests.clear();
+    }
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+    PrintStatistics();
+    return SUCCESS_CODE;
+}
+
+// 읽기 스레드에서 호출, 검사가 필요 없거나 캐시에 판정이 있으면 바로 응답하고 나머지는 작업자에게 넘김
+void CAccessGuard::HandleEvent(int fd, pid_t pid) {
+    auto request = std::make_shared<ST_AccessRequest>();
+    request->Fd = fd;
+    request->Pid = pid;
+    request->Key = {};
+    request->Start = std::chrono::steady_clock::now();
+
+    // 자신의 파일 접근(룰 재로드 등)은 검사하지 않음, 응답을 기다리면 교착 상태가 됨
+    struct stat fileStat;
+    if (pid == getpid() || fstat(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode) || fileStat.st_size > ACCESS_MAX_SCAN_SIZE) {
+        m_ullSkipped++;
+        Respond(*request, true);
+        return;
+    }
+    request->Key = {fileStat.st_dev, fileStat.st_ino,
+                    fileStat.st_mtim.tv_sec * 1000000000LL + fileStat.st_mtim.tv_nsec,
+                    fileStat.st_ctim.tv_sec * 1000000000LL + fileStat.st_ctim.tv_nsec,
+                    fileStat.st_size};
+
+    bool bAllow;
+    if (LookupVerdict(request->Key, m_engineManager.GetGeneration(), bAllow)) {
+        m_ullCacheHits++;
+        Respond(*request, bAllow);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_vecInFlight.push_back(request);
+        m_queRequests.push_back(std::move(request));
+    }
+    m_cv.notify_one();
+}
+
+void CAccessGuard::RunWorker() {
+    while (true) {
+        std::shared_ptr<ST_AccessRequest> request;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] { return m_bStopGuard || !m_queRequests.empty(); });
+            if (m_bStopGuard) {
+                return;
+            }
+            request = std::move(m_queRequests.front());
+            m_queRequests.pop_front();
+        }
+        // 시간 초과로 이미 허용된 요청은 건너뜀
+        if (!request->Answered) {
+            ScanRequest(request);
+        }
+    }
+}
+
+void CAccessGuard::ScanRequest(const std::shared_ptr<ST_AccessRequest>& request) {
+    std::shared_ptr<const ST_EngineSnapshot> engine = m_engineManager.Acquire();
+
+    char szPath[PATH_MAX];
+    std::string strLink = "/proc/self/fd/" + std::to_string(request->Fd);
+    ssize_t length = readlink(strLink.c_str(), szPath, sizeof(szPath) - 1);
+    std::string strPath = length > 0 ? std::string(szPath, length) : strLink;
+
+    // 매핑은 복제한 fd로 하여 응답에 쓰이는 원본 fd의 수명과 분리
+    CMappedFile file;
+    int nResult = file.Attach(dup(request->Fd));
+    if (nResult == SUCCESS_CODE) {
+        nResult = file.Map();
+    }
+    if (nResult != SUCCESS_CODE || (m_nScanType == YARA_RULE && engine->YaraChecker->IsRuleFile(file.Stat()))) {
+        Respond(*request, true);
+        return;
+    }
+
+    // 검사 오류는 허용으로 처리 (fail-open), 정상 판정만 캐시에 저장
+    std::string strDetectionCause;
+    ST_YaraExternals externals = CYaraChecker::MakeExternals(strPath, &file.Stat(), file.Data(), file.Size());
+    nResult = engine->Scan(m_nScanType, strPath, file.Data(), file.Size(), strDetectionCause, nullptr, &externals);
+    bool bAllow = strDetectionCause.empty();
+    if (nResult == SUCCESS_CODE) {
+        StoreVerdict(request->Key, engine->Generation, bAllow);
+    }
+
+    if (Respond(*request, bAllow)) {
+        if (!bAllow) {
+            std::cout << COLOR_RED << "[+] Blocked access to " << strPath << " by pid " << request->Pid << " (" << strDetectionCause << ")" << COLOR_RESET << "\n";
+        }
+    } else if (!bAllow) {
+        PrintError("Detected after fail-open timeout, access was allowed: " + strPath);
+    }
+    if (!bAllow) {
+        LogDenied(strPath, request->Pid, strDetectionCause, request->Key.Size);
+    }
+}
+
+// 요청당 한 번만 응답, 응답 지연은 허용/거부 히스토그램에 따로 기록
+bool CAccessGuard::Respond(ST_AccessRequest& request, bool allow) {
+    bool bExpected = false;
+    if (!request.Answered.compare_exchange_strong(bExpected, true)) {
+        return false;
+    }
+    struct fanotify_response response = {request.Fd, static_cast<uint32_t>(allow ? FAN_ALLOW : FAN_DENY)};
+    if (write(m_fanotifyFd, &response, sizeof(response)) != sizeof(response)) {
+        PrintError("Failed to write fanotify response: " + std::string(strerror(errno)));
+    }
+    uint64_t ullElapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - request.Start).count();
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    (allow ? m_allowHistogram : m_denyHistogram).Record(ullElapsedNs, static_cast<uint64_t>(request.Key.Size));
+    return true;
+}
+
+// 제한 시간을 넘긴 요청은 허용으로 응답하여 느린 검사가 호스트를 멈추지 않도록 함
+void CAccessGuard::ExpireRequests() {
+    auto now = std::chrono::steady_clock::now();
+    auto timeout = std::chrono::milliseconds(m_nTimeoutMs);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (size_t i = 0; i < m_vecInFlight.size();) {
+        ST_AccessRequest& request = *m_vecInFlight[i];
+        if (!request.Answered && now - request.Start < timeout) {
+            i++;
+            continue;
+        }
+        if (Respond(request, true)) {
+            m_ullTimeouts++;
+        }
+        m_vecInFlight[i] = std::move(m_vecInFlight.back());
+        m_vecInFlight.pop_back();
+    }
+}
+
+bool CAccessGuard::LookupVerdict(const ST_AccessKey& key, uint64_t generation, bool& allow) {
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
+    auto it = m_mapVerdicts.find(key);
+    if (it == m_mapVerdicts.end() || it->second.Generation != generation) {
+        return false;
+    }
+    allow = it->second.Allow;
+    return true;
+}
+
+void CAccessGuard::StoreVerdict(const ST_AccessKey& key, uint64_t generation, bool allow) {
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
+    if (m_mapVerdicts.size() >= ACCESS_CACHE_MAX_ENTRIES) {
+        m_mapVerdicts.clear();
+    }
+    m_mapVerdicts[key] = {generation, allow};
+}
+
+void CAccessGuard::LogDenied(const std::string& path, pid_t pid, const std::string& cause, off_t size) {
+    Json::Value logEntry;
+    logEntry["timestamp"] = GetCurrentTimeWithMilliseconds();
+    logEntry["scan_type"] = m_nScanType == YARA_RULE ? "Yara" : "Hash";
+    logEntry["detected_file"] = path;
+    logEntry["hash_value"] = m_nScanType == HASH_COMPARISON ? cause : "N/A";
+    logEntry["yara_rule"] = m_nScanType == YARA_RULE ? cause : "N/A";
+    logEntry["is_moved"] = "False";
+    logEntry["path_after_moving"] = "N/A";
+    logEntry["file_size"] = Json::UInt64(size);
+    logEntry["pid"] = pid;
+    CJsonLogWriter::Instance().Append(logEntry, LOG_FILE_PATH);
+}
+
+void CAccessGuard::PrintStatistics() {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    CScanProfiler::PrintHeader("On-Access Verdict Latency");
+    CScanProfiler::PrintRow("allow", m_allowHistogram);
+    CScanProfiler::PrintRow("deny", m_denyHistogram);
+    std::cout << "\n[+] Cache hits : " << m_ullCacheHits.load() << ", skipped : " << m_ullSkipped.load()
+              << ", fail-open timeouts : " << m_ullTimeouts.load() << "\n";
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <sys/types.h>
+#include "engine_manager.h"
+#include "scan_profiler.h"
+
+#define ACCESS_SCAN_TIMEOUT_MS 1000                // 이 시간 안에 판정하지 못하면 허용 (fail-open)
+#define ACCESS_CACHE_MAX_ENTRIES 65536             // 판정 캐시 최대 항목 수, 넘치면 비움
+#define ACCESS_MAX_SCAN_SIZE (64 * 1024 * 1024)    // 이보다 큰 파일은 검사하지 않고 허용
+#define ACCESS_EXPIRE_CHECK_MS 20                  // 시간 초과 요청을 확인하는 주기
+
+// 판정 캐시 키, 내용이 바뀌면 mtime/ctime/크기 중 하나가 달라지므로 같은 키는 같은 내용으로 간주
+struct ST_AccessKey {
+    dev_t Dev;
+    ino_t Ino;
+    int64_t MtimeNs;
+    int64_t CtimeNs;
+    off_t Size;
+
+    bool operator==(const ST_AccessKey& other) const {
+        return Dev == other.Dev && Ino == other.Ino && MtimeNs == other.MtimeNs && CtimeNs == other.CtimeNs && Size == other.Size;
+    }
+};
+
+struct ST_AccessKeyHash {
+    size_t operator()(const ST_AccessKey& key) const {
+        return std::hash<uint64_t>()(key.Ino ^ (static_cast<uint64_t>(key.Dev) << 32) ^ static_cast<uint64_t>(key.MtimeNs) ^ static_cast<uint64_t>(key.Size));
+    }
+};
+
+struct ST_AccessVerdict {
+    uint64_t Generation; // 판정에 사용한 엔진 스냅샷, 룰이 바뀌면 무효
+    bool Allow;
+};
+
+// 응답을 기다리는 권한 이벤트 하나, 작업자와 시간 초과 처리 중 먼저 응답한 쪽만 유효
+struct ST_AccessRequest {
+    int Fd;
+    pid_t Pid;
+    ST_AccessKey Key;
+    std::chrono::steady_clock::time_point Start;
+    std::atomic<bool> Answered{false};
+
+    ~ST_AccessRequest();
+};
+
+// fanotify 권한 이벤트로 파일이 실행(또는 열리기) 전에 검사하는 on-access 스캐너
+// 캐시 적중은 읽기 스레드에서 바로 응답하고, 나머지는 작업자 풀에서 검사
+class CAccessGuard {
+public:
+    static std::atomic<bool> m_bStopGuard;
+
+    CAccessGuard(const std::string& mountPath, bool guardAllOpens, int workerCount, int scanType, int timeoutMs);
+    ~CAccessGuard();
+    int Run();
+
+    CAccessGuard(const CAccessGuard&) = delete;
+    CAccessGuard& operator=(const CAccessGuard&) = delete;
+
+private:
+    std::string m_strMountPath;
+    bool m_bGuardAllOpens;
+    int m_nWorkerCount;
+    int m_nScanType;
+    int m_nTimeoutMs;
+    int m_fanotifyFd;
+    CEngineManager m_engineManager;
+
+    std::vector<std::thread> m_vecWorkers;
+    std::deque<std::shared_ptr<ST_AccessRequest>> m_queRequests; // 작업자 대기열
+    std::vector<std::shared_ptr<ST_AccessRequest>> m_vecInFlight; // 응답 전인 요청 (시간 초과 확인용)
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+
+    std::unordered_map<ST_AccessKey, ST_AccessVerdict, ST_AccessKeyHash> m_mapVerdicts;
+    std::mutex m_cacheMutex;
+
+    CLatencyHistogram m_allowHistogram;
+    CLatencyHistogram m_denyHistogram;
+    std::mutex m_statsMutex;
+    std::atomic<uint64_t> m_ullCacheHits;
+    std::atomic<uint64_t> m_ullTimeouts;
+    std::atomic<uint64_t> m_ullSkipped;
+
+    int InitFanotify();
+    void HandleEvent(int fd, pid_t pid);
+    void RunWorker();
+    void ScanRequest(const std::shared_ptr<ST_AccessRequest>& request);
+    bool Respond(ST_AccessRequest& request, bool allow);
+    void ExpireRequests();
+    bool LookupVerdict(const ST_AccessKey& key, uint64_t generation, bool& allow);
+    void StoreVerdict(const ST_AccessKey& key, uint64_t generation, bool allow);
+    void LogDenied(const std::string& path, pid_t pid, const std::string& cause, off_t size);
+    void PrintStatistics();
+};
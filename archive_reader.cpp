@@ -0,0 +1,482 @@
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <zlib.h>
+#include "archive_reader.h"
+#include "error_codes.h"
+
+#define ZIP_LOCAL_HEADER_SIGNATURE 0x04034b50
+#define ZIP_CENTRAL_HEADER_SIGNATURE 0x02014b50
+#define ZIP_END_OF_CENTRAL_DIRECTORY_SIGNATURE 0x06054b50
+#define ZIP_END_OF_CENTRAL_DIRECTORY_SIZE 22
+#define ZIP_MAX_COMMENT_SIZE 65535
+#define TAR_BLOCK_SIZE 512
+#define TAR_MAX_METADATA_SIZE 65536 // GNU 긴 이름/pax 헤더의 최대 크기
+
+static uint16_t ReadLe16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+static uint32_t ReadLe32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// tar 숫자 필드 (8진수 문자열, 큰 값은 GNU base-256)
+static uint64_t ParseTarNumber(const uint8_t* field, size_t length) {
+    uint64_t ullValue = 0;
+    if (field[0] & 0x80) {
+        for (size_t i = 1; i < length; i++) {
+            ullValue = (ullValue << 8) | field[i];
+        }
+        return ullValue;
+    }
+    for (size_t i = 0; i < length && field[i] != '\0'; i++) {
+        if (field[i] >= '0' && field[i] <= '7') {
+            ullValue = (ullValue << 3) | static_cast<uint64_t>(field[i] - '0');
+        }
+    }
+    return ullValue;
+}
+
+static bool IsTarHeader(const uint8_t* block) {
+    uint64_t ullStored = ParseTarNumber(block + 148, 8);
+    uint64_t ullSum = 0;
+    for (size_t i = 0; i < TAR_BLOCK_SIZE; i++) {
+        ullSum += (i >= 148 && i < 156) ? ' ' : block[i];
+    }
+    return ullSum == ullStored;
+}
+
+static std::string GetBaseName(const std::string& path) {
+    size_t siSeparator = path.find_last_of("/" ARCHIVE_PATH_SEPARATOR);
+    return siSeparator == std::string::npos ? path : path.substr(siSeparator + 1);
+}
+
+// 바이트를 조금씩 받아 tar 헤더를 해석하고, 일반 파일 멤버를 모아 완성될 때마다 넘겨주는 스트림 해석기
+// gzip 해제 결과를 조각 단위로 넣을 수 있어 압축 파일 전체를 펼쳐둘 필요가 없음
+class CTarStream {
+public:
+    using MemberHandler = std::function<void(const std::string& name, const uint8_t* data, size_t size)>;
+    using ReserveHandler = std::function<bool(const std::string& name, uint64_t bytes)>;
+
+    CTarStream(const MemberHandler& onMember, const ReserveHandler& reserve)
+        : m_onMember(onMember), m_reserve(reserve), m_siHeaderFill(0), m_ullRemaining(0), m_ullPadding(0),
+          m_type(ENTRY_SKIP), m_bEnd(false), m_bInvalid(false) {}
+
+    // 더 이상 읽을 필요가 없으면 false (끝 블록, 손상된 헤더, 제한 초과)
+    bool Feed(const uint8_t* data, size_t size) {
+        while (size > 0 && !m_bEnd && !m_bInvalid) {
+            if (m_ullRemaining > 0) {
+                size_t siTake = static_cast<size_t>(std::min<uint64_t>(m_ullRemaining, size));
+                if (m_type != ENTRY_SKIP) {
+                    m_vecContent.insert(m_vecContent.end(), data, data + siTake);
+                }
+                m_ullRemaining -= siTake;
+                data += siTake;
+                size -= siTake;
+                if (m_ullRemaining == 0) {
+                    FinishEntry();
+                }
+            } else if (m_ullPadding > 0) {
+                size_t siTake = static_cast<size_t>(std::min<uint64_t>(m_ullPadding, size));
+                m_ullPadding -= siTake;
+                data += siTake;
+                size -= siTake;
+            } else {
+                size_t siTake = std::min(TAR_BLOCK_SIZE - m_siHeaderFill, size);
+                memcpy(m_header + m_siHeaderFill, data, siTake);
+                m_siHeaderFill += siTake;
+                data += siTake;
+                size -= siTake;
+                if (m_siHeaderFill == TAR_BLOCK_SIZE) {
+                    m_siHeaderFill = 0;
+                    ParseHeader();
+                }
+            }
+        }
+        return !m_bEnd && !m_bInvalid;
+    }
+
+    bool IsInvalid() const { return m_bInvalid; }
+
+private:
+    enum EEntryType { ENTRY_SKIP, ENTRY_FILE, ENTRY_LONG_NAME, ENTRY_PAX };
+
+    MemberHandler m_onMember;
+    ReserveHandler m_reserve;
+    uint8_t m_header[TAR_BLOCK_SIZE];
+    size_t m_siHeaderFill;
+    uint64_t m_ullRemaining;
+    uint64_t m_ullPadding;
+    EEntryType m_type;
+    std::string m_strName;
+    std::string m_strNextName; // GNU 'L' 또는 pax 'path'로 지정된 다음 멤버의 이름
+    std::vector<uint8_t> m_vecContent;
+    bool m_bEnd;
+    bool m_bInvalid;
+
+    void ParseHeader() {
+        if (std::all_of(m_header, m_header + TAR_BLOCK_SIZE, [](uint8_t c) { return c == 0; })) {
+            m_bEnd = true;
+            return;
+        }
+        if (!IsTarHeader(m_header)) {
+            m_bInvalid = true;
+            return;
+        }
+
+        std::string strName(reinterpret_cast<const char*>(m_header), strnlen(reinterpret_cast<const char*>(m_header), 100));
+        if (memcmp(m_header + 257, "ustar", 5) == 0 && m_header[345] != '\0') {
+            std::string strPrefix(reinterpret_cast<const char*>(m_header + 345), strnlen(reinterpret_cast<const char*>(m_header + 345), 155));
+            strName = strPrefix + "/" + strName;
+        }
+        uint64_t ullSize = ParseTarNumber(m_header + 124, 12);
+        char cType = static_cast<char>(m_header[156]);
+
+        m_vecContent.clear();
+        m_strName = m_strNextName.empty() ? strName : m_strNextName;
+        if (cType == '0' || cType == '\0' || cType == '7') {
+            m_strNextName.clear();
+            m_type = m_reserve(m_strName, ullSize) ? ENTRY_FILE : ENTRY_SKIP;
+        } else if (cType == 'L' || cType == 'x') {
+            m_type = ullSize <= TAR_MAX_METADATA_SIZE ? (cType == 'L' ? ENTRY_LONG_NAME : ENTRY_PAX) : ENTRY_SKIP;
+        } else {
+            m_strNextName.clear();
+            m_type = ENTRY_SKIP;
+        }
+        m_ullRemaining = ullSize;
+        m_ullPadding = (TAR_BLOCK_SIZE - ullSize % TAR_BLOCK_SIZE) % TAR_BLOCK_SIZE;
+        if (ullSize == 0) {
+            FinishEntry();
+        }
+    }
+
+    void FinishEntry() {
+        if (m_type == ENTRY_FILE) {
+            m_onMember(m_strName, m_vecContent.data(), m_vecContent.size());
+        } else if (m_type == ENTRY_LONG_NAME) {
+            m_strNextName.assign(m_vecContent.begin(), m_vecContent.end());
+            m_strNextName.resize(strnlen(m_strNextName.c_str(), m_strNextName.size()));
+        } else if (m_type == ENTRY_PAX) {
+            // "길이 키=값\n" 레코드 중 path만 사용
+            std::string strRecords(m_vecContent.begin(), m_vecContent.end());
+            size_t siPosition = 0;
+            while (siPosition < strRecords.size()) {
+                size_t siSpace = strRecords.find(' ', siPosition);
+                if (siSpace == std::string::npos) {
+                    break;
+                }
+                size_t siLength = strtoul(strRecords.c_str() + siPosition, nullptr, 10);
+                if (siLength == 0 || siPosition + siLength > strRecords.size()) {
+                    break;
+                }
+                std::string strRecord = strRecords.substr(siSpace + 1, siPosition + siLength - siSpace - 2);
+                if (strRecord.compare(0, 5, "path=") == 0) {
+                    m_strNextName = strRecord.substr(5);
+                }
+                siPosition += siLength;
+            }
+        }
+        m_vecContent.clear();
+        m_type = ENTRY_SKIP;
+    }
+};
+
+CArchiveReader::CArchiveReader() : m_ullTotalBytes(0), m_bAborted(false) {}
+
+EArchiveType CArchiveReader::DetectType(const uint8_t* data, size_t size) {
+    if (size >= 4 && ReadLe32(data) == ZIP_LOCAL_HEADER_SIGNATURE) {
+        return ARCHIVE_ZIP;
+    }
+    if (size >= 3 && data[0] == 0x1f && data[1] == 0x8b && data[2] == Z_DEFLATED) {
+        return ARCHIVE_GZIP;
+    }
+    if (size >= TAR_BLOCK_SIZE && memcmp(data + 257, "ustar", 5) == 0 && IsTarHeader(data)) {
+        return ARCHIVE_TAR;
+    }
+    return ARCHIVE_NONE;
+}
+
+// 최상위 압축 파일 하나를 펼침, 멤버는 콜백으로 넘어간 뒤 버려지므로 메모리는 멤버 크기만큼만 사용
+int CArchiveReader::Read(const std::string& containerName, const uint8_t* data, size_t size, const ArchiveMemberCallback& callback) {
+    m_ullTotalBytes = 0;
+    m_bAborted = false;
+    m_strLimitReason.clear();
+    return ReadArchive("", containerName, data, size, 1, callback);
+}
+
+int CArchiveReader::ReadArchive(const std::string& prefix, const std::string& containerName, const uint8_t* data, size_t size,
+                                int depth, const ArchiveMemberCallback& callback) {
+    switch (DetectType(data, size)) {
+        case ARCHIVE_ZIP:
+            return ReadZip(prefix, data, size, depth, callback);
+        case ARCHIVE_GZIP:
+            return ReadGzip(prefix, containerName, data, size, depth, callback);
+        case ARCHIVE_TAR:
+            return ReadTar(prefix, data, size, depth, callback);
+        default:
+            return ERROR_INVALID_INPUT;
+    }
+}
+
+// 멤버를 넘기고, 멤버가 다시 압축 파일이면 깊이 제한 안에서 펼침
+void CArchiveReader::EmitMember(const std::string& memberPath, const uint8_t* data, size_t size, int depth, const ArchiveMemberCallback& callback) {
+    callback(memberPath, data, size);
+    if (m_bAborted || DetectType(data, size) == ARCHIVE_NONE) {
+        return;
+    }
+    if (depth >= ARCHIVE_MAX_DEPTH) {
+        NoteLimit("nesting depth " + std::to_string(ARCHIVE_MAX_DEPTH) + " at " + memberPath);
+        return;
+    }
+    ReadArchive(memberPath + ARCHIVE_PATH_SEPARATOR, GetBaseName(memberPath), data, size, depth + 1, callback);
+}
+
+bool CArchiveReader::ReserveBytes(uint64_t bytes) {
+    if (m_ullTotalBytes + bytes > ARCHIVE_MAX_TOTAL_BYTES) {
+        return Abort("total expanded size over " + std::to_string(ARCHIVE_MAX_TOTAL_BYTES / (1024 * 1024)) + " MB");
+    }
+    m_ullTotalBytes += bytes;
+    return true;
+}
+
+// 멤버 하나의 크기 제한은 그 멤버만 건너뛰고 나머지는 계속 펼침
+bool CArchiveReader::ReserveMember(const std::string& memberPath, uint64_t bytes) {
+    if (bytes > ARCHIVE_MAX_MEMBER_SIZE) {
+        NoteLimit(MemberSizeReason(memberPath));
+        return false;
+    }
+    return ReserveBytes(bytes);
+}
+
+bool CArchiveReader::Abort(const std::string& reason) {
+    m_bAborted = true;
+    NoteLimit(reason);
+    return false;
+}
+
+void CArchiveReader::NoteLimit(const std::string& reason) {
+    if (m_strLimitReason.empty()) {
+        m_strLimitReason = reason;
+    }
+}
+
+std::string CArchiveReader::MemberSizeReason(const std::string& memberPath) {
+    return "member over " + std::to_string(ARCHIVE_MAX_MEMBER_SIZE / (1024 * 1024)) + " MB skipped at " + memberPath;
+}
+
+// 끝에서 EOCD를 찾아 중앙 디렉토리의 크기/오프셋을 신뢰하고, 로컬 헤더는 데이터 위치를 찾는 데만 사용
+int CArchiveReader::ReadZip(const std::string& prefix, const uint8_t* data, size_t size, int depth, const ArchiveMemberCallback& callback) {
+    if (size < ZIP_END_OF_CENTRAL_DIRECTORY_SIZE) {
+        return ERROR_INVALID_INPUT;
+    }
+    size_t siLowest = size > ZIP_END_OF_CENTRAL_DIRECTORY_SIZE + ZIP_MAX_COMMENT_SIZE ? size - ZIP_END_OF_CENTRAL_DIRECTORY_SIZE - ZIP_MAX_COMMENT_SIZE : 0;
+    const uint8_t* eocd = nullptr;
+    for (size_t i = size - ZIP_END_OF_CENTRAL_DIRECTORY_SIZE + 1; i-- > siLowest;) {
+        if (ReadLe32(data + i) == ZIP_END_OF_CENTRAL_DIRECTORY_SIGNATURE) {
+            eocd = data + i;
+            break;
+        }
+    }
+    if (eocd == nullptr) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    uint16_t usEntries = ReadLe16(eocd + 10);
+    uint32_t ulDirectoryOffset = ReadLe32(eocd + 16);
+    if (usEntries == 0xFFFF || ulDirectoryOffset == 0xFFFFFFFF) {
+        Abort("ZIP64 archives are not supported");
+        return ERROR_INVALID_INPUT;
+    }
+
+    std::vector<uint8_t> vecMember; // 멤버마다 재사용
+    size_t siPosition = ulDirectoryOffset;
+    for (uint16_t i = 0; i < usEntries && !m_bAborted; i++) {
+        if (siPosition > size || size - siPosition < 46 || ReadLe32(data + siPosition) != ZIP_CENTRAL_HEADER_SIGNATURE) {
+            return ERROR_INVALID_INPUT;
+        }
+        const uint8_t* entry = data + siPosition;
+        uint16_t usFlags = ReadLe16(entry + 8);
+        uint16_t usMethod = ReadLe16(entry + 10);
+        uint32_t ulCompressedSize = ReadLe32(entry + 20);
+        uint32_t ulUncompressedSize = ReadLe32(entry + 24);
+        uint16_t usNameLength = ReadLe16(entry + 28);
+        size_t siEntryLength = 46 + usNameLength + ReadLe16(entry + 30) + ReadLe16(entry + 32);
+        uint64_t ullLocalOffset = ReadLe32(entry + 42); // 32비트 덧셈이 넘쳐 경계 검사를 통과하지 않도록 64비트로 계산
+        if (size - siPosition < siEntryLength) {
+            return ERROR_INVALID_INPUT;
+        }
+        std::string strName(reinterpret_cast<const char*>(entry + 46), usNameLength);
+        siPosition += siEntryLength;
+
+        // 디렉토리, 암호화된 멤버, 지원하지 않는 압축 방식은 건너뜀
+        if (strName.empty() || strName.back() == '/' || (usFlags & 0x1) || (usMethod != 0 && usMethod != Z_DEFLATED)) {
+            continue;
+        }
+        if (ullLocalOffset > size || size - ullLocalOffset < 30 || ReadLe32(data + ullLocalOffset) != ZIP_LOCAL_HEADER_SIGNATURE) {
+            continue;
+        }
+        uint64_t ullDataOffset = ullLocalOffset + 30 + ReadLe16(data + ullLocalOffset + 26) + ReadLe16(data + ullLocalOffset + 28);
+        if (ullDataOffset > size || size - ullDataOffset < ulCompressedSize) {
+            continue;
+        }
+        const uint8_t* compressed = data + ullDataOffset;
+
+        if (usMethod == 0) {
+            // 저장 방식은 복사 없이 원본 매핑을 그대로 넘김
+            EmitMember(prefix + strName, compressed, ulCompressedSize, depth, callback);
+            continue;
+        }
+
+        if (ulUncompressedSize > ARCHIVE_MAX_MEMBER_SIZE) {
+            NoteLimit(MemberSizeReason(prefix + strName));
+            continue;
+        }
+        if (ulUncompressedSize > ARCHIVE_RATIO_MIN_BYTES && ulUncompressedSize > static_cast<uint64_t>(ulCompressedSize) * ARCHIVE_MAX_RATIO) {
+            Abort("expansion ratio over " + std::to_string(ARCHIVE_MAX_RATIO) + " at " + prefix + strName);
+            break;
+        }
+        if (!ReserveBytes(ulUncompressedSize)) {
+            break;
+        }
+
+        // 중앙 디렉토리의 크기만큼만 출력 공간을 주므로 크기를 속인 멤버도 그 이상 풀리지 않음
+        vecMember.resize(ulUncompressedSize);
+        z_stream stream = {};
+        if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+            return ERROR_UNKNOWN;
+        }
+        stream.next_in = const_cast<Bytef*>(compressed);
+        stream.avail_in = ulCompressedSize;
+        stream.next_out = vecMember.data();
+        stream.avail_out = ulUncompressedSize;
+        int nStatus = inflate(&stream, Z_FINISH);
+        size_t siProduced = stream.total_out;
+        inflateEnd(&stream);
+        if (nStatus != Z_STREAM_END && nStatus != Z_BUF_ERROR) {
+            continue;
+        }
+        EmitMember(prefix + strName, vecMember.data(), siProduced, depth, callback);
+    }
+    return SUCCESS_CODE;
+}
+
+// gzip은 조각 단위로 풀어 tar 해석기에 넣고, tar가 아니면 풀린 내용 전체를 멤버 하나로 취급
+int CArchiveReader::ReadGzip(const std::string& prefix, const std::string& containerName, const uint8_t* data, size_t size,
+                             int depth, const ArchiveMemberCallback& callback) {
+    z_stream stream = {};
+    if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) {
+        return ERROR_UNKNOWN;
+    }
+    // avail_in은 32비트이므로 4 GB가 넘는 입력은 나누어 넣음
+    const uint8_t* pInput = data;
+    size_t siInputLeft = size;
+
+    // 압축 비율은 tar 멤버마다 따로 봄 (멤버 헤더가 나올 때 새로 셈), tar가 아니면 풀린 내용 전체가 멤버 하나
+    std::string strRatioMember = prefix + containerName;
+    uint64_t ullMemberIn = 0;
+    uint64_t ullMemberOut = 0;
+
+    CTarStream tarStream(
+        [&](const std::string& name, const uint8_t* member, size_t memberSize) { EmitMember(prefix + name, member, memberSize, depth, callback); },
+        [&](const std::string& name, uint64_t bytes) {
+            strRatioMember = prefix + name;
+            ullMemberIn = 0;
+            ullMemberOut = 0;
+            return ReserveMember(prefix + name, bytes);
+        });
+
+    std::vector<uint8_t> vecChunk(ARCHIVE_CHUNK_SIZE);
+    std::vector<uint8_t> vecPlain;  // tar가 아닐 때 모으는 내용
+    std::vector<uint8_t> vecProbe;  // tar 여부를 판단하기 위한 첫 블록
+    bool bIsTar = false;
+    bool bDecided = false;
+    int nStatus = Z_OK;
+
+    while (nStatus != Z_STREAM_END && !m_bAborted) {
+        if (stream.avail_in == 0 && siInputLeft > 0) {
+            uInt uiFeed = static_cast<uInt>(std::min<size_t>(siInputLeft, UINT_MAX));
+            stream.next_in = const_cast<Bytef*>(pInput);
+            stream.avail_in = uiFeed;
+            pInput += uiFeed;
+            siInputLeft -= uiFeed;
+        }
+        uInt uiAvailableIn = stream.avail_in;
+        stream.next_out = vecChunk.data();
+        stream.avail_out = ARCHIVE_CHUNK_SIZE;
+        nStatus = inflate(&stream, Z_NO_FLUSH);
+        if (nStatus != Z_OK && nStatus != Z_STREAM_END) {
+            break;
+        }
+        size_t siLength = ARCHIVE_CHUNK_SIZE - stream.avail_out;
+        ullMemberIn += uiAvailableIn - stream.avail_in;
+        ullMemberOut += siLength;
+        if (ullMemberOut > ARCHIVE_RATIO_MIN_BYTES && ullMemberOut > ullMemberIn * ARCHIVE_MAX_RATIO) {
+            Abort("expansion ratio over " + std::to_string(ARCHIVE_MAX_RATIO) + " at " + strRatioMember);
+            break;
+        }
+
+        const uint8_t* chunk = vecChunk.data();
+        if (!bDecided) {
+            size_t siTake = std::min(siLength, static_cast<size_t>(TAR_BLOCK_SIZE) - vecProbe.size());
+            vecProbe.insert(vecProbe.end(), chunk, chunk + siTake);
+            chunk += siTake;
+            siLength -= siTake;
+            if (vecProbe.size() < TAR_BLOCK_SIZE && nStatus != Z_STREAM_END) {
+                continue;
+            }
+            bDecided = true;
+            bIsTar = vecProbe.size() == TAR_BLOCK_SIZE && IsTarHeader(vecProbe.data());
+            if (bIsTar) {
+                tarStream.Feed(vecProbe.data(), vecProbe.size());
+            } else if (ReserveBytes(vecProbe.size())) {
+                vecPlain = vecProbe;
+            }
+        }
+
+        if (bIsTar) {
+            if (!tarStream.Feed(chunk, siLength)) {
+                break;
+            }
+        } else if (vecPlain.size() + siLength > ARCHIVE_MAX_MEMBER_SIZE) {
+            // tar가 아닌 gzip은 제한까지 풀린 앞부분만 멤버로 넘김
+            size_t siRoom = ARCHIVE_MAX_MEMBER_SIZE - vecPlain.size();
+            if (ReserveBytes(siRoom)) {
+                vecPlain.insert(vecPlain.end(), chunk, chunk + siRoom);
+                NoteLimit("only first " + std::to_string(ARCHIVE_MAX_MEMBER_SIZE / (1024 * 1024)) + " MB scanned at " + prefix + containerName);
+            }
+            break;
+        } else if (ReserveBytes(siLength)) {
+            vecPlain.insert(vecPlain.end(), chunk, chunk + siLength);
+        }
+
+        // 여러 gzip 멤버가 이어진 파일은 다음 멤버를 계속 풀어 같은 스트림으로 취급
+        if (nStatus == Z_STREAM_END && (stream.avail_in > 0 || siInputLeft > 0)) {
+            inflateReset(&stream);
+            nStatus = Z_OK;
+        }
+    }
+    inflateEnd(&stream);
+
+    if (!bIsTar && !vecPlain.empty() && !m_bAborted) {
+        std::string strName = containerName;
+        for (const char* suffix : {".gz", ".tgz"}) {
+            size_t siLength = strlen(suffix);
+            if (strName.size() > siLength && strName.compare(strName.size() - siLength, siLength, suffix) == 0) {
+                strName = strName.substr(0, strName.size() - siLength) + (strcmp(suffix, ".tgz") == 0 ? ".tar" : "");
+                break;
+            }
+        }
+        EmitMember(prefix + strName, vecPlain.data(), vecPlain.size(), depth, callback);
+    }
+    return SUCCESS_CODE;
+}
+
+int CArchiveReader::ReadTar(const std::string& prefix, const uint8_t* data, size_t size, int depth, const ArchiveMemberCallback& callback) {
+    CTarStream tarStream(
+        [&](const std::string& name, const uint8_t* member, size_t memberSize) { EmitMember(prefix + name, member, memberSize, depth, callback); },
+        [&](const std::string& name, uint64_t bytes) { return ReserveMember(prefix + name, bytes); });
+    tarStream.Feed(data, size);
+    return tarStream.IsInvalid() ? ERROR_INVALID_INPUT : SUCCESS_CODE;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#define ARCHIVE_MAX_DEPTH 3                            // 중첩 압축 파일을 펼치는 최대 깊이
+#define ARCHIVE_MAX_RATIO 100                          // 압축 해제 크기 / 압축 크기의 최대 비율
+#define ARCHIVE_RATIO_MIN_BYTES (1024 * 1024)          // 이보다 작게 풀리는 멤버는 비율 검사를 하지 않음
+#define ARCHIVE_MAX_MEMBER_SIZE (64 * 1024 * 1024)     // 멤버 하나의 최대 압축 해제 크기
+#define ARCHIVE_MAX_TOTAL_BYTES (256 * 1024 * 1024)    // 최상위 압축 파일 하나에서 풀어내는 총량
+#define ARCHIVE_CHUNK_SIZE (64 * 1024)                 // gzip 스트림 해제 단위
+#define ARCHIVE_PATH_SEPARATOR "!"                     // 중첩 경로 구분자 (예: a.zip!lib/b.jar!x.class)
+
+enum EArchiveType {
+    ARCHIVE_NONE,
+    ARCHIVE_ZIP,
+    ARCHIVE_GZIP,
+    ARCHIVE_TAR
+};
+
+// 멤버 경로(컨테이너 내부 경로, 중첩 시 구분자로 연결)와 압축 해제된 내용을 받는 콜백
+using ArchiveMemberCallback = std::function<void(const std::string& memberPath, const uint8_t* data, size_t size)>;
+
+// zip/jar, tar, tar.gz(gz)을 임시 파일 없이 메모리에서 풀어 멤버 단위로 넘겨주는 읽기 전용 해제기
+// zip은 중앙 디렉토리를 기준으로 멤버별로 inflate하고, gzip은 스트림으로 풀면서 tar 헤더를 해석함
+// 중첩 깊이, 압축 비율, 총 해제량 제한을 넘으면 해당 압축 파일의 나머지는 건너뜀
+// 멤버 크기 제한을 넘는 멤버는 그 멤버만 건너뛰며, 어느 제한이든 걸리면 GetLimitReason에 처음 이유가 남음
+class CArchiveReader {
+public:
+    CArchiveReader();
+    int Read(const std::string& containerName, const uint8_t* data, size_t size, const ArchiveMemberCallback& callback);
+    const std::string& GetLimitReason() const { return m_strLimitReason; }
+    uint64_t GetExpandedBytes() const { return m_ullTotalBytes; }
+
+    static EArchiveType DetectType(const uint8_t* data, size_t size);
+
+private:
+    uint64_t m_ullTotalBytes;
+    bool m_bAborted;              // 비율/총량 제한에 걸려 나머지 멤버를 건너뛰는 중
+    std::string m_strLimitReason; // 처음 걸린 제한의 이유, 비어 있으면 모두 펼침
+
+    int ReadArchive(const std::string& prefix, const std::string& containerName, const uint8_t* data, size_t size,
+                    int depth, const ArchiveMemberCallback& callback);
+    int ReadZip(const std::string& prefix, const uint8_t* data, size_t size, int depth, const ArchiveMemberCallback& callback);
+    int ReadGzip(const std::string& prefix, const std::string& containerName, const uint8_t* data, size_t size,
+                 int depth, const ArchiveMemberCallback& callback);
+    int ReadTar(const std::string& prefix, const uint8_t* data, size_t size, int depth, const ArchiveMemberCallback& callback);
+    void EmitMember(const std::string& memberPath, const uint8_t* data, size_t size, int depth, const ArchiveMemberCallback& callback);
+    bool ReserveBytes(uint64_t bytes);
+    bool ReserveMember(const std::string& memberPath, uint64_t bytes);
+    bool Abort(const std::string& reason);
+    void NoteLimit(const std::string& reason);
+    static std::string MemberSizeReason(const std::string& memberPath);
+};
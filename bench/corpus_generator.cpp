@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sys/stat.h>
+#include "corpus_generator.h"
+#include "util.h"
+
+Json::Value ST_CorpusSpec::ToJson() const {
+    Json::Value value;
+    value["tiny_files"] = Json::UInt64(TinyFiles);
+    value["tiny_max_size"] = Json::UInt64(TinyMaxSize);
+    value["huge_files"] = Json::UInt64(HugeFiles);
+    value["huge_size_mb"] = Json::UInt64(HugeSizeMb);
+    value["tree_depth"] = TreeDepth;
+    value["tree_fanout"] = TreeFanout;
+    value["elf_percent"] = ElfPercent;
+    value["planted_files"] = Json::UInt64(PlantedFiles);
+    value["seed"] = Json::UInt64(Seed);
+    return value;
+}
+
+CCorpusGenerator::CCorpusGenerator(const std::string& corpusDir, const ST_CorpusSpec& spec)
+    : m_strCorpusDir(corpusDir), m_spec(spec), m_random(spec.Seed), m_ullFileCount(0), m_ullTotalBytes(0) {}
+
+// 같은 조건으로 만든 코퍼스가 이미 있으면 재사용하여 빌드 간 비교가 같은 파일로 이루어지도록 함
+int CCorpusGenerator::Generate(bool force) {
+    if (!force && IsUpToDate()) {
+        std::cout << "[+] Reusing corpus " << GetTreePath() << " (" << m_ullFileCount << " files, "
+                  << m_ullTotalBytes / (1024 * 1024) << " MB)\n";
+        return SUCCESS_CODE;
+    }
+    std::error_code error;
+    std::filesystem::remove_all(GetTreePath(), error);
+    std::filesystem::remove(m_strCorpusDir + "/" CORPUS_MANIFEST_NAME, error);
+    std::filesystem::create_directories(GetTreePath(), error);
+    if (error) {
+        PrintErrorMessage(ERROR_CANNOT_OPEN_DIRECTORY, GetTreePath());
+        return ERROR_CANNOT_OPEN_DIRECTORY;
+    }
+
+    m_vecDirectories.clear();
+    int nResult = CreateTree(GetTreePath(), 0);
+    if (nResult != SUCCESS_CODE) {
+        return nResult;
+    }
+
+    // 작은 파일은 모든 디렉토리에 고르게, 큰 파일과 탐지 파일은 임의의 디렉토리에 배치
+    std::vector<uint8_t> vecData;
+    std::uniform_int_distribution<uint64_t> sizeDistribution(0, m_spec.TinyMaxSize);
+    std::uniform_int_distribution<int> percentDistribution(0, 99);
+    std::uniform_int_distribution<size_t> directoryDistribution(0, m_vecDirectories.size() - 1);
+    for (uint64_t i = 0; i < m_spec.TinyFiles; i++) {
+        const std::string& strDirectory = m_vecDirectories[i % m_vecDirectories.size()];
+        size_t siSize = sizeDistribution(m_random);
+        bool bElf = percentDistribution(m_random) < m_spec.ElfPercent;
+        if (bElf) {
+            FillElf(vecData, siSize);
+        } else {
+            FillText(vecData, siSize);
+        }
+        nResult = WriteFile(strDirectory + "/file_" + std::to_string(i) + (bElf ? ".so" : ".txt"), vecData);
+        if (nResult != SUCCESS_CODE) {
+            return nResult;
+        }
+    }
+    for (uint64_t i = 0; i < m_spec.HugeFiles; i++) {
+        nResult = WriteHugeFile(m_vecDirectories[directoryDistribution(m_random)] + "/huge_" + std::to_string(i) + ".bin", m_spec.HugeSizeMb * 1024 * 1024);
+        if (nResult != SUCCESS_CODE) {
+            return nResult;
+        }
+    }
+    vecData.assign(CORPUS_PLANTED_SAMPLE, CORPUS_PLANTED_SAMPLE + strlen(CORPUS_PLANTED_SAMPLE));
+    for (uint64_t i = 0; i < m_spec.PlantedFiles; i++) {
+        nResult = WriteFile(m_vecDirectories[directoryDistribution(m_random)] + "/planted_" + std::to_string(i) + ".txt", vecData);
+        if (nResult != SUCCESS_CODE) {
+            return nResult;
+        }
+    }
+
+    std::cout << "[+] Generated corpus " << GetTreePath() << " (" << m_vecDirectories.size() << " directories, " << m_ullFileCount
+              << " files, " << m_ullTotalBytes / (1024 * 1024) << " MB)\n";
+    return SaveManifest();
+}
+
+bool CCorpusGenerator::IsUpToDate() {
+    std::ifstream manifestFile(m_strCorpusDir + "/" CORPUS_MANIFEST_NAME);
+    Json::Value manifest;
+    Json::CharReaderBuilder reader;
+    std::string strErrors;
+    if (!manifestFile.is_open() || !Json::parseFromStream(reader, manifestFile, &manifest, &strErrors)) {
+        return false;
+    }
+    if (manifest["spec"] != m_spec.ToJson() || !IsDirectory(GetTreePath())) {
+        return false;
+    }
+    m_ullFileCount = manifest.get("files", 0).asUInt64();
+    m_ullTotalBytes = manifest.get("bytes", 0).asUInt64();
+    return true;
+}
+
+int CCorpusGenerator::CreateTree(const std::string& path, int depth) {
+    if (mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+        PrintErrorMessage(ERROR_CANNOT_OPEN_DIRECTORY, path);
+        return ERROR_CANNOT_OPEN_DIRECTORY;
+    }
+    m_vecDirectories.push_back(path);
+    if (depth >= m_spec.TreeDepth) {
+        return SUCCESS_CODE;
+    }
+    for (int i = 0; i < m_spec.TreeFanout; i++) {
+        int nResult = CreateTree(path + "/d" + std::to_string(depth) + "_" + std::to_string(i), depth + 1);
+        if (nResult != SUCCESS_CODE) {
+            return nResult;
+        }
+    }
+    return SUCCESS_CODE;
+}
+
+int CCorpusGenerator::WriteFile(const std::string& path, const std::vector<uint8_t>& data) {
+    std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        PrintErrorMessage(ERROR_CANNOT_OPEN_FILE, path);
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    if (!file.good()) {
+        PrintErrorMessage(ERROR_CANNOT_WRITE_FILE, path);
+        return ERROR_CANNOT_WRITE_FILE;
+    }
+    m_ullFileCount++;
+    m_ullTotalBytes += data.size();
+    return SUCCESS_CODE;
+}
+
+// 큰 파일은 청크 단위로 난수를 채워 메모리 사용량을 일정하게 유지
+int CCorpusGenerator::WriteHugeFile(const std::string& path, uint64_t size) {
+    std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        PrintErrorMessage(ERROR_CANNOT_OPEN_FILE, path);
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+    std::vector<uint64_t> vecChunk(CORPUS_WRITE_CHUNK / sizeof(uint64_t));
+    uint64_t ullRemaining = size;
+    while (ullRemaining > 0) {
+        for (uint64_t& value : vecChunk) {
+            value = m_random();
+        }
+        size_t siLength = std::min<uint64_t>(ullRemaining, CORPUS_WRITE_CHUNK);
+        file.write(reinterpret_cast<const char*>(vecChunk.data()), siLength);
+        ullRemaining -= siLength;
+    }
+    if (!file.good()) {
+        PrintErrorMessage(ERROR_CANNOT_WRITE_FILE, path);
+        return ERROR_CANNOT_WRITE_FILE;
+    }
+    m_ullFileCount++;
+    m_ullTotalBytes += size;
+    return SUCCESS_CODE;
+}
+
+// 소문자 단어와 공백/줄바꿈으로 된 텍스트 (YARA 룰의 텍스트 문자열이 부분 일치를 시도하도록)
+void CCorpusGenerator::FillText(std::vector<uint8_t>& data, size_t size) {
+    data.resize(size);
+    std::uniform_int_distribution<int> letterDistribution(0, 31);
+    for (size_t i = 0; i < size; i++) {
+        int nValue = letterDistribution(m_random);
+        data[i] = nValue < 26 ? static_cast<uint8_t>('a' + nValue) : (nValue < 31 ? ' ' : '\n');
+    }
+}
+
+// ELF 매직과 64비트/리틀 엔디언 식별 바이트 뒤에 난수 (ELF 파일만 검사하는 옵션과 우선 스캔의 매직 확인 대상)
+void CCorpusGenerator::FillElf(std::vector<uint8_t>& data, size_t size) {
+    static const uint8_t elfHeader[] = {0x7f, 'E', 'L', 'F', 2, 1, 1, 0};
+    data.resize(size);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = i < sizeof(elfHeader) ? elfHeader[i] : static_cast<uint8_t>(m_random());
+    }
+}
+
+int CCorpusGenerator::SaveManifest() {
+    Json::Value manifest;
+    manifest["spec"] = m_spec.ToJson();
+    manifest["files"] = Json::UInt64(m_ullFileCount);
+    manifest["bytes"] = Json::UInt64(m_ullTotalBytes);
+    manifest["directories"] = Json::UInt64(m_vecDirectories.size());
+    manifest["generated_at"] = GetCurrentTimeWithMilliseconds();
+
+    std::string strPath = m_strCorpusDir + "/" CORPUS_MANIFEST_NAME;
+    std::ofstream manifestFile(strPath, std::ios::out | std::ios::trunc);
+    if (!manifestFile.is_open()) {
+        PrintErrorMessage(ERROR_CANNOT_OPEN_FILE, strPath);
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+    Json::StreamWriterBuilder writer;
+    manifestFile << Json::writeString(writer, manifest) << "\n";
+    return manifestFile.good() ? SUCCESS_CODE : ERROR_CANNOT_WRITE_FILE;
+}
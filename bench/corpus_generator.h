@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include <jsoncpp/json/json.h>
+
+#define CORPUS_TREE_DIR "tree"                 // 스캔 대상 디렉토리 (코퍼스 디렉토리 아래)
+#define CORPUS_MANIFEST_NAME "corpus.json"     // 생성 조건을 기록하여 같은 조건이면 다시 만들지 않음
+#define CORPUS_PLANTED_SAMPLE "file scan test" // scan-test/malware1.txt와 같은 내용 (Udkd_Rules.yar와 hashes.txt 양쪽에서 탐지)
+#define CORPUS_WRITE_CHUNK (1 << 20)
+
+// 코퍼스 생성 조건, 같은 조건과 시드는 항상 같은 파일을 만듦
+struct ST_CorpusSpec {
+    uint64_t TinyFiles = 20000;
+    uint64_t TinyMaxSize = 4096;       // 작은 파일 크기는 0 ~ TinyMaxSize 균등 분포
+    uint64_t HugeFiles = 4;
+    uint64_t HugeSizeMb = 256;
+    int TreeDepth = 6;
+    int TreeFanout = 3;                // 디렉토리당 하위 디렉토리 수 (전체 디렉토리 수는 fanout^depth에 비례)
+    int ElfPercent = 30;               // 작은 파일 중 ELF 헤더로 시작하는 파일 비율, 나머지는 텍스트
+    uint64_t PlantedFiles = 10;        // 두 엔진 모두 탐지해야 하는 파일 수
+    uint64_t Seed = 42;
+
+    Json::Value ToJson() const;
+};
+
+// 스캐너 성능 비교용 합성 코퍼스 생성기
+// 작은 파일 다수(열기/메타데이터 비용), 큰 파일 소수(읽기/매칭 처리량), 깊은 트리(순회 비용), ELF/텍스트 혼합과 심어둔 탐지 파일로 구성
+class CCorpusGenerator {
+public:
+    CCorpusGenerator(const std::string& corpusDir, const ST_CorpusSpec& spec);
+    int Generate(bool force);
+    std::string GetTreePath() const { return m_strCorpusDir + "/" CORPUS_TREE_DIR; }
+    uint64_t GetFileCount() const { return m_ullFileCount; }
+    uint64_t GetTotalBytes() const { return m_ullTotalBytes; }
+
+private:
+    std::string m_strCorpusDir;
+    ST_CorpusSpec m_spec;
+    std::mt19937_64 m_random;
+    std::vector<std::string> m_vecDirectories;
+    uint64_t m_ullFileCount;
+    uint64_t m_ullTotalBytes;
+
+    bool IsUpToDate();
+    int CreateTree(const std::string& path, int depth);
+    int WriteFile(const std::string& path, const std::vector<uint8_t>& data);
+    int WriteHugeFile(const std::string& path, uint64_t size);
+    void FillText(std::vector<uint8_t>& data, size_t size);
+    void FillElf(std::vector<uint8_t>& data, size_t size);
+    int SaveManifest();
+};
@@ -0,0 +1,99 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <unistd.h>
+#include "db_bench.h"
+#include "util.h"
+
+static void RemoveDatabaseFiles() {
+    for (const char* chSuffix : {"", "-wal", "-shm", "-journal"}) {
+        unlink((std::string(DB_BENCH_DATABASE_PATH) + chSuffix).c_str());
+    }
+}
+
+// 모니터 작업자와 같은 순서로 호출 (수정은 이전 해시 조회 후 기록, 삭제는 files에서 지운 뒤 기록)
+static void LogBenchEvent(CDatabaseManager& database, uint64_t index) {
+    ST_MonitorData data = {
+        .eventType = "",
+        .filePath = "/bench/monitor/dir" + std::to_string(index % 10) + "/file" + std::to_string(index % DB_BENCH_PATH_COUNT) + ".txt",
+        .newHash = "",
+        .oldHash = "",
+        .timestamp = GetCurrentTimeWithMilliseconds(),
+        .fileSize = static_cast<int64_t>(index % 65536),
+        .user = "bench",
+        .processId = static_cast<int>(getpid()),
+        .mtimeNs = static_cast<int64_t>(index + 1) * 1000,
+        .ctimeNs = static_cast<int64_t>(index + 1) * 1000,
+        .isArchive = false,
+        .mergedEvents = 1
+    };
+    std::string strHash = std::to_string(index);
+    data.newHash = std::string(64 - strHash.size(), '0') + strHash;
+
+    if (index < DB_BENCH_PATH_COUNT) {
+        data.eventType = "File created";
+    } else if (index % 20 == 19) {
+        data.eventType = "File deleted";
+        data.oldHash = database.GetFileHash(data.filePath);
+        data.newHash.clear();
+        database.RemoveFileFromDatabase(data.filePath);
+    } else {
+        data.eventType = "File modified";
+        data.oldHash = database.GetFileHash(data.filePath);
+    }
+    database.LogEventToDatabase(data);
+}
+
+static Json::Value BenchCase(const ST_DatabaseBenchCase& benchCase, uint64_t eventCount) {
+    RemoveDatabaseFiles();
+    Json::Value result;
+    result["name"] = benchCase.Name;
+    result["journal_mode"] = benchCase.Options.JournalMode;
+    result["synchronous"] = benchCase.Options.Synchronous;
+    result["batch_size"] = benchCase.Options.BatchSize;
+    result["flush_interval_ms"] = benchCase.Options.FlushIntervalMs;
+    {
+        CDatabaseManager database(benchCase.Options, DB_BENCH_DATABASE_PATH);
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < eventCount; i++) {
+            LogBenchEvent(database, i);
+        }
+        database.Flush();
+        double wallSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        result["events"] = Json::UInt64(eventCount);
+        result["wall_time_sec"] = wallSec;
+        result["events_per_sec"] = wallSec > 0 ? eventCount / wallSec : 0.0;
+        result["transactions"] = Json::UInt64(database.GetTransactionCount());
+    }
+    RemoveDatabaseFiles();
+    return result;
+}
+
+int RunDatabaseBench(uint64_t eventCount, Json::Value& report) {
+    ST_DatabaseOptions legacy;
+    legacy.JournalMode = "DELETE";
+    legacy.Synchronous = "FULL";
+    legacy.BatchSize = 1;
+    ST_DatabaseOptions walPerEvent;
+    walPerEvent.BatchSize = 1;
+    const std::vector<ST_DatabaseBenchCase> vecCases = {
+        {"per-event", legacy},
+        {"per-event-wal", walPerEvent},
+        {"batched-wal", ST_DatabaseOptions()},
+    };
+
+    std::cout << "\n### Monitor Database Benchmark Start ! (" << eventCount << " events per case) ###\n\n";
+    report["timestamp"] = GetCurrentTimeWithMilliseconds();
+    report["build"]["compiler"] = __VERSION__;
+    report["results"] = Json::Value(Json::arrayValue);
+    for (const ST_DatabaseBenchCase& benchCase : vecCases) {
+        Json::Value result = BenchCase(benchCase, eventCount);
+        std::cout << "[+] " << std::left << std::setw(14) << benchCase.Name << ": " << std::fixed << std::setprecision(3)
+                  << result["wall_time_sec"].asDouble() << " sec, " << std::setprecision(0) << result["events_per_sec"].asDouble()
+                  << " events/s, " << result["transactions"].asUInt64() << " transactions\n\n";
+        std::cout.unsetf(std::ios::fixed);
+        report["results"].append(result);
+    }
+    return SUCCESS_CODE;
+}
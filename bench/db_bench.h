@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <jsoncpp/json/json.h>
+#include "database_manager.h"
+
+#define DB_BENCH_DATABASE_PATH "bench/db_bench.db"
+#define DB_BENCH_DEFAULT_REPORT_PATH "logs/db_bench.json"
+#define DB_BENCH_PATH_COUNT 1000   // 이벤트가 돌아가며 쓰는 파일 경로 수 (files 테이블 삽입과 갱신이 섞이도록)
+
+// 비교할 DB 설정 하나
+struct ST_DatabaseBenchCase {
+    std::string Name;
+    ST_DatabaseOptions Options;
+};
+
+// 파일 이벤트 모니터의 DB 기록 처리량 측정
+// 설정마다 빈 DB에 같은 이벤트(생성/수정/삭제 혼합)를 기록하고, 모두 커밋될 때까지의 시간으로 events/s 계산
+// 이벤트마다 autocommit(이전 동작, DELETE 저널 + synchronous=FULL)과 WAL, 트랜잭션 묶음 기록을 비교
+int RunDatabaseBench(uint64_t eventCount, Json::Value& report);
@@ -0,0 +1,325 @@
+#include <chrono>
+#include <fcntl.h>
+#include <fstream>
+#include <getopt.h>
+#include <iomanip>
+#include <iostream>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "ansi_color.h"
+#include "corpus_generator.h"
+#include "db_bench.h"
+#include "file_scanner.h"
+#include "util.h"
+
+#define BENCH_DEFAULT_CORPUS_DIR "bench/corpus"
+#define BENCH_DEFAULT_REPORT_PATH "logs/scan_bench.json"
+#define BENCH_DEFAULT_REPETITIONS 3    // 엔진별 반복 횟수, 첫 실행은 페이지 캐시를 채우므로 최솟값을 대표값으로 사용
+
+// 스캔 벤치마크는 UdkdAgent와 같은 오브젝트를 링크한 별도 실행 파일 (make bench)
+// 저장소 루트에서 실행해야 yara-rules와 hashes.txt를 스캐너가 찾을 수 있음
+
+enum EBenchOption {
+    BENCH_OPT_CORPUS = 1000,
+    BENCH_OPT_TINY,
+    BENCH_OPT_TINY_MAX_SIZE,
+    BENCH_OPT_HUGE,
+    BENCH_OPT_HUGE_SIZE,
+    BENCH_OPT_DEPTH,
+    BENCH_OPT_FANOUT,
+    BENCH_OPT_ELF_PERCENT,
+    BENCH_OPT_PLANTED,
+    BENCH_OPT_SEED,
+    BENCH_OPT_ENGINE,
+    BENCH_OPT_REPEAT,
+    BENCH_OPT_OUTPUT,
+    BENCH_OPT_REGENERATE,
+    BENCH_OPT_GENERATE_ONLY,
+    BENCH_OPT_DB_EVENTS
+};
+
+struct option benchOptions[] = {
+    {"help", no_argument, 0, 'h'},
+    {"corpus", required_argument, 0, BENCH_OPT_CORPUS},
+    {"tiny", required_argument, 0, BENCH_OPT_TINY},
+    {"tiny-max-size", required_argument, 0, BENCH_OPT_TINY_MAX_SIZE},
+    {"huge", required_argument, 0, BENCH_OPT_HUGE},
+    {"huge-size-mb", required_argument, 0, BENCH_OPT_HUGE_SIZE},
+    {"depth", required_argument, 0, BENCH_OPT_DEPTH},
+    {"fanout", required_argument, 0, BENCH_OPT_FANOUT},
+    {"elf-percent", required_argument, 0, BENCH_OPT_ELF_PERCENT},
+    {"planted", required_argument, 0, BENCH_OPT_PLANTED},
+    {"seed", required_argument, 0, BENCH_OPT_SEED},
+    {"engine", required_argument, 0, BENCH_OPT_ENGINE},
+    {"repeat", required_argument, 0, BENCH_OPT_REPEAT},
+    {"output", required_argument, 0, BENCH_OPT_OUTPUT},
+    {"regenerate", no_argument, 0, BENCH_OPT_REGENERATE},
+    {"generate-only", no_argument, 0, BENCH_OPT_GENERATE_ONLY},
+    {"db-events", required_argument, 0, BENCH_OPT_DB_EVENTS},
+    {0, 0, 0, 0}
+};
+
+struct ST_BenchRun {
+    int ExitCode;
+    double WallSec;
+    long PeakRssKb;
+    Json::Value Summary;
+    Json::Value Profile;
+};
+
+static void DisplayBenchHelp() {
+    std::cout << "Usage: UdkdBench [options]   (run from the repository root)\n\n"
+              << "Corpus options (the corpus is reused while these stay the same): \n"
+              << "  --corpus <dir>              Corpus directory (Default is '" BENCH_DEFAULT_CORPUS_DIR "').\n"
+              << "  --tiny <n>                  Number of small files (Default is 20000).\n"
+              << "  --tiny-max-size <bytes>     Small file size is uniform in [0, bytes] (Default is 4096).\n"
+              << "  --huge <n>                  Number of large random files (Default is 4).\n"
+              << "  --huge-size-mb <mb>         Size of each large file (Default is 256).\n"
+              << "  --depth <n>                 Directory tree depth (Default is 6).\n"
+              << "  --fanout <n>                Subdirectories per directory (Default is 3).\n"
+              << "  --elf-percent <0-100>       Share of small files starting with an ELF header (Default is 30).\n"
+              << "  --planted <n>               Files both engines must detect (Default is 10).\n"
+              << "  --seed <n>                  Random seed (Default is 42).\n"
+              << "  --regenerate                Rebuild the corpus even if it matches.\n"
+              << "  --generate-only             Only build the corpus.\n\n"
+              << "Run options: \n"
+              << "  --engine <yara|hash|all>    Engine mode to measure (Default is all).\n"
+              << "  --repeat <n>                Runs per engine, the fastest is reported as best (Default is 3).\n"
+              << "  --output <file>             JSON report path (Default is '" BENCH_DEFAULT_REPORT_PATH "').\n\n"
+              << "Monitor database benchmark (instead of the scan benchmark): \n"
+              << "  --db-events <n>             Write n file events per database setting and report events/s\n"
+              << "                              (Default report is '" DB_BENCH_DEFAULT_REPORT_PATH "').\n";
+}
+
+// 스캔 한 번을 자식 프로세스에서 실행하여 실행마다 최대 RSS를 따로 측정 (wait4의 ru_maxrss)
+// 스캐너의 화면 출력은 측정을 왜곡하지 않도록 /dev/null로 보냄
+static int RunScan(const std::string& treePath, int scanType, ST_BenchRun& run) {
+    std::string strSummaryPath = "logs/scan_bench_summary." + std::to_string(getpid()) + ".json";
+    std::string strProfilePath = "logs/scan_bench_profile." + std::to_string(getpid()) + ".json";
+
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == -1) {
+        PrintError("fork failed");
+        return ERROR_UNKNOWN;
+    }
+    if (pid == 0) {
+        int nullFd = open("/dev/null", O_WRONLY);
+        if (nullFd != -1) {
+            dup2(nullFd, STDOUT_FILENO);
+            close(nullFd);
+        }
+        ST_ScanOptions options;
+        options.Headless = true;
+        options.TargetPath = treePath;
+        options.ScanTypeOption = scanType;
+        options.SummaryPath = strSummaryPath;
+        options.ProfilePath = strProfilePath;
+        options.Checkpoint = false;
+        CFileScanner IFileScanner;
+        IFileScanner.SetOptions(options);
+        _exit(IFileScanner.StartScan());
+    }
+
+    int nStatus = 0;
+    struct rusage usage = {};
+    wait4(pid, &nStatus, 0, &usage);
+    run.WallSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    run.ExitCode = WIFEXITED(nStatus) ? WEXITSTATUS(nStatus) : -1;
+    run.PeakRssKb = usage.ru_maxrss;
+
+    Json::CharReaderBuilder reader;
+    std::string strErrors;
+    std::ifstream summaryFile(strSummaryPath);
+    std::ifstream profileFile(strProfilePath);
+    if (!summaryFile.is_open() || !Json::parseFromStream(reader, summaryFile, &run.Summary, &strErrors)
+        || !profileFile.is_open() || !Json::parseFromStream(reader, profileFile, &run.Profile, &strErrors)) {
+        PrintError("Scan did not produce a summary (exit code " + std::to_string(run.ExitCode) + ")");
+        return run.ExitCode != SUCCESS_CODE ? run.ExitCode : ERROR_CANNOT_OPEN_FILE;
+    }
+    unlink(strSummaryPath.c_str());
+    unlink(strProfilePath.c_str());
+    return SUCCESS_CODE;
+}
+
+// 실행 하나를 보고서 항목으로 변환, 단계별 시간은 스캐너 프로파일의 누적 시간과 백분위
+static Json::Value ToJson(const ST_BenchRun& run) {
+    Json::Value value;
+    value["wall_time_sec"] = run.WallSec;
+    value["scan_time_sec"] = run.Summary["scan_time_sec"];
+    value["files_scanned"] = run.Summary["files_scanned"];
+    value["bytes_scanned"] = run.Summary["bytes_scanned"];
+    value["files_per_sec"] = run.Summary["files_per_sec"];
+    value["mb_per_sec"] = run.Summary["mb_per_sec"];
+    value["peak_rss_kb"] = Json::Int64(run.PeakRssKb);
+    value["detection_count"] = run.Summary["detection_count"];
+
+    Json::Value phases(Json::objectValue);
+    for (const std::string& strPhase : run.Profile["phases"].getMemberNames()) {
+        const Json::Value& phase = run.Profile["phases"][strPhase];
+        if (phase["count"].asUInt64() == 0) {
+            continue;
+        }
+        Json::Value entry;
+        entry["count"] = phase["count"];
+        entry["total_ms"] = phase["total_ns"].asUInt64() / 1e6;
+        entry["p50_us"] = phase["p50_ns"].asUInt64() / 1e3;
+        entry["p99_us"] = phase["p99_ns"].asUInt64() / 1e3;
+        entry["mb_per_sec"] = phase["mb_per_sec"];
+        phases[strPhase] = entry;
+    }
+    value["phases"] = phases;
+    return value;
+}
+
+static int BenchEngine(const std::string& treePath, int scanType, int repetitions, uint64_t plantedFiles, Json::Value& result) {
+    std::string strEngine = scanType == YARA_RULE ? "Yara" : "Hash";
+    result["engine"] = strEngine;
+    result["runs"] = Json::Value(Json::arrayValue);
+    int nBest = -1;
+    for (int i = 0; i < repetitions; i++) {
+        ST_BenchRun run;
+        int nResult = RunScan(treePath, scanType, run);
+        if (nResult != SUCCESS_CODE) {
+            return nResult;
+        }
+        Json::Value entry = ToJson(run);
+        std::cout << "[+] " << std::left << std::setw(5) << strEngine << " run " << i + 1 << " : " << std::fixed << std::setprecision(3)
+                  << run.WallSec << " sec, " << std::setprecision(1) << entry["files_per_sec"].asDouble() << " files/s, "
+                  << entry["mb_per_sec"].asDouble() << " MB/s, peak RSS " << run.PeakRssKb / 1024 << " MB, "
+                  << entry["detection_count"].asUInt64() << " detections\n";
+        std::cout.unsetf(std::ios::fixed);
+        if (nBest == -1 || run.WallSec < result["runs"][nBest]["wall_time_sec"].asDouble()) {
+            nBest = static_cast<int>(result["runs"].size());
+        }
+        result["runs"].append(entry);
+    }
+    result["best"] = result["runs"][nBest];
+
+    // 심어둔 파일을 모두 찾지 못하면 빌드가 빨라진 것이 아니라 탐지가 깨진 것
+    uint64_t ullDetections = result["best"]["detection_count"].asUInt64();
+    result["expected_detections"] = Json::UInt64(plantedFiles);
+    result["detections_ok"] = ullDetections >= plantedFiles;
+    if (ullDetections < plantedFiles) {
+        std::cout << COLOR_RED << "[+] " << strEngine << " found " << ullDetections << " of " << plantedFiles << " planted files" << COLOR_RESET << "\n";
+    }
+    return SUCCESS_CODE;
+}
+
+static int SaveReport(const std::string& reportPath, const Json::Value& report) {
+    std::ofstream reportFile(reportPath, std::ios::out | std::ios::trunc);
+    if (!reportFile.is_open()) {
+        PrintErrorMessage(ERROR_CANNOT_OPEN_FILE, reportPath);
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+    Json::StreamWriterBuilder writer;
+    reportFile << Json::writeString(writer, report) << "\n";
+    if (!reportFile.good()) {
+        return ERROR_CANNOT_WRITE_FILE;
+    }
+    std::cout << "\n[+] Benchmark report saved to " << reportPath << "\n";
+    return SUCCESS_CODE;
+}
+
+int main(int argc, char** argv) {
+    ST_CorpusSpec spec;
+    std::string strCorpusDir = BENCH_DEFAULT_CORPUS_DIR;
+    std::string strReportPath = BENCH_DEFAULT_REPORT_PATH;
+    std::vector<int> vecEngines = {YARA_RULE, HASH_COMPARISON};
+    int nRepetitions = BENCH_DEFAULT_REPETITIONS;
+    bool bRegenerate = false;
+    bool bGenerateOnly = false;
+    uint64_t ullDbEvents = 0;
+    bool bReportPathSet = false;
+
+    int nOpt;
+    int nOptionIndex = 0;
+    while ((nOpt = getopt_long(argc, argv, "h", benchOptions, &nOptionIndex)) != -1) {
+        switch (nOpt) {
+            case 'h':
+                DisplayBenchHelp();
+                return SUCCESS_CODE;
+            case BENCH_OPT_CORPUS: strCorpusDir = optarg; break;
+            case BENCH_OPT_TINY: spec.TinyFiles = strtoull(optarg, nullptr, 10); break;
+            case BENCH_OPT_TINY_MAX_SIZE: spec.TinyMaxSize = strtoull(optarg, nullptr, 10); break;
+            case BENCH_OPT_HUGE: spec.HugeFiles = strtoull(optarg, nullptr, 10); break;
+            case BENCH_OPT_HUGE_SIZE: spec.HugeSizeMb = strtoull(optarg, nullptr, 10); break;
+            case BENCH_OPT_DEPTH: spec.TreeDepth = atoi(optarg); break;
+            case BENCH_OPT_FANOUT: spec.TreeFanout = atoi(optarg); break;
+            case BENCH_OPT_ELF_PERCENT: spec.ElfPercent = atoi(optarg); break;
+            case BENCH_OPT_PLANTED: spec.PlantedFiles = strtoull(optarg, nullptr, 10); break;
+            case BENCH_OPT_SEED: spec.Seed = strtoull(optarg, nullptr, 10); break;
+            case BENCH_OPT_ENGINE: {
+                std::string strEngine = optarg;
+                if (strEngine == "yara") {
+                    vecEngines = {YARA_RULE};
+                } else if (strEngine == "hash") {
+                    vecEngines = {HASH_COMPARISON};
+                } else if (strEngine != "all") {
+                    DisplayBenchHelp();
+                    return ERROR_INVALID_OPTION;
+                }
+                break;
+            }
+            case BENCH_OPT_REPEAT: nRepetitions = atoi(optarg); break;
+            case BENCH_OPT_OUTPUT: strReportPath = optarg; bReportPathSet = true; break;
+            case BENCH_OPT_REGENERATE: bRegenerate = true; break;
+            case BENCH_OPT_GENERATE_ONLY: bGenerateOnly = true; break;
+            case BENCH_OPT_DB_EVENTS: ullDbEvents = strtoull(optarg, nullptr, 10); break;
+            default:
+                DisplayBenchHelp();
+                return ERROR_INVALID_OPTION;
+        }
+    }
+    if (nRepetitions <= 0 || spec.TreeDepth < 0 || spec.TreeFanout <= 0 || spec.ElfPercent < 0 || spec.ElfPercent > 100) {
+        DisplayBenchHelp();
+        return ERROR_INVALID_OPTION;
+    }
+
+    if (ullDbEvents > 0) {
+        Json::Value dbReport;
+        int nResult = RunDatabaseBench(ullDbEvents, dbReport);
+        if (nResult != SUCCESS_CODE) {
+            return nResult;
+        }
+        return SaveReport(bReportPathSet ? strReportPath : DB_BENCH_DEFAULT_REPORT_PATH, dbReport);
+    }
+
+    CCorpusGenerator ICorpusGenerator(strCorpusDir, spec);
+    int nResult = ICorpusGenerator.Generate(bRegenerate);
+    if (nResult != SUCCESS_CODE || bGenerateOnly) {
+        return nResult;
+    }
+
+    Json::Value report;
+    report["timestamp"] = GetCurrentTimeWithMilliseconds();
+    report["build"]["compiler"] = __VERSION__;
+    report["build"]["compiled_at"] = __DATE__ " " __TIME__;
+    report["build"]["cpus"] = static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
+    report["corpus"] = spec.ToJson();
+    report["corpus"]["path"] = GetAbsolutePath(ICorpusGenerator.GetTreePath());
+    report["corpus"]["files"] = Json::UInt64(ICorpusGenerator.GetFileCount());
+    report["corpus"]["bytes"] = Json::UInt64(ICorpusGenerator.GetTotalBytes());
+    report["results"] = Json::Value(Json::arrayValue);
+
+    std::cout << "\n### Scanner Benchmark Start ! (" << ICorpusGenerator.GetFileCount() << " files, "
+              << ICorpusGenerator.GetTotalBytes() / (1024 * 1024) << " MB, " << nRepetitions << " runs per engine) ###\n\n";
+    bool bDetectionsOk = true;
+    for (int nEngine : vecEngines) {
+        Json::Value result;
+        nResult = BenchEngine(ICorpusGenerator.GetTreePath(), nEngine, nRepetitions, spec.PlantedFiles, result);
+        if (nResult != SUCCESS_CODE) {
+            PrintErrorMessage(nResult);
+            return nResult;
+        }
+        bDetectionsOk = bDetectionsOk && result["detections_ok"].asBool();
+        report["results"].append(result);
+    }
+
+    nResult = SaveReport(strReportPath, report);
+    if (nResult != SUCCESS_CODE) {
+        return nResult;
+    }
+    return bDetectionsOk ? SUCCESS_CODE : ERROR_UNKNOWN;
+}
@@ -1,24 +1,116 @@
+#include <algorithm>
+#include <cctype>
+#include <csignal>
 #include <iostream>
 #include "ansi_color.h"
 #include "database_manager.h"
+#include "ini.h"
 #include "util.h"
 
-CDatabaseManager::CDatabaseManager() {
+// 잘못된 값은 기본값으로 두고 알림
+ST_DatabaseOptions ST_DatabaseOptions::Load(const std::string& iniPath) {
+    ST_DatabaseOptions options;
+    INIReader reader(iniPath);
+    if (reader.ParseError() != 0) {
+        return options;
+    }
+    auto upper = [](std::string value) {
+        std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) { return std::toupper(c); });
+        return value;
+    };
+    const std::vector<std::string> vecJournalModes = {"DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL", "OFF"};
+    const std::vector<std::string> vecSynchronousModes = {"OFF", "NORMAL", "FULL", "EXTRA"};
+
+    std::string strJournalMode = upper(reader.Get(DATABASE_SETTINGS_SECTION, "journal_mode", options.JournalMode));
+    if (std::find(vecJournalModes.begin(), vecJournalModes.end(), strJournalMode) != vecJournalModes.end()) {
+        options.JournalMode = strJournalMode;
+    } else {
+        PrintError("Unknown database journal_mode: " + strJournalMode + ", using " + options.JournalMode);
+    }
+    std::string strSynchronous = upper(reader.Get(DATABASE_SETTINGS_SECTION, "synchronous", options.Synchronous));
+    if (std::find(vecSynchronousModes.begin(), vecSynchronousModes.end(), strSynchronous) != vecSynchronousModes.end()) {
+        options.Synchronous = strSynchronous;
+    } else {
+        PrintError("Unknown database synchronous mode: " + strSynchronous + ", using " + options.Synchronous);
+    }
+    options.BatchSize = std::max(1, reader.GetInteger(DATABASE_SETTINGS_SECTION, "batch_size", options.BatchSize));
+    options.FlushIntervalMs = std::max(1, reader.GetInteger(DATABASE_SETTINGS_SECTION, "flush_interval_ms", options.FlushIntervalMs));
+    return options;
+}
+
+CDatabaseManager::CDatabaseManager(const ST_DatabaseOptions& options, const std::string& databasePath)
+    : m_pDb(nullptr), m_options(options), m_pInsertEventStmt(nullptr), m_pUpsertFileStmt(nullptr), m_pDeleteFileStmt(nullptr),
+      m_ullNextSequence(0), m_ullWrittenSequence(0), m_ullHandledSequence(0), m_bFlushRequested(false), m_bStopWriter(false),
+      m_ullCommitted(0), m_ullTransactions(0), m_ullDropped(0) {
     // 데이터베이스 파일 오픈, 파일 없으면 새로 생성
-    if (sqlite3_open(DATABASE_NAME, &m_pDb)) {
+    if (sqlite3_open(databasePath.c_str(), &m_pDb)) {
         HandleError(ERROR_DATABASE_GENERAL, "Can't open database: " + std::string(sqlite3_errmsg(m_pDb)));
     } else {
         std::cout << COLOR_GREEN <<"Opened database successfully"  << COLOR_RESET << "\n";;
     }
+    ApplyOptions();
     InitializeDatabase();
+
+    PrepareSQL(R"(
+        INSERT INTO file_events (file_path, event_time, hash, event_type, file_size, user, process_id)
+        VALUES (?, ?, ?, ?, ?, ?, ?);
+    )", &m_pInsertEventStmt);
+    PrepareSQL(R"(
+        INSERT INTO files (file_path, creation_time, last_modified_time, hash, file_size, mtime_ns, ctime_ns, is_archive)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?)
+        ON CONFLICT(file_path) DO UPDATE SET
+            last_modified_time=excluded.last_modified_time,
+            hash=excluded.hash,
+            file_size=excluded.file_size,
+            mtime_ns=excluded.mtime_ns,
+            ctime_ns=excluded.ctime_ns,
+            is_archive=excluded.is_archive;
+    )", &m_pUpsertFileStmt);
+    PrepareSQL("DELETE FROM files WHERE file_path = ?", &m_pDeleteFileStmt);
+
+    if (m_options.BatchSize > 1) {
+        // 종료 신호는 모니터의 signalfd가 받아야 하므로 모든 신호를 막은 채로 스레드를 만들어 처음부터 막힌 상태를 물려주고 원래대로 되돌림
+        // (스레드 안에서 막으면 막기 전에 도착한 SIGTERM이 이 스레드로 전달되어 기본 동작으로 프로세스 전체가 종료될 수 있음)
+        sigset_t allSignals;
+        sigset_t oldSignals;
+        sigfillset(&allSignals);
+        pthread_sigmask(SIG_BLOCK, &allSignals, &oldSignals);
+        m_writerThread = std::thread(&CDatabaseManager::RunWriter, this);
+        pthread_sigmask(SIG_SETMASK, &oldSignals, nullptr);
+    }
 }
 
+// 쓰기 스레드는 큐에 남은 기록을 모두 커밋한 뒤 종료
 CDatabaseManager::~CDatabaseManager() {
+    if (m_writerThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_bStopWriter = true;
+        }
+        m_cvWriter.notify_one();
+        m_writerThread.join();
+    }
+    sqlite3_finalize(m_pInsertEventStmt);
+    sqlite3_finalize(m_pUpsertFileStmt);
+    sqlite3_finalize(m_pDeleteFileStmt);
     if (m_pDb) {
         sqlite3_close(m_pDb);
     }
 }
 
+// WAL이면 스캐너/다시 검사의 읽기 연결이 커밋을 막지 않고, synchronous=NORMAL이면 체크포인트 때만 fsync
+void CDatabaseManager::ApplyOptions() {
+    sqlite3_busy_timeout(m_pDb, DATABASE_BUSY_TIMEOUT_MS);
+    ExecuteSQL("PRAGMA journal_mode=" + m_options.JournalMode);
+    ExecuteSQL("PRAGMA synchronous=" + m_options.Synchronous);
+    std::cout << "[+] Database: journal_mode=" << m_options.JournalMode << ", synchronous=" << m_options.Synchronous;
+    if (m_options.BatchSize > 1) {
+        std::cout << ", commit every " << m_options.BatchSize << " events or " << m_options.FlushIntervalMs << " ms\n";
+    } else {
+        std::cout << ", commit every event\n";
+    }
+}
+
 // 데이터베이스 초기화 + 필요한 테이블 생성
 void CDatabaseManager::InitializeDatabase() {
     const char* chSql = R"(
@@ -28,7 +120,10 @@ void CDatabaseManager::InitializeDatabase() {
             creation_time TEXT,
             last_modified_time TEXT,
             hash TEXT,
-            file_size INTEGER
+            file_size INTEGER,
+            mtime_ns INTEGER NOT NULL DEFAULT 0,
+            ctime_ns INTEGER NOT NULL DEFAULT 0,
+            is_archive INTEGER NOT NULL DEFAULT 0
         );
 
         CREATE TABLE IF NOT EXISTS file_events (
@@ -44,6 +139,31 @@ void CDatabaseManager::InitializeDatabase() {
     )";
 
     ExecuteSQL(chSql);
+    MigrateFilesTable();
+}
+
+// 이전 버전에서 만든 files 테이블에 해시 계산 시점의 메타데이터 열 추가
+// 기존 행은 mtime_ns = 0으로 남아 스캐너가 신뢰하지 않고, 다음 이벤트에서 채워짐
+void CDatabaseManager::MigrateFilesTable() {
+    sqlite3_stmt* stmt;
+    if (!PrepareSQL("PRAGMA table_info(files)", &stmt)) {
+        return;
+    }
+    bool bHasMtime = false;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char* chName = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        if (chName && std::string(chName) == "mtime_ns") {
+            bHasMtime = true;
+        }
+    }
+    sqlite3_finalize(stmt);
+    if (!bHasMtime) {
+        ExecuteSQL(R"(
+            ALTER TABLE files ADD COLUMN mtime_ns INTEGER NOT NULL DEFAULT 0;
+            ALTER TABLE files ADD COLUMN ctime_ns INTEGER NOT NULL DEFAULT 0;
+            ALTER TABLE files ADD COLUMN is_archive INTEGER NOT NULL DEFAULT 0;
+        )");
+    }
 }
 
 // SQL 쿼리 준비
@@ -55,78 +175,206 @@ bool CDatabaseManager::PrepareSQL(const std::string& sql, sqlite3_stmt** stmt) {
     return true;
 }
 
-// SQL 쿼리 실행 및 리소스 해제
-void CDatabaseManager::FinalizeAndExecuteSQL(sqlite3_stmt* stmt) {
-    if (sqlite3_step(stmt) != SQLITE_DONE) {
-        PrintErrorMessage(ERROR_DATABASE_GENERAL, "Failed to execute statement: " + std::string(sqlite3_errmsg(m_pDb)));
+// 파일 이벤트 발생마다 데이터 추가 및 업데이트
+void CDatabaseManager::LogEventToDatabase(const ST_MonitorData& data) {
+    Enqueue({
+        .RemoveFile = false,
+        .FilePath = data.filePath,
+        .Timestamp = data.timestamp,
+        .Hash = data.newHash,
+        .EventType = data.eventType,
+        .FileSize = data.fileSize,
+        .User = data.user,
+        .ProcessId = data.processId,
+        .MtimeNs = data.mtimeNs,
+        .CtimeNs = data.ctimeNs,
+        .IsArchive = data.isArchive,
+        .Sequence = 0
+    });
+}
+
+// files 테이블 업데이트 대상 (삭제/이동으로 없어진 파일과 디렉토리 이벤트는 이벤트 기록만 남김)
+bool CDatabaseManager::UpdatesFilesTable(const std::string& eventType) {
+    return eventType != "File moved from" && eventType != "File deleted" && eventType.rfind("Directory", 0) != 0;
+}
+
+// 쓰기 스레드가 없으면 바로 기록, 있으면 큐에 넣고 files 변경은 커밋될 때까지 겹쳐 보이기에 남김
+void CDatabaseManager::Enqueue(ST_DatabaseRecord&& record) {
+    if (!m_writerThread.joinable()) {
+        WriteRecords({record}, false);
+        return;
+    }
+    bool bNotify;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        record.Sequence = ++m_ullNextSequence;
+        if (record.RemoveFile) {
+            m_mapPendingFiles[record.FilePath] = {true, "", -1, record.Sequence};
+        } else if (UpdatesFilesTable(record.EventType)) {
+            m_mapPendingFiles[record.FilePath] = {false, record.Hash, record.FileSize, record.Sequence};
+        }
+        if (m_queRecords.empty()) {
+            m_firstQueuedTime = std::chrono::steady_clock::now();
+        }
+        m_queRecords.push_back(std::move(record));
+        // 첫 기록이면 쓰기 스레드가 커밋 시한을 잡도록, BatchSize에 이르면 바로 커밋하도록 깨움
+        bNotify = m_queRecords.size() == 1 || m_queRecords.size() == static_cast<size_t>(m_options.BatchSize);
+    }
+    if (bNotify) {
+        m_cvWriter.notify_one();
     }
-    sqlite3_finalize(stmt);
 }
 
+// 큐가 BatchSize에 이르거나 첫 기록 후 FlushIntervalMs가 지나면 그때까지 쌓인 기록을 한 트랜잭션으로 커밋
+void CDatabaseManager::RunWriter() {
+    std::vector<ST_DatabaseRecord> vecBatch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cvWriter.wait(lock, [this] { return m_bStopWriter || !m_queRecords.empty(); });
+            m_cvWriter.wait_until(lock, m_firstQueuedTime + std::chrono::milliseconds(m_options.FlushIntervalMs), [this] {
+                return m_bStopWriter || m_bFlushRequested || m_queRecords.size() >= static_cast<size_t>(m_options.BatchSize);
+            });
+            if (m_queRecords.empty()) {
+                return; // 중지 요청이고 남은 기록이 없음
+            }
+            vecBatch.assign(std::make_move_iterator(m_queRecords.begin()), std::make_move_iterator(m_queRecords.end()));
+            m_queRecords.clear();
+            m_bFlushRequested = false;
+        }
 
-// 파일 이벤트 발생마다 데이터 추가 및 업데이트
-void CDatabaseManager::LogEventToDatabase(const ST_MonitorData& data) {
-    sqlite3_stmt* stmt;
+        // 실패한 묶음은 롤백되었으므로 겹쳐 보이기를 그대로 두고 다시 시도
+        bool bCommitted = false;
+        for (int nAttempt = 0; nAttempt < DATABASE_COMMIT_ATTEMPTS && !bCommitted; nAttempt++) {
+            if (nAttempt > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(DATABASE_BUSY_TIMEOUT_MS));
+            }
+            bCommitted = WriteRecords(vecBatch, true);
+        }
 
-    // file_events 테이블에 삽입
-    std::string insertEventSql = R"(
-        INSERT INTO file_events (file_path, event_time, hash, event_type, file_size, user, process_id)
-        VALUES (?, ?, ?, ?, ?, ?, ?);
-    )";
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (bCommitted) {
+                for (const ST_DatabaseRecord& record : vecBatch) {
+                    auto it = m_mapPendingFiles.find(record.FilePath);
+                    if (it != m_mapPendingFiles.end() && it->second.Sequence == record.Sequence) {
+                        m_mapPendingFiles.erase(it);
+                    }
+                }
+                m_ullWrittenSequence = vecBatch.back().Sequence;
+            } else {
+                // DB에 없는 변경이므로 겹쳐 보이기는 남겨 이후 이벤트의 이전 해시/크기가 맞게 함 (같은 파일의 다음 커밋이 지움)
+                m_ullDropped += vecBatch.size();
+                PrintErrorMessage(ERROR_DATABASE_GENERAL, "Dropped " + std::to_string(vecBatch.size()) + " file events after " + std::to_string(DATABASE_COMMIT_ATTEMPTS) + " failed commits");
+            }
+            m_ullHandledSequence = vecBatch.back().Sequence;
+        }
+        m_cvFlushed.notify_all();
+        vecBatch.clear();
+    }
+}
 
-    // SQL 쿼리 준비
-if (!PrepareSQL(insertEventSql, &stmt)) {
-    return;
-}
-
-    // SQL 쿼리에 매개변수 바인딩
-    sqlite3_bind_text(stmt, 1, data.filePath.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, data.timestamp.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, data.newHash.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 4, data.eventType.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_int64(stmt, 5, data.fileSize);
-    sqlite3_bind_text(stmt, 6, data.user.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_int64(stmt, 7, data.processId);
-
-    // SQL 쿼리 실행
-    FinalizeAndExecuteSQL(stmt);
-
-    // files 테이블 업데이트
-    if (data.eventType != "File moved from" && data.eventType != "File deleted") {
-        std::string updateMainSql = R"(
-            INSERT INTO files (file_path, creation_time, last_modified_time, hash, file_size)
-            VALUES (?, ?, ?, ?, ?)
-            ON CONFLICT(file_path) DO UPDATE SET
-                last_modified_time=excluded.last_modified_time,
-                hash=excluded.hash,
-                file_size=excluded.file_size;
-        )";
-
-        if (!PrepareSQL(updateMainSql, &stmt)) {
-            return;
+// 지금까지 넘긴 기록이 모두 처리될 때까지 대기 (다른 연결로 DB를 읽기 전에 호출), 버린 기록이 있으면 false
+bool CDatabaseManager::Flush() {
+    if (!m_writerThread.joinable()) {
+        return true;
+    }
+    std::unique_lock<std::mutex> lock(m_mutex);
+    uint64_t ullTarget = m_ullNextSequence;
+    uint64_t ullDropped = m_ullDropped;
+    m_bFlushRequested = true;
+    m_cvWriter.notify_one();
+    m_cvFlushed.wait(lock, [this, ullTarget] { return m_ullHandledSequence >= ullTarget; });
+    return m_ullWrittenSequence >= ullTarget && m_ullDropped == ullDropped;
+}
+
+// 트랜잭션으로 기록하면 커밋에 실패했을 때 롤백하고 false 반환 (BEGIN이 실패하면 autocommit으로 흩어 쓰지 않고 바로 false)
+bool CDatabaseManager::WriteRecords(const std::vector<ST_DatabaseRecord>& records, bool transaction) {
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    if (m_pInsertEventStmt == nullptr || m_pUpsertFileStmt == nullptr || m_pDeleteFileStmt == nullptr) {
+        return false;
+    }
+    if (transaction && !ExecuteSQL("BEGIN IMMEDIATE")) {
+        return false;
+    }
+    uint64_t ullStatements = 0; // 트랜잭션 밖에서는 문장 하나가 autocommit 트랜잭션 하나
+    for (const ST_DatabaseRecord& record : records) {
+        if (record.RemoveFile) {
+            sqlite3_bind_text(m_pDeleteFileStmt, 1, record.FilePath.c_str(), -1, SQLITE_STATIC);
+            StepStatement(m_pDeleteFileStmt);
+            ullStatements++;
+            continue;
         }
 
-        sqlite3_bind_text(stmt, 1, data.filePath.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_text(stmt, 2, data.timestamp.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_text(stmt, 3, data.timestamp.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_text(stmt, 4, data.newHash.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_int64(stmt, 5, data.fileSize);
+        // file_events 테이블에 삽입
+        sqlite3_bind_text(m_pInsertEventStmt, 1, record.FilePath.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(m_pInsertEventStmt, 2, record.Timestamp.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(m_pInsertEventStmt, 3, record.Hash.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(m_pInsertEventStmt, 4, record.EventType.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int64(m_pInsertEventStmt, 5, record.FileSize);
+        sqlite3_bind_text(m_pInsertEventStmt, 6, record.User.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int64(m_pInsertEventStmt, 7, record.ProcessId);
+        StepStatement(m_pInsertEventStmt);
+        ullStatements++;
+
+        if (UpdatesFilesTable(record.EventType)) {
+            sqlite3_bind_text(m_pUpsertFileStmt, 1, record.FilePath.c_str(), -1, SQLITE_STATIC);
+            sqlite3_bind_text(m_pUpsertFileStmt, 2, record.Timestamp.c_str(), -1, SQLITE_STATIC);
+            sqlite3_bind_text(m_pUpsertFileStmt, 3, record.Timestamp.c_str(), -1, SQLITE_STATIC);
+            sqlite3_bind_text(m_pUpsertFileStmt, 4, record.Hash.c_str(), -1, SQLITE_STATIC);
+            sqlite3_bind_int64(m_pUpsertFileStmt, 5, record.FileSize);
+            sqlite3_bind_int64(m_pUpsertFileStmt, 6, record.MtimeNs);
+            sqlite3_bind_int64(m_pUpsertFileStmt, 7, record.CtimeNs);
+            sqlite3_bind_int(m_pUpsertFileStmt, 8, record.IsArchive ? 1 : 0);
+            StepStatement(m_pUpsertFileStmt);
+            ullStatements++;
+        }
+    }
+    if (transaction) {
+        if (!ExecuteSQL("COMMIT") || !sqlite3_get_autocommit(m_pDb)) {
+            if (!sqlite3_get_autocommit(m_pDb)) {
+                ExecuteSQL("ROLLBACK");
+            }
+            PrintErrorMessage(ERROR_DATABASE_GENERAL, "Failed to commit " + std::to_string(records.size()) + " file events");
+            return false;
+        }
+        m_ullTransactions++;
+    } else {
+        m_ullTransactions += ullStatements;
+    }
+    m_ullCommitted += records.size();
+    return true;
+}
 
-        FinalizeAndExecuteSQL(stmt);
+// 준비된 문장을 실행하고 다음 기록을 위해 초기화
+void CDatabaseManager::StepStatement(sqlite3_stmt* stmt) {
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        PrintErrorMessage(ERROR_DATABASE_GENERAL, "Failed to execute statement: " + std::string(sqlite3_errmsg(m_pDb)));
     }
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
 }
 
 // SQL 쿼리 실행
-void CDatabaseManager::ExecuteSQL(const std::string& sql) {
+bool CDatabaseManager::ExecuteSQL(const std::string& sql) {
     char* errMsg = nullptr;
     if (sqlite3_exec(m_pDb, sql.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
-        PrintErrorMessage(ERROR_DATABASE_GENERAL, "Failed to execute SQL: " + std::string(errMsg));
+        PrintErrorMessage(ERROR_DATABASE_GENERAL, "Failed to execute SQL: " + std::string(errMsg != nullptr ? errMsg : sqlite3_errmsg(m_pDb)));
         sqlite3_free(errMsg);
+        return false;
     }
+    return true;
 }
 
 // 파일 경로에 대한 해시 값을 files 테이블에서 가져옴
 std::string CDatabaseManager::GetFileHash(const std::string& filePath) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_mapPendingFiles.find(filePath);
+        if (it != m_mapPendingFiles.end()) {
+            return it->second.Removed ? "" : it->second.Hash;
+        }
+    }
     sqlite3_stmt* stmt;
     std::string sql = "SELECT hash FROM files WHERE file_path = ?";
 
@@ -147,6 +395,13 @@ std::string CDatabaseManager::GetFileHash(const std::string& filePath) {
 
 // 특정 파일 경로의 파일 크기 가져옴
 int64_t CDatabaseManager::GetFileSize(const std::string& filePath) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_mapPendingFiles.find(filePath);
+        if (it != m_mapPendingFiles.end()) {
+            return it->second.Removed ? -1 : it->second.FileSize;
+        }
+    }
     sqlite3_stmt* stmt;
     std::string sql = "SELECT file_size FROM files WHERE file_path = ?";
 
@@ -165,16 +420,59 @@ int64_t CDatabaseManager::GetFileSize(const std::string& filePath) {
     return fileSize;
 }
 
-// 파일 경로에 대한 데이터를 files 테이블에서 삭제
+// 파일 경로에 대한 데이터를 files 테이블에서 삭제 (이벤트 기록과 같은 순서로 커밋)
 void CDatabaseManager::RemoveFileFromDatabase(const std::string& filePath) {
-    sqlite3_stmt* stmt;
-    std::string sql = "DELETE FROM files WHERE file_path = ?";
+    ST_DatabaseRecord record = {};
+    record.RemoveFile = true;
+    record.FilePath = filePath;
+    Enqueue(std::move(record));
+}
 
-    if (!PrepareSQL(sql, &stmt)) {
-        return;
-    }
+// 스캐너용으로 신뢰할 수 있는 해시(계산 시점의 mtime이 기록된 행)를 한 번의 쿼리로 모두 읽어 경로별 색인 생성
+int CDatabaseManager::LoadFileDigests(const std::string& databasePath, std::unordered_map<std::string, ST_FileDigest>& digests) {
+    return ReadFileDigests(databasePath, R"(
+        SELECT file_path, hash, file_size, mtime_ns, ctime_ns, is_archive
+        FROM files WHERE mtime_ns != 0 AND hash != '';
+    )", digests);
+}
 
-    sqlite3_bind_text(stmt, 1, filePath.c_str(), -1, SQLITE_STATIC);
+// files 테이블의 모든 행, 모니터 재검사는 기록이 불완전한 파일도 있는 것으로 보고 변경/삭제를 판단해야 함
+int CDatabaseManager::LoadFileRecords(const std::string& databasePath, std::unordered_map<std::string, ST_FileDigest>& files) {
+    return ReadFileDigests(databasePath, R"(
+        SELECT file_path, hash, file_size, mtime_ns, ctime_ns, is_archive FROM files;
+    )", files);
+}
+
+// 모니터가 쓰는 중에도 읽을 수 있도록 읽기 전용으로 열고, 데이터베이스가 없거나 이전 스키마면 빈 색인
+int CDatabaseManager::ReadFileDigests(const std::string& databasePath, const char* sql, std::unordered_map<std::string, ST_FileDigest>& digests) {
+    sqlite3* pDb = nullptr;
+    if (sqlite3_open_v2(databasePath.c_str(), &pDb, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+        sqlite3_close(pDb);
+        return ERROR_FILE_NOT_FOUND;
+    }
+    sqlite3_busy_timeout(pDb, 1000);
 
-    FinalizeAndExecuteSQL(stmt);
-}
\ No newline at end of file
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(pDb, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        sqlite3_close(pDb);
+        return ERROR_DATABASE_GENERAL;
+    }
+    int nStep;
+    while ((nStep = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const char* chPath = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        const char* chHash = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        if (chPath == nullptr) {
+            continue;
+        }
+        digests[chPath] = {
+            .Hash = chHash ? chHash : "",
+            .FileSize = sqlite3_column_int64(stmt, 2),
+            .MtimeNs = sqlite3_column_int64(stmt, 3),
+            .CtimeNs = sqlite3_column_int64(stmt, 4),
+            .IsArchive = sqlite3_column_int(stmt, 5) != 0
+        };
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_close(pDb);
+    return nStep == SQLITE_DONE ? SUCCESS_CODE : ERROR_DATABASE_GENERAL;
+}
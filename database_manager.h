@@ -1,18 +1,69 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
 #include <sqlite3.h>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #include "event_monitor.h"
+#include "file_event.h"
 
 #define DATABASE_NAME "file_monitor.db"
 #define FILES_TABLE "files"
 #define FILE_EVENTS_TABLE "file_events"
+#define DATABASE_SETTINGS_SECTION "database"
+#define DATABASE_BUSY_TIMEOUT_MS 1000
+#define DATABASE_DEFAULT_BATCH_SIZE 256   // 이만큼 쌓이면 바로 한 트랜잭션으로 커밋
+#define DATABASE_DEFAULT_FLUSH_MS 100     // 쌓인 이벤트가 적어도 첫 이벤트 후 이 시간 안에 커밋
+#define DATABASE_COMMIT_ATTEMPTS 3        // 커밋 실패(잠김 등) 시 같은 묶음을 다시 시도하는 횟수, 모두 실패하면 버림으로 집계
 
 struct ST_MonitorData; //전방 선언
 
+// settings.ini [database] 섹션, BatchSize가 1이면 쓰기 스레드 없이 호출한 스레드에서 이벤트마다 바로 기록
+struct ST_DatabaseOptions {
+    std::string JournalMode = "WAL";     // DELETE, TRUNCATE, PERSIST, MEMORY, WAL, OFF
+    std::string Synchronous = "NORMAL";  // OFF, NORMAL, FULL, EXTRA
+    int BatchSize = DATABASE_DEFAULT_BATCH_SIZE;
+    int FlushIntervalMs = DATABASE_DEFAULT_FLUSH_MS;
+
+    static ST_DatabaseOptions Load(const std::string& iniPath);
+};
+
+// 쓰기 스레드에 넘기는 기록 하나 (ST_MonitorData 중 DB에 쓰는 값만 복사)
+struct ST_DatabaseRecord {
+    bool RemoveFile;         // true면 files 테이블에서 경로만 삭제
+    std::string FilePath;
+    std::string Timestamp;
+    std::string Hash;
+    std::string EventType;
+    int64_t FileSize;
+    std::string User;
+    int64_t ProcessId;
+    int64_t MtimeNs;
+    int64_t CtimeNs;
+    bool IsArchive;
+    uint64_t Sequence;
+};
+
+// 아직 커밋되지 않은 files 테이블 변경, 조회 함수가 DB보다 먼저 확인하여 방금 기록한 해시를 돌려줌
+struct ST_PendingFileRecord {
+    bool Removed;
+    std::string Hash;
+    int64_t FileSize;
+    uint64_t Sequence;       // 이 변경을 만든 기록 번호, 커밋 후 번호가 같을 때만 지움
+};
+
+// 이벤트 기록은 큐에 넣고 바로 반환하며, 쓰기 스레드가 BatchSize개 또는 FlushIntervalMs마다 한 트랜잭션으로 커밋
+// (기본 rollback journal에서 이벤트마다 autocommit 두 번 = fsync 여러 번 하던 것을 트랜잭션당 한 번으로 줄임)
 class CDatabaseManager {
 public:
-    CDatabaseManager();
+    explicit CDatabaseManager(const ST_DatabaseOptions& options = ST_DatabaseOptions(), const std::string& databasePath = DATABASE_NAME);
     ~CDatabaseManager();
     
     void InitializeDatabase();
@@ -20,11 +71,44 @@ public:
     std::string GetFileHash(const std::string& filePath);
     void RemoveFileFromDatabase(const std::string& filePath);
     int64_t GetFileSize(const std::string& filePath);
+    bool Flush();
+    uint64_t GetCommittedCount() const { return m_ullCommitted; }
+    uint64_t GetTransactionCount() const { return m_ullTransactions; }
+    uint64_t GetDroppedCount() const { return m_ullDropped; }
+    static int LoadFileDigests(const std::string& databasePath, std::unordered_map<std::string, ST_FileDigest>& digests);
+    static int LoadFileRecords(const std::string& databasePath, std::unordered_map<std::string, ST_FileDigest>& files);
 
 private:
     sqlite3* m_pDb;
-    
+    ST_DatabaseOptions m_options;
+    sqlite3_stmt* m_pInsertEventStmt;
+    sqlite3_stmt* m_pUpsertFileStmt;
+    sqlite3_stmt* m_pDeleteFileStmt;
+    std::mutex m_writeMutex;                 // 준비된 문장과 트랜잭션 보호 (바로 기록할 때는 여러 작업자가 호출)
+    std::mutex m_mutex;                      // 큐, 겹쳐 보이기, 기록 번호 보호
+    std::condition_variable m_cvWriter;
+    std::condition_variable m_cvFlushed;
+    std::deque<ST_DatabaseRecord> m_queRecords;
+    std::unordered_map<std::string, ST_PendingFileRecord> m_mapPendingFiles;
+    std::chrono::steady_clock::time_point m_firstQueuedTime; // 큐가 비어있다가 처음 들어온 시각
+    uint64_t m_ullNextSequence;
+    uint64_t m_ullWrittenSequence;           // 커밋까지 끝난 마지막 기록 번호
+    uint64_t m_ullHandledSequence;           // 커밋했거나 재시도 끝에 버린 마지막 기록 번호 (Flush 대기 기준)
+    bool m_bFlushRequested;
+    bool m_bStopWriter;
+    std::atomic<uint64_t> m_ullCommitted;
+    std::atomic<uint64_t> m_ullTransactions;
+    std::atomic<uint64_t> m_ullDropped;      // 커밋하지 못해 버린 기록 수
+    std::thread m_writerThread;
+
     bool PrepareSQL(const std::string& sql, sqlite3_stmt** stmt);
-    void FinalizeAndExecuteSQL(sqlite3_stmt* stmt);
-    void ExecuteSQL(const std::string& sql);
+    bool ExecuteSQL(const std::string& sql);
+    void MigrateFilesTable();
+    void ApplyOptions();
+    void Enqueue(ST_DatabaseRecord&& record);
+    void RunWriter();
+    bool WriteRecords(const std::vector<ST_DatabaseRecord>& records, bool transaction);
+    void StepStatement(sqlite3_stmt* stmt);
+    static bool UpdatesFilesTable(const std::string& eventType);
+    static int ReadFileDigests(const std::string& databasePath, const char* sql, std::unordered_map<std::string, ST_FileDigest>& digests);
 };
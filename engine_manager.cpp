@@ -0,0 +1,285 @@
+#include <cerrno>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include "ansi_color.h"
+#include "engine_manager.h"
+#include "file_scanner.h"
+#include "util.h"
+
+#define ENGINE_WATCH_MASK (IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE)
+
+// 이미 읽어둔 메모리를 선택한 엔진으로 검사, 탐지 시 detectionCause에 룰/시그니처 이름, 해시값 또는 유사 해시 일치 정보를 채움
+int ST_EngineSnapshot::Scan(int scanType, const std::string& name, const uint8_t* data, size_t size, std::string& detectionCause, std::string* fileHash,
+                             const ST_YaraExternals* externals) const {
+    std::vector<std::string> vecDetected;
+    if (scanType == YARA_RULE) {
+        int nResult = YaraChecker->CheckYaraRule(name, data, size, vecDetected, detectionCause, externals);
+        if (nResult != SUCCESS_CODE || !vecDetected.empty()) {
+            return nResult;
+        }
+        return SignatureChecker->CheckSignatures(name, data, size, vecDetected, detectionCause);
+    }
+    std::string strFileHash;
+    int nResult = ComputeSHA256(data, size, strFileHash);
+    if (nResult != SUCCESS_CODE) {
+        return ERROR_CANNOT_COMPUTE_HASH;
+    }
+    if (fileHash) {
+        *fileHash = strFileHash;
+    }
+    nResult = HashChecker->CompareByHash(name, strFileHash, vecDetected, detectionCause);
+    if (nResult != SUCCESS_CODE || !detectionCause.empty() || FuzzyChecker->GetHashCount() == 0) {
+        return nResult;
+    }
+
+    // 정확히 일치하는 해시가 없으면 알려진 악성 파일의 변종인지 유사 해시로 확인
+    std::string strFuzzyHash;
+    ST_FuzzyMatch match;
+    CFuzzyHashChecker::ComputeFuzzyHash(data, size, strFuzzyHash);
+    nResult = FuzzyChecker->CheckFuzzyHash(name, strFuzzyHash, vecDetected, match);
+    if (!vecDetected.empty()) {
+        detectionCause = match.Name + " (similarity " + std::to_string(match.Score) + ")";
+    }
+    return nResult;
+}
+
+CEngineManager::CEngineManager(const std::string& rulesDirectory, const std::string& hashListPath)
+    : m_strRulesDirectory(rulesDirectory), m_strHashListPath(hashListPath), m_ullGeneration(0), m_inotifyFd(-1), m_hashDirWd(-1), m_stopFd(-1),
+      m_releaseLog(std::make_shared<ST_SnapshotReleaseLog>()) {}
+
+CEngineManager::~CEngineManager() {
+    StopWatching();
+}
+
+// 최초 스냅샷을 동기적으로 생성
+int CEngineManager::Load() {
+    std::shared_ptr<const ST_EngineSnapshot> snapshot;
+    int nResult = BuildSnapshot(1, snapshot);
+    if (nResult != SUCCESS_CODE) {
+        return nResult;
+    }
+    Swap(snapshot);
+    return SUCCESS_CODE;
+}
+
+std::shared_ptr<const ST_EngineSnapshot> CEngineManager::Acquire() const {
+    return std::atomic_load(&m_snapshot);
+}
+
+int CEngineManager::BuildSnapshot(uint64_t generation, std::shared_ptr<const ST_EngineSnapshot>& snapshot) {
+    long lRssBefore = GetResidentMemoryKb();
+
+    auto hashChecker = std::make_shared<CMalwareHashChecker>();
+    int nResult = hashChecker->LoadHashes(m_strHashListPath);
+    if (nResult != SUCCESS_CODE) {
+        return nResult;
+    }
+
+    auto yaraChecker = std::make_shared<CYaraChecker>(m_strRulesDirectory);
+    std::shared_ptr<const ST_EngineSnapshot> current = Acquire();
+    if (yaraChecker->GetLoadResult() != SUCCESS_CODE && current && current->YaraChecker->GetLoadResult() == SUCCESS_CODE) {
+        // 재로드 중 룰 로드에 실패하면 정상 동작하던 기존 스냅샷을 계속 사용
+        return yaraChecker->GetLoadResult();
+    }
+
+    auto signatureChecker = std::make_shared<CSignatureChecker>(GetSiblingPath(SIGNATURE_DB_PATH));
+    auto fuzzyChecker = std::make_shared<CFuzzyHashChecker>();
+    fuzzyChecker->LoadHashes(GetSiblingPath(FUZZY_HASH_LIST_PATH));
+
+    ST_EngineSnapshot* pSnapshot = new ST_EngineSnapshot();
+    pSnapshot->Generation = generation;
+    pSnapshot->YaraChecker = yaraChecker;
+    pSnapshot->HashChecker = hashChecker;
+    pSnapshot->SignatureChecker = signatureChecker;
+    pSnapshot->FuzzyChecker = fuzzyChecker;
+    pSnapshot->LoadedRssKb = GetResidentMemoryKb() - lRssBefore;
+    snapshot = std::shared_ptr<const ST_EngineSnapshot>(pSnapshot, [releaseLog = m_releaseLog](ST_EngineSnapshot* p) { ReleaseSnapshot(p, *releaseLog); });
+    return SUCCESS_CODE;
+}
+
+// 새 스냅샷을 게시하고 이전 스냅샷에 교체 시각을 기록, 진행 중인 스캔은 파일 경계에서 새 스냅샷을 가져감
+// 이전 스냅샷을 돌려주어 호출자가 보고를 마친 뒤 참조를 놓도록 함
+std::shared_ptr<const ST_EngineSnapshot> CEngineManager::Swap(std::shared_ptr<const ST_EngineSnapshot> snapshot) {
+    uint64_t ullGeneration = snapshot->Generation;
+    std::shared_ptr<const ST_EngineSnapshot> previous = std::atomic_exchange(&m_snapshot, std::move(snapshot));
+    m_ullGeneration.store(ullGeneration, std::memory_order_release);
+    if (previous) {
+        std::lock_guard<std::mutex> lock(m_releaseLog->Mutex);
+        previous->RetiredAtNs.store(GetSteadyTimeNs());
+        ++m_releaseLog->Retired;
+    }
+    return previous;
+}
+
+int CEngineManager::Reload() {
+    uint64_t ullGeneration = GetGeneration() + 1;
+    auto buildStart = std::chrono::steady_clock::now();
+    std::shared_ptr<const ST_EngineSnapshot> snapshot;
+    int nResult = BuildSnapshot(ullGeneration, snapshot);
+    auto buildEnd = std::chrono::steady_clock::now();
+    if (nResult != SUCCESS_CODE) {
+        PrintErrorMessage(nResult, "Engine reload failed, keeping snapshot #" + std::to_string(GetGeneration()));
+        return nResult;
+    }
+
+    long lRssKb = snapshot->LoadedRssKb;
+    size_t siHashCount = snapshot->HashChecker->GetHashCount();
+    size_t siRuleSets = snapshot->YaraChecker->GetRuleSets().size();
+    size_t siSignatures = snapshot->SignatureChecker->GetSignatureCount();
+    size_t siFuzzyHashes = snapshot->FuzzyChecker->GetHashCount();
+    std::shared_ptr<const ST_EngineSnapshot> previous = Swap(std::move(snapshot));
+    auto swapEnd = std::chrono::steady_clock::now();
+
+    std::cout << "\n" << COLOR_GREEN << "[+] Engine snapshot #" << ullGeneration << " loaded ("
+              << siRuleSets << " rule sets, " << siSignatures << " signatures, " << siHashCount << " hashes, " << siFuzzyHashes << " fuzzy hashes) : build "
+              << std::fixed << std::setprecision(1) << std::chrono::duration<double, std::milli>(buildEnd - buildStart).count() << " ms, swap "
+              << std::chrono::duration<double, std::micro>(swapEnd - buildEnd).count() << " us, +" << lRssKb << " KB RSS"
+              << COLOR_RESET << "\n";
+    return SUCCESS_CODE;
+}
+
+// 마지막 참조가 사라졌을 때 호출, 두 스냅샷이 함께 살아있던 시간과 그동안 추가로 점유한 메모리를 기록만 함
+// 임의의 스캔 스레드에서 불리므로 콘솔 출력 같은 느린 작업은 하지 않음
+void CEngineManager::ReleaseSnapshot(ST_EngineSnapshot* snapshot, ST_SnapshotReleaseLog& releaseLog) {
+    int64_t llRetiredAt = snapshot->RetiredAtNs.load();
+    if (llRetiredAt != 0) {
+        ST_SnapshotRelease release = {
+            .Generation = snapshot->Generation,
+            .OverlapMs = (GetSteadyTimeNs() - llRetiredAt) / 1e6,
+            .RssKb = snapshot->LoadedRssKb,
+            .HashKb = snapshot->HashChecker->GetMemoryUsage() / 1024,
+            .FuzzyKb = snapshot->FuzzyChecker->GetMemoryUsage() / 1024
+        };
+        std::lock_guard<std::mutex> lock(releaseLog.Mutex);
+        releaseLog.Releases.push_back(release);
+        --releaseLog.Retired;
+    }
+    delete snapshot;
+}
+
+// 감시 스레드에서 쌓인 해제 기록을 출력, 아직 해제되지 않은 교체된 스냅샷이 남아있으면 true
+bool CEngineManager::ReportReleases() {
+    std::vector<ST_SnapshotRelease> vecReleases;
+    size_t siRetired;
+    {
+        std::lock_guard<std::mutex> lock(m_releaseLog->Mutex);
+        vecReleases.swap(m_releaseLog->Releases);
+        siRetired = m_releaseLog->Retired;
+    }
+    for (const ST_SnapshotRelease& release : vecReleases) {
+        std::cout << "\n" << COLOR_GREEN << "[+] Engine snapshot #" << release.Generation << " released : overlap "
+                  << std::fixed << std::setprecision(1) << release.OverlapMs << " ms, ~" << release.RssKb << " KB RSS ("
+                  << release.HashKb << " KB hash DB, " << release.FuzzyKb << " KB fuzzy index)" << COLOR_RESET << "\n";
+    }
+    return siRetired > 0;
+}
+
+int64_t CEngineManager::GetSteadyTimeNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 룰 디렉토리와 해시 파일(및 시그니처 DB)이 있는 디렉토리를 감시 (편집기가 rename으로 교체해도 감지되도록 디렉토리 단위로 감시)
+int CEngineManager::StartWatching() {
+    if (m_watchThread.joinable()) {
+        return SUCCESS_CODE;
+    }
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    m_stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_inotifyFd == -1 || m_stopFd == -1) {
+        StopWatching();
+        return ERROR_INVALID_FUNCTION;
+    }
+    if (inotify_add_watch(m_inotifyFd, m_strRulesDirectory.c_str(), ENGINE_WATCH_MASK) == -1) {
+        PrintErrorMessage(ERROR_CANNOT_OPEN_DIRECTORY, m_strRulesDirectory);
+    }
+    size_t siSlash = m_strHashListPath.find_last_of('/');
+    std::string strHashDir = siSlash == std::string::npos ? "." : m_strHashListPath.substr(0, siSlash);
+    m_hashDirWd = inotify_add_watch(m_inotifyFd, strHashDir.c_str(), ENGINE_WATCH_MASK);
+    m_watchThread = std::thread(&CEngineManager::RunWatchLoop, this);
+    return SUCCESS_CODE;
+}
+
+void CEngineManager::StopWatching() {
+    if (m_watchThread.joinable()) {
+        uint64_t ullValue = 1;
+        if (write(m_stopFd, &ullValue, sizeof(ullValue)) < 0) {
+            PrintError("Failed to signal engine watcher.");
+        }
+        m_watchThread.join();
+    }
+    if (m_inotifyFd != -1) {
+        close(m_inotifyFd);
+        m_inotifyFd = -1;
+    }
+    if (m_stopFd != -1) {
+        close(m_stopFd);
+        m_stopFd = -1;
+    }
+}
+
+bool CEngineManager::IsRelevantEvent(const struct inotify_event* event) const {
+    if (event->wd != m_hashDirWd) {
+        return true; // 룰 디렉토리의 모든 변경
+    }
+    std::string strHashFile = m_strHashListPath.substr(m_strHashListPath.find_last_of('/') + 1);
+    if (event->len == 0) {
+        return false;
+    }
+    std::string strName = event->name;
+    return strName == strHashFile || strName == SIGNATURE_DB_PATH || strName == FUZZY_HASH_LIST_PATH;
+}
+
+// 시그니처 DB와 유사 해시 목록은 해시 목록과 같은 디렉토리에 둠
+std::string CEngineManager::GetSiblingPath(const std::string& fileName) const {
+    size_t siSlash = m_strHashListPath.find_last_of('/');
+    return siSlash == std::string::npos ? fileName : m_strHashListPath.substr(0, siSlash + 1) + fileName;
+}
+
+void CEngineManager::RunWatchLoop() {
+    alignas(struct inotify_event) char buffer[4096];
+    bool bPending = false;
+    auto deadline = std::chrono::steady_clock::now();
+
+    while (true) {
+        // 교체된 스냅샷이 남아있으면 해제 보고를 위해 주기적으로 깨어남
+        int nTimeoutMs = ReportReleases() ? ENGINE_RELEASE_POLL_MS : -1;
+        if (bPending) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            nTimeoutMs = remaining.count() > 0 ? static_cast<int>(remaining.count()) : 0;
+        }
+
+        struct pollfd fds[2] = {{m_inotifyFd, POLLIN, 0}, {m_stopFd, POLLIN, 0}};
+        int nReady = poll(fds, 2, nTimeoutMs);
+        if (nReady < 0 && errno != EINTR) {
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            ssize_t length;
+            while ((length = read(m_inotifyFd, buffer, sizeof(buffer))) > 0) {
+                for (ssize_t i = 0; i < length;) {
+                    auto* event = reinterpret_cast<struct inotify_event*>(&buffer[i]);
+                    if (IsRelevantEvent(event)) {
+                        // 여러 파일을 연속으로 복사하는 경우를 위해 조용해질 때까지 기다렸다가 한 번만 로드
+                        bPending = true;
+                        deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ENGINE_RELOAD_QUIET_MS);
+                    }
+                    i += sizeof(struct inotify_event) + event->len;
+                }
+            }
+        }
+
+        if (bPending && std::chrono::steady_clock::now() >= deadline) {
+            bPending = false;
+            Reload();
+        }
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "fuzzy_hash_checker.h"
+#include "malware_hash_checker.h"
+#include "signature_checker.h"
+#include "yara_checker.h"
+
+#define ENGINE_RELOAD_QUIET_MS 500   // 마지막 변경 이후 이 시간 동안 추가 변경이 없으면 다시 로드
+#define ENGINE_RELEASE_POLL_MS 1000  // 교체된 스냅샷이 아직 해제되지 않은 동안 해제 보고를 확인하는 주기
+
+// 스캔 엔진(YARA 룰 + 바이트 시그니처 + 해시 DB + 유사 해시 색인)의 불변 스냅샷
+// 스캐너는 파일 단위로 스냅샷을 잡고, 마지막 참조가 사라질 때 메모리가 해제됨
+struct ST_EngineSnapshot {
+    uint64_t Generation;
+    std::shared_ptr<const CYaraChecker> YaraChecker;
+    std::shared_ptr<const CMalwareHashChecker> HashChecker;
+    std::shared_ptr<const CSignatureChecker> SignatureChecker; // signatures.ndb가 없으면 시그니처 0개
+    std::shared_ptr<const CFuzzyHashChecker> FuzzyChecker;     // fuzzy_hashes.txt가 없으면 해시 0개
+    long LoadedRssKb;                             // 스냅샷 생성으로 늘어난 RSS
+    mutable std::atomic<int64_t> RetiredAtNs{0};  // 새 스냅샷으로 교체된 시각 (0이면 현재 사용 중), 불변 스냅샷에서 유일하게 나중에 기록되는 값
+
+    int Scan(int scanType, const std::string& name, const uint8_t* data, size_t size, std::string& detectionCause, std::string* fileHash = nullptr,
+             const ST_YaraExternals* externals = nullptr) const;
+};
+
+// 교체된 스냅샷이 해제될 때 남기는 기록
+struct ST_SnapshotRelease {
+    uint64_t Generation;
+    double OverlapMs;   // 새 스냅샷과 함께 살아있던 시간
+    long RssKb;
+    size_t HashKb;
+    size_t FuzzyKb;
+};
+
+// 해제는 마지막 참조를 놓은 스캔 스레드에서 일어나므로 그 자리에서는 기록만 하고 출력은 감시 스레드가 맡음
+// 스냅샷이 관리자보다 오래 살 수 있으므로 삭제자가 shared_ptr로 함께 잡고 있음
+struct ST_SnapshotReleaseLog {
+    std::mutex Mutex;
+    size_t Retired = 0;                          // 교체되었지만 아직 해제되지 않은 스냅샷 수
+    std::vector<ST_SnapshotRelease> Releases;    // 아직 출력하지 않은 해제 기록
+};
+
+// RCU 방식으로 스냅샷을 교체하는 엔진 관리자
+// 룰 디렉토리/해시 파일 변경을 inotify로 감지하면 백그라운드에서 새 스냅샷을 만들어 원자적으로 교체
+class CEngineManager {
+public:
+    CEngineManager(const std::string& rulesDirectory, const std::string& hashListPath);
+    ~CEngineManager();
+    int Load();
+    std::shared_ptr<const ST_EngineSnapshot> Acquire() const;
+    uint64_t GetGeneration() const { return m_ullGeneration.load(std::memory_order_acquire); }
+    int StartWatching();
+    void StopWatching();
+
+    CEngineManager(const CEngineManager&) = delete;
+    CEngineManager& operator=(const CEngineManager&) = delete;
+
+private:
+    std::string m_strRulesDirectory;
+    std::string m_strHashListPath;
+    std::shared_ptr<const ST_EngineSnapshot> m_snapshot; // std::atomic_load/std::atomic_exchange로만 접근
+    std::atomic<uint64_t> m_ullGeneration;
+    int m_inotifyFd;
+    int m_hashDirWd;
+    int m_stopFd;
+    std::thread m_watchThread;
+    std::shared_ptr<ST_SnapshotReleaseLog> m_releaseLog;
+
+    int BuildSnapshot(uint64_t generation, std::shared_ptr<const ST_EngineSnapshot>& snapshot);
+    std::shared_ptr<const ST_EngineSnapshot> Swap(std::shared_ptr<const ST_EngineSnapshot> snapshot);
+    int Reload();
+    void RunWatchLoop();
+    bool IsRelevantEvent(const struct inotify_event* event) const;
+    std::string GetSiblingPath(const std::string& fileName) const;
+    bool ReportReleases();
+    static void ReleaseSnapshot(ST_EngineSnapshot* snapshot, ST_SnapshotReleaseLog& releaseLog);
+    static int64_t GetSteadyTimeNs();
+};
@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <sys/inotify.h>
+#include "event_coalescer.h"
+
+CEventCoalescer::CEventCoalescer(int windowMs) : m_nWindowMs(windowMs), m_ullReceived(0), m_ullEmitted(0) {}
+
+void CEventCoalescer::Add(const ST_FileEvent& event, std::vector<ST_FileEvent>& ready) {
+    m_ullReceived++;
+    if (m_nWindowMs <= 0) {
+        m_ullEmitted++;
+        ready.push_back(event);
+        return;
+    }
+
+    // 삭제/이동으로 경로가 사라지면 대기 중인 기록을 먼저 내보낸 뒤 바로 전달 (생성 후 곧바로 삭제된 파일도 기록이 남음)
+    auto it = m_mapPending.find(event.Path);
+    if (event.Mask & (IN_DELETE | IN_MOVED_FROM)) {
+        if (it != m_mapPending.end()) {
+            Emit(it, ready);
+        }
+        m_ullEmitted++;
+        ready.push_back(event);
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (it == m_mapPending.end()) {
+        it = m_mapPending.emplace(event.Path, ST_PendingFileEvent{event, now, now}).first;
+    } else {
+        ST_FileEvent& pending = it->second.Event;
+        pending.Mask |= event.Mask;
+        pending.Count += event.Count;
+        if (pending.Pid < 0) {
+            pending.Pid = event.Pid;
+            pending.User = event.User;
+        }
+        it->second.Last = now;
+    }
+    if (event.Mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+        Emit(it, ready);
+    }
+}
+
+// 창 시간 동안 이벤트가 없었거나 최대 대기 시간을 넘긴 경로를 내보냄
+void CEventCoalescer::Expire(std::vector<ST_FileEvent>& ready) {
+    auto now = std::chrono::steady_clock::now();
+    auto window = std::chrono::milliseconds(m_nWindowMs);
+    auto maxHold = std::chrono::milliseconds(EVENT_COALESCE_MAX_HOLD_MS);
+    for (auto it = m_mapPending.begin(); it != m_mapPending.end();) {
+        auto current = it++;
+        if (now - current->second.Last >= window || now - current->second.First >= maxHold) {
+            Emit(current, ready);
+        }
+    }
+}
+
+void CEventCoalescer::FlushAll(std::vector<ST_FileEvent>& ready) {
+    while (!m_mapPending.empty()) {
+        Emit(m_mapPending.begin(), ready);
+    }
+}
+
+// 가장 먼저 내보낼 경로까지 남은 시간 (poll 타임아웃), 대기 중인 이벤트가 없으면 -1
+int CEventCoalescer::GetTimeoutMs() const {
+    if (m_mapPending.empty()) {
+        return -1;
+    }
+    auto now = std::chrono::steady_clock::now();
+    auto deadline = std::chrono::steady_clock::time_point::max();
+    for (const auto& pending : m_mapPending) {
+        deadline = std::min({deadline, pending.second.Last + std::chrono::milliseconds(m_nWindowMs),
+                             pending.second.First + std::chrono::milliseconds(EVENT_COALESCE_MAX_HOLD_MS)});
+    }
+    if (deadline <= now) {
+        return 0;
+    }
+    return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count()) + 1;
+}
+
+void CEventCoalescer::Emit(std::unordered_map<std::string, ST_PendingFileEvent>::iterator it, std::vector<ST_FileEvent>& ready) {
+    m_ullEmitted++;
+    ready.push_back(std::move(it->second.Event));
+    m_mapPending.erase(it);
+}
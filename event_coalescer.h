@@ -0,0 +1,40 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "file_event.h"
+
+#define EVENT_COALESCE_DEFAULT_MS 500   // 같은 경로의 이벤트가 이 시간 동안 없으면 합친 기록을 내보냄 (settings.ini coalesce_ms, 0이면 사용 안 함)
+#define EVENT_COALESCE_MAX_HOLD_MS 5000 // 계속 쓰이는 파일(로그 등)도 이 시간이 지나면 한 번 내보냄
+
+// 경로별로 대기 중인 이벤트, Event.Mask에 받은 이벤트를 모두 누적
+struct ST_PendingFileEvent {
+    ST_FileEvent Event;
+    std::chrono::steady_clock::time_point First;
+    std::chrono::steady_clock::time_point Last;
+};
+
+// 파일 쓰기 한 번에 생기는 많은 IN_MODIFY를 경로별로 합쳐 해시/기록을 한 번만 하도록 하는 단계
+// IN_CLOSE_WRITE(쓰기 완료)나 IN_MOVED_TO(완성된 파일이 들어옴)가 오면 바로, 아니면 창 시간 동안 조용할 때 내보냄
+class CEventCoalescer {
+public:
+    explicit CEventCoalescer(int windowMs = EVENT_COALESCE_DEFAULT_MS);
+    void SetWindow(int windowMs) { m_nWindowMs = windowMs; }
+    void Add(const ST_FileEvent& event, std::vector<ST_FileEvent>& ready);
+    void Expire(std::vector<ST_FileEvent>& ready);
+    void FlushAll(std::vector<ST_FileEvent>& ready);
+    int GetTimeoutMs() const;
+    uint64_t GetReceivedCount() const { return m_ullReceived; }
+    uint64_t GetEmittedCount() const { return m_ullEmitted; }
+
+private:
+    int m_nWindowMs;
+    std::unordered_map<std::string, ST_PendingFileEvent> m_mapPending;
+    uint64_t m_ullReceived;
+    uint64_t m_ullEmitted;
+
+    void Emit(std::unordered_map<std::string, ST_PendingFileEvent>::iterator it, std::vector<ST_FileEvent>& ready);
+};
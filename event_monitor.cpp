@@ -1,28 +1,115 @@
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
+#include <condition_variable>
+#include <cstring>
 #include <ctime>
+#include <deque>
 #include <iostream>
 #include <dirent.h>
+#include <fcntl.h>
 #include <fstream>
 #include <iomanip>
 #include <jsoncpp/json/json.h>
+#include <mutex>
 #include <pwd.h>
+#include <thread>
 #include <vector>
 #include <string>
 #include <sys/inotify.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
+#include <sys/un.h>
 #include <unistd.h>
 #include "ansi_color.h"
+#include "archive_reader.h"
 #include "email_sender.h"
 #include "event_monitor.h"
 #include "ini.h"
+#include "json_log_writer.h"
 #include "util.h"
 #include "config.h"
 #include "log_parser.h"
 
+namespace {
 
-CEventMonitor::CEventMonitor() : m_inotifyFd(-1), m_vecWatchList(*(new std::vector<std::string>)), m_dbManager(nullptr) {}
+// 초기 등록 순회에서 처리할 디렉토리, Id는 큐에 넣을 때 정해지므로 부모 Id가 항상 자식보다 작음
+struct ST_WalkItem {
+    std::string Path;
+    uint32_t Id;
+    uint32_t Parent;
+};
+
+struct ST_WalkResult {
+    uint32_t Id;
+    uint32_t Parent;
+    std::string Name;
+    int Wd;
+};
+
+// 하위 디렉토리 이름과 (files가 있으면) 일반 파일 경로를 수집, 심볼릭 링크는 따라가지 않음
+void ListDirectory(const std::string& path, std::vector<std::string>& subdirectories, std::vector<std::string>* files) {
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr) {
+        return;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+        unsigned char type = entry->d_type;
+        if (type == DT_UNKNOWN) {
+            struct stat entryStat;
+            if (fstatat(dirfd(dir), entry->d_name, &entryStat, AT_SYMLINK_NOFOLLOW) != 0) {
+                continue;
+            }
+            type = S_ISDIR(entryStat.st_mode) ? DT_DIR : (S_ISREG(entryStat.st_mode) ? DT_REG : DT_UNKNOWN);
+        }
+        if (type == DT_DIR) {
+            subdirectories.push_back(entry->d_name);
+        } else if (type == DT_REG && files != nullptr) {
+            files->push_back(path + "/" + entry->d_name);
+        }
+    }
+    closedir(dir);
+}
+
+// 이벤트를 일으킨 프로세스의 실제 사용자 (/proc/<pid>/status의 Uid 첫 값), 알 수 없으면 "N/A"
+std::string GetProcessUser(pid_t pid) {
+    if (pid < 0) {
+        return "N/A";
+    }
+    std::ifstream statusFile("/proc/" + std::to_string(pid) + "/status");
+    std::string strLine;
+    while (std::getline(statusFile, strLine)) {
+        if (strLine.compare(0, 4, "Uid:") != 0) {
+            continue;
+        }
+        uid_t uid = static_cast<uid_t>(std::stoul(strLine.substr(4)));
+        struct passwd pwd;
+        struct passwd* pResult = nullptr;
+        char szBuffer[1024];
+        if (getpwuid_r(uid, &pwd, szBuffer, sizeof(szBuffer), &pResult) == 0 && pResult != nullptr) {
+            return pwd.pw_name;
+        }
+        return std::to_string(uid);
+    }
+    return "N/A"; // 이미 종료된 프로세스
+}
+
+}
+
+
+CEventMonitor::CEventMonitor()
+    : m_inotifyFd(-1), m_bWatchLimitReached(false), m_ullWatchFailures(0),
+      m_vecWatchList(*(new std::vector<std::string>)), m_nWorkerCount(0), m_bStopWorkers(false),
+      m_signalFd(-1), m_coalesceTimerFd(-1), m_rescanTimerFd(-1), m_statisticsTimerFd(-1), m_controlFd(-1),
+      m_bStopRequested(false), m_dbManager(nullptr) {}
 
 CEventMonitor::~CEventMonitor() {
+    stopWorkers();
     if (m_inotifyFd != -1) {
         close(m_inotifyFd);
     }
@@ -33,7 +120,7 @@ CEventMonitor::~CEventMonitor() {
 }
 
 int CEventMonitor::StartMonitoring() {
-    m_dbManager = new CDatabaseManager();
+    m_dbManager = new CDatabaseManager(ST_DatabaseOptions::Load(SETTING_FILE));
     std::cout << "\nPlease select the task you'd like to perform:\n\n"
         << "1. Perform a file event monitoring (Default)\n"
         << "2. Send today's log file to an email\n\n"
@@ -59,16 +146,44 @@ int CEventMonitor::StartMonitoring() {
         // 감시할 파일 목록 읽기
         readWatchList();
 
-        // inotify 인스턴스 생성
-        createInotifyInstance();
-        
-        // 감시 대상 추가
-        addWatchListToInotify();
+        // 신호, 타이머, 제어 소켓 준비 (이후 만들어지는 스레드는 SIGINT/SIGTERM을 막은 상태를 물려받음)
+        if (openEventSources() != SUCCESS_CODE) {
+            closeEventSources();
+            return ERROR_INVALID_FUNCTION;
+        }
+
+        // fanotify를 쓸 수 없으면(권한, 커널 버전) inotify로 감시
+        bool bFanotify = false;
+        if (m_strBackend == MONITOR_BACKEND_FANOTIFY) {
+            if (m_fanotifyMonitor.Open(m_vecWatchList) == SUCCESS_CODE) {
+                for (const std::string& strPath : m_vecWatchList) {
+                    m_vecRoots.emplace_back(GetAbsolutePath(strPath), -1);
+                }
+                bFanotify = m_reactor.Add(m_fanotifyMonitor.GetFd(), EPOLLIN, [this](uint32_t) { onFanotifyReadable(); }) == SUCCESS_CODE;
+            } else {
+                std::cout << COLOR_YELLOW << "[+] fanotify backend is not available, falling back to inotify." << COLOR_RESET << "\n\n";
+            }
+        }
 
-        // 이벤트 대기 루프 시작
+        if (!bFanotify) {
+            // inotify 인스턴스 생성
+            createInotifyInstance();
+
+            // 감시 대상 추가
+            addWatchListToInotify();
+            m_reactor.Add(m_inotifyFd, EPOLLIN, [this](uint32_t) { onInotifyReadable(); });
+        }
+
+        // 이벤트 대기 루프 시작, 종료 요청을 받으면 남은 이벤트를 모두 기록한 뒤 반환
+        startWorkers();
         std::cout << "\n### File Event Monitoring Start ! ###\n\n";
         runEventLoop();
-        close(m_inotifyFd);
+        drainAndStop();
+        closeEventSources();
+        if (m_inotifyFd != -1) {
+            close(m_inotifyFd);
+            m_inotifyFd = -1;
+        }
 
     } else if (taskTypeOption == SEND_EMAIL) {
 
@@ -152,11 +267,28 @@ void CEventMonitor::readWatchList() {
             }
         }
     }
+
+    int nCoalesceMs = reader.GetInteger("monitor", "coalesce_ms", EVENT_COALESCE_DEFAULT_MS);
+    m_coalescer.SetWindow(nCoalesceMs);
+    if (nCoalesceMs > 0) {
+        std::cout << "[+] Coalescing file events within " << nCoalesceMs << " ms (hash on IN_CLOSE_WRITE)\n";
+    }
+
+    m_nWorkerCount = static_cast<int>(reader.GetInteger("monitor", "workers", 0));
+    if (m_nWorkerCount <= 0) {
+        m_nWorkerCount = std::max(1, std::min<int>(EVENT_WORKER_MAX_COUNT, std::thread::hardware_concurrency()));
+    }
+
+    m_strBackend = reader.Get("monitor", "backend", MONITOR_BACKEND_INOTIFY);
+    if (m_strBackend != MONITOR_BACKEND_INOTIFY && m_strBackend != MONITOR_BACKEND_FANOTIFY) {
+        PrintError("Unknown monitor backend: " + m_strBackend + ", using " MONITOR_BACKEND_INOTIFY);
+        m_strBackend = MONITOR_BACKEND_INOTIFY;
+    }
 }
 
 // inotify 인스턴스 생성 함수
 void CEventMonitor::createInotifyInstance() {
-    int inotifyFd = inotify_init();
+    int inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
     if (inotifyFd == -1) {
         HandleError(ERROR_INVALID_FUNCTION);
     }
@@ -164,7 +296,10 @@ void CEventMonitor::createInotifyInstance() {
 }
 
 // 파일 목록을 기반으로 inotify에 감시 대상 추가 함수
+// 디렉토리는 하위 디렉토리까지 모두 감시하고, 등록에 걸린 시간과 watch당 메모리를 출력
 void CEventMonitor::addWatchListToInotify() {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::string> vecDirectories;
     for (const auto& filePath : m_vecWatchList) {
         struct stat pathStat;
         if (stat(filePath.c_str(), &pathStat) != 0) {
@@ -172,89 +307,927 @@ void CEventMonitor::addWatchListToInotify() {
             continue;
         }
 
-        if (S_ISREG(pathStat.st_mode) || S_ISDIR(pathStat.st_mode)) {
-            std::string fullPath = GetAbsolutePath(filePath);
-            int wd = inotify_add_watch(m_inotifyFd, fullPath.c_str(), IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM);
+        std::string fullPath = GetAbsolutePath(filePath);
+        if (S_ISDIR(pathStat.st_mode)) {
+            vecDirectories.push_back(fullPath);
+            std::cout << COLOR_GREEN << "[+] Monitoring " << fullPath << " (recursive)" << COLOR_RESET << "\n";
+        } else if (S_ISREG(pathStat.st_mode)) {
+            int wd = addWatch(fullPath, false);
             if (wd == -1) {
                 PrintErrorMessage(ERROR_CANNOT_OPEN_DIRECTORY, fullPath);
-            } else {
-                m_mapWatchDescriptors[wd] = fullPath; // 전체 경로를 매핑에 추가
+            } else if (m_watchTree.Find(wd) == WATCH_NO_NODE) {
+                m_watchTree.Add(WATCH_NO_NODE, fullPath, wd);
+                m_vecRoots.emplace_back(fullPath, wd);
                 std::cout << COLOR_GREEN << "[+] Monitoring " << fullPath << COLOR_RESET << "\n";
             }
         }
     }
+    registerTrees(vecDirectories);
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    reportRegistration(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() / 1000000.0);
     std::cout << "\n";
 }
 
-// 이벤트 대기 루프 구현
+int CEventMonitor::addWatch(const std::string& path, bool directoryOnly) {
+    // 순회 중 디렉토리가 심볼릭 링크로 바뀌어도 따라가지 않도록 하위 디렉토리는 IN_ONLYDIR | IN_DONT_FOLLOW
+    int wd = inotify_add_watch(m_inotifyFd, path.c_str(), WATCH_EVENT_MASK | (directoryOnly ? IN_ONLYDIR | IN_DONT_FOLLOW : 0));
+    if (wd == -1) {
+        if (errno == ENOSPC) {
+            m_bWatchLimitReached = true;
+        } else if (errno != ENOENT && errno != ENOTDIR) {
+            m_ullWatchFailures++;
+        }
+    }
+    return wd;
+}
+
+// 설정된 디렉토리들을 여러 스레드로 순회하며 watch를 추가 (inotify_add_watch의 경로 탐색과 readdir이 병렬로 진행)
+// 결과는 Id 순으로 정렬하여 부모가 먼저 테이블에 들어가도록 한 뒤 한 스레드에서 등록
+void CEventMonitor::registerTrees(const std::vector<std::string>& roots) {
+    std::deque<ST_WalkItem> dequeItems;
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    size_t siBusyWorkers = 0;
+    std::atomic<uint32_t> nextId(0);
+    std::vector<ST_WalkResult> vecResults;
+    for (const std::string& strRoot : roots) {
+        dequeItems.push_back({strRoot, nextId++, WATCH_NO_NODE});
+    }
+
+    auto worker = [&]() {
+        std::vector<std::string> vecSubdirectories;
+        std::vector<ST_WalkItem> vecNewItems;
+        while (true) {
+            ST_WalkItem item;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                queueCondition.wait(lock, [&]() { return !dequeItems.empty() || siBusyWorkers == 0; });
+                if (dequeItems.empty()) {
+                    return;
+                }
+                item = std::move(dequeItems.front());
+                dequeItems.pop_front();
+                siBusyWorkers++;
+            }
+
+            bool bRoot = item.Parent == WATCH_NO_NODE;
+            ST_WalkResult result = {item.Id, item.Parent, bRoot ? item.Path : item.Path.substr(item.Path.find_last_of('/') + 1), addWatch(item.Path, !bRoot)};
+            vecSubdirectories.clear();
+            vecNewItems.clear();
+            if (result.Wd != -1) {
+                ListDirectory(item.Path, vecSubdirectories, nullptr);
+                for (const std::string& strName : vecSubdirectories) {
+                    vecNewItems.push_back({item.Path + "/" + strName, nextId++, item.Id});
+                }
+            }
+
+            bool bFinished;
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                vecResults.push_back(std::move(result));
+                for (ST_WalkItem& newItem : vecNewItems) {
+                    dequeItems.push_back(std::move(newItem));
+                }
+                siBusyWorkers--;
+                bFinished = siBusyWorkers == 0 && dequeItems.empty();
+            }
+            if (bFinished || vecNewItems.size() > 1) {
+                queueCondition.notify_all();
+            } else if (!vecNewItems.empty()) {
+                queueCondition.notify_one();
+            }
+        }
+    };
+
+    int nThreadCount = std::max(1, std::min<int>(WATCH_WALK_MAX_THREADS, std::thread::hardware_concurrency() * 2));
+    std::vector<std::thread> vecThreads;
+    for (int i = 0; i < nThreadCount; i++) {
+        vecThreads.emplace_back(worker);
+    }
+    for (std::thread& thread : vecThreads) {
+        thread.join();
+    }
+
+    std::sort(vecResults.begin(), vecResults.end(), [](const ST_WalkResult& a, const ST_WalkResult& b) { return a.Id < b.Id; });
+    std::vector<uint32_t> vecNodes(vecResults.size(), WATCH_NO_NODE); // Id -> 테이블 노드
+    for (const ST_WalkResult& result : vecResults) {
+        uint32_t parent = result.Parent == WATCH_NO_NODE ? WATCH_NO_NODE : vecNodes[result.Parent];
+        if (result.Wd == -1 || (result.Parent != WATCH_NO_NODE && parent == WATCH_NO_NODE)) {
+            continue;
+        }
+        // 같은 디렉토리가 두 경로로 보이면(겹치는 설정 경로, bind mount) 커널이 같은 wd를 돌려주므로 처음 것만 사용
+        if (m_watchTree.Find(result.Wd) != WATCH_NO_NODE) {
+            continue;
+        }
+        vecNodes[result.Id] = m_watchTree.Add(parent, result.Name, result.Wd);
+        if (result.Parent == WATCH_NO_NODE) {
+            m_vecRoots.emplace_back(result.Name, result.Wd);
+        }
+    }
+}
+
+// 감시 중에 생기거나 옮겨온 디렉토리를 하위까지 등록
+// watch를 추가하기 전에 이미 들어있던 파일은 이벤트가 오지 않으므로 생성 이벤트로 기록 (압축 해제, cp -r 등)
+void CEventMonitor::registerDirectory(uint32_t parent, const std::string& name) {
+    std::vector<std::pair<uint32_t, std::string>> vecPending = {{parent, name}};
+    std::vector<std::string> vecSubdirectories;
+    std::vector<std::string> vecFiles;
+    while (!vecPending.empty()) {
+        std::pair<uint32_t, std::string> pending = std::move(vecPending.back());
+        vecPending.pop_back();
+        std::string strPath = m_watchTree.GetPath(pending.first) + "/" + pending.second;
+        int wd = addWatch(strPath, true);
+        if (wd == -1 || m_watchTree.Find(wd) != WATCH_NO_NODE) {
+            continue;
+        }
+        uint32_t node = m_watchTree.Add(pending.first, pending.second, wd);
+        vecSubdirectories.clear();
+        ListDirectory(strPath, vecSubdirectories, &vecFiles);
+        for (std::string& strName : vecSubdirectories) {
+            vecPending.emplace_back(node, std::move(strName));
+        }
+    }
+    if (m_bWatchLimitReached) {
+        PrintError("inotify watch limit reached, new directories are not monitored.");
+    }
+    for (std::string& strFile : vecFiles) {
+        m_vecReadyEvents.push_back({std::move(strFile), IN_CREATE, false, -1});
+    }
+}
+
+// 노드와 하위 디렉토리의 watch를 모두 해제 (이미 해제된 wd는 inotify_rm_watch가 실패해도 무시)
+void CEventMonitor::removeWatch(uint32_t node) {
+    std::vector<int> vecRemovedWds;
+    m_watchTree.Remove(node, vecRemovedWds);
+    for (int wd : vecRemovedWds) {
+        inotify_rm_watch(m_inotifyFd, wd);
+    }
+}
+
+// 짝이 되는 IN_MOVED_TO가 오지 않은 디렉토리는 감시 범위 밖으로 옮겨진 것이므로 watch 해제
+void CEventMonitor::flushPendingMoves() {
+    for (const auto& pendingMove : m_mapPendingMoves) {
+        if (m_watchTree.Find(pendingMove.second.Wd) == pendingMove.second.Node) {
+            removeWatch(pendingMove.second.Node);
+        }
+    }
+    m_mapPendingMoves.clear();
+}
+
+void CEventMonitor::reportRegistration(double elapsedSec) {
+    size_t siWatchCount = m_watchTree.GetWatchCount();
+    size_t siMemory = m_watchTree.GetMemoryUsage();
+    std::cout << "\n[+] Registered " << siWatchCount << " watches in " << std::fixed << std::setprecision(3) << elapsedSec << " s";
+    if (elapsedSec > 0) {
+        std::cout << " (" << std::setprecision(0) << siWatchCount / elapsedSec << " watches/s)";
+    }
+    std::cout << "\n[+] Watch table memory: " << std::setprecision(1) << siMemory / 1024.0 << " KB ("
+              << (siWatchCount > 0 ? siMemory / siWatchCount : 0) << " bytes/watch, excluding kernel memory of about 1 KB/watch)\n";
+    std::cout.unsetf(std::ios::floatfield);
+
+    if (m_bWatchLimitReached) {
+        std::ifstream limitFile(INOTIFY_MAX_WATCHES_PATH);
+        std::string strLimit;
+        limitFile >> strLimit;
+        PrintError("inotify watch limit (" + (strLimit.empty() ? std::string("unknown") : strLimit)
+                   + ") reached, some directories are not monitored. Raise fs.inotify.max_user_watches.");
+    }
+    if (m_ullWatchFailures > 0) {
+        PrintError("Failed to add " + std::to_string(m_ullWatchFailures.load()) + " watches.");
+    }
+}
+
+// SIGINT/SIGTERM은 signalfd로, 합치기 만료/다시 검사/통계 기록은 timerfd로 받아 모두 한 epoll 루프에서 처리
+// 신호는 모든 스레드에서 막아야 signalfd로 전달되므로 등록 순회/작업자 스레드를 만들기 전에 호출
+// (그보다 먼저 만들어지는 DB 쓰기 스레드는 CDatabaseManager가 모든 신호를 막은 채로 생성)
+int CEventMonitor::openEventSources() {
+    sigset_t signalMask;
+    sigemptyset(&signalMask);
+    sigaddset(&signalMask, SIGINT);
+    sigaddset(&signalMask, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signalMask, &m_oldSignalMask);
+
+    if (m_reactor.Open() != SUCCESS_CODE) {
+        return ERROR_INVALID_FUNCTION;
+    }
+    m_signalFd = signalfd(-1, &signalMask, SFD_NONBLOCK | SFD_CLOEXEC);
+    m_coalesceTimerFd = CEventReactor::CreateTimer();
+    m_rescanTimerFd = CEventReactor::CreateTimer();
+    m_statisticsTimerFd = CEventReactor::CreateTimer();
+    if (m_signalFd == -1 || m_coalesceTimerFd == -1 || m_rescanTimerFd == -1 || m_statisticsTimerFd == -1) {
+        PrintError("Cannot create monitor event sources: " + std::string(strerror(errno)));
+        return ERROR_INVALID_FUNCTION;
+    }
+    // 합치기 만료는 루프가 매 반복 끝에 처리하므로 타이머는 epoll_wait를 깨우기만 함
+    if (m_reactor.Add(m_signalFd, EPOLLIN, [this](uint32_t) { onSignal(); }) != SUCCESS_CODE
+        || m_reactor.Add(m_coalesceTimerFd, EPOLLIN, [this](uint32_t) { CEventReactor::ReadTimer(m_coalesceTimerFd); }) != SUCCESS_CODE
+        || m_reactor.Add(m_rescanTimerFd, EPOLLIN, [this](uint32_t) {
+               CEventReactor::ReadTimer(m_rescanTimerFd);
+               continueRescan();
+           }) != SUCCESS_CODE
+        || m_reactor.Add(m_statisticsTimerFd, EPOLLIN, [this](uint32_t) {
+               CEventReactor::ReadTimer(m_statisticsTimerFd);
+               writeStatistics();
+           }) != SUCCESS_CODE) {
+        return ERROR_INVALID_FUNCTION;
+    }
+    CEventReactor::ArmTimer(m_statisticsTimerFd, MONITOR_STATS_INTERVAL_SEC * 1000, MONITOR_STATS_INTERVAL_SEC * 1000);
+
+    // 제어 소켓은 없어도 감시는 할 수 있으므로 실패해도 계속 진행
+    struct stat socketStat;
+    if (lstat(MONITOR_CONTROL_SOCKET_PATH, &socketStat) == 0 && S_ISSOCK(socketStat.st_mode)) {
+        unlink(MONITOR_CONTROL_SOCKET_PATH);
+    }
+    m_controlFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_controlFd == -1 || BindUnixSocket(m_controlFd, MONITOR_CONTROL_SOCKET_PATH, 0600) != SUCCESS_CODE
+        || listen(m_controlFd, SOMAXCONN) != 0
+        || m_reactor.Add(m_controlFd, EPOLLIN, [this](uint32_t) { onControlConnection(); }) != SUCCESS_CODE) {
+        PrintErrorMessage(ERROR_CANNOT_OPEN_FILE, MONITOR_CONTROL_SOCKET_PATH);
+        if (m_controlFd != -1) {
+            close(m_controlFd);
+            m_controlFd = -1;
+        }
+        return SUCCESS_CODE;
+    }
+    std::cout << "[+] Control socket: " << MONITOR_CONTROL_SOCKET_PATH << " (status, flush, rescan, stop)\n";
+    return SUCCESS_CODE;
+}
+
+void CEventMonitor::closeEventSources() {
+    for (const auto& client : m_mapControlClients) {
+        m_reactor.Remove(client.first);
+        close(client.first);
+    }
+    m_mapControlClients.clear();
+    if (m_controlFd != -1) {
+        m_reactor.Remove(m_controlFd);
+        close(m_controlFd);
+        unlink(MONITOR_CONTROL_SOCKET_PATH);
+        m_controlFd = -1;
+    }
+    for (int* pFd : {&m_signalFd, &m_coalesceTimerFd, &m_rescanTimerFd, &m_statisticsTimerFd}) {
+        if (*pFd != -1) {
+            m_reactor.Remove(*pFd);
+            close(*pFd);
+            *pFd = -1;
+        }
+    }
+    pthread_sigmask(SIG_SETMASK, &m_oldSignalMask, nullptr);
+}
+
+// 이벤트 대기 루프 구현, 종료 요청(신호, 제어 명령, 이벤트 읽기 실패)까지 반복
+// 각 콜백은 읽기 한 번만 처리하므로 한 반복의 길이가 정해져 있고, 반복마다 만료된 합치기 기록을 내보낸 뒤
+// 다음 만료 시점으로 타이머를 다시 맞춤 (기록 지연은 합치기 창 시간 + 읽기 한 번 이내)
 void CEventMonitor::runEventLoop() {
-    char buffer[EVENT_BUFFER_SIZE];
+    while (!m_bStopRequested) {
+        if (m_reactor.RunOnce(-1) < 0) {
+            break;
+        }
+        m_coalescer.Expire(m_vecReadyEvents);
+        dispatchReadyEvents();
+        CEventReactor::ArmTimer(m_coalesceTimerFd, m_coalescer.GetTimeoutMs());
+    }
+}
 
-    while (true) {
-        int length = read(m_inotifyFd, buffer, EVENT_BUFFER_SIZE);
-        if (length < 0) {
-            perror("Read error: ");
+// 합치는 중인 이벤트와 작업자 링에 남은 이벤트를 모두 기록한 뒤 작업자를 종료 (예약된 다시 검사는 하지 않음)
+void CEventMonitor::drainAndStop() {
+    m_coalescer.FlushAll(m_vecReadyEvents);
+    size_t siQueued = m_vecReadyEvents.size();
+    for (std::unique_ptr<ST_EventWorker>& worker : m_vecWorkers) {
+        siQueued += worker->Ring.Size();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_outputMutex);
+        std::cout << COLOR_YELLOW << "[+] Recording " << siQueued << " queued event(s) before exit..." << COLOR_RESET << "\n\n";
+    }
+    dispatchReadyEvents(true);
+    stopWorkers();
+    if (m_rescan.Loader.valid()) {
+        m_rescan.Loader.wait(); // DB 관리자를 정리하기 전에 다시 검사의 읽기 스레드가 끝나야 함
+    }
+    m_dbManager->Flush();
+    CJsonLogWriter::Instance().Flush();
+    if (CJsonLogWriter::Instance().GetFailedRecords() > 0) {
+        std::cout << COLOR_YELLOW << "[+] " << CJsonLogWriter::Instance().GetFailedRecords() << " log record(s) could not be written"
+                  << COLOR_RESET << "\n";
+    }
+    std::cout << COLOR_GREEN << "[+] File event monitoring stopped (" << m_statistics.Records.load() << " records, "
+              << m_statistics.Dropped.load() << " dropped, " << m_statistics.Overflows.load() << " overflows)" << COLOR_RESET << "\n";
+}
+
+// 읽기 스레드는 이벤트 해석과 watch 관리만 하고 해시/로그/DB 기록은 작업자에게 넘김
+void CEventMonitor::onInotifyReadable() {
+    alignas(struct inotify_event) char buffer[EVENT_BUFFER_SIZE];
+    ssize_t length = read(m_inotifyFd, buffer, EVENT_BUFFER_SIZE);
+    if (length < 0) {
+        if (errno == EAGAIN || errno == EINTR) {
+            return;
+        }
+        PrintError("inotify read failed: " + std::string(strerror(errno)));
+        m_bStopRequested = true;
+        return;
+    }
+
+    ssize_t i = 0;
+    while (i < length) {
+        struct inotify_event *event = (struct inotify_event *)&buffer[i];
+        m_statistics.EventsRead++;
+        processEvent(event); // 이벤트 처리 함수 호출
+        dispatchReadyEvents();
+        i += EVENT_SIZE + event->len;
+    }
+}
+
+// fanotify 이벤트는 이미 경로가 정해져 있으므로 watch 관리 없이 작업자에게 넘김
+void CEventMonitor::onFanotifyReadable() {
+    std::vector<ST_FileEvent> vecEvents;
+    uint64_t ullOverflows = m_fanotifyMonitor.GetOverflowCount();
+    if (m_fanotifyMonitor.ReadEvents(vecEvents) != SUCCESS_CODE) {
+        m_bStopRequested = true;
+        return;
+    }
+    if (m_fanotifyMonitor.GetOverflowCount() != ullOverflows) {
+        m_statistics.Overflows += m_fanotifyMonitor.GetOverflowCount() - ullOverflows;
+        for (const auto& root : m_vecRoots) {
+            scheduleRescan(root.first);
+        }
+    }
+    m_statistics.EventsRead += vecEvents.size();
+    std::unordered_map<pid_t, std::string> mapUsers; // 한 번 읽은 이벤트들은 같은 프로세스가 만든 경우가 많음
+    for (ST_FileEvent& fileEvent : vecEvents) {
+        auto itUser = mapUsers.find(fileEvent.Pid);
+        if (itUser == mapUsers.end()) {
+            itUser = mapUsers.emplace(fileEvent.Pid, GetProcessUser(fileEvent.Pid)).first;
+        }
+        fileEvent.User = itUser->second;
+        if (fileEvent.IsDirectory) {
+            m_coalescer.FlushAll(m_vecReadyEvents);
+            m_vecReadyEvents.push_back(std::move(fileEvent));
+        } else {
+            m_coalescer.Add(fileEvent, m_vecReadyEvents);
+        }
+        dispatchReadyEvents();
+    }
+}
+
+void CEventMonitor::onSignal() {
+    struct signalfd_siginfo signalInfo;
+    while (read(m_signalFd, &signalInfo, sizeof(signalInfo)) == sizeof(signalInfo)) {
+        std::lock_guard<std::mutex> lock(m_outputMutex);
+        std::cout << COLOR_YELLOW << "[+] Received " << strsignal(signalInfo.ssi_signo) << ", stopping file event monitoring" << COLOR_RESET << "\n\n";
+        m_bStopRequested = true;
+    }
+}
+
+void CEventMonitor::onControlConnection() {
+    int clientFd;
+    while ((clientFd = accept4(m_controlFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) != -1) {
+        if (m_reactor.Add(clientFd, EPOLLIN | EPOLLRDHUP, [this, clientFd](uint32_t) { onControlClient(clientFd); }) != SUCCESS_CODE) {
+            close(clientFd);
+            continue;
         }
+        m_mapControlClients[clientFd];
+    }
+}
 
-        int i = 0;
-        while (i < length) {
-            struct inotify_event *event = (struct inotify_event *)&buffer[i];
-            processEvent(event); // 이벤트 처리 함수 호출
-            i += EVENT_SIZE + event->len;
+// 연결마다 명령 한 줄을 받아 JSON 한 줄로 응답하고 연결을 닫음
+void CEventMonitor::onControlClient(int clientFd) {
+    char buffer[1024];
+    std::string& strPending = m_mapControlClients[clientFd];
+    ssize_t length = recv(clientFd, buffer, sizeof(buffer), 0);
+    if (length < 0 && (errno == EAGAIN || errno == EINTR)) {
+        return;
+    }
+    bool bClose = length <= 0;
+    if (length > 0) {
+        strPending.append(buffer, length);
+    }
+    size_t siNewline = strPending.find('\n');
+    if (siNewline != std::string::npos) {
+        std::string strResponse = handleControlCommand(strPending.substr(0, siNewline)) + "\n";
+        send(clientFd, strResponse.data(), strResponse.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+        bClose = true;
+    } else if (strPending.size() > MONITOR_CONTROL_MAX_LINE) {
+        bClose = true;
+    }
+    if (bClose) {
+        m_reactor.Remove(clientFd);
+        close(clientFd);
+        m_mapControlClients.erase(clientFd);
+    }
+}
+
+std::string CEventMonitor::handleControlCommand(const std::string& command) {
+    std::string strCommand = command;
+    while (!strCommand.empty() && isspace(static_cast<unsigned char>(strCommand.back()))) {
+        strCommand.pop_back();
+    }
+
+    Json::Value response;
+    response["status"] = "ok";
+    if (strCommand == "status") {
+        response["statistics"] = collectStatistics();
+    } else if (strCommand == "flush") {
+        m_coalescer.FlushAll(m_vecReadyEvents);
+        response["flushed"] = static_cast<Json::UInt64>(m_vecReadyEvents.size());
+        dispatchReadyEvents();
+    } else if (strCommand == "rescan") {
+        for (const auto& root : m_vecRoots) {
+            scheduleRescan(root.first);
         }
+    } else if (strCommand == "stop") {
+        m_bStopRequested = true;
+    } else {
+        response["status"] = "error";
+        response["error"] = "Unknown command: " + strCommand;
     }
+    Json::StreamWriterBuilder writer;
+    writer["indentation"] = "";
+    return Json::writeString(writer, response);
 }
 
 
 // 이벤트 처리 함수 구현
 void CEventMonitor::processEvent(struct inotify_event *event) {
-    auto it = m_mapWatchDescriptors.find(event->wd);
-    if (it == m_mapWatchDescriptors.end()) {
-        PrintError("Unknown watch descriptor: " + std::to_string(event->wd));
+    // 커널 큐가 넘쳐 이벤트를 잃었으므로 감시 루트 전체를 DB와 비교하여 다시 검사
+    if (event->mask & IN_Q_OVERFLOW) {
+        m_statistics.Overflows++;
+        PrintError("inotify event queue overflowed, rescanning monitored paths.");
+        for (const auto& root : m_vecRoots) {
+            scheduleRescan(root.first);
+        }
         return;
     }
 
+    // 이름 변경은 IN_MOVED_FROM 바로 뒤에 같은 cookie의 IN_MOVED_TO가 오므로, 다른 이벤트가 먼저 오면 밖으로 이동한 것
+    if (!m_mapPendingMoves.empty() && !((event->mask & IN_MOVED_TO) && m_mapPendingMoves.count(event->cookie) > 0)) {
+        flushPendingMoves();
+    }
+
+    uint32_t node = m_watchTree.Find(event->wd);
+    if (node == WATCH_NO_NODE) {
+        // 해제한 watch에 남아있던 이벤트는 무시, IN_IGNORED가 그 wd의 마지막 이벤트
+        if (!m_watchTree.WasRemoved(event->wd)) {
+            PrintError("Unknown watch descriptor: " + std::to_string(event->wd));
+        } else if (event->mask & IN_IGNORED) {
+            m_watchTree.Forget(event->wd);
+        }
+        return;
+    }
+
+    // watch가 해제됨 (디렉토리 삭제, 파일 시스템 해제 등), 테이블에서 하위 디렉토리까지 정리
+    if (event->mask & IN_IGNORED) {
+        if (m_watchTree.IsRoot(node)) {
+            std::cout << COLOR_YELLOW << "[-] Stopped monitoring " << m_watchTree.GetPath(node) << COLOR_RESET << "\n\n";
+        }
+        removeWatch(node);
+        m_watchTree.Forget(event->wd); // 커널이 이미 해제한 watch이므로 이후 이벤트 없음
+        return;
+    }
+    // 삭제 이벤트는 부모 디렉토리의 IN_DELETE로 기록되고 IN_IGNORED가 뒤따름
+    if (event->mask & IN_DELETE_SELF) {
+        return;
+    }
+
+    // inotify는 이벤트를 일으킨 프로세스를 알려주지 않음
+    ST_FileEvent fileEvent = {m_watchTree.GetPath(node), event->mask, (event->mask & IN_ISDIR) != 0, -1};
+    if (event->len > 0) {
+        fileEvent.Path += "/" + std::string(event->name);
+    }
+    // 디렉토리 이벤트 전에 대기 중인 파일 기록을 먼저 내보내 기록 순서와 경로를 유지
+    if (fileEvent.IsDirectory) {
+        m_coalescer.FlushAll(m_vecReadyEvents);
+        dispatchReadyEvents();
+        processDirectoryEvent(node, event, fileEvent);
+        return;
+    }
+    m_coalescer.Add(fileEvent, m_vecReadyEvents);
+}
+
+// 같은 경로는 항상 같은 작업자에게 가도록 경로 해시로 나눔
+// 링이 가득 차면 wait가 false면 이벤트를 버리고 그 경로의 루트를 다시 검사, true면 자리가 날 때까지 기다림
+void CEventMonitor::dispatchReadyEvents(bool wait) {
+    for (ST_FileEvent& fileEvent : m_vecReadyEvents) {
+        ST_EventWorker& worker = *m_vecWorkers[std::hash<std::string>()(fileEvent.Path) % m_vecWorkers.size()];
+        bool bPushed = worker.Ring.TryPush(std::move(fileEvent));
+        while (!bPushed && wait) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            bPushed = worker.Ring.TryPush(std::move(fileEvent));
+        }
+        if (!bPushed) {
+            m_statistics.Dropped++;
+            scheduleRescan(fileEvent.Path); // 실패한 TryPush는 이벤트를 옮기지 않음
+            continue;
+        }
+        worker.Pushed++;
+        sem_post(&worker.Ready);
+    }
+    m_vecReadyEvents.clear();
+}
+
+void CEventMonitor::startWorkers() {
+    m_bStopWorkers = false;
+    for (int i = 0; i < m_nWorkerCount; i++) {
+        m_vecWorkers.push_back(std::make_unique<ST_EventWorker>());
+    }
+    for (std::unique_ptr<ST_EventWorker>& worker : m_vecWorkers) {
+        ST_EventWorker* pWorker = worker.get();
+        pWorker->Thread = std::thread([this, pWorker]() { runWorker(*pWorker); });
+    }
+    std::cout << "[+] Hashing and recording file events on " << m_vecWorkers.size() << " worker thread(s)\n";
+}
+
+// 링에 남은 이벤트를 모두 기록한 뒤 종료
+void CEventMonitor::stopWorkers() {
+    if (m_vecWorkers.empty()) {
+        return;
+    }
+    m_bStopWorkers = true;
+    for (std::unique_ptr<ST_EventWorker>& worker : m_vecWorkers) {
+        sem_post(&worker->Ready);
+    }
+    for (std::unique_ptr<ST_EventWorker>& worker : m_vecWorkers) {
+        if (worker->Thread.joinable()) {
+            worker->Thread.join();
+        }
+    }
+    m_vecWorkers.clear();
+    writeStatistics();
+}
+
+void CEventMonitor::runWorker(ST_EventWorker& worker) {
+    ST_FileEvent fileEvent;
+    while (true) {
+        while (sem_wait(&worker.Ready) == -1 && errno == EINTR) {}
+        if (!worker.Ring.TryPop(fileEvent)) {
+            if (m_bStopWorkers) {
+                return;
+            }
+            continue;
+        }
+        if (!fileEvent.IsDirectory) {
+            handleFileEvent(fileEvent);
+            m_statistics.Records++;
+        } else if (logDirectoryEvent(fileEvent)) {
+            m_statistics.Records++;
+        }
+        worker.Completed.fetch_add(1, std::memory_order_release);
+    }
+}
+
+// 경로가 속한 감시 루트를 다시 검사 대상으로 표시 (겹치는 루트는 가장 긴 것)
+void CEventMonitor::scheduleRescan(const std::string& path) {
+    const std::string* pRoot = nullptr;
+    for (const auto& root : m_vecRoots) {
+        const std::string& strRoot = root.first;
+        bool bUnder = strRoot == "/" || (path.compare(0, strRoot.size(), strRoot) == 0 && (path.size() == strRoot.size() || path[strRoot.size()] == '/'));
+        if (bUnder && (pRoot == nullptr || strRoot.size() > pRoot->size())) {
+            pRoot = &strRoot;
+        }
+    }
+    if (pRoot == nullptr) {
+        return;
+    }
+    // 넘침이 이어지면 이벤트를 더 잃으므로 잠시 모았다가 한 번에 검사 (진행 중인 검사가 있으면 끝난 뒤 타이머를 맞춤)
+    if (m_setRescanRoots.empty() && m_rescan.Phase == RESCAN_IDLE) {
+        CEventReactor::ArmTimer(m_rescanTimerFd, MONITOR_RESCAN_DELAY_MS);
+    }
+    m_setRescanRoots.insert(*pRoot);
+}
+
+// 잃은 이벤트를 되찾기 위해 루트 아래 파일을 files 테이블과 비교
+// 기록이 없으면 생성, 크기/mtime이 다르면 수정, 기록은 있는데 파일이 없으면 삭제 이벤트를 만들어 작업자에게 넘김
+// inotify는 watch가 없는 하위 디렉토리(이벤트를 잃는 동안 생긴 디렉토리)를 새로 등록
+// 트리가 커도 반응기가 멈추지 않도록 단계마다 정해진 양만 처리하고 타이머를 다시 맞춰 돌아감 (그 사이 신호, 이벤트, 제어 요청 처리)
+void CEventMonitor::continueRescan() {
+    int64_t llNextMs = 0;
+    switch (m_rescan.Phase) {
+    case RESCAN_IDLE:
+        if (m_setRescanRoots.empty()) {
+            return;
+        }
+        startRescan();
+        llNextMs = MONITOR_RESCAN_POLL_MS;
+        break;
+    case RESCAN_DRAINING:
+        for (size_t i = 0; i < m_vecWorkers.size(); i++) {
+            if (m_vecWorkers[i]->Completed.load(std::memory_order_acquire) < m_rescan.DrainTargets[i]) {
+                CEventReactor::ArmTimer(m_rescanTimerFd, MONITOR_RESCAN_POLL_MS);
+                return;
+            }
+        }
+        // 다른 연결로 읽으므로 쓰기 스레드의 대기 중인 기록까지 커밋한 뒤 읽음
+        m_rescan.Loader = std::async(std::launch::async, [this]() {
+            m_dbManager->Flush();
+            return CDatabaseManager::LoadFileRecords(DATABASE_NAME, m_rescan.Records);
+        });
+        m_rescan.Phase = RESCAN_LOADING;
+        llNextMs = MONITOR_RESCAN_POLL_MS;
+        break;
+    case RESCAN_LOADING:
+        if (m_rescan.Loader.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            llNextMs = MONITOR_RESCAN_POLL_MS;
+            break;
+        }
+        if (m_rescan.Loader.get() != SUCCESS_CODE) {
+            PrintError("Cannot load file records from " DATABASE_NAME ", rescan skipped.");
+            finishRescan(false);
+            return;
+        }
+        for (const auto& root : m_vecRoots) {
+            struct stat rootStat;
+            if (m_rescan.Roots.count(root.first) == 0 || lstat(root.first.c_str(), &rootStat) != 0) {
+                continue;
+            }
+            if (S_ISREG(rootStat.st_mode)) {
+                m_rescan.Files.push_back(root.first);
+            } else {
+                m_rescan.Directories.emplace_back(root.first, root.second);
+            }
+        }
+        m_rescan.Phase = RESCAN_WALKING;
+        break;
+    case RESCAN_WALKING:
+        walkRescanDirectories();
+        break;
+    case RESCAN_COMPARING:
+        llNextMs = compareRescanFiles() ? 0 : MONITOR_RESCAN_POLL_MS;
+        break;
+    case RESCAN_DELETING:
+        if (recordRescanDeletes()) {
+            finishRescan(true);
+            return;
+        }
+        llNextMs = MONITOR_RESCAN_POLL_MS;
+        break;
+    }
+    CEventReactor::ArmTimer(m_rescanTimerFd, llNextMs);
+}
+
+// 표시된 루트를 가져오고, 그 전에 받은 이벤트를 모두 작업자에게 넘긴 뒤 작업자별 기록 목표를 잡음
+void CEventMonitor::startRescan() {
+    m_rescan.Roots.swap(m_setRescanRoots);
+    {
+        std::lock_guard<std::mutex> lock(m_outputMutex);
+        for (const std::string& strRoot : m_rescan.Roots) {
+            std::cout << COLOR_YELLOW << "[+] Rescanning " << strRoot << " against " DATABASE_NAME << COLOR_RESET << "\n\n";
+        }
+    }
+    m_coalescer.FlushAll(m_vecReadyEvents);
+    dispatchReadyEvents();
+    m_rescan.DrainTargets.clear();
+    for (std::unique_ptr<ST_EventWorker>& worker : m_vecWorkers) {
+        m_rescan.DrainTargets.push_back(worker->Pushed);
+    }
+    m_rescan.Phase = RESCAN_DRAINING;
+}
+
+void CEventMonitor::walkRescanDirectories() {
+    std::vector<std::string> vecSubdirectories;
+    for (size_t n = 0; n < MONITOR_RESCAN_SLICE && !m_rescan.Directories.empty(); n++) {
+        std::pair<std::string, int> directory = std::move(m_rescan.Directories.back());
+        m_rescan.Directories.pop_back();
+        // 순회 사이에 watch가 해제되었거나 wd가 다른 디렉토리에 다시 쓰였으면 새 디렉토리 등록 없이 파일만 비교
+        uint32_t node = directory.second == -1 ? WATCH_NO_NODE : m_watchTree.Find(directory.second);
+        if (node != WATCH_NO_NODE && m_watchTree.GetPath(node) != directory.first) {
+            node = WATCH_NO_NODE;
+        }
+        vecSubdirectories.clear();
+        ListDirectory(directory.first, vecSubdirectories, &m_rescan.Files);
+        for (const std::string& strName : vecSubdirectories) {
+            int wd = -1;
+            if (node != WATCH_NO_NODE) {
+                uint32_t child = m_watchTree.FindChild(node, strName);
+                if (child == WATCH_NO_NODE) {
+                    registerDirectory(node, strName); // 안의 파일은 생성 이벤트로 기록됨
+                    continue;
+                }
+                wd = m_watchTree.GetWd(child);
+            }
+            m_rescan.Directories.emplace_back(directory.first + "/" + strName, wd);
+        }
+    }
+    dispatchReadyEvents();
+    if (m_rescan.Directories.empty()) {
+        m_rescan.NextFile = 0;
+        m_rescan.Phase = RESCAN_COMPARING;
+    }
+}
+
+// 작업자 링이 절반 넘게 차 있으면 false (한 단계에서 넣는 양이 남은 자리보다 작아야 링이 넘쳐 버리는 이벤트가 없음)
+bool CEventMonitor::compareRescanFiles() {
+    for (std::unique_ptr<ST_EventWorker>& worker : m_vecWorkers) {
+        if (worker->Ring.Size() > worker->Ring.Capacity() / 2) {
+            return false;
+        }
+    }
+    size_t siEnd = std::min(m_rescan.Files.size(), m_rescan.NextFile + MONITOR_RESCAN_SLICE);
+    for (; m_rescan.NextFile < siEnd; m_rescan.NextFile++) {
+        std::string& strFile = m_rescan.Files[m_rescan.NextFile];
+        struct stat fileStat;
+        if (lstat(strFile.c_str(), &fileStat) != 0) {
+            continue;
+        }
+        auto it = m_rescan.Records.find(strFile);
+        if (it == m_rescan.Records.end()) {
+            m_vecReadyEvents.push_back({std::move(strFile), IN_CREATE, false, -1});
+            m_rescan.Events++;
+            continue;
+        }
+        int64_t mtimeNs = static_cast<int64_t>(fileStat.st_mtim.tv_sec) * 1000000000LL + fileStat.st_mtim.tv_nsec;
+        if (it->second.FileSize != fileStat.st_size || it->second.MtimeNs == 0 || it->second.MtimeNs != mtimeNs) {
+            m_vecReadyEvents.push_back({std::move(strFile), IN_MODIFY, false, -1});
+            m_rescan.Events++;
+        }
+        m_rescan.Records.erase(it);
+    }
+    dispatchReadyEvents();
+    if (m_rescan.NextFile == m_rescan.Files.size()) {
+        m_rescan.Files.clear();
+        m_rescan.NextRecord = m_rescan.Records.cbegin();
+        m_rescan.Phase = RESCAN_DELETING;
+    }
+    return true;
+}
+
+// 다시 검사한 루트 아래인데 파일이 없는 기록을 삭제로 넘기고, 모두 확인했으면 true
+bool CEventMonitor::recordRescanDeletes() {
+    for (std::unique_ptr<ST_EventWorker>& worker : m_vecWorkers) {
+        if (worker->Ring.Size() > worker->Ring.Capacity() / 2) {
+            return false;
+        }
+    }
+    for (size_t n = 0; n < MONITOR_RESCAN_SLICE && m_rescan.NextRecord != m_rescan.Records.cend(); n++, ++m_rescan.NextRecord) {
+        const std::string& strPath = m_rescan.NextRecord->first;
+        bool bUnder = false;
+        for (const std::string& strRoot : m_rescan.Roots) {
+            bUnder = bUnder || strRoot == "/" || (strPath.compare(0, strRoot.size(), strRoot) == 0 && (strPath.size() == strRoot.size() || strPath[strRoot.size()] == '/'));
+        }
+        struct stat fileStat;
+        if (bUnder && lstat(strPath.c_str(), &fileStat) != 0 && errno == ENOENT) {
+            m_vecReadyEvents.push_back({strPath, IN_DELETE, false, -1});
+            m_rescan.Events++;
+        }
+    }
+    dispatchReadyEvents();
+    return m_rescan.NextRecord == m_rescan.Records.cend();
+}
+
+void CEventMonitor::finishRescan(bool completed) {
+    if (completed) {
+        m_statistics.Rescans++;
+        m_statistics.RescanEvents += m_rescan.Events;
+        {
+            std::lock_guard<std::mutex> lock(m_outputMutex);
+            std::cout << COLOR_YELLOW << "[+] Rescan found " << m_rescan.Events << " changed file(s)" << COLOR_RESET << "\n\n";
+        }
+        writeStatistics();
+    }
+    m_rescan = ST_RescanState();
+    // 검사하는 동안 다시 표시된 루트
+    if (!m_setRescanRoots.empty()) {
+        CEventReactor::ArmTimer(m_rescanTimerFd, MONITOR_RESCAN_DELAY_MS);
+    }
+}
+
+// 누적 이벤트/기록/버림/넘침 수 (통계 파일과 제어 소켓 status 응답에 사용)
+Json::Value CEventMonitor::collectStatistics() {
+    size_t siQueued = 0;
+    for (std::unique_ptr<ST_EventWorker>& worker : m_vecWorkers) {
+        siQueued += worker->Ring.Size();
+    }
+
+    Json::Value root;
+    root["backend"] = m_inotifyFd != -1 ? MONITOR_BACKEND_INOTIFY : MONITOR_BACKEND_FANOTIFY;
+    root["workers"] = static_cast<Json::UInt>(m_nWorkerCount);
+    root["events_read"] = Json::UInt64(m_statistics.EventsRead.load());
+    root["coalesced_received"] = Json::UInt64(m_coalescer.GetReceivedCount());
+    root["coalesced_emitted"] = Json::UInt64(m_coalescer.GetEmittedCount());
+    root["records"] = Json::UInt64(m_statistics.Records.load());
+    root["queued"] = Json::UInt64(siQueued);
+    root["dropped"] = Json::UInt64(m_statistics.Dropped.load());
+    root["overflows"] = Json::UInt64(m_statistics.Overflows.load());
+    root["rescans"] = Json::UInt64(m_statistics.Rescans.load());
+    root["rescan_events"] = Json::UInt64(m_statistics.RescanEvents.load());
+    root["watches"] = Json::UInt64(m_watchTree.GetWatchCount());
+    if (m_dbManager != nullptr) {
+        root["db_committed"] = Json::UInt64(m_dbManager->GetCommittedCount());
+        root["db_transactions"] = Json::UInt64(m_dbManager->GetTransactionCount());
+        root["db_dropped"] = Json::UInt64(m_dbManager->GetDroppedCount());
+    }
+    root["updated_at"] = GetCurrentTimeWithMilliseconds();
+    return root;
+}
+
+// 누적 통계를 주기적으로 파일에 남김 (읽는 쪽이 쓰는 중인 파일을 보지 않도록 임시 파일 후 rename)
+void CEventMonitor::writeStatistics() {
+    std::string strTempPath = std::string(MONITOR_STATS_PATH) + ".tmp";
+    std::ofstream file(strTempPath, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        return;
+    }
+    Json::StreamWriterBuilder writer;
+    file << Json::writeString(writer, collectStatistics()) << "\n";
+    file.close();
+    if (!file.good() || rename(strTempPath.c_str(), MONITOR_STATS_PATH) != 0) {
+        unlink(strTempPath.c_str());
+    }
+}
+
+// 기록할 디렉토리 이벤트를 작업자에게 넘긴 뒤 watch 테이블에 반영
+void CEventMonitor::processDirectoryEvent(uint32_t node, struct inotify_event *event, const ST_FileEvent& fileEvent) {
+    if (!(event->mask & (IN_CREATE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE))) {
+        return;
+    }
+    m_vecReadyEvents.push_back(fileEvent);
+    if (event->mask & IN_CREATE) {
+        registerDirectory(node, event->name);
+    } else if (event->mask & IN_MOVED_FROM) {
+        uint32_t child = m_watchTree.FindChild(node, event->name);
+        if (child != WATCH_NO_NODE) {
+            m_mapPendingMoves[event->cookie] = {child, m_watchTree.GetWd(child)};
+        }
+    } else if (event->mask & IN_MOVED_TO) {
+        // 감시 범위 안에서의 이동은 노드의 부모와 이름만 바꾸고, 밖에서 옮겨온 디렉토리는 새로 등록
+        auto it = m_mapPendingMoves.find(event->cookie);
+        if (it != m_mapPendingMoves.end() && m_watchTree.Find(it->second.Wd) == it->second.Node) {
+            m_watchTree.Move(it->second.Node, node, event->name);
+            m_mapPendingMoves.erase(it);
+        } else {
+            registerDirectory(node, event->name);
+        }
+    }
+}
+
+// 디렉토리 생성/이동/삭제 기록 (해시와 files 테이블은 파일에만 해당), 기록할 이벤트가 아니면 false
+bool CEventMonitor::logDirectoryEvent(const ST_FileEvent& fileEvent) {
+    ST_MonitorData data = createMonitorData(fileEvent);
+    if (fileEvent.Mask & IN_CREATE) {
+        data.eventType = "Directory created";
+    } else if (fileEvent.Mask & IN_MOVED_FROM) {
+        data.eventType = "Directory moved from";
+    } else if (fileEvent.Mask & IN_MOVED_TO) {
+        data.eventType = "Directory moved to";
+    } else if (fileEvent.Mask & IN_DELETE) {
+        data.eventType = "Directory deleted";
+    } else {
+        return false;
+    }
+
+    logEvent(data);
+    m_dbManager->LogEventToDatabase(data);
+    std::lock_guard<std::mutex> lock(m_outputMutex);
+    std::cout << "[" << data.timestamp << "]";
+    printEventsInfo(data);
+    std::cout << "\n\n";
+    return true;
+}
+
+ST_MonitorData CEventMonitor::createMonitorData(const ST_FileEvent& fileEvent) {
     ST_MonitorData data = {
         .eventType = "",
-        .filePath = it->second,
+        .filePath = fileEvent.Path,
         .newHash = "",
         .oldHash = "",
         .timestamp = GetCurrentTimeWithMilliseconds(),
         .fileSize = -1,
-        .user = getpwuid(getuid())->pw_name,
-        .processId = getpid()
+        .user = fileEvent.User,
+        .processId = fileEvent.Pid,
+        .mtimeNs = 0,
+        .ctimeNs = 0,
+        .isArchive = false,
+        .mergedEvents = fileEvent.Count
     };
+    return data;
+}
 
-    struct stat pathStat;
-    if (stat(data.filePath.c_str(), &pathStat) == 0 && S_ISDIR(pathStat.st_mode)) {
-        if (event->len > 0) {
-            data.filePath += "/" + std::string(event->name);
-        }
-    }
+void CEventMonitor::handleFileEvent(const ST_FileEvent& fileEvent) {
+    uint32_t mask = fileEvent.Mask;
+    ST_MonitorData data = createMonitorData(fileEvent);
 
     // 파일 크기 가져오기
+    struct stat pathStat;
     if (stat(data.filePath.c_str(), &pathStat) == 0) {
         data.fileSize = pathStat.st_size;
     } 
 
-    std::cout << "[" << data.timestamp << "]";
-
-    if (event->mask & IN_CREATE) {
+    if (mask & IN_CREATE) {
         data.eventType = "File created";
-        data.newHash = CalculateFileHash(data.filePath);
-    } else if (event->mask & IN_MODIFY) {
+        CalculateFileDigest(data);
+    } else if (mask & (IN_MODIFY | IN_CLOSE_WRITE)) {
         data.eventType = "File modified";
         data.oldHash = m_dbManager->GetFileHash(data.filePath);
-        data.newHash = CalculateFileHash(data.filePath);
-    } else if (event->mask & IN_MOVED_TO) {
+        CalculateFileDigest(data);
+    } else if (mask & IN_MOVED_TO) {
         data.eventType = "File moved to";
-        data.newHash = CalculateFileHash(data.filePath);
-    } else if (event->mask & IN_MOVED_FROM) {
+        CalculateFileDigest(data);
+    } else if (mask & IN_MOVED_FROM) {
         data.eventType = "File moved from";
         data.oldHash = m_dbManager->GetFileHash(data.filePath);
         data.fileSize = m_dbManager->GetFileSize(data.filePath);
         m_dbManager->RemoveFileFromDatabase(data.filePath);
-    } else if (event->mask & IN_DELETE) {
+    } else if (mask & IN_DELETE) {
         data.eventType = "File deleted";
         data.oldHash = m_dbManager->GetFileHash(data.filePath);
         data.fileSize = m_dbManager->GetFileSize(data.filePath);
@@ -263,9 +1236,11 @@ void CEventMonitor::processEvent(struct inotify_event *event) {
         data.eventType = "Other event occurred";
     }
 
-    printEventsInfo(data);
     logEvent(data);
     m_dbManager->LogEventToDatabase(data);
+    std::lock_guard<std::mutex> lock(m_outputMutex);
+    std::cout << "[" << data.timestamp << "]";
+    printEventsInfo(data);
     std::cout << "\n\n";
 }
 
@@ -278,6 +1253,31 @@ std::string CEventMonitor::CalculateFileHash(std::string filePath) {
     return fileHash;
 }
 
+// 해시 전후로 stat을 비교하여 계산 중에 파일이 바뀌지 않은 경우에만 mtime/ctime을 기록
+// 압축 파일 여부는 앞부분만 읽어 판별 (스캐너는 압축 파일이면 기록된 해시가 있어도 멤버를 검사)
+void CEventMonitor::CalculateFileDigest(ST_MonitorData& data) {
+    struct stat before;
+    struct stat after;
+    if (stat(data.filePath.c_str(), &before) != 0 || !S_ISREG(before.st_mode)) {
+        data.newHash = CalculateFileHash(data.filePath);
+        return;
+    }
+    data.newHash = CalculateFileHash(data.filePath);
+
+    uint8_t header[512];
+    std::ifstream file(data.filePath, std::ios::binary);
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+    data.isArchive = CArchiveReader::DetectType(header, static_cast<size_t>(file.gcount())) != ARCHIVE_NONE;
+
+    if (!data.newHash.empty() && stat(data.filePath.c_str(), &after) == 0 && after.st_size == before.st_size
+        && after.st_mtim.tv_sec == before.st_mtim.tv_sec && after.st_mtim.tv_nsec == before.st_mtim.tv_nsec
+        && after.st_ctim.tv_sec == before.st_ctim.tv_sec && after.st_ctim.tv_nsec == before.st_ctim.tv_nsec) {
+        data.fileSize = after.st_size;
+        data.mtimeNs = static_cast<int64_t>(after.st_mtim.tv_sec) * 1000000000LL + after.st_mtim.tv_nsec;
+        data.ctimeNs = static_cast<int64_t>(after.st_ctim.tv_sec) * 1000000000LL + after.st_ctim.tv_nsec;
+    }
+}
+
 void CEventMonitor::printEventsInfo(ST_MonitorData& data) {
     std::cout << "\n[+] Event type: " << COLOR_YELLOW << data.eventType << COLOR_RESET;
     std::cout << "\n[+] Target file: " << data.filePath;
@@ -292,8 +1292,13 @@ void CEventMonitor::logEvent(ST_MonitorData& data) {
     logEntry["target_file"] = data.filePath;
     logEntry["old_hash"] = data.oldHash.empty() ? "N/A" : data.oldHash;
     logEntry["new_hash"] = data.newHash.empty() ? "N/A" : data.newHash;
-    logEntry["pid"] = Json::Int(getpid());
+    if (data.processId >= 0) {
+        logEntry["pid"] = Json::Int(data.processId);
+    } else {
+        logEntry["pid"] = "N/A";
+    }
     logEntry["user"] = data.user;
+    logEntry["merged_events"] = Json::UInt(data.mergedEvents);
 
     if (data.fileSize != -1) {
         logEntry["file_size"] = Json::UInt64(data.fileSize);
@@ -301,7 +1306,7 @@ void CEventMonitor::logEvent(ST_MonitorData& data) {
         logEntry["file_size"] = "N/A";
     }
 
-    SaveLogInJson(logEntry, getLogFilePath());
+    CJsonLogWriter::Instance().Append(logEntry, getLogFilePath());
 }
 
 // 로그 파일 이름 생성 함수(날짜별로)
@@ -1,23 +1,56 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 #include <string>
 #include <sstream>
+#include <semaphore.h>
+#include <signal.h>
 #include <sys/inotify.h>
+#include <jsoncpp/json/json.h>
 #include "database_manager.h"
 #include "log_parser.h"
 #include "email_sender.h"
+#include "event_coalescer.h"
+#include "event_reactor.h"
+#include "fanotify_monitor.h"
+#include "file_event.h"
+#include "spsc_ring.h"
+#include "watch_tree.h"
 
 #define SETTING_FILE "settings.ini"
 #define LOG_SAVE_PATH "logs/file_event_monitor_"
 
+#define MONITOR_BACKEND_INOTIFY "inotify"     // 디렉토리마다 watch (기본값)
+#define MONITOR_BACKEND_FANOTIFY "fanotify"   // 파일 시스템 전체를 mark 하나로 감시, root 필요
+
 #define PERFORM_MONITORING 1
 #define SEND_EMAIL 2
 
 #define EVENT_SIZE (sizeof(struct inotify_event)) // 이벤트 구조체 크기
 #define EVENT_BUFFER_SIZE (1024 * (EVENT_SIZE + 16)) // 한 번에 읽을 수 있는 최대 바이트 수
 
+#define WATCH_EVENT_MASK (IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE_SELF)
+#define WATCH_WALK_MAX_THREADS 8 // 초기 등록 시 디렉토리 순회 스레드 수 상한 (디스크 대기가 많아 코어 수보다 많아도 이득이 있음)
+#define INOTIFY_MAX_WATCHES_PATH "/proc/sys/fs/inotify/max_user_watches"
+
+#define EVENT_WORKER_MAX_COUNT 8         // settings.ini workers=0(자동)일 때 코어 수와 이 값 중 작은 값
+#define EVENT_RING_CAPACITY 4096         // 작업자별 이벤트 링 크기, 가득 차면 이벤트를 버리고 해당 감시 경로를 다시 검사
+#define MONITOR_STATS_PATH "logs/file_monitor_stats.json"
+#define MONITOR_STATS_INTERVAL_SEC 10
+#define MONITOR_RESCAN_DELAY_MS 200      // 넘침이 이어지는 동안의 다시 검사를 한 번으로 모으는 대기 시간
+#define MONITOR_RESCAN_SLICE 1024        // 다시 검사가 타이머 한 번에 처리하는 디렉토리/파일/DB 기록 수
+#define MONITOR_RESCAN_POLL_MS 5         // 작업자 기록, DB 읽기, 작업자 링 여유를 기다리는 동안 다시 확인하는 간격
+#define MONITOR_CONTROL_SOCKET_PATH "logs/file_monitor.sock"
+#define MONITOR_CONTROL_MAX_LINE 4096
+
 struct ST_MonitorData {
     std::string eventType;
     std::string filePath;
@@ -27,6 +60,60 @@ struct ST_MonitorData {
     int64_t fileSize;
     std::string user;
     int processId;
+    int64_t mtimeNs;    // newHash를 계산하는 동안 파일이 바뀌지 않았을 때의 mtime (바뀌었으면 0, 스캐너가 해시를 신뢰하지 않음)
+    int64_t ctimeNs;
+    bool isArchive;
+    uint32_t mergedEvents; // 이 기록으로 합쳐진 원본 이벤트 수
+};
+
+// IN_MOVED_FROM을 받고 짝이 되는 IN_MOVED_TO를 기다리는 디렉토리 (바로 다음 이벤트가 짝이 아니면 감시 범위 밖으로 이동)
+struct ST_PendingMove {
+    uint32_t Node;
+    int Wd;
+};
+
+// 해시/DB 기록 작업자 하나, 읽기 스레드가 경로 해시로 고른 작업자의 링에만 넣으므로 같은 경로의 이벤트 순서가 유지됨
+struct ST_EventWorker {
+    CSpscRing<ST_FileEvent> Ring;
+    sem_t Ready;                         // 링에 들어있는 이벤트 수 (중지 요청 시 한 번 더 post)
+    std::thread Thread;
+    uint64_t Pushed;                     // 읽기 스레드만 씀
+    std::atomic<uint64_t> Completed;
+
+    ST_EventWorker() : Ring(EVENT_RING_CAPACITY), Pushed(0), Completed(0) { sem_init(&Ready, 0, 0); }
+    ~ST_EventWorker() { sem_destroy(&Ready); }
+};
+
+// 다시 검사 진행 단계, 반응기 스레드에서 타이머가 만료될 때마다 정해진 양만 처리하고 돌아감
+enum ERescanPhase {
+    RESCAN_IDLE = 0,
+    RESCAN_DRAINING,    // 시작 전에 넘긴 이벤트를 작업자가 모두 기록하기를 기다림
+    RESCAN_LOADING,     // 별도 스레드에서 DB 쓰기를 커밋한 뒤 files 테이블을 읽는 중
+    RESCAN_WALKING,     // 루트 아래 디렉토리 순회
+    RESCAN_COMPARING,   // 찾은 파일을 DB 기록과 비교
+    RESCAN_DELETING     // DB에만 남은 파일을 삭제로 기록
+};
+
+struct ST_RescanState {
+    int Phase = RESCAN_IDLE;
+    std::set<std::string> Roots;
+    std::vector<uint64_t> DrainTargets;                      // 작업자별로 이만큼 기록되면 시작 전 이벤트가 모두 DB에 반영됨
+    std::future<int> Loader;
+    std::unordered_map<std::string, ST_FileDigest> Records;  // files 테이블, 비교에서 찾은 파일은 지움
+    std::unordered_map<std::string, ST_FileDigest>::const_iterator NextRecord;
+    std::vector<std::pair<std::string, int>> Directories;    // 순회할 디렉토리와 wd (watch가 없으면 -1)
+    std::vector<std::string> Files;
+    size_t NextFile = 0;
+    uint64_t Events = 0;
+};
+
+struct ST_MonitorStatistics {
+    std::atomic<uint64_t> EventsRead{0};     // 커널에서 읽은 이벤트
+    std::atomic<uint64_t> Records{0};        // 작업자가 기록한 이벤트 (합친 뒤)
+    std::atomic<uint64_t> Dropped{0};        // 작업자 링이 가득 차 버린 이벤트
+    std::atomic<uint64_t> Overflows{0};      // 커널 이벤트 큐 넘침 (IN_Q_OVERFLOW, FAN_Q_OVERFLOW)
+    std::atomic<uint64_t> Rescans{0};
+    std::atomic<uint64_t> RescanEvents{0};   // 다시 검사하여 DB와 달라 만든 이벤트
 };
 
 class CDatabaseManager; //전방 선언
@@ -43,16 +130,73 @@ public:
     friend class EmailSender; 
 private:
     int m_inotifyFd;
-    std::unordered_map<int, std::string> m_mapWatchDescriptors;
+    CWatchTree m_watchTree;
+    std::unordered_map<uint32_t, ST_PendingMove> m_mapPendingMoves; // inotify 이동 cookie -> 이동 중인 디렉토리
+    std::atomic<bool> m_bWatchLimitReached;
+    std::atomic<uint64_t> m_ullWatchFailures;
     std::vector<std::string> m_vecWatchList;
+    std::string m_strBackend;
+    CFanotifyMonitor m_fanotifyMonitor;
+    CEventCoalescer m_coalescer;
+    std::vector<ST_FileEvent> m_vecReadyEvents; // 합치기가 끝나 작업자에게 넘길 이벤트
+    std::vector<std::unique_ptr<ST_EventWorker>> m_vecWorkers;
+    int m_nWorkerCount;
+    std::atomic<bool> m_bStopWorkers;
+    std::mutex m_outputMutex;                   // 작업자들의 이벤트 출력이 섞이지 않도록 보호
+    ST_MonitorStatistics m_statistics;
+    std::vector<std::pair<std::string, int>> m_vecRoots; // 감시 루트 절대 경로와 wd (fanotify는 -1)
+    std::set<std::string> m_setRescanRoots;     // 이벤트를 잃어 다시 검사할 루트
+    ST_RescanState m_rescan;                    // 진행 중인 다시 검사 (그동안 표시된 루트는 끝난 뒤 다시 검사)
+    CEventReactor m_reactor;
+    int m_signalFd;
+    int m_coalesceTimerFd;                      // 합치는 중인 이벤트 중 가장 이른 만료 시점
+    int m_rescanTimerFd;
+    int m_statisticsTimerFd;
+    int m_controlFd;
+    std::unordered_map<int, std::string> m_mapControlClients; // 제어 연결 -> 아직 줄바꿈을 받지 못한 요청
+    bool m_bStopRequested;
+    sigset_t m_oldSignalMask;
     CDatabaseManager* m_dbManager;
 
     void readWatchList();
     void createInotifyInstance();
     void addWatchListToInotify();
+    int addWatch(const std::string& path, bool directoryOnly);
+    void registerTrees(const std::vector<std::string>& roots);
+    void registerDirectory(uint32_t parent, const std::string& name);
+    void removeWatch(uint32_t node);
+    void flushPendingMoves();
+    void reportRegistration(double elapsedSec);
+    int openEventSources();
+    void closeEventSources();
     void runEventLoop();
+    void drainAndStop();
+    void onInotifyReadable();
+    void onFanotifyReadable();
+    void onSignal();
+    void onControlConnection();
+    void onControlClient(int clientFd);
+    std::string handleControlCommand(const std::string& command);
     void processEvent(struct inotify_event *event);
+    void processDirectoryEvent(uint32_t node, struct inotify_event *event, const ST_FileEvent& fileEvent);
+    bool logDirectoryEvent(const ST_FileEvent& fileEvent);
+    void handleFileEvent(const ST_FileEvent& fileEvent);
+    void dispatchReadyEvents(bool wait = false);
+    void startWorkers();
+    void stopWorkers();
+    void runWorker(ST_EventWorker& worker);
+    void scheduleRescan(const std::string& path);
+    void continueRescan();
+    void startRescan();
+    void walkRescanDirectories();
+    bool compareRescanFiles();
+    bool recordRescanDeletes();
+    void finishRescan(bool completed);
+    Json::Value collectStatistics();
+    void writeStatistics();
+    ST_MonitorData createMonitorData(const ST_FileEvent& fileEvent);
     std::string CalculateFileHash(std::string filePath);
+    void CalculateFileDigest(ST_MonitorData& data);
     void printEventsInfo(ST_MonitorData& data);
     void logEvent(ST_MonitorData& data);
     std::string getLogFilePath();
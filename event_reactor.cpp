@@ -0,0 +1,96 @@
+#include <cerrno>
+#include <cstring>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include "event_reactor.h"
+#include "util.h"
+
+CEventReactor::CEventReactor() : m_epollFd(-1) {}
+
+CEventReactor::~CEventReactor() {
+    if (m_epollFd != -1) {
+        close(m_epollFd);
+    }
+}
+
+int CEventReactor::Open() {
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epollFd == -1) {
+        PrintError("epoll_create1 failed: " + std::string(strerror(errno)));
+        return ERROR_INVALID_FUNCTION;
+    }
+    return SUCCESS_CODE;
+}
+
+int CEventReactor::Add(int fd, uint32_t events, EventHandler handler) {
+    struct epoll_event event = {};
+    event.events = events;
+    event.data.fd = fd;
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event) == -1) {
+        PrintError("epoll_ctl failed: " + std::string(strerror(errno)));
+        return ERROR_INVALID_FUNCTION;
+    }
+    m_mapHandlers[fd] = std::move(handler);
+    return SUCCESS_CODE;
+}
+
+// fd를 닫기 전에 호출 (같은 반복에서 이미 받은 이벤트는 콜백이 없으므로 무시됨)
+void CEventReactor::Remove(int fd) {
+    epoll_ctl(m_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    m_mapHandlers.erase(fd);
+}
+
+// 준비된 fd의 콜백을 한 번씩 호출하고 처리한 fd 수를 반환, 실패하면 -1
+int CEventReactor::RunOnce(int timeoutMs) {
+    struct epoll_event events[REACTOR_MAX_EVENTS];
+    int nReady = epoll_wait(m_epollFd, events, REACTOR_MAX_EVENTS, timeoutMs);
+    if (nReady < 0) {
+        if (errno == EINTR) {
+            return 0;
+        }
+        PrintError("epoll_wait failed: " + std::string(strerror(errno)));
+        return -1;
+    }
+    for (int i = 0; i < nReady; i++) {
+        auto it = m_mapHandlers.find(events[i].data.fd);
+        if (it == m_mapHandlers.end()) {
+            continue;
+        }
+        EventHandler handler = it->second; // 콜백 안에서 자신을 Remove해도 안전하도록 복사
+        handler(events[i].events);
+    }
+    return nReady;
+}
+
+int CEventReactor::CreateTimer() {
+    int timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timerFd == -1) {
+        PrintError("timerfd_create failed: " + std::string(strerror(errno)));
+    }
+    return timerFd;
+}
+
+// it_value가 0이면 해제이므로, 이미 기한이 지난 경우(0)는 1ns 뒤로 설정하여 다음 반복에서 바로 만료되게 함
+int CEventReactor::ArmTimer(int timerFd, int64_t delayMs, int64_t intervalMs) {
+    struct itimerspec spec = {};
+    if (delayMs == 0) {
+        spec.it_value.tv_nsec = 1;
+    } else if (delayMs > 0) {
+        spec.it_value.tv_sec = delayMs / 1000;
+        spec.it_value.tv_nsec = (delayMs % 1000) * 1000000;
+    }
+    if (delayMs >= 0) {
+        spec.it_interval.tv_sec = intervalMs / 1000;
+        spec.it_interval.tv_nsec = (intervalMs % 1000) * 1000000;
+    }
+    return timerfd_settime(timerFd, 0, &spec, nullptr) == 0 ? SUCCESS_CODE : ERROR_INVALID_FUNCTION;
+}
+
+// 만료 횟수를 읽어 timerfd를 다시 대기 상태로 만듦
+uint64_t CEventReactor::ReadTimer(int timerFd) {
+    uint64_t ullExpirations = 0;
+    if (read(timerFd, &ullExpirations, sizeof(ullExpirations)) != sizeof(ullExpirations)) {
+        return 0;
+    }
+    return ullExpirations;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <sys/epoll.h>
+
+#define REACTOR_MAX_EVENTS 32
+
+// epoll 하나로 여러 fd(inotify/fanotify, signalfd, timerfd, 소켓)를 기다리고 fd별 콜백을 호출하는 단일 스레드 이벤트 루프
+// 레벨 트리거이므로 콜백이 한 번에 정해진 양만 처리하고 돌아가도 남은 데이터는 다음 반복에서 다시 알려짐
+// (이벤트가 쏟아지는 fd가 있어도 신호/타이머/제어 요청은 읽기 한 번 이내에 처리됨)
+class CEventReactor {
+public:
+    using EventHandler = std::function<void(uint32_t events)>;
+
+    CEventReactor();
+    ~CEventReactor();
+    int Open();
+    int Add(int fd, uint32_t events, EventHandler handler);
+    void Remove(int fd);
+    int RunOnce(int timeoutMs);
+
+    // timerfd 보조 함수, delayMs가 음수(-1)면 타이머 해제하고 0이면 바로 만료
+    static int CreateTimer();
+    static int ArmTimer(int timerFd, int64_t delayMs, int64_t intervalMs = 0);
+    static uint64_t ReadTimer(int timerFd);
+
+    CEventReactor(const CEventReactor&) = delete;
+    CEventReactor& operator=(const CEventReactor&) = delete;
+
+private:
+    int m_epollFd;
+    std::unordered_map<int, EventHandler> m_mapHandlers;
+};
@@ -0,0 +1,193 @@
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/inotify.h>
+#include <sys/statfs.h>
+#include <unistd.h>
+#include "ansi_color.h"
+#include "fanotify_monitor.h"
+#include "util.h"
+
+// 이벤트 마스크를 변환 없이 inotify 이벤트와 같은 처리 경로로 넘기기 위한 전제
+static_assert(FAN_MODIFY == IN_MODIFY && FAN_CLOSE_WRITE == IN_CLOSE_WRITE && FAN_CREATE == IN_CREATE && FAN_DELETE == IN_DELETE
+              && FAN_MOVED_FROM == IN_MOVED_FROM && FAN_MOVED_TO == IN_MOVED_TO, "fanotify and inotify event bits differ");
+
+CFanotifyMonitor::CFanotifyMonitor() : m_fanotifyFd(-1), m_selfPid(getpid()), m_ullOverflows(0) {}
+
+CFanotifyMonitor::~CFanotifyMonitor() {
+    for (const ST_FanotifyFilesystem& filesystem : m_vecFilesystems) {
+        close(filesystem.MountFd);
+    }
+    if (m_fanotifyFd != -1) {
+        close(m_fanotifyFd);
+    }
+}
+
+// 감시 경로마다 그 경로가 속한 파일 시스템에 mark를 추가 (같은 파일 시스템은 한 번만)
+int CFanotifyMonitor::Open(const std::vector<std::string>& roots) {
+    m_fanotifyFd = fanotify_init(FAN_CLASS_NOTIF | FAN_REPORT_DFID_NAME | FAN_CLOEXEC | FAN_NONBLOCK, O_RDONLY | O_LARGEFILE | O_CLOEXEC);
+    if (m_fanotifyFd == -1) {
+        PrintError("fanotify_init failed: " + std::string(strerror(errno)) + " (requires root and Linux 5.9 or later)");
+        return ERROR_ACCESS_DENIED;
+    }
+
+    for (const std::string& strRoot : roots) {
+        std::string strPath = GetAbsolutePath(strRoot);
+        struct statfs fsStat;
+        if (statfs(strPath.c_str(), &fsStat) != 0) {
+            PrintErrorMessage(ERROR_CANNOT_OPEN_DIRECTORY, strPath);
+            continue;
+        }
+        m_vecRoots.push_back(strPath);
+
+        // statfs의 fsid_t와 이벤트의 __kernel_fsid_t는 같은 8바이트지만 다른 타입이므로 복사해서 변환
+        static_assert(sizeof(fsStat.f_fsid) == sizeof(__kernel_fsid_t), "fsid_t and __kernel_fsid_t differ in size");
+        __kernel_fsid_t kernelFsid;
+        memcpy(&kernelFsid, &fsStat.f_fsid, sizeof(kernelFsid));
+        uint64_t ullFsid = GetFsid(kernelFsid);
+        bool bMarked = false;
+        for (const ST_FanotifyFilesystem& filesystem : m_vecFilesystems) {
+            bMarked = bMarked || filesystem.Fsid == ullFsid;
+        }
+        if (!bMarked) {
+            if (fanotify_mark(m_fanotifyFd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM, FANOTIFY_EVENT_MASK, AT_FDCWD, strPath.c_str()) == -1) {
+                PrintError("fanotify_mark failed on " + strPath + ": " + strerror(errno));
+                m_vecRoots.pop_back();
+                continue;
+            }
+            int mountFd = open(strPath.c_str(), O_RDONLY | O_CLOEXEC); // open_by_handle_at은 O_PATH fd를 받지 않음
+            if (mountFd == -1) {
+                PrintErrorMessage(ERROR_CANNOT_OPEN_DIRECTORY, strPath);
+                m_vecRoots.pop_back();
+                continue;
+            }
+            m_vecFilesystems.push_back({ullFsid, mountFd, strPath});
+        }
+        std::cout << COLOR_GREEN << "[+] Monitoring " << strPath << " (fanotify)" << COLOR_RESET << "\n";
+    }
+    if (m_vecRoots.empty()) {
+        return ERROR_CANNOT_OPEN_DIRECTORY;
+    }
+    std::cout << "\n[+] " << m_vecFilesystems.size() << " filesystem mark(s) cover " << m_vecRoots.size() << " monitored path(s)\n";
+    return SUCCESS_CODE;
+}
+
+// 이벤트를 한 번 읽어 감시 경로 아래의 이벤트만 events에 추가 (논블로킹, 읽을 것이 없으면 그대로 성공)
+int CFanotifyMonitor::ReadEvents(std::vector<ST_FileEvent>& events) {
+    alignas(struct fanotify_event_metadata) char buffer[FANOTIFY_EVENT_BUFFER_SIZE];
+    ssize_t length = read(m_fanotifyFd, buffer, sizeof(buffer));
+    if (length < 0) {
+        if (errno == EINTR || errno == EAGAIN) {
+            return SUCCESS_CODE;
+        }
+        PrintError("fanotify read failed: " + std::string(strerror(errno)));
+        return ERROR_INVALID_FUNCTION;
+    }
+
+    const struct fanotify_event_metadata* metadata = reinterpret_cast<const struct fanotify_event_metadata*>(buffer);
+    for (; FAN_EVENT_OK(metadata, length); metadata = FAN_EVENT_NEXT(metadata, length)) {
+        if (metadata->vers != FANOTIFY_METADATA_VERSION) {
+            PrintError("fanotify metadata version mismatch");
+            return ERROR_INVALID_FUNCTION;
+        }
+        if (metadata->fd >= 0) {
+            close(metadata->fd);
+        }
+        if (metadata->mask & FAN_Q_OVERFLOW) {
+            m_ullOverflows++;
+            PrintError("fanotify event queue overflowed, some events were lost.");
+            continue;
+        }
+        // 에이전트 자신의 로그/DB 쓰기는 무시 (같은 파일 시스템이면 이벤트가 다시 이벤트를 만듦)
+        if (metadata->pid == m_selfPid || metadata->event_len < sizeof(*metadata) + sizeof(struct fanotify_event_info_fid)) {
+            continue;
+        }
+        const struct fanotify_event_info_fid* info = reinterpret_cast<const struct fanotify_event_info_fid*>(metadata + 1);
+        if (info->hdr.info_type != FAN_EVENT_INFO_TYPE_DFID_NAME) {
+            continue;
+        }
+
+        bool bDirectory = (metadata->mask & FAN_ONDIR) != 0;
+        std::string strDirectory;
+        bool bResolved = ResolveDirectory(info, strDirectory);
+        // 디렉토리가 옮겨지거나 지워지면 캐시된 하위 디렉토리 경로가 틀릴 수 있으므로 비움
+        if (bDirectory && (metadata->mask & (FAN_MOVED_FROM | FAN_MOVED_TO | FAN_DELETE))) {
+            m_mapDirectoryPaths.clear();
+        }
+        if (!bResolved) {
+            continue;
+        }
+        const struct file_handle* handle = reinterpret_cast<const struct file_handle*>(info->handle);
+        std::string strName(reinterpret_cast<const char*>(handle->f_handle + handle->handle_bytes));
+        if (strName.empty() || strName == ".") {
+            continue;
+        }
+        std::string strPath = strDirectory.back() == '/' ? strDirectory + strName : strDirectory + "/" + strName;
+        if (IsUnderRoots(strPath)) {
+            events.push_back({strPath, static_cast<uint32_t>(metadata->mask & ~FAN_ONDIR), bDirectory, metadata->pid});
+        }
+    }
+    return SUCCESS_CODE;
+}
+
+// 부모 디렉토리 파일 핸들을 경로로 변환, 같은 디렉토리의 이벤트가 이어지는 경우가 많으므로 결과를 캐시
+// 이미 삭제된 디렉토리(rm -rf 중 하위 파일 삭제 등)는 핸들을 열 수 없어 이벤트를 건너뜀
+bool CFanotifyMonitor::ResolveDirectory(const struct fanotify_event_info_fid* info, std::string& path) {
+    const struct file_handle* handle = reinterpret_cast<const struct file_handle*>(info->handle);
+    std::string strKey(reinterpret_cast<const char*>(&info->fsid), sizeof(info->fsid));
+    strKey.append(reinterpret_cast<const char*>(handle), sizeof(struct file_handle) + handle->handle_bytes);
+    auto it = m_mapDirectoryPaths.find(strKey);
+    if (it != m_mapDirectoryPaths.end()) {
+        path = it->second;
+        return true;
+    }
+
+    uint64_t ullFsid = GetFsid(info->fsid);
+    int mountFd = -1;
+    for (const ST_FanotifyFilesystem& filesystem : m_vecFilesystems) {
+        if (filesystem.Fsid == ullFsid) {
+            mountFd = filesystem.MountFd;
+            break;
+        }
+    }
+    if (mountFd == -1) {
+        return false;
+    }
+    int directoryFd = open_by_handle_at(mountFd, const_cast<struct file_handle*>(handle), O_PATH | O_CLOEXEC);
+    if (directoryFd == -1) {
+        return false;
+    }
+    char szLinkPath[64];
+    char szPath[PATH_MAX];
+    snprintf(szLinkPath, sizeof(szLinkPath), "/proc/self/fd/%d", directoryFd);
+    ssize_t length = readlink(szLinkPath, szPath, sizeof(szPath));
+    close(directoryFd);
+    if (length <= 0 || length >= static_cast<ssize_t>(sizeof(szPath))) {
+        return false;
+    }
+    path.assign(szPath, length);
+
+    if (m_mapDirectoryPaths.size() >= FANOTIFY_DIRECTORY_CACHE_MAX_ENTRIES) {
+        m_mapDirectoryPaths.clear();
+    }
+    m_mapDirectoryPaths.emplace(std::move(strKey), path);
+    return true;
+}
+
+// 파일 시스템 mark는 파일 시스템 전체를 감시하므로 settings.ini의 경로 아래 이벤트만 남김
+bool CFanotifyMonitor::IsUnderRoots(const std::string& path) const {
+    for (const std::string& strRoot : m_vecRoots) {
+        if (strRoot == "/" || (path.compare(0, strRoot.size(), strRoot) == 0 && (path.size() == strRoot.size() || path[strRoot.size()] == '/'))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t CFanotifyMonitor::GetFsid(const __kernel_fsid_t& fsid) {
+    uint64_t ullFsid;
+    memcpy(&ullFsid, &fsid, sizeof(ullFsid));
+    return ullFsid;
+}
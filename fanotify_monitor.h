@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <sys/fanotify.h>
+#include "file_event.h"
+
+#define FANOTIFY_EVENT_BUFFER_SIZE (64 * 1024)
+#define FANOTIFY_DIRECTORY_CACHE_MAX_ENTRIES 65536  // 디렉토리 핸들 -> 경로 캐시 최대 항목 수, 넘치면 비움
+#define FANOTIFY_EVENT_MASK (FAN_CREATE | FAN_DELETE | FAN_MODIFY | FAN_CLOSE_WRITE | FAN_MOVED_FROM | FAN_MOVED_TO | FAN_ONDIR)
+
+// 감시 경로가 속한 파일 시스템, 이벤트의 fsid로 찾아 open_by_handle_at의 기준 fd로 사용
+struct ST_FanotifyFilesystem {
+    uint64_t Fsid;
+    int MountFd;
+    std::string Path;
+};
+
+// 파일 시스템 전체를 mark 하나로 감시하는 fanotify 이벤트 모니터 (커널 5.9 이상, CAP_SYS_ADMIN과 CAP_DAC_READ_SEARCH 필요)
+// 디렉토리마다 watch를 두는 inotify와 달리 등록 비용과 max_user_watches 제한이 없고, 이벤트를 일으킨 pid를 알 수 있음
+// 이벤트는 부모 디렉토리의 파일 핸들과 이름으로 오므로 핸들을 경로로 바꾼 뒤 설정된 감시 경로 아래의 이벤트만 전달
+class CFanotifyMonitor {
+public:
+    CFanotifyMonitor();
+    ~CFanotifyMonitor();
+    int Open(const std::vector<std::string>& roots);
+    int ReadEvents(std::vector<ST_FileEvent>& events);
+    int GetFd() const { return m_fanotifyFd; }
+    uint64_t GetOverflowCount() const { return m_ullOverflows; }
+
+    CFanotifyMonitor(const CFanotifyMonitor&) = delete;
+    CFanotifyMonitor& operator=(const CFanotifyMonitor&) = delete;
+
+private:
+    int m_fanotifyFd;
+    pid_t m_selfPid;
+    std::vector<std::string> m_vecRoots;
+    std::vector<ST_FanotifyFilesystem> m_vecFilesystems;
+    std::unordered_map<std::string, std::string> m_mapDirectoryPaths; // fsid + 파일 핸들 바이트 -> 디렉토리 경로
+    uint64_t m_ullOverflows;
+
+    bool ResolveDirectory(const struct fanotify_event_info_fid* info, std::string& path);
+    bool IsUnderRoots(const std::string& path) const;
+    static uint64_t GetFsid(const __kernel_fsid_t& fsid);
+};
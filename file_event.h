@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+
+// 감시 백엔드(inotify, fanotify)와 무관한 파일 이벤트 하나
+// Mask는 IN_* 값 (커널이 FAN_CREATE, FAN_MODIFY 등을 같은 값으로 정의하므로 fanotify 이벤트도 그대로 사용)
+struct ST_FileEvent {
+    std::string Path;
+    uint32_t Mask;
+    bool IsDirectory;
+    pid_t Pid;          // 이벤트를 일으킨 프로세스, 알 수 없으면(inotify) -1
+    uint32_t Count = 1; // 합쳐진 원본 이벤트 수 (CEventCoalescer)
+    std::string User = "N/A"; // Pid의 사용자, 작업자가 처리할 때는 프로세스가 끝났거나 pid가 재사용되었을 수 있으므로 읽을 때 확인
+};
+
+// files 테이블에 기록된 파일 하나의 해시와, 해시를 계산할 때의 메타데이터
+// 스캐너는 크기/mtime/ctime이 지금과 같으면 파일을 다시 읽지 않고 이 해시를 사용
+struct ST_FileDigest {
+    std::string Hash;
+    int64_t FileSize;
+    int64_t MtimeNs;
+    int64_t CtimeNs;
+    bool IsArchive;     // 압축 파일이면 멤버를 검사해야 하므로 해시만으로 판정하지 않음
+};
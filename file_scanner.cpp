@@ -1,34 +1,134 @@
+#include <climits>
 #include <csignal>
 #include <iostream>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #include <fstream>
 #include <chrono>
 #include <iomanip>
+#include <map>
 #include <jsoncpp/json/json.h>
 #include "ansi_color.h"
+#include "archive_reader.h"
 #include "config.h"
+#include "engine_manager.h"
 #include "file_scanner.h"
+#include "json_log_writer.h"
 #include "malware_hash_checker.h"
+#include "mapped_file.h"
+#include "scan_checkpoint.h"
+#include "scan_progress.h"
 #include "yara_checker.h"
 
 // 전역 변수 추가
 bool CFileScanner::m_bStopScanning = false;
 
 CFileScanner::CFileScanner() 
-    : m_nScanTypeOption(YARA_RULE), m_nFileTypeOption(ALL_FILES), m_nFileCount(0), m_llTotalSize(0), m_dScanTime(0.0) {}
+    : m_nScanTypeOption(YARA_RULE), m_nFileTypeOption(ALL_FILES), m_nFileCount(0), m_llTotalSize(0), m_dScanTime(0.0),
+      m_bHeadless(false), m_bAutoQuarantine(false), m_bResume(false), m_dPreviousScanTime(0.0),
+      m_bPrioritize(false), m_dFirstDetectionTime(-1.0), m_bCheckpoint(true), m_ullDigestHits(0), m_pProgress(nullptr) {}
 
-// 신호 처리기 함수 추가
+// 신호 처리기 함수 추가 (서비스 중지 시의 SIGTERM도 체크포인트를 남기고 종료)
 void signalHandler(int signal) {
-    if (signal == SIGINT) {
+    if (signal == SIGINT || signal == SIGTERM) {
         std::cout << "\nScan interrupted. Stopping the scan...\n";
         CFileScanner::m_bStopScanning = true;
     }
 }
 
+// 커맨드라인에서 받은 스캔 옵션 적용
+void CFileScanner::SetOptions(const ST_ScanOptions& options) {
+    m_bHeadless = options.Headless;
+    m_strScanTargetPath = options.TargetPath;
+    m_nFileTypeOption = options.FileTypeOption;
+    m_strExtension = options.Extension;
+    m_nScanTypeOption = options.ScanTypeOption;
+    m_strSummaryPath = options.SummaryPath;
+    m_bAutoQuarantine = options.AutoQuarantine;
+    m_bResume = options.Resume;
+    m_strProfilePath = options.ProfilePath;
+    m_bPrioritize = options.Prioritize;
+    m_vecShardPaths = options.ShardPaths;
+    m_setShallowPaths.insert(options.ShallowPaths.begin(), options.ShallowPaths.end());
+    m_bCheckpoint = options.Checkpoint;
+    m_pProgress = options.Progress;
+}
+
+// 체크포인트에서 스캔 옵션과 지금까지의 결과를 복원
+int CFileScanner::RestoreCheckpoint() {
+    CScanCheckpoint IScanCheckpoint(CHECKPOINT_FILE_PATH);
+    ST_ScanCheckpoint checkpoint;
+    int nResult = IScanCheckpoint.Load(checkpoint);
+    if (nResult != SUCCESS_CODE) {
+        PrintErrorMessage(nResult, CHECKPOINT_FILE_PATH);
+        return nResult;
+    }
+
+    m_strScanTargetPath = checkpoint.TargetPath;
+    m_nFileTypeOption = checkpoint.FileTypeOption;
+    m_strExtension = checkpoint.Extension;
+    m_nScanTypeOption = checkpoint.ScanTypeOption;
+    m_strResumeAfter = checkpoint.LastPath;
+    m_nFileCount = checkpoint.FileCount;
+    m_llTotalSize = checkpoint.TotalSize;
+    m_dPreviousScanTime = checkpoint.ScanTime;
+    m_vecDetectedMalware = checkpoint.DetectedMalware;
+    m_vecScanData = checkpoint.ScanData;
+    m_bPrioritize = checkpoint.Prioritize;
+    m_setPriorityScanned.insert(checkpoint.PriorityScanned.begin(), checkpoint.PriorityScanned.end());
+    m_dFirstDetectionTime = checkpoint.FirstDetectionTime;
+
+    std::cout << "[-] Resuming scan of " << m_strScanTargetPath << " after " << m_strResumeAfter
+              << " (" << m_nFileCount << " files, " << m_vecScanData.size() << " detections so far)\n\n";
+    return SUCCESS_CODE;
+}
+
+// 현재까지의 순회 위치와 결과를 체크포인트로 저장
+int CFileScanner::SaveCheckpoint(const std::string& lastPath, double elapsedTime) {
+    ST_ScanCheckpoint checkpoint = {
+        .TargetPath = m_strScanTargetPath,
+        .FileTypeOption = m_nFileTypeOption,
+        .Extension = m_strExtension,
+        .ScanTypeOption = m_nScanTypeOption,
+        .LastPath = lastPath,
+        .FileCount = m_nFileCount,
+        .TotalSize = m_llTotalSize,
+        .ScanTime = m_dPreviousScanTime + elapsedTime,
+        .DetectedMalware = m_vecDetectedMalware,
+        .ScanData = m_vecScanData,
+        .Prioritize = m_bPrioritize,
+        .PriorityScanned = std::vector<std::string>(m_setPriorityScanned.begin(), m_setPriorityScanned.end()),
+        .FirstDetectionTime = m_dFirstDetectionTime
+    };
+    CScanCheckpoint IScanCheckpoint(CHECKPOINT_FILE_PATH);
+    return IScanCheckpoint.Save(checkpoint);
+}
+
+// 체크포인트 재개를 위해 순회 순서를 이름순으로 고정
+static int CompareFtsEntries(const FTSENT** lhs, const FTSENT** rhs) {
+    return strcmp((*lhs)->fts_name, (*rhs)->fts_name);
+}
+
 //-s 혹은 --scan 옵션 입력 시 실행되는 함수
 int CFileScanner::StartScan(){
-    int nRresult = PerformFileScan();
+    int nRresult;
+    if (m_bResume) {
+        // 재개 시에는 체크포인트에 저장된 옵션을 그대로 사용
+        nRresult = RestoreCheckpoint();
+        if (nRresult == SUCCESS_CODE) {
+            nRresult = ScanDirectory();
+        }
+    } else if (m_bHeadless) {
+        // 헤드리스 모드는 표준입력을 사용하지 않고 옵션 값으로 바로 스캔
+        if (!IsDirectory(m_strScanTargetPath)) {
+            nRresult = ERROR_PATH_NOT_FOUND;
+        } else {
+            nRresult = ScanDirectory();
+        }
+    } else {
+        nRresult = PerformFileScan();
+    }
     if (nRresult != SUCCESS_CODE) {
         PrintErrorMessage(nRresult);
         return nRresult;
@@ -123,104 +223,548 @@ int CFileScanner::ScanDirectory() {
     // 파일 검사 시작 시간 기록
     auto start = std::chrono::high_resolution_clock::now();
 
-    char * const paths[] = {const_cast<char *>(m_strScanTargetPath.c_str()), nullptr};
-
-    FTS *fileSystem = fts_open(paths, FTS_NOCHDIR | FTS_PHYSICAL, nullptr);
+    std::vector<char*> vecRoots = GetScanRoots();
+    FTS *fileSystem = fts_open(vecRoots.data(), FTS_NOCHDIR | FTS_PHYSICAL, CompareFtsEntries);
     if (fileSystem == nullptr) {
         return ERROR_CANNOT_OPEN_DIRECTORY;
     }
 
     FTSENT *node;
     int nResult;
-
-    CYaraChecker IYaraChecker(YARA_RULES_PATH);
-    CMalwareHashChecker IMalwareHashChecker;
-    nResult = IMalwareHashChecker.LoadHashes(HASH_LIST_PATH);
+    std::string strDestination = GetAbsolutePath(DESTINATION_PATH);
+    bool bBeforeFrontier = !m_strResumeAfter.empty(); // 재개 시 이미 처리한 구간인지 여부
+    std::string strLastPath = m_strResumeAfter;
+    int nFilesSinceCheckpoint = 0;
+    auto lastCheckpointTime = std::chrono::steady_clock::now();
+
+    // 스캔 중 룰/해시 파일이 바뀌면 백그라운드에서 다시 로드하고, 파일 경계에서 새 스냅샷으로 전환
+    CEngineManager IEngineManager(YARA_RULES_PATH, HASH_LIST_PATH);
+    nResult = IEngineManager.Load();
     if (nResult != SUCCESS_CODE) {
         fts_close(fileSystem);
         return nResult;
     }
+    IEngineManager.StartWatching();
+    std::shared_ptr<const ST_EngineSnapshot> snapshot = IEngineManager.Acquire();
+    if (m_nScanTypeOption == HASH_COMPARISON) {
+        LoadMonitorDigests();
+    }
+
+    // 묻지 않고 격리하는 경우 탐지 즉시 작업 스레드에 넘겨 스캔과 격리를 겹쳐서 진행
+    if (m_bHeadless && m_bAutoQuarantine) {
+        m_pQuarantine.reset(new CQuarantineQueue(DESTINATION_PATH));
+        if (m_pQuarantine->Start() != SUCCESS_CODE) {
+            m_pQuarantine.reset();
+        }
+    }
     
+    // 헤드리스 모드는 ETA 계산을 위해 메타데이터만으로 전체 작업량을 먼저 집계
+    // 우선 스캔 모드는 같은 메타데이터 순회에서 위험 점수가 높은 파일 목록도 함께 만듦
+    CScanProgress IScanProgress;
+    uint64_t ullTotalFiles = 0;
+    uint64_t ullTotalBytes = 0;
+    std::vector<ST_ScanCandidate> vecCandidates;
+    if (m_bPrioritize) {
+        CScopedTimer timer(&m_profiler, PHASE_TRAVERSAL);
+        CollectPriorityTargets(vecCandidates, ullTotalFiles, ullTotalBytes);
+    } else if (m_bHeadless) {
+        CountScanTargets(ullTotalFiles, ullTotalBytes);
+    }
+    if (m_bHeadless) {
+        IScanProgress.Start(ullTotalFiles, ullTotalBytes);
+    }
+
+    // 우선 스캔과 일반 순회가 함께 쓰는 파일 하나 검사 및 첫 탐지 시간 기록
+    size_t siDetectionsBefore = m_vecScanData.size();
+    auto ScanTarget = [&](const std::string& filePath, long long fileSize) {
+        m_nFileCount++;
+        m_llTotalSize += fileSize;
+        if (m_bHeadless) {
+            IScanProgress.Update(m_nFileCount, m_llTotalSize, m_vecScanData.size());
+        } else {
+            std::cout << filePath << "\n";
+        }
+        if (IEngineManager.GetGeneration() != snapshot->Generation) {
+            snapshot = IEngineManager.Acquire();
+        }
+        ScanFile(filePath, *snapshot);
+        if (m_pProgress != nullptr) {
+            m_pProgress->fetch_add(1, std::memory_order_relaxed);
+        }
+        if (m_dFirstDetectionTime < 0 && m_vecScanData.size() > siDetectionsBefore) {
+            m_dFirstDetectionTime = m_dPreviousScanTime + std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        }
+    };
+
+    // 처리가 끝난 파일 기준으로 주기적으로 체크포인트 저장
+    auto SaveCheckpointPeriodically = [&]() {
+        nFilesSinceCheckpoint++;
+        auto now = std::chrono::steady_clock::now();
+        if (m_bCheckpoint && (nFilesSinceCheckpoint >= CHECKPOINT_INTERVAL_FILES
+            || now - lastCheckpointTime >= std::chrono::seconds(CHECKPOINT_INTERVAL_SEC))) {
+            double dElapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+            if (SaveCheckpoint(strLastPath, dElapsed) != SUCCESS_CODE) {
+                PrintErrorMessage(ERROR_CANNOT_WRITE_FILE, CHECKPOINT_FILE_PATH);
+            }
+            nFilesSinceCheckpoint = 0;
+            lastCheckpointTime = now;
+        }
+    };
+
     signal(SIGINT, signalHandler);  // 신호 처리기 등록
-    while ((node = fts_read(fileSystem)) != nullptr && !m_bStopScanning) {
+    signal(SIGTERM, signalHandler);
+
+    // 위험 점수가 높은 파일을 먼저 검사, 순회 경계는 그대로 두고 검사한 경로만 기록하여 일반 순회에서 건너뜀
+    if (m_bPrioritize) {
+        std::cout << "[-] Scanning " << vecCandidates.size() << " high-risk files first (of " << ullTotalFiles << " files)\n";
+        for (const ST_ScanCandidate& candidate : vecCandidates) {
+            if (m_bStopScanning) {
+                break;
+            }
+            if (m_setPriorityScanned.count(candidate.Path) > 0
+                || (!m_strResumeAfter.empty() && CScanCheckpoint::ComparePathOrder(candidate.Path, m_strResumeAfter) <= 0)) {
+                continue; // 이전 실행에서 이미 검사한 파일
+            }
+            ScanTarget(candidate.Path, candidate.Size);
+            m_setPriorityScanned.insert(candidate.Path);
+            SaveCheckpointPeriodically();
+        }
+    }
+
+    while (!m_bStopScanning) {
+        {
+            CScopedTimer timer(&m_profiler, PHASE_TRAVERSAL);
+            node = fts_read(fileSystem);
+        }
+        if (node == nullptr) {
+            break;
+        }
+
+        // 재개 시 체크포인트 경계 이전의 하위 트리는 통째로 건너뛰고, 경계를 지나면 더 이상 비교하지 않음
+        if (bBeforeFrontier && (node->fts_info == FTS_D || node->fts_info == FTS_F)) {
+            if (CScanCheckpoint::ComparePathOrder(node->fts_path, m_strResumeAfter) <= 0) {
+                if (node->fts_info == FTS_D && !CScanCheckpoint::IsAncestorPath(node->fts_path, m_strResumeAfter)) {
+                    fts_set(fileSystem, node, FTS_SKIP);
+                }
+                continue;
+            }
+            bBeforeFrontier = false;
+        }
+
         if (node->fts_info == FTS_D) {
             // 특정 디렉토리를 건너뛰도록 설정
-            if (strcmp(GetAbsolutePath(node->fts_path).c_str(), GetAbsolutePath(DESTINATION_PATH).c_str()) == 0) {
+            if (ShouldSkipDirectory(node, strDestination)) {
                 fts_set(fileSystem, node, FTS_SKIP);
                 continue;
             }
         }
 
         if (node->fts_info == FTS_F) {
-            bool shouldScan = false;
-
-            if (m_nFileTypeOption == SPECIFIC_EXTENSION) {
-                if(m_strExtension.empty()) {
-                    m_strExtension = DEFAULT_EXTENSION;
-                }
-                shouldScan = IsExtension(node->fts_path, m_strExtension);
-            } else if (m_nFileTypeOption == ELF_FILES) {
-                shouldScan = IsELFFile(node->fts_path);
-            } else {
-                shouldScan = true;
-            }
-
-            if (shouldScan) {
-                m_nFileCount++;
-                m_llTotalSize += node->fts_statp->st_size;
-                std::cout << node->fts_path << "\n";
-                std::string strDetectionCause;
-                if (m_nScanTypeOption == YARA_RULE) {
-                    nResult = IYaraChecker.CheckYaraRule(node->fts_path, m_vecDetectedMalware, strDetectionCause);
-                } else {
-                    nResult = IMalwareHashChecker.CompareByHash(node, m_vecDetectedMalware, strDetectionCause);
-                }
-                if(!strDetectionCause.empty()) {
-                    ST_ScanData data = {
-                    .DetectedFile = GetAbsolutePath(node->fts_path),
-                    .ScanType = m_nScanTypeOption == YARA_RULE ? "Yara" : "Hash",
-                    .YaraRule = m_nScanTypeOption == YARA_RULE ? strDetectionCause : "N/A",
-                    .HashValue = m_nScanTypeOption == HASH_COMPARISON ? strDetectionCause : "N/A",
-                    .FileSize = "",
-                    .Timestamp = GetCurrentTimeWithMilliseconds(),
-                    .IsMoved = false,
-                    .PathAfterMoving = "N/A"
-                    };
-                    m_vecScanData.push_back(data);
-                }
+            if (ShouldScanFile(node) && (m_setPriorityScanned.empty() || m_setPriorityScanned.count(node->fts_path) == 0)) {
+                ScanTarget(node->fts_path, node->fts_statp->st_size);
             }
+            strLastPath = node->fts_path;
+            SaveCheckpointPeriodically();
         }
     }
 
     signal(SIGINT, SIG_DFL);  // 신호 처리기 기본으로 되돌림
+    signal(SIGTERM, SIG_DFL);
 
     if (fts_close(fileSystem) < 0) {
         return ERROR_CANNOT_CLOSE_FILE_SYSTEM;
     }
 
+    if (m_bHeadless) {
+        IScanProgress.Finish(m_nFileCount, m_llTotalSize, m_vecScanData.size());
+    }
     std::cout << "\n### End File Scan ###\n\n";
 
         // 파일 검사 종료 시간 기록
     auto stop = std::chrono::high_resolution_clock::now();
 
-    // 소요된 시간 계산 (밀리초 단위)
+    // 소요된 시간 계산 (밀리초 단위), 재개한 경우 이전 실행 시간 포함
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
-    m_dScanTime = duration.count() / 1000.0;
+    m_dScanTime = m_dPreviousScanTime + duration.count() / 1000.0;
 
     // 스캔 결과 출력
     nResult = PrintScanResult();
     if(nResult != SUCCESS_CODE) {
         return nResult;
     }
+
+    // 중단된 경우 이동/로그 기록은 재개 후 스캔이 끝났을 때 한 번만 수행
+    CScanCheckpoint IScanCheckpoint(CHECKPOINT_FILE_PATH);
+    if (m_bStopScanning && m_bCheckpoint) {
+        CollectQuarantineResults(); // 이미 격리된 파일은 재개 후 다시 옮기지 않도록 체크포인트에 반영
+        nResult = SaveCheckpoint(strLastPath, duration.count() / 1000.0);
+        if (nResult != SUCCESS_CODE) {
+            return nResult;
+        }
+        std::cout << "\n[-] Checkpoint saved to " << CHECKPOINT_FILE_PATH << ". Run with --resume to continue the scan.\n";
+        if (!m_strSummaryPath.empty()) {
+            WriteSummary();
+        }
+        return ReportProfile();
+    }
+    if (m_bCheckpoint) {
+        IScanCheckpoint.Remove();
+    }
     // 악성 파일 이동
     nResult = MoveDetectedMalware();
 
     for(ST_ScanData& data : m_vecScanData) {
+        CScopedTimer timer(&m_profiler, PHASE_LOGGING);
         LogResult(data);
     }
+
+    if (!m_strSummaryPath.empty()) {
+        nResult = WriteSummary();
+        if (nResult != SUCCESS_CODE) {
+            return nResult;
+        }
+    }
+    return ReportProfile();
+}
+
+// 파일 하나를 열고 읽은 뒤 선택한 엔진으로 검사, 단계별 소요 시간을 기록
+int CFileScanner::ScanFile(const std::string& filePath, const ST_EngineSnapshot& engine) {
+    auto fileStart = std::chrono::steady_clock::now();
+    // 이벤트 모니터가 해시를 계산한 뒤 바뀌지 않은 파일은 열지 않고 기록된 해시로 판정
+    // 유사 해시는 내용이 필요하므로 유사 해시 색인이 있으면 일반 경로로 검사
+    if (!m_mapMonitorDigests.empty() && engine.FuzzyChecker->GetHashCount() == 0) {
+        const ST_FileDigest* pDigest = FindMonitorDigest(filePath);
+        if (pDigest != nullptr) {
+            m_ullDigestHits++;
+            int nResult = ScanBuffer(engine, filePath, "", nullptr, 0, &pDigest->Hash);
+            m_profiler.RecordFile(filePath, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - fileStart).count(), 0);
+            return nResult;
+        }
+    }
+    CMappedFile file;
+    int nResult;
+    {
+        CScopedTimer timer(&m_profiler, PHASE_OPEN);
+        nResult = file.Open(filePath);
+    }
+    if (nResult != SUCCESS_CODE) {
+        return nResult;
+    }
+
+    if (m_nScanTypeOption == YARA_RULE && engine.YaraChecker->IsRuleFile(file.Stat())) {
+        std::cout << "\n" << COLOR_YELLOW << "[+] Skipping YARA rule check for file : " << filePath << COLOR_RESET << "\n\n";
+        return SUCCESS_CODE;
+    }
+
+    // 파일을 한 번만 읽고 해시/YARA 검사는 같은 메모리를 사용
+    {
+        CScopedTimer timer(&m_profiler, PHASE_READ, file.Size());
+        nResult = file.Map();
+    }
+    if (nResult != SUCCESS_CODE) {
+        return nResult;
+    }
+
+    nResult = ScanBuffer(engine, filePath, "", file.Data(), file.Size(), nullptr, &file.Stat());
+
+    // 압축 파일이면 멤버를 메모리에서 풀어 같은 엔진으로 검사
+    if (CArchiveReader::DetectType(file.Data(), file.Size()) != ARCHIVE_NONE) {
+        CScopedTimer timer(&m_profiler, PHASE_ARCHIVE, file.Size());
+        CArchiveReader IArchiveReader;
+        IArchiveReader.Read(filePath.substr(filePath.find_last_of('/') + 1), file.Data(), file.Size(),
+            [&](const std::string& memberPath, const uint8_t* data, size_t size) {
+                ScanBuffer(engine, filePath, memberPath, data, size);
+            });
+        if (!IArchiveReader.GetLimitReason().empty()) {
+            std::cout << COLOR_YELLOW << "[+] Archive partially scanned (" << IArchiveReader.GetLimitReason() << ") : " << filePath << COLOR_RESET << "\n";
+        }
+    }
+    // 잘린 뒤쪽은 0으로 검사되었으므로 결과는 잘리기 전 남은 내용에 대한 것
+    if (file.WasTruncated()) {
+        std::cout << COLOR_YELLOW << "[+] File truncated during scan, only the remaining content was checked : " << filePath << COLOR_RESET << "\n";
+    }
+
+    auto elapsed = std::chrono::steady_clock::now() - fileStart;
+    m_profiler.RecordFile(filePath, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), file.Size());
+    return nResult;
+}
+
+// 파일 또는 압축 파일 멤버 하나를 선택한 엔진으로 검사하고 탐지 결과를 기록
+int CFileScanner::ScanBuffer(const ST_EngineSnapshot& engine, const std::string& filePath, const std::string& memberPath, const uint8_t* data, size_t size,
+                             const std::string* knownHash, const struct stat* fileStat) {
+    std::string strDisplayPath = memberPath.empty() ? filePath : filePath + ARCHIVE_PATH_SEPARATOR + memberPath;
+    std::string strDetectionCause;
+    int nResult;
+    if (m_nScanTypeOption == YARA_RULE) {
+        CScopedTimer timer(&m_profiler, PHASE_YARA, size);
+        // 압축 파일 멤버는 압축 파일을 디렉토리처럼 보고 경로를 이어 붙임 (소유자/실행 권한은 알 수 없음)
+        ST_YaraExternals externals = CYaraChecker::MakeExternals(memberPath.empty() ? filePath : filePath + "/" + memberPath,
+                                                                 memberPath.empty() ? fileStat : nullptr, data, size);
+        nResult = engine.YaraChecker->CheckYaraRule(strDisplayPath, data, size, m_vecDetectedMalware, strDetectionCause, &externals);
+    } else {
+        std::string strFileHash;
+        if (knownHash != nullptr) {
+            strFileHash = *knownHash;
+            nResult = SUCCESS_CODE;
+        } else {
+            CScopedTimer timer(&m_profiler, PHASE_HASH, size);
+            nResult = ComputeSHA256(data, size, strFileHash);
+        }
+        if (nResult != SUCCESS_CODE) {
+            return ERROR_CANNOT_COMPUTE_HASH;
+        }
+        nResult = engine.HashChecker->CompareByHash(strDisplayPath, strFileHash, m_vecDetectedMalware, strDetectionCause);
+    }
+
+    // 해시가 정확히 일치하지 않으면 내용이 메모리에 있는 동안 유사 해시를 계산하여 변종 여부 확인
+    std::string strFuzzyHash;
+    ST_FuzzyMatch fuzzyMatch = {"N/A", "N/A", 0};
+    if (m_nScanTypeOption == HASH_COMPARISON && strDetectionCause.empty() && engine.FuzzyChecker->GetHashCount() > 0) {
+        CScopedTimer timer(&m_profiler, PHASE_FUZZY, size);
+        CFuzzyHashChecker::ComputeFuzzyHash(data, size, strFuzzyHash);
+        nResult = engine.FuzzyChecker->CheckFuzzyHash(strDisplayPath, strFuzzyHash, m_vecDetectedMalware, fuzzyMatch);
+    }
+
+    // YARA 룰에 걸리지 않은 경우 바이트 시그니처로 한 번 더 검사
+    std::string strSignatureName;
+    if (m_nScanTypeOption == YARA_RULE && strDetectionCause.empty() && engine.SignatureChecker->GetSignatureCount() > 0) {
+        CScopedTimer timer(&m_profiler, PHASE_SIGNATURE, size);
+        nResult = engine.SignatureChecker->CheckSignatures(strDisplayPath, data, size, m_vecDetectedMalware, strSignatureName);
+    }
+
+    bool bFuzzyDetected = fuzzyMatch.Score > 0;
+    if(!strDetectionCause.empty() || !strSignatureName.empty() || bFuzzyDetected) {
+        ST_ScanData data = {
+        .DetectedFile = GetAbsolutePath(filePath),
+        .ArchiveMember = memberPath.empty() ? "N/A" : memberPath,
+        .ScanType = !strSignatureName.empty() ? "Signature" : bFuzzyDetected ? "Fuzzy" : m_nScanTypeOption == YARA_RULE ? "Yara" : "Hash",
+        .YaraRule = m_nScanTypeOption == YARA_RULE && strSignatureName.empty() ? strDetectionCause : "N/A",
+        .HashValue = bFuzzyDetected ? strFuzzyHash : m_nScanTypeOption == HASH_COMPARISON ? strDetectionCause : "N/A",
+        .SignatureName = strSignatureName.empty() ? "N/A" : strSignatureName,
+        .FuzzyMatch = fuzzyMatch.Name,
+        .SimilarityScore = fuzzyMatch.Score,
+        .FileSize = "",
+        .Timestamp = GetCurrentTimeWithMilliseconds(),
+        .IsMoved = false,
+        .PathAfterMoving = "N/A"
+        };
+        m_vecScanData.push_back(data);
+        if (m_pQuarantine) {
+            m_pQuarantine->Submit(data.DetectedFile, data.ScanType, GetDetectionCause(data));
+        }
+    }
+    return nResult;
+}
+
+// 단계별 소요 시간 출력 및 JSON 내보내기
+int CFileScanner::ReportProfile() {
+    m_profiler.Print();
+    if (!m_strProfilePath.empty()) {
+        int nResult = m_profiler.SaveJson(m_strProfilePath);
+        if (nResult != SUCCESS_CODE) {
+            PrintErrorMessage(nResult, m_strProfilePath);
+            return nResult;
+        }
+        std::cout << "\n[+] Scan profile saved to " << m_strProfilePath << "\n";
+    }
     return SUCCESS_CODE;
 }
 
+// 파일 유형 옵션에 따라 검사 대상 여부 판단
+bool CFileScanner::ShouldScanFile(FTSENT* node) {
+    if (m_nFileTypeOption == SPECIFIC_EXTENSION) {
+        if(m_strExtension.empty()) {
+            m_strExtension = DEFAULT_EXTENSION;
+        }
+        return IsExtension(node->fts_path, m_strExtension);
+    } else if (m_nFileTypeOption == ELF_FILES) {
+        return IsELFFile(node->fts_path);
+    }
+    return true;
+}
+
+// 격리 디렉토리와, 하위 디렉토리를 다른 샤드가 맡은 경로 아래의 디렉토리는 순회하지 않음
+bool CFileScanner::ShouldSkipDirectory(FTSENT* node, const std::string& destination) {
+    // fts_path는 순회 중 공유되는 버퍼이므로 상위 경로는 fts_pathlen만큼만 사용
+    if (node->fts_level == FTS_ROOTLEVEL + 1 && !m_setShallowPaths.empty()
+        && m_setShallowPaths.count(std::string(node->fts_parent->fts_path, node->fts_parent->fts_pathlen)) > 0) {
+        return true;
+    }
+    return GetAbsolutePath(node->fts_path) == destination;
+}
+
+// fts_open에 넘길 순회 시작 경로 목록 (샤드 작업자는 여러 경로를 한 번에 순회)
+std::vector<char*> CFileScanner::GetScanRoots() {
+    std::vector<char*> vecRoots;
+    if (m_vecShardPaths.empty()) {
+        vecRoots.push_back(const_cast<char *>(m_strScanTargetPath.c_str()));
+    }
+    for (const std::string& path : m_vecShardPaths) {
+        vecRoots.push_back(const_cast<char *>(path.c_str()));
+    }
+    vecRoots.push_back(nullptr);
+    return vecRoots;
+}
+
+// ETA 계산용 사전 집계, 파일 내용은 읽지 않으므로 ELF 옵션에서는 상한값이 됨
+void CFileScanner::CountScanTargets(uint64_t& totalFiles, uint64_t& totalBytes) {
+    totalFiles = 0;
+    totalBytes = 0;
+
+    std::vector<char*> vecRoots = GetScanRoots();
+    FTS *fileSystem = fts_open(vecRoots.data(), FTS_NOCHDIR | FTS_PHYSICAL, nullptr);
+    if (fileSystem == nullptr) {
+        return;
+    }
+
+    std::string strDestination = GetAbsolutePath(DESTINATION_PATH);
+    FTSENT *node;
+    while ((node = fts_read(fileSystem)) != nullptr && !m_bStopScanning) {
+        if (node->fts_info == FTS_D && ShouldSkipDirectory(node, strDestination)) {
+            fts_set(fileSystem, node, FTS_SKIP);
+        } else if (node->fts_info == FTS_F) {
+            if (m_nFileTypeOption == SPECIFIC_EXTENSION && !IsExtension(node->fts_path, m_strExtension.empty() ? DEFAULT_EXTENSION : m_strExtension)) {
+                continue;
+            }
+            totalFiles++;
+            totalBytes += node->fts_statp->st_size;
+            if (m_pProgress != nullptr) {
+                m_pProgress->fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+    fts_close(fileSystem);
+}
+
+// 우선 스캔용 메타데이터 순회, 전체 작업량 집계와 위험 점수가 기준 이상인 파일 목록을 한 번에 만듦
+void CFileScanner::CollectPriorityTargets(std::vector<ST_ScanCandidate>& candidates, uint64_t& totalFiles, uint64_t& totalBytes) {
+    totalFiles = 0;
+    totalBytes = 0;
+
+    std::vector<char*> vecRoots = GetScanRoots();
+    FTS *fileSystem = fts_open(vecRoots.data(), FTS_NOCHDIR | FTS_PHYSICAL, nullptr);
+    if (fileSystem == nullptr) {
+        return;
+    }
+
+    std::string strDestination = GetAbsolutePath(DESTINATION_PATH);
+    time_t now = time(nullptr);
+    FTSENT *node;
+    while ((node = fts_read(fileSystem)) != nullptr && !m_bStopScanning) {
+        if (node->fts_info == FTS_D && ShouldSkipDirectory(node, strDestination)) {
+            fts_set(fileSystem, node, FTS_SKIP);
+        } else if (node->fts_info == FTS_F && ShouldScanFile(node)) {
+            totalFiles++;
+            totalBytes += node->fts_statp->st_size;
+            if (m_pProgress != nullptr) {
+                m_pProgress->fetch_add(1, std::memory_order_relaxed);
+            }
+            const struct stat* pParentStat = node->fts_level > FTS_ROOTLEVEL ? node->fts_parent->fts_statp : nullptr;
+            int nScore = CScanPriority::ComputeScore(node->fts_path, *node->fts_statp, pParentStat, now);
+            if (nScore >= PRIORITY_MIN_SCORE) {
+                candidates.push_back({node->fts_path, static_cast<long long>(node->fts_statp->st_size),
+                                      std::max(node->fts_statp->st_mtime, node->fts_statp->st_ctime), nScore});
+            }
+        }
+    }
+    fts_close(fileSystem);
+    CScanPriority::SortCandidates(candidates);
+}
+
+// 스캔 요약을 기계가 읽을 수 있는 JSON 파일로 저장
+int CFileScanner::WriteSummary() {
+    Json::Value summary;
+    summary["timestamp"] = GetCurrentTimeWithMilliseconds();
+    summary["scan_path"] = GetAbsolutePath(m_strScanTargetPath);
+    if (!m_vecShardPaths.empty()) {
+        Json::Value shardPaths(Json::arrayValue);
+        for (const std::string& path : m_vecShardPaths) {
+            shardPaths.append(path);
+        }
+        summary["shard_paths"] = shardPaths;
+    }
+    summary["file_type_option"] = m_nFileTypeOption;
+    summary["scan_type"] = m_nScanTypeOption == YARA_RULE ? "Yara" : "Hash";
+    summary["interrupted"] = m_bStopScanning;
+    summary["files_scanned"] = Json::UInt64(m_nFileCount);
+    summary["bytes_scanned"] = Json::UInt64(m_llTotalSize);
+    summary["scan_time_sec"] = m_dScanTime;
+    summary["files_per_sec"] = m_dScanTime > 0 ? m_nFileCount / m_dScanTime : 0.0;
+    summary["mb_per_sec"] = m_dScanTime > 0 ? m_llTotalSize / m_dScanTime / (1024.0 * 1024.0) : 0.0;
+    summary["detection_count"] = Json::UInt64(m_vecScanData.size());
+    summary["prioritized"] = m_bPrioritize;
+    summary["monitor_hash_hits"] = Json::UInt64(m_ullDigestHits);
+    summary["time_to_first_detection_sec"] = m_dFirstDetectionTime >= 0 ? Json::Value(m_dFirstDetectionTime) : Json::Value();
+
+    Json::Value detections(Json::arrayValue);
+    for (const ST_ScanData& data : m_vecScanData) {
+        Json::Value entry;
+        entry["detected_file"] = data.DetectedFile;
+        entry["archive_member"] = data.ArchiveMember;
+        entry["scan_type"] = data.ScanType;
+        entry["yara_rule"] = data.YaraRule;
+        entry["hash_value"] = data.HashValue;
+        entry["signature_name"] = data.SignatureName;
+        entry["fuzzy_match"] = data.FuzzyMatch;
+        entry["similarity_score"] = data.SimilarityScore;
+        entry["timestamp"] = data.Timestamp;
+        entry["is_moved"] = data.IsMoved;
+        entry["path_after_moving"] = data.PathAfterMoving;
+        detections.append(entry);
+    }
+    summary["detections"] = detections;
+
+    std::ofstream summaryFile(m_strSummaryPath, std::ios::out | std::ios::trunc);
+    if (!summaryFile.is_open()) {
+        PrintErrorMessage(ERROR_CANNOT_OPEN_FILE, m_strSummaryPath);
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+    Json::StreamWriterBuilder writer;
+    summaryFile << Json::writeString(writer, summary) << "\n";
+    if (!summaryFile.good()) {
+        return ERROR_CANNOT_WRITE_FILE;
+    }
+    return SUCCESS_CODE;
+}
+
+// file_monitor.db의 files 테이블을 한 번에 읽어 색인 생성, 스캔 중에는 파일마다 쿼리하지 않음
+void CFileScanner::LoadMonitorDigests() {
+    m_mapMonitorDigests.clear();
+    if (CDatabaseManager::LoadFileDigests(DATABASE_NAME, m_mapMonitorDigests) != SUCCESS_CODE || m_mapMonitorDigests.empty()) {
+        return;
+    }
+    char szCwd[PATH_MAX];
+    m_strWorkingDirectory = getcwd(szCwd, sizeof(szCwd)) != nullptr ? szCwd : "";
+    std::cout << "[-] Loaded " << m_mapMonitorDigests.size() << " monitored file hashes from " << DATABASE_NAME << "\n";
+}
+
+// 스캔 경로를 모니터가 기록한 절대 경로 형식으로 바꿔 찾고, 크기/mtime/ctime이 기록 당시와 같을 때만 반환
+// 경로 정규화는 문자열 처리만 하므로 심볼릭 링크를 거친 경로는 색인에서 찾지 못하고 일반 검사로 처리됨
+const ST_FileDigest* CFileScanner::FindMonitorDigest(const std::string& filePath) {
+    std::string strPath = filePath;
+    if (strPath.empty() || strPath[0] != '/') {
+        while (strPath.compare(0, 2, "./") == 0) {
+            strPath.erase(0, 2);
+        }
+        strPath = m_strWorkingDirectory + "/" + strPath;
+    }
+    for (size_t siPos = strPath.find("//"); siPos != std::string::npos; siPos = strPath.find("//", siPos)) {
+        strPath.erase(siPos, 1);
+    }
+
+    auto it = m_mapMonitorDigests.find(strPath);
+    if (it == m_mapMonitorDigests.end() || it->second.IsArchive) {
+        return nullptr;
+    }
+    struct stat fileStat;
+    if (stat(filePath.c_str(), &fileStat) != 0 || fileStat.st_size != it->second.FileSize
+        || static_cast<int64_t>(fileStat.st_mtim.tv_sec) * 1000000000LL + fileStat.st_mtim.tv_nsec != it->second.MtimeNs
+        || static_cast<int64_t>(fileStat.st_ctim.tv_sec) * 1000000000LL + fileStat.st_ctim.tv_nsec != it->second.CtimeNs) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
 // 검사 결과 출력
 int CFileScanner::PrintScanResult() {
         
@@ -231,62 +775,96 @@ int CFileScanner::PrintScanResult() {
     }
     std::cout << "\n[+] Total Scan File : " << m_nFileCount << " files " << m_llTotalSize << " bytes\n";
     std::cout << "\n[+] File scan time :  " << std::fixed << std::setprecision(3) << m_dScanTime << " sec\n";
+    if (m_ullDigestHits > 0) {
+        std::cout << "\n[+] Hashes reused from " << DATABASE_NAME << " : " << m_ullDigestHits << " files\n";
+    }
+    if (m_dFirstDetectionTime >= 0) {
+        std::cout << "\n[+] Time to first detection :  " << std::fixed << std::setprecision(3) << m_dFirstDetectionTime << " sec\n";
+    }
 
     return SUCCESS_CODE;
 }
 
 // 악성파일로 탐지된 파일들 특정 디렉토리로 이동
 int CFileScanner::MoveDetectedMalware() {
-    if (!m_vecDetectedMalware.empty()) {
-        std::cout << "\nWould you like to move all detected malware files? (Y/n): ";
+    if (!m_vecDetectedMalware.empty() && !m_pQuarantine) {
         std::string input;
-        getline(std::cin, input);
+        if (m_bHeadless) {
+            // 헤드리스 모드는 --quarantine 옵션이 있을 때만 이동
+            input = m_bAutoQuarantine ? "y" : "n";
+        } else {
+            std::cout << "\nWould you like to move all detected malware files? (Y/n): ";
+            getline(std::cin, input);
+        }
 
         if (input == "y" || input.empty()) { // 기본값으로 엔터 입력을 y로 처리
-            // 이동할 디렉토리 설정
-            if (!IsDirectory(DESTINATION_PATH)) {
-                if (mkdir(DESTINATION_PATH, 0700) != 0) {  // 관리자만 접근 가능
-                    return ERROR_CANNOT_OPEN_DIRECTORY;
-                }
+            m_pQuarantine.reset(new CQuarantineQueue(DESTINATION_PATH));
+            if (m_pQuarantine->Start() != SUCCESS_CODE) {
+                m_pQuarantine.reset();
+                return ERROR_CANNOT_OPEN_DIRECTORY;
             }
+        }
+    }
+    if (!m_pQuarantine) {
+        return SUCCESS_CODE;
+    }
 
-            // 발견된 모든 악성 파일을 이동
-            for(ST_ScanData& data : m_vecScanData) {
-                int nResult = MoveFile(data, DESTINATION_PATH);
-                if(nResult != SUCCESS_CODE) {
-                    PrintErrorMessage(nResult);
-                }
-            }
+    // 재개한 스캔에서 이전 실행 때 탐지되었지만 아직 옮기지 않은 파일도 함께 격리
+    for (const ST_ScanData& data : m_vecScanData) {
+        if (!data.IsMoved) {
+            m_pQuarantine->Submit(data.DetectedFile, data.ScanType, GetDetectionCause(data));
         }
     }
+    CollectQuarantineResults();
     return SUCCESS_CODE;
 }
 
-// 특정 파일을 이동시키고 로그에 기록
-int CFileScanner::MoveFile(ST_ScanData& data, const std::string& destinationDir) {
-    try {
-        std::string strFileName = data.DetectedFile.substr(data.DetectedFile.find_last_of("/") + 1);
-        std::string strDestination = destinationDir + "/" + strFileName;
+// 보관소 인덱스에 남길 탐지 원인, 압축 파일 멤버에서 탐지된 경우 멤버 경로를 함께 기록
+std::string CFileScanner::GetDetectionCause(const ST_ScanData& data) {
+    std::string strCause = data.SignatureName != "N/A" ? data.SignatureName
+                         : data.FuzzyMatch != "N/A" ? data.FuzzyMatch + " (similarity " + std::to_string(data.SimilarityScore) + ")"
+                         : data.YaraRule != "N/A" ? data.YaraRule : data.HashValue;
+    if (data.ArchiveMember != "N/A") {
+        strCause += " in " + data.ArchiveMember;
+    }
+    return strCause;
+}
 
-        // 파일 이동
-        if (rename(data.DetectedFile.c_str(), strDestination.c_str()) != 0) {
-            return ERROR_CANNOT_MOVE_FILE;
+// 격리 작업이 끝나기를 기다린 뒤 결과를 탐지 목록에 반영, 한 압축 파일의 여러 멤버는 같은 격리 경로를 가짐
+void CFileScanner::CollectQuarantineResults() {
+    if (!m_pQuarantine) {
+        return;
+    }
+    auto waitStart = std::chrono::steady_clock::now();
+    m_pQuarantine->Finish();
+    double dWaitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - waitStart).count();
+
+    std::map<std::string, bool> mapReported;
+    for (ST_ScanData& data : m_vecScanData) {
+        ST_QuarantineResult result;
+        if (data.IsMoved || !m_pQuarantine->GetResult(data.DetectedFile, result)) {
+            continue;
         }
-
-        // 파일 읽기 전용 권한만 부여
-        if (chmod(strDestination.c_str(), S_IRUSR) != 0) {
-            return ERROR_CANNOT_CHANGE_PERMISSIONS;
+        bool bFirst = mapReported.emplace(data.DetectedFile, true).second;
+        if (result.Result != SUCCESS_CODE) {
+            if (bFirst) {
+                PrintErrorMessage(result.Result, data.DetectedFile);
+            }
+            continue;
         }
-
-        std::cout << COLOR_GREEN << "[+] Moved: " << data.DetectedFile << " -> " << GetAbsolutePath(strDestination) << COLOR_RESET << "\n";
         data.IsMoved = true;
-        data.PathAfterMoving = GetAbsolutePath(strDestination);
-
-        return SUCCESS_CODE;
-    } catch (const std::exception& e) {
-        PrintError("Exception occurred while moving file: " + std::string(e.what()));
-        return ERROR_UNKNOWN;
+        data.PathAfterMoving = result.Destination;
+        if (bFirst) {
+            std::cout << COLOR_GREEN << "[+] Moved: " << data.DetectedFile << " -> " << result.Destination;
+            if (result.VaultId > 0) {
+                std::cout << " (vault id " << result.VaultId << ")";
+            }
+            std::cout << COLOR_RESET << "\n";
+        }
     }
+    m_pQuarantine->PrintStatistics(dWaitMs);
+    m_profiler.Merge(m_pQuarantine->GetProfiler());
+    m_pQuarantine.reset();
 }
 
 // 파일 이벤트를 날짜별로 로그에 기록
@@ -296,8 +874,12 @@ void CFileScanner::LogResult(ST_ScanData& data) {
     logEntry["timestamp"] = data.Timestamp;
     logEntry["scan_type"] = data.ScanType;
     logEntry["detected_file"] = data.DetectedFile;
+    logEntry["archive_member"] = data.ArchiveMember;
     logEntry["hash_value"] = data.HashValue;
     logEntry["yara_rule"] = data.YaraRule;
+    logEntry["signature_name"] = data.SignatureName;
+    logEntry["fuzzy_match"] = data.FuzzyMatch;
+    logEntry["similarity_score"] = data.SimilarityScore;
     logEntry["is_moved"] = data.IsMoved ? "True" : "False";
     logEntry["path_after_moving"] = data.PathAfterMoving;
 
@@ -309,5 +891,5 @@ void CFileScanner::LogResult(ST_ScanData& data) {
     } else {
         logEntry["file_size"] = "N/A";
     }
-    SaveLogInJson(logEntry, LOG_FILE_PATH);
+    CJsonLogWriter::Instance().Append(logEntry, LOG_FILE_PATH);
 }
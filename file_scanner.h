@@ -1,7 +1,18 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <fts.h>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
+#include "database_manager.h"
+#include "engine_manager.h"
+#include "quarantine_queue.h"
+#include "scan_priority.h"
+#include "scan_profiler.h"
 #include "util.h"
 
 #define ALL_FILES 1
@@ -21,15 +32,37 @@
 
 struct ST_ScanData {
     std::string DetectedFile;
+    std::string ArchiveMember;   // 압축 파일 내부에서 탐지된 경우 멤버 경로 (중첩 시 '!'로 연결), 아니면 "N/A"
     std::string ScanType;
     std::string YaraRule;
     std::string HashValue;
+    std::string SignatureName;   // 바이트 시그니처(signatures.ndb)로 탐지된 경우 시그니처 이름, 아니면 "N/A"
+    std::string FuzzyMatch;      // 유사 해시로 탐지된 경우 가장 비슷한 알려진 악성 파일 이름, 아니면 "N/A" (HashValue에는 파일의 CTPH 해시)
+    int SimilarityScore;         // 유사 해시 점수 (0~100, 유사 해시 탐지가 아니면 0)
     std::string FileSize;
     std::string Timestamp;
     bool IsMoved;
     std::string PathAfterMoving;
 };
 
+// 커맨드라인으로 지정하는 비대화형(헤드리스) 스캔 옵션
+struct ST_ScanOptions {
+    bool Headless = false;
+    std::string TargetPath = DEFAULT_PATH;
+    int FileTypeOption = ALL_FILES;
+    std::string Extension;
+    int ScanTypeOption = YARA_RULE;
+    std::string SummaryPath;     // 비어있지 않으면 스캔 요약을 JSON으로 저장
+    bool AutoQuarantine = false; // 헤드리스 모드에서 탐지 파일을 묻지 않고 이동
+    bool Resume = false;         // 마지막 체크포인트부터 스캔 재개
+    std::string ProfilePath;     // 비어있지 않으면 단계별 소요 시간을 JSON으로 저장
+    bool Prioritize = false;     // 최근 변경/실행 파일 등 위험 점수가 높은 파일을 먼저 스캔
+    std::vector<std::string> ShardPaths;   // 비어있지 않으면 TargetPath 대신 이 경로들을 한 번에 순회 (샤드 작업자)
+    std::vector<std::string> ShallowPaths; // ShardPaths 중 하위 디렉토리는 다른 샤드가 맡아 바로 아래 파일만 검사하는 경로
+    bool Checkpoint = true;                // 샤드 작업자는 중단 시 코디네이터가 샤드를 다시 배정하므로 체크포인트를 남기지 않음
+    std::atomic<uint64_t>* Progress = nullptr; // 있으면 파일 하나를 집계하거나 검사할 때마다 증가 (샤드 작업자의 하트비트용)
+};
+
 class CFileScanner {
 public:
     static bool m_bStopScanning;
@@ -37,6 +70,7 @@ public:
     CFileScanner();
     int StartScan();
     int StartIniScan();
+    void SetOptions(const ST_ScanOptions& options);
 
 private:
     std::vector<std::string> m_vecDetectedMalware; // 악성파일로 판별된 파일의 경로를 저장
@@ -48,11 +82,45 @@ private:
     double m_dScanTime;
     std::string m_strExtension;
     std::vector<ST_ScanData> m_vecScanData;
+    bool m_bHeadless;
+    bool m_bAutoQuarantine;
+    std::string m_strSummaryPath;
+    bool m_bResume;
+    std::string m_strResumeAfter; // 재개 시 이 경로까지는 이미 처리됨
+    double m_dPreviousScanTime;
+    std::string m_strProfilePath;
+    CScanProfiler m_profiler;
+    std::unique_ptr<CQuarantineQueue> m_pQuarantine; // 헤드리스 + --quarantine이면 스캔 중 탐지 즉시 격리
+    bool m_bPrioritize;
+    std::unordered_set<std::string> m_setPriorityScanned; // 우선 스캔에서 이미 검사하여 일반 순회에서 건너뛸 파일
+    double m_dFirstDetectionTime; // 스캔 시작부터 첫 탐지까지 걸린 시간(초), 탐지가 없으면 음수
+    std::vector<std::string> m_vecShardPaths;
+    std::unordered_set<std::string> m_setShallowPaths;
+    bool m_bCheckpoint;
+    std::unordered_map<std::string, ST_FileDigest> m_mapMonitorDigests; // 해시 모드에서 file_monitor.db의 해시를 절대 경로로 색인
+    std::string m_strWorkingDirectory;  // 상대 경로를 색인 키(절대 경로)로 바꿀 때 사용
+    uint64_t m_ullDigestHits;           // 파일을 읽지 않고 기록된 해시로 판정한 파일 수
+    std::atomic<uint64_t>* m_pProgress; // ST_ScanOptions::Progress
 
     int PerformFileScan();
     int ScanDirectory();
+    bool ShouldScanFile(FTSENT* node);
+    bool ShouldSkipDirectory(FTSENT* node, const std::string& destination);
+    std::vector<char*> GetScanRoots();
+    int ScanFile(const std::string& filePath, const ST_EngineSnapshot& engine);
+    int ScanBuffer(const ST_EngineSnapshot& engine, const std::string& filePath, const std::string& memberPath, const uint8_t* data, size_t size,
+                   const std::string* knownHash = nullptr, const struct stat* fileStat = nullptr);
+    void LoadMonitorDigests();
+    const ST_FileDigest* FindMonitorDigest(const std::string& filePath);
+    int ReportProfile();
+    void CountScanTargets(uint64_t& totalFiles, uint64_t& totalBytes);
+    void CollectPriorityTargets(std::vector<ST_ScanCandidate>& candidates, uint64_t& totalFiles, uint64_t& totalBytes);
     int MoveDetectedMalware();
-    int MoveFile(ST_ScanData& data, const std::string& quarantineDir);
+    void CollectQuarantineResults();
+    static std::string GetDetectionCause(const ST_ScanData& data);
     int PrintScanResult();
     void LogResult(ST_ScanData& data);
+    int WriteSummary();
+    int RestoreCheckpoint();
+    int SaveCheckpoint(const std::string& lastPath, double elapsedTime);
 };
\ No newline at end of file
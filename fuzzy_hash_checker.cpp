@@ -0,0 +1,353 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include "ansi_color.h"
+#include "fuzzy_hash_checker.h"
+#include "util.h"
+
+#define FUZZY_HASH_PRIME 0x01000193
+#define FUZZY_HASH_INIT 0x28021967
+
+static const char* g_szBase64 = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+namespace {
+
+// 최근 7바이트에 대한 롤링 해시, 값이 블록 크기의 배수 - 1이 되는 위치에서 조각을 나눔
+struct ST_RollingState {
+    uint8_t Window[FUZZY_ROLLING_WINDOW];
+    uint32_t H1, H2, H3, N;
+
+    uint32_t Update(uint8_t c) {
+        H2 -= H1;
+        H2 += FUZZY_ROLLING_WINDOW * static_cast<uint32_t>(c);
+        H1 += c;
+        H1 -= Window[N % FUZZY_ROLLING_WINDOW];
+        Window[N % FUZZY_ROLLING_WINDOW] = c;
+        N++;
+        H3 = (H3 << 5) ^ c;
+        return H1 + H2 + H3;
+    }
+};
+
+uint32_t HashGram(const char* gram, uint32_t blockSize) {
+    uint32_t ulHash = (2166136261u ^ blockSize) * 16777619u;
+    for (int i = 0; i < FUZZY_ROLLING_WINDOW; i++) {
+        ulHash = (ulHash ^ static_cast<uint8_t>(gram[i])) * 16777619u;
+    }
+    return ulHash;
+}
+
+// 삽입/삭제 1, 치환 2의 가중 편집 거리 (서명은 최대 64자)
+int EditDistance(std::string_view lhs, std::string_view rhs) {
+    std::vector<int> vecPrevious(rhs.size() + 1);
+    std::vector<int> vecCurrent(rhs.size() + 1);
+    for (size_t j = 0; j <= rhs.size(); j++) {
+        vecPrevious[j] = static_cast<int>(j);
+    }
+    for (size_t i = 1; i <= lhs.size(); i++) {
+        vecCurrent[0] = static_cast<int>(i);
+        for (size_t j = 1; j <= rhs.size(); j++) {
+            int nReplace = vecPrevious[j - 1] + (lhs[i - 1] == rhs[j - 1] ? 0 : 2);
+            vecCurrent[j] = std::min({vecPrevious[j] + 1, vecCurrent[j - 1] + 1, nReplace});
+        }
+        std::swap(vecPrevious, vecCurrent);
+    }
+    return vecPrevious[rhs.size()];
+}
+
+bool HasCommonSubstring(std::string_view lhs, std::string_view rhs) {
+    if (lhs.size() < FUZZY_ROLLING_WINDOW || rhs.size() < FUZZY_ROLLING_WINDOW) {
+        return false;
+    }
+    for (size_t i = 0; i + FUZZY_ROLLING_WINDOW <= lhs.size(); i++) {
+        if (rhs.find(lhs.substr(i, FUZZY_ROLLING_WINDOW)) != std::string_view::npos) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+// 파일 내용으로 "blocksize:sig1:sig2" 형식의 CTPH 해시 생성 (ssdeep과 같은 형식)
+// 첫 번째 서명이 너무 짧으면 블록 크기를 절반으로 줄여 다시 계산
+int CFuzzyHashChecker::ComputeFuzzyHash(const uint8_t* data, size_t size, std::string& fuzzyHash) {
+    uint32_t ulBlockSize = FUZZY_MIN_BLOCKSIZE;
+    while (static_cast<uint64_t>(ulBlockSize) * FUZZY_SPAMSUM_LENGTH < size) {
+        ulBlockSize *= 2;
+    }
+
+    char szSignature1[FUZZY_SPAMSUM_LENGTH + 1];
+    char szSignature2[FUZZY_SPAMSUM_LENGTH / 2 + 1];
+    size_t j, k;
+    while (true) {
+        ST_RollingState roll = {};
+        uint32_t ulSum1 = FUZZY_HASH_INIT;
+        uint32_t ulSum2 = FUZZY_HASH_INIT;
+        uint32_t ulHash = 0;
+        j = k = 0;
+        for (size_t i = 0; i < size; i++) {
+            uint8_t c = data[i];
+            ulHash = roll.Update(c);
+            ulSum1 = (ulSum1 * FUZZY_HASH_PRIME) ^ c;
+            ulSum2 = (ulSum2 * FUZZY_HASH_PRIME) ^ c;
+            if (ulHash % ulBlockSize == ulBlockSize - 1) {
+                szSignature1[j] = g_szBase64[ulSum1 % 64];
+                if (j < FUZZY_SPAMSUM_LENGTH - 1) {
+                    ulSum1 = FUZZY_HASH_INIT;
+                    j++;
+                }
+            }
+            if (ulHash % (ulBlockSize * 2) == ulBlockSize * 2 - 1) {
+                szSignature2[k] = g_szBase64[ulSum2 % 64];
+                if (k < FUZZY_SPAMSUM_LENGTH / 2 - 1) {
+                    ulSum2 = FUZZY_HASH_INIT;
+                    k++;
+                }
+            }
+        }
+        if (ulHash != 0) {
+            szSignature1[j++] = g_szBase64[ulSum1 % 64];
+            szSignature2[k++] = g_szBase64[ulSum2 % 64];
+        }
+        if (ulBlockSize > FUZZY_MIN_BLOCKSIZE && j < FUZZY_SPAMSUM_LENGTH / 2) {
+            ulBlockSize /= 2;
+            continue;
+        }
+        break;
+    }
+
+    fuzzyHash = std::to_string(ulBlockSize) + ":" + std::string(szSignature1, j) + ":" + std::string(szSignature2, k);
+    return SUCCESS_CODE;
+}
+
+bool CFuzzyHashChecker::Parse(const std::string& text, ST_FuzzyHash& hash) {
+    size_t siFirst = text.find(':');
+    size_t siSecond = siFirst == std::string::npos ? std::string::npos : text.find(':', siFirst + 1);
+    if (siSecond == std::string::npos || siFirst == 0) {
+        return false;
+    }
+    char* end = nullptr;
+    unsigned long ulBlockSize = strtoul(text.c_str(), &end, 10);
+    if (end != text.c_str() + siFirst || ulBlockSize < FUZZY_MIN_BLOCKSIZE) {
+        return false;
+    }
+    hash.BlockSize = static_cast<uint32_t>(ulBlockSize);
+    hash.Signature1 = EliminateSequences(text.substr(siFirst + 1, siSecond - siFirst - 1));
+    hash.Signature2 = EliminateSequences(text.substr(siSecond + 1));
+    return true;
+}
+
+// 같은 문자가 4번 이상 이어지면 3개로 줄임 (반복 구조가 점수를 부풀리지 않도록)
+std::string CFuzzyHashChecker::EliminateSequences(const std::string& signature) {
+    std::string strResult;
+    for (size_t i = 0; i < signature.size(); i++) {
+        if (i < 3 || signature[i] != signature[i - 1] || signature[i] != signature[i - 2] || signature[i] != signature[i - 3]) {
+            strResult += signature[i];
+        }
+    }
+    return strResult;
+}
+
+void CFuzzyHashChecker::CollectGramKeys(const std::string& signature, uint32_t blockSize, std::vector<uint32_t>& keys) {
+    for (size_t i = 0; i + FUZZY_ROLLING_WINDOW <= signature.size(); i++) {
+        keys.push_back(HashGram(signature.c_str() + i, blockSize));
+    }
+}
+
+int CFuzzyHashChecker::ScoreStrings(std::string_view lhs, std::string_view rhs, uint32_t blockSize) {
+    if (!HasCommonSubstring(lhs, rhs)) {
+        return 0;
+    }
+    int nScore = EditDistance(lhs, rhs);
+    nScore = nScore * FUZZY_SPAMSUM_LENGTH / static_cast<int>(lhs.size() + rhs.size());
+    nScore = 100 * nScore / FUZZY_SPAMSUM_LENGTH;
+    if (nScore >= 100) {
+        return 0;
+    }
+    nScore = 100 - nScore;
+    // 블록 크기가 작으면 짧은 서명끼리의 우연한 일치가 많으므로 점수 상한을 둠
+    if (blockSize < (99 + FUZZY_ROLLING_WINDOW) / FUZZY_ROLLING_WINDOW * FUZZY_MIN_BLOCKSIZE) {
+        int nCap = static_cast<int>(blockSize / FUZZY_MIN_BLOCKSIZE * std::min(lhs.size(), rhs.size()));
+        nScore = std::min(nScore, nCap);
+    }
+    return nScore;
+}
+
+int CFuzzyHashChecker::CompareParsed(const ST_FuzzyView& lhs, const ST_FuzzyView& rhs) {
+    if (lhs.BlockSize == rhs.BlockSize) {
+        if (lhs.Signature1 == rhs.Signature1) {
+            return 100;
+        }
+        return std::max(ScoreStrings(lhs.Signature1, rhs.Signature1, lhs.BlockSize),
+                        ScoreStrings(lhs.Signature2, rhs.Signature2, lhs.BlockSize * 2));
+    }
+    if (lhs.BlockSize == rhs.BlockSize * 2) {
+        return ScoreStrings(lhs.Signature1, rhs.Signature2, lhs.BlockSize);
+    }
+    if (rhs.BlockSize == lhs.BlockSize * 2) {
+        return ScoreStrings(lhs.Signature2, rhs.Signature1, rhs.BlockSize);
+    }
+    return 0;
+}
+
+// 두 CTPH 해시의 유사도 (0~100)
+int CFuzzyHashChecker::Compare(const std::string& lhs, const std::string& rhs) {
+    ST_FuzzyHash lhsHash, rhsHash;
+    if (!Parse(lhs, lhsHash) || !Parse(rhs, rhsHash)) {
+        return 0;
+    }
+    return CompareParsed(View(lhsHash), View(rhsHash));
+}
+
+CFuzzyHashChecker::ST_FuzzyView CFuzzyHashChecker::View(const ST_FuzzyEntry& entry) const {
+    std::string_view signatures(m_strSignatures);
+    return {entry.BlockSize, signatures.substr(entry.Offset, entry.Length1), signatures.substr(entry.Offset + entry.Length1, entry.Length2)};
+}
+
+// 저장된 (반복 문자를 줄인) 서명으로 "blocksize:sig1:sig2"를 다시 만듦, 탐지 결과를 보고할 때만 사용
+std::string CFuzzyHashChecker::FormatHash(const ST_FuzzyEntry& entry) const {
+    ST_FuzzyView view = View(entry);
+    return std::to_string(entry.BlockSize) + ":" + std::string(view.Signature1) + ":" + std::string(view.Signature2);
+}
+
+// fuzzy_hashes.txt (ssdeep 출력 형식 "hash,\"name\"" 또는 해시만 있는 줄)를 읽어 n-gram 색인 생성
+int CFuzzyHashChecker::LoadHashes(const std::string& fileName) {
+    std::ifstream file(fileName);
+    if (!file.is_open()) {
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+    std::string strLine;
+    std::vector<uint32_t> vecKeys;
+    while (std::getline(file, strLine)) {
+        strLine = Trim(strLine);
+        if (strLine.empty() || strLine[0] == '#' || strLine.compare(0, 7, "ssdeep,") == 0) {
+            continue;
+        }
+        size_t siComma = strLine.find(',');
+        ST_FuzzyHash hash;
+        if (!Parse(strLine.substr(0, siComma), hash) || hash.Signature1.size() > FUZZY_SPAMSUM_LENGTH || hash.Signature2.size() > FUZZY_SPAMSUM_LENGTH) {
+            continue;
+        }
+        std::string strName = siComma == std::string::npos ? "" : strLine.substr(siComma + 1);
+        if (strName.size() >= 2 && strName.front() == '"' && strName.back() == '"') {
+            strName = strName.substr(1, strName.size() - 2);
+        }
+        strName.resize(std::min<size_t>(strName.size(), FUZZY_MAX_NAME_LENGTH));
+        if (m_strSignatures.size() + hash.Signature1.size() + hash.Signature2.size() + strName.size() > UINT32_MAX) {
+            PrintError("Too many fuzzy hashes in " + fileName + ", the rest are ignored.");
+            break;
+        }
+        ST_FuzzyEntry entry = {hash.BlockSize, static_cast<uint32_t>(m_strSignatures.size()), static_cast<uint8_t>(hash.Signature1.size()),
+                               static_cast<uint8_t>(hash.Signature2.size()), static_cast<uint16_t>(strName.size())};
+        m_strSignatures += hash.Signature1;
+        m_strSignatures += hash.Signature2;
+        m_strSignatures += strName;
+
+        vecKeys.clear();
+        CollectGramKeys(hash.Signature1, hash.BlockSize, vecKeys);
+        CollectGramKeys(hash.Signature2, hash.BlockSize * 2, vecKeys);
+        std::sort(vecKeys.begin(), vecKeys.end());
+        vecKeys.erase(std::unique(vecKeys.begin(), vecKeys.end()), vecKeys.end());
+        uint32_t ulEntry = static_cast<uint32_t>(m_vecEntries.size());
+        for (uint32_t ulKey : vecKeys) {
+            m_vecGrams.push_back({ulKey, ulEntry});
+        }
+        m_vecEntries.push_back(std::move(entry));
+    }
+    file.close();
+
+    std::sort(m_vecGrams.begin(), m_vecGrams.end(), [](const ST_FuzzyGram& lhs, const ST_FuzzyGram& rhs) {
+        return lhs.Key < rhs.Key || (lhs.Key == rhs.Key && lhs.Entry < rhs.Entry);
+    });
+    m_vecGrams.shrink_to_fit();
+    m_vecEntries.shrink_to_fit();
+    m_strSignatures.shrink_to_fit();
+    return SUCCESS_CODE;
+}
+
+// 공통 7-gram이 있는 후보만 채점하여 가장 유사한 알려진 해시를 찾음, 임계값 이상이면 true
+bool CFuzzyHashChecker::FindBestMatch(const std::string& fuzzyHash, ST_FuzzyMatch& match) const {
+    ST_FuzzyHash query;
+    if (m_vecGrams.empty() || !Parse(fuzzyHash, query)) {
+        return false;
+    }
+    std::vector<uint32_t> vecKeys;
+    CollectGramKeys(query.Signature1, query.BlockSize, vecKeys);
+    CollectGramKeys(query.Signature2, query.BlockSize * 2, vecKeys);
+    std::sort(vecKeys.begin(), vecKeys.end());
+    vecKeys.erase(std::unique(vecKeys.begin(), vecKeys.end()), vecKeys.end());
+
+    std::vector<uint32_t> vecCandidates;
+    auto compareKey = [](const ST_FuzzyGram& gram, uint32_t key) { return gram.Key < key; };
+    auto compareGram = [](uint32_t key, const ST_FuzzyGram& gram) { return key < gram.Key; };
+    std::vector<ST_FuzzyGram>::const_iterator cappedFirst = m_vecGrams.end();
+    std::vector<ST_FuzzyGram>::const_iterator cappedLast = m_vecGrams.end();
+    for (uint32_t ulKey : vecKeys) {
+        auto first = std::lower_bound(m_vecGrams.begin(), m_vecGrams.end(), ulKey, compareKey);
+        auto last = first;
+        while (last != m_vecGrams.end() && last->Key == ulKey && last - first <= FUZZY_MAX_POSTING) {
+            ++last;
+        }
+        if (last - first > FUZZY_MAX_POSTING) {
+            // 흔한 n-gram은 건너뛰되, 대체 후보로 쓰기 위해 가장 짧은 목록을 기억
+            last = std::upper_bound(last, m_vecGrams.end(), ulKey, compareGram);
+            if (cappedFirst == m_vecGrams.end() || last - first < cappedLast - cappedFirst) {
+                cappedFirst = first;
+                cappedLast = last;
+            }
+            continue;
+        }
+        for (auto it = first; it != last; ++it) {
+            vecCandidates.push_back(it->Entry);
+        }
+    }
+    // 질의의 n-gram이 모두 흔한 것뿐이면 (패딩이 많은 파일 등) 후보가 없어 변종을 놓치므로
+    // 가장 짧은 목록에서 고르게 뽑은 항목을 채점 (목록이 짧으면 전부)
+    if (vecCandidates.empty() && cappedFirst != m_vecGrams.end()) {
+        size_t siPosting = static_cast<size_t>(cappedLast - cappedFirst);
+        size_t siTake = std::min<size_t>(siPosting, FUZZY_FALLBACK_CANDIDATES);
+        for (size_t i = 0; i < siTake; i++) {
+            vecCandidates.push_back(cappedFirst[i * siPosting / siTake].Entry);
+        }
+    }
+    std::sort(vecCandidates.begin(), vecCandidates.end());
+    vecCandidates.erase(std::unique(vecCandidates.begin(), vecCandidates.end()), vecCandidates.end());
+
+    ST_FuzzyView queryView = View(query);
+    int nBestScore = 0;
+    const ST_FuzzyEntry* pBest = nullptr;
+    for (uint32_t ulEntry : vecCandidates) {
+        int nScore = CompareParsed(queryView, View(m_vecEntries[ulEntry]));
+        if (nScore > nBestScore) {
+            nBestScore = nScore;
+            pBest = &m_vecEntries[ulEntry];
+        }
+    }
+    if (!pBest || nBestScore < FUZZY_MATCH_THRESHOLD) {
+        return false;
+    }
+    std::string strKnownHash = FormatHash(*pBest);
+    std::string strName = pBest->NameLength == 0 ? strKnownHash : m_strSignatures.substr(pBest->Offset + pBest->Length1 + pBest->Length2, pBest->NameLength);
+    match = {strName, strKnownHash, nBestScore};
+    return true;
+}
+
+// 스캔 단계에서 계산한 CTPH 해시를 알려진 악성 해시들과 비교
+int CFuzzyHashChecker::CheckFuzzyHash(const std::string& filePath, const std::string& fuzzyHash, std::vector<std::string>& detectedMalware,
+                                      ST_FuzzyMatch& match) const {
+    if (!FindBestMatch(fuzzyHash, match)) {
+        return SUCCESS_CODE;
+    }
+    if (std::find(detectedMalware.begin(), detectedMalware.end(), filePath) == detectedMalware.end()) {
+        detectedMalware.push_back(filePath);
+        std::cout << "\n" << COLOR_RED << "[+] Malware variant detected: [" << filePath << "]" << COLOR_RESET << "\n";
+        std::cout << COLOR_RED << "[+] Similar to: [" << match.Name << "] (score " << match.Score << ")" << COLOR_RESET << "\n\n";
+    }
+    return SUCCESS_CODE;
+}
+
+// 항목 배열 + 서명/이름 저장소 + 색인 배열이 차지하는 메모리
+size_t CFuzzyHashChecker::GetMemoryUsage() const {
+    return m_vecGrams.capacity() * sizeof(ST_FuzzyGram) + m_vecEntries.capacity() * sizeof(ST_FuzzyEntry) + m_strSignatures.capacity();
+}
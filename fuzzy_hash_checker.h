@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#define FUZZY_HASH_LIST_PATH "fuzzy_hashes.txt"
+#define FUZZY_MATCH_THRESHOLD 60          // 이 이상의 유사도(0~100)면 변종으로 탐지
+#define FUZZY_SPAMSUM_LENGTH 64           // 첫 번째 서명의 최대 길이 (두 번째는 절반)
+#define FUZZY_MIN_BLOCKSIZE 3
+#define FUZZY_ROLLING_WINDOW 7            // 롤링 해시 창 크기이자 후보 색인의 n-gram 길이
+#define FUZZY_MAX_POSTING 4096            // 이보다 많은 해시가 공유하는 n-gram은 후보 선정에 쓰지 않음
+#define FUZZY_FALLBACK_CANDIDATES 16384   // 질의의 n-gram이 모두 위 제한에 걸렸을 때 가장 짧은 목록에서 채점할 최대 후보 수
+#define FUZZY_MAX_NAME_LENGTH 65535
+
+// 파싱된 CTPH(ssdeep 형식) 해시 "blocksize:sig1:sig2"
+struct ST_FuzzyHash {
+    uint32_t BlockSize;
+    std::string Signature1;   // BlockSize 기준
+    std::string Signature2;   // BlockSize * 2 기준
+};
+
+struct ST_FuzzyMatch {
+    std::string Name;         // fuzzy_hashes.txt에 기록된 원본 이름 (없으면 해시 문자열)
+    std::string KnownHash;
+    int Score;
+};
+
+// 알려진 악성 파일의 CTPH 해시 목록에 대한 유사도 검색기
+// 두 해시가 0보다 큰 점수를 받으려면 같은 유효 블록 크기에서 7글자 공통 부분 문자열이 있어야 하므로,
+// (블록 크기, 7-gram) 키로 색인하여 공통 n-gram이 있는 후보만 편집 거리로 채점
+class CFuzzyHashChecker {
+public:
+    int LoadHashes(const std::string& fileName);
+    bool FindBestMatch(const std::string& fuzzyHash, ST_FuzzyMatch& match) const;
+    int CheckFuzzyHash(const std::string& filePath, const std::string& fuzzyHash, std::vector<std::string>& detectedMalware,
+                       ST_FuzzyMatch& match) const;
+    size_t GetHashCount() const { return m_vecEntries.size(); }
+    size_t GetMemoryUsage() const;
+
+    static int ComputeFuzzyHash(const uint8_t* data, size_t size, std::string& fuzzyHash);
+    static int Compare(const std::string& lhs, const std::string& rhs);
+
+private:
+    // 항목마다 문자열 객체를 두지 않고 파싱된 서명과 이름을 저장소 하나에 이어서 저장 (후보 채점 시 다시 파싱하지 않음)
+    struct ST_FuzzyEntry {
+        uint32_t BlockSize;
+        uint32_t Offset;      // m_strSignatures 안의 서명1, 서명2, 이름 시작 위치
+        uint8_t Length1;
+        uint8_t Length2;
+        uint16_t NameLength;  // 0이면 이름 없음 (해시 문자열로 표시)
+    };
+    // 파싱된 해시를 복사 없이 가리킴 (질의는 ST_FuzzyHash, 알려진 해시는 저장소)
+    struct ST_FuzzyView {
+        uint32_t BlockSize;
+        std::string_view Signature1;
+        std::string_view Signature2;
+    };
+    struct ST_FuzzyGram {
+        uint32_t Key;         // 유효 블록 크기와 7-gram의 해시 (충돌은 후보가 늘어날 뿐 채점에서 걸러짐)
+        uint32_t Entry;
+    };
+
+    std::vector<ST_FuzzyEntry> m_vecEntries;
+    std::string m_strSignatures;
+    std::vector<ST_FuzzyGram> m_vecGrams;   // Key 순으로 정렬
+
+    static bool Parse(const std::string& text, ST_FuzzyHash& hash);
+    static std::string EliminateSequences(const std::string& signature);
+    static void CollectGramKeys(const std::string& signature, uint32_t blockSize, std::vector<uint32_t>& keys);
+    static int CompareParsed(const ST_FuzzyView& lhs, const ST_FuzzyView& rhs);
+    static int ScoreStrings(std::string_view lhs, std::string_view rhs, uint32_t blockSize);
+    static ST_FuzzyView View(const ST_FuzzyHash& hash) { return {hash.BlockSize, hash.Signature1, hash.Signature2}; }
+    ST_FuzzyView View(const ST_FuzzyEntry& entry) const;
+    std::string FormatHash(const ST_FuzzyEntry& entry) const;
+};
@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include "json_log_writer.h"
+#include "util.h"
+
+// 정적지역 변수 싱글톤 -> 프로그램 종료 시 소멸자에서 남은 로그를 모두 기록
+CJsonLogWriter& CJsonLogWriter::Instance() {
+    static CJsonLogWriter instance;
+    return instance;
+}
+
+CJsonLogWriter::CJsonLogWriter() : m_siPendingBytes(0), m_ullFailedRecords(0), m_bStop(false) {
+    m_flushThread = std::thread(&CJsonLogWriter::RunFlushLoop, this);
+}
+
+CJsonLogWriter::~CJsonLogWriter() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bStop = true;
+    }
+    m_cvFlush.notify_one();
+    if (m_flushThread.joinable()) {
+        m_flushThread.join();
+    }
+    Flush();
+    for (auto& entry : m_mapFiles) {
+        if (entry.second.Fd != -1) {
+            close(entry.second.Fd);
+        }
+    }
+}
+
+// 로그 한 줄을 직렬화해서 버퍼에 추가, 실제 디스크 기록은 flush 스레드가 담당
+int CJsonLogWriter::Append(const Json::Value& logEntry, const std::string& logFilePath) {
+    Json::StreamWriterBuilder writer;
+    writer["indentation"] = "";
+    std::string strLine = Json::writeString(writer, logEntry);
+    strLine += "\n";
+
+    bool bNeedFlush;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_mapFiles[logFilePath].Pending += strLine;
+        m_siPendingBytes += strLine.size();
+        bNeedFlush = m_siPendingBytes >= LOG_FLUSH_THRESHOLD;
+    }
+    if (bNeedFlush) {
+        m_cvFlush.notify_one();
+    }
+    return SUCCESS_CODE;
+}
+
+// 대기 중인 로그를 파일별로 한 번의 write + fdatasync로 기록
+int CJsonLogWriter::Flush() {
+    std::lock_guard<std::mutex> writeLock(m_writeMutex);
+
+    // 잠금 구간에서는 버퍼만 교체하고, 느린 I/O는 잠금 밖에서 수행
+    std::vector<std::pair<std::string, std::string>> vecBatches;
+    std::vector<std::pair<std::string, int>> vecFds;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = m_mapFiles.begin(); it != m_mapFiles.end();) {
+            if (it->second.Pending.empty()) {
+                // 한 주기 동안 기록이 없던 파일은 닫음 (날짜별 로그 파일 교체 대응)
+                if (it->second.Fd != -1) {
+                    close(it->second.Fd);
+                }
+                it = m_mapFiles.erase(it);
+                continue;
+            }
+            vecBatches.emplace_back(it->first, std::string());
+            vecBatches.back().second.swap(it->second.Pending);
+            vecFds.emplace_back(it->first, it->second.Fd);
+            ++it;
+        }
+        m_siPendingBytes = 0;
+    }
+
+    // 기록하지 못한 묶음은 버려지므로 로그 수를 세어 남김
+    auto countFailed = [this](int code, const std::string& path, const std::string& batch) {
+        uint64_t ullRecords = static_cast<uint64_t>(std::count(batch.begin(), batch.end(), '\n'));
+        uint64_t ullTotal = m_ullFailedRecords.fetch_add(ullRecords) + ullRecords;
+        PrintErrorMessage(code, path + " (" + std::to_string(ullRecords) + " log records lost, " + std::to_string(ullTotal) + " in total)");
+        return code;
+    };
+
+    int nResult = SUCCESS_CODE;
+    for (size_t i = 0; i < vecBatches.size(); ++i) {
+        const std::string& strPath = vecBatches[i].first;
+        int fd = vecFds[i].second;
+        if (fd == -1) {
+            fd = OpenLogFile(strPath);
+            if (fd == -1) {
+                nResult = countFailed(ERROR_CANNOT_OPEN_FILE, strPath, vecBatches[i].second);
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_mapFiles[strPath].Fd = fd;
+        }
+        if (WriteAll(fd, vecBatches[i].second) != SUCCESS_CODE || fdatasync(fd) != 0) {
+            nResult = countFailed(ERROR_CANNOT_WRITE_FILE, strPath, vecBatches[i].second);
+        }
+    }
+    return nResult;
+}
+
+void CJsonLogWriter::RunFlushLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_bStop) {
+        m_cvFlush.wait_for(lock, std::chrono::milliseconds(LOG_FLUSH_INTERVAL_MS), [this] {
+            return m_bStop || m_siPendingBytes >= LOG_FLUSH_THRESHOLD;
+        });
+        if (m_bStop) {
+            break;
+        }
+        lock.unlock();
+        Flush();
+        lock.lock();
+    }
+}
+
+int CJsonLogWriter::OpenLogFile(const std::string& logFilePath) {
+    if (ConvertLegacyArrayLog(logFilePath) != SUCCESS_CODE) {
+        return -1;
+    }
+    return open(logFilePath.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+}
+
+// 이전 버전의 JSON 배열 형식 로그가 있으면 한 번만 JSON Lines 형식으로 변환
+int CJsonLogWriter::ConvertLegacyArrayLog(const std::string& logFilePath) {
+    std::ifstream logFileIn(logFilePath);
+    if (!logFileIn.is_open()) {
+        return SUCCESS_CODE;
+    }
+    char chFirst = 0;
+    logFileIn >> std::ws;
+    if (!logFileIn.get(chFirst) || chFirst != '[') {
+        return SUCCESS_CODE;
+    }
+    logFileIn.seekg(0);
+
+    Json::CharReaderBuilder reader;
+    Json::Value existingLog;
+    std::string errs;
+    if (!Json::parseFromStream(reader, logFileIn, &existingLog, &errs) || !existingLog.isArray()) {
+        // 파싱할 수 없는 파일은 덮어쓰지 않고 보존
+        std::string strBackupPath = logFilePath + ".corrupt";
+        if (rename(logFilePath.c_str(), strBackupPath.c_str()) != 0) {
+            return ERROR_CANNOT_MOVE_FILE;
+        }
+        return SUCCESS_CODE;
+    }
+    logFileIn.close();
+
+    Json::StreamWriterBuilder writer;
+    writer["indentation"] = "";
+    std::string strConverted;
+    for (const auto& entry : existingLog) {
+        strConverted += Json::writeString(writer, entry);
+        strConverted += "\n";
+    }
+
+    std::string strTempPath = logFilePath + ".tmp";
+    int fd = open(strTempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+    int nResult = WriteAll(fd, strConverted);
+    if (nResult == SUCCESS_CODE && fsync(fd) != 0) {
+        nResult = ERROR_CANNOT_WRITE_FILE;
+    }
+    close(fd);
+    if (nResult != SUCCESS_CODE || rename(strTempPath.c_str(), logFilePath.c_str()) != 0) {
+        unlink(strTempPath.c_str());
+        return nResult != SUCCESS_CODE ? nResult : ERROR_CANNOT_MOVE_FILE;
+    }
+    return SUCCESS_CODE;
+}
+
+int CJsonLogWriter::WriteAll(int fd, const std::string& data) {
+    size_t siWritten = 0;
+    while (siWritten < data.size()) {
+        ssize_t n = write(fd, data.data() + siWritten, data.size() - siWritten);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return ERROR_CANNOT_WRITE_FILE;
+        }
+        siWritten += static_cast<size_t>(n);
+    }
+    return SUCCESS_CODE;
+}
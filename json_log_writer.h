@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <jsoncpp/json/json.h>
+
+#define LOG_FLUSH_INTERVAL_MS 200          // 백그라운드 flush 주기
+#define LOG_FLUSH_THRESHOLD (256 * 1024)   // 대기 중인 로그가 이 크기를 넘으면 즉시 flush
+
+// JSON Lines(한 줄에 JSON 객체 하나) 형식의 추가 전용 로그 작성기
+// Append는 메모리 버퍼에만 쌓고, 백그라운드 스레드가 파일별로 모아서 write + fdatasync 수행
+// 로그 파일을 읽는 쪽은 최대 한 주기만큼 기록되지 않은 로그를 놓치지 않도록 읽기 전에 Flush를 호출해야 함
+class CJsonLogWriter {
+public:
+    static CJsonLogWriter& Instance();
+    int Append(const Json::Value& logEntry, const std::string& logFilePath);
+    int Flush();
+    uint64_t GetFailedRecords() const { return m_ullFailedRecords.load(); }
+
+private:
+    struct ST_LogFile {
+        int Fd = -1;
+        std::string Pending;
+    };
+
+    CJsonLogWriter();
+    ~CJsonLogWriter();
+    CJsonLogWriter(const CJsonLogWriter&) = delete;
+    CJsonLogWriter& operator=(const CJsonLogWriter&) = delete;
+
+    std::mutex m_mutex;        // m_mapFiles, m_siPendingBytes 보호
+    std::mutex m_writeMutex;   // 파일 쓰기 순서 보장 (flush 스레드와 Flush() 호출 간)
+    std::condition_variable m_cvFlush;
+    std::unordered_map<std::string, ST_LogFile> m_mapFiles;
+    size_t m_siPendingBytes;
+    std::atomic<uint64_t> m_ullFailedRecords;   // 파일을 열거나 쓰지 못해 기록되지 않은 로그 수 (일부만 쓰인 묶음 포함)
+    bool m_bStop;
+    std::thread m_flushThread;
+
+    void RunFlushLoop();
+    static int OpenLogFile(const std::string& logFilePath);
+    static int ConvertLegacyArrayLog(const std::string& logFilePath);
+    static int WriteAll(int fd, const std::string& data);
+};
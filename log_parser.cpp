@@ -1,6 +1,8 @@
 #include "log_parser.h"
+#include "json_log_writer.h"
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 #include <regex>
@@ -39,40 +41,76 @@ std::unordered_map<std::string, std::vector<std::string>> LogParser::ParsePacket
 
 std::vector<std::unordered_map<std::string, std::string>> LogParser::ParseJsonLogFile(const std::string& logFilePath) {
     std::vector<std::unordered_map<std::string, std::string>> logEntries;
+    // 작성기 버퍼에 남아있는 로그(최대 한 flush 주기 분량)까지 파일에 기록된 뒤 읽음
+    CJsonLogWriter::Instance().Flush();
     std::ifstream logFile(logFilePath, std::ifstream::binary);
     if (!logFile.is_open()) {
         std::cerr << "Could not open log file: " << logFilePath << std::endl;
         return logEntries;
     }
 
-    Json::Value root;
     Json::CharReaderBuilder builder;
     std::string errs;
 
-    if (!Json::parseFromStream(builder, logFile, &root, &errs)) {
-        std::cerr << "Failed to parse JSON: " << errs << std::endl;
+    // 이전 버전의 JSON 배열 형식 로그도 읽을 수 있도록 첫 글자로 형식 판별
+    char chFirst = 0;
+    logFile >> std::ws;
+    if (logFile.get(chFirst) && chFirst == '[') {
+        logFile.seekg(0);
+        Json::Value root;
+        if (!Json::parseFromStream(builder, logFile, &root, &errs)) {
+            std::cerr << "Failed to parse JSON: " << errs << std::endl;
+            return logEntries;
+        }
+        for (const auto& entry : root) {
+            logEntries.push_back(ToEventLogData(entry));
+        }
         return logEntries;
     }
 
-    if (root.isArray()) {
-        for (const auto& entry : root) {
-            std::unordered_map<std::string, std::string> logData;
-            logData["event_type"] = entry["event_type"].asString();
-            logData["file_size"] = std::to_string(entry["file_size"].asInt());
-            logData["new_hash"] = entry["new_hash"].asString();
-            logData["old_hash"] = entry["old_hash"].asString();
-            logData["pid"] = std::to_string(entry["pid"].asInt());
-            logData["target_file"] = entry["target_file"].asString();
-            logData["timestamp"] = entry["timestamp"].asString();
-            logData["user"] = entry["user"].asString();
-            logEntries.push_back(logData);
+    // JSON Lines 형식: 한 줄에 로그 하나, 기록 도중 잘린 마지막 줄 등은 건너뜀
+    logFile.clear();
+    logFile.seekg(0);
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    std::string line;
+    while (std::getline(logFile, line)) {
+        if (line.empty()) {
+            continue;
         }
+        Json::Value entry;
+        if (!reader->parse(line.data(), line.data() + line.size(), &entry, &errs) || !entry.isObject()) {
+            std::cerr << "Skipping malformed log line: " << errs << std::endl;
+            continue;
+        }
+        logEntries.push_back(ToEventLogData(entry));
     }
 
     logFile.close();
     return logEntries;
 }
 
+// 파일 이벤트 로그 한 건을 문자열 맵으로 변환 ("N/A"처럼 문자열로 기록된 숫자 필드도 처리)
+std::unordered_map<std::string, std::string> LogParser::ToEventLogData(const Json::Value& entry) {
+    auto toString = [](const Json::Value& value) -> std::string {
+        if (value.isString()) return value.asString();
+        if (value.isInt64()) return std::to_string(value.asInt64());
+        if (value.isUInt64()) return std::to_string(value.asUInt64());
+        if (value.isNull()) return "";
+        return value.asString();
+    };
+
+    std::unordered_map<std::string, std::string> logData;
+    logData["event_type"] = toString(entry["event_type"]);
+    logData["file_size"] = toString(entry["file_size"]);
+    logData["new_hash"] = toString(entry["new_hash"]);
+    logData["old_hash"] = toString(entry["old_hash"]);
+    logData["pid"] = toString(entry["pid"]);
+    logData["target_file"] = toString(entry["target_file"]);
+    logData["timestamp"] = toString(entry["timestamp"]);
+    logData["user"] = toString(entry["user"]);
+    return logData;
+}
+
 std::unordered_map<std::string, std::string> LogParser::ParseFirewallLog(const std::string& logFilePath) {
     std::unordered_map<std::string, std::string> logData;
     std::ifstream logFile(logFilePath);
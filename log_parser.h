@@ -16,6 +16,9 @@ public:
     std::vector<std::unordered_map<std::string, std::string>> ParseJsonLogFile(const std::string& logFilePath);
     std::unordered_map<std::string, std::string> ParseFirewallLog(const std::string& logFilePath);
 
+private:
+    static std::unordered_map<std::string, std::string> ToEventLogData(const Json::Value& entry);
+
 
 
 };
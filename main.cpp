@@ -17,7 +17,21 @@ void CheckOption(int &argc, char** &argv) {
     int nOpt;
     const char* pOption = "c:dhilmsunfe"; 
     bool bNetworkOption = false;
+    bool bScanOption = false;
+    ST_ScanOptions stScanOptions;
     std::string configPath;
+    bool bDaemonOption = false;
+    std::string strSocketPath = DAEMON_SOCKET_PATH;
+    std::string strSubmitTarget;
+    int nWorkerCount = std::thread::hardware_concurrency();
+    std::string strAccessPath;
+    bool bGuardAllOpens = false;
+    int nAccessTimeoutMs = ACCESS_SCAN_TIMEOUT_MS;
+    bool bCoordinatorOption = false;
+    bool bShardWorkerOption = false;
+    int nShardCount = 0;
+    bool bProcessScanOption = false;
+    std::vector<std::string> vecScanRoots; // --path를 여러 번 지정하면 코디네이터가 모두 나눠서 스캔
 
     while ((nOpt = getopt_long(argc, argv, pOption, options, &nOptionIndex)) != -1) {
         switch (nOpt) {
@@ -42,7 +56,8 @@ void CheckOption(int &argc, char** &argv) {
                 IEventMonitor.StartMonitoring();
                 break;
             case 's':
-                IFileScanner.StartScan();
+                // 스캔 관련 long 옵션을 모두 읽은 뒤 실행
+                bScanOption = true;
                 break;
             case 'u':
                 IUsageOption.CollectAndSaveUsage();
@@ -67,6 +82,135 @@ void CheckOption(int &argc, char** &argv) {
                 IEmailSender.SendLogEmail(); // 이메일 보내기 함수 호출
                 break;
             }
+            case OPT_HEADLESS:
+                stScanOptions.Headless = true;
+                bScanOption = true;
+                break;
+            case OPT_PATH:
+                stScanOptions.TargetPath = optarg;
+                vecScanRoots.push_back(optarg);
+                break;
+            case OPT_FILE_TYPE:
+                stScanOptions.FileTypeOption = ParseFileTypeOption(optarg);
+                if (stScanOptions.FileTypeOption == 0) {
+                    IAgentOptions.DisplayErrorOption();
+                    exit(ERROR_INVALID_OPTION);
+                }
+                break;
+            case OPT_EXTENSION:
+                stScanOptions.Extension = optarg;
+                stScanOptions.FileTypeOption = SPECIFIC_EXTENSION;
+                break;
+            case OPT_ENGINE:
+                stScanOptions.ScanTypeOption = ParseEngineOption(optarg);
+                if (stScanOptions.ScanTypeOption == 0) {
+                    IAgentOptions.DisplayErrorOption();
+                    exit(ERROR_INVALID_OPTION);
+                }
+                break;
+            case OPT_SUMMARY:
+                stScanOptions.SummaryPath = optarg;
+                break;
+            case OPT_QUARANTINE:
+                stScanOptions.AutoQuarantine = true;
+                break;
+            case OPT_PRIORITIZE:
+                stScanOptions.Prioritize = true;
+                break;
+            case OPT_PROFILE_JSON:
+                stScanOptions.ProfilePath = optarg;
+                break;
+            case OPT_YARA_PROFILE: {
+                CYaraChecker IYaraChecker(YARA_RULES_PATH);
+                CYaraProfiler IYaraProfiler(IYaraChecker);
+                int nResult = IYaraProfiler.StartProfiling(optarg);
+                if (nResult != SUCCESS_CODE) {
+                    PrintErrorMessage(nResult, optarg);
+                }
+                break;
+            }
+            case OPT_SIGNATURE_BENCH: {
+                CSignatureBenchmark ISignatureBenchmark(SIGNATURE_DB_PATH);
+                int nResult = ISignatureBenchmark.Run(optarg);
+                if (nResult != SUCCESS_CODE) {
+                    PrintErrorMessage(nResult, optarg);
+                }
+                break;
+            }
+            case OPT_VAULT_LIST:
+            case OPT_VAULT_RESTORE:
+            case OPT_VAULT_PURGE: {
+                CQuarantineVault IQuarantineVault(DESTINATION_PATH);
+                int nResult = IQuarantineVault.Open();
+                if (nResult == SUCCESS_CODE && nOpt == OPT_VAULT_LIST) {
+                    nResult = IQuarantineVault.PrintEntries();
+                } else if (nResult == SUCCESS_CODE && nOpt == OPT_VAULT_RESTORE) {
+                    std::string strRestoredPath;
+                    nResult = IQuarantineVault.Restore(atoll(optarg), strRestoredPath);
+                    if (nResult == SUCCESS_CODE) {
+                        std::cout << COLOR_GREEN << "[+] Restored: " << strRestoredPath << COLOR_RESET << "\n";
+                    }
+                } else if (nResult == SUCCESS_CODE) {
+                    uint64_t ullRemovedEntries = 0;
+                    nResult = IQuarantineVault.Purge(optarg, ullRemovedEntries);
+                    if (nResult == SUCCESS_CODE) {
+                        std::cout << COLOR_GREEN << "[+] Purged: " << optarg << " (" << ullRemovedEntries << " detections)" << COLOR_RESET << "\n";
+                    }
+                }
+                if (nResult != SUCCESS_CODE) {
+                    PrintErrorMessage(nResult, nOpt == OPT_VAULT_LIST ? DESTINATION_PATH : optarg);
+                }
+                break;
+            }
+            case OPT_RESUME:
+                stScanOptions.Resume = true;
+                bScanOption = true;
+                break;
+            case OPT_DAEMON:
+                bDaemonOption = true;
+                break;
+            case OPT_SOCKET:
+                strSocketPath = optarg;
+                break;
+            case OPT_WORKERS:
+                nWorkerCount = atoi(optarg);
+                if (nWorkerCount <= 0) {
+                    IAgentOptions.DisplayErrorOption();
+                    exit(ERROR_INVALID_OPTION);
+                }
+                break;
+            case OPT_SUBMIT:
+                strSubmitTarget = optarg;
+                break;
+            case OPT_ON_ACCESS:
+                strAccessPath = optarg;
+                break;
+            case OPT_ON_ACCESS_OPEN:
+                bGuardAllOpens = true;
+                break;
+            case OPT_ACCESS_TIMEOUT:
+                nAccessTimeoutMs = atoi(optarg);
+                if (nAccessTimeoutMs <= 0) {
+                    IAgentOptions.DisplayErrorOption();
+                    exit(ERROR_INVALID_OPTION);
+                }
+                break;
+            case OPT_COORDINATOR:
+                bCoordinatorOption = true;
+                break;
+            case OPT_SHARD_WORKER:
+                bShardWorkerOption = true;
+                break;
+            case OPT_SHARDS:
+                nShardCount = atoi(optarg);
+                if (nShardCount <= 0) {
+                    IAgentOptions.DisplayErrorOption();
+                    exit(ERROR_INVALID_OPTION);
+                }
+                break;
+            case OPT_SCAN_PROCESSES:
+                bProcessScanOption = true;
+                break;
             case '?':
                 IAgentOptions.DisplayErrorOption();
                 break;
@@ -74,6 +218,74 @@ void CheckOption(int &argc, char** &argv) {
                 abort();
         }
     }
+
+    if (bScanOption) {
+        IFileScanner.SetOptions(stScanOptions);
+        int nResult = IFileScanner.StartScan();
+        if (stScanOptions.Headless && nResult != SUCCESS_CODE) {
+            exit(nResult);
+        }
+    }
+
+    // 데몬/클라이언트도 --socket, --engine 등을 모두 읽은 뒤 실행
+    if (bDaemonOption) {
+        CScanDaemon IScanDaemon(strSocketPath, nWorkerCount, stScanOptions.ScanTypeOption);
+        int nResult = IScanDaemon.Run();
+        if (nResult != SUCCESS_CODE) {
+            exit(nResult);
+        }
+    }
+    if (!strAccessPath.empty()) {
+        CAccessGuard IAccessGuard(strAccessPath, bGuardAllOpens, nWorkerCount, stScanOptions.ScanTypeOption, nAccessTimeoutMs);
+        int nResult = IAccessGuard.Run();
+        if (nResult != SUCCESS_CODE) {
+            exit(nResult);
+        }
+    }
+    if (bProcessScanOption) {
+        CProcessScanner IProcessScanner(nWorkerCount, stScanOptions.ScanTypeOption, stScanOptions.SummaryPath);
+        int nResult = IProcessScanner.Run();
+        if (nResult != SUCCESS_CODE) {
+            exit(nResult);
+        }
+    }
+    // 코디네이터/작업자는 데몬 소켓과 겹치지 않도록 --socket이 없으면 별도 경로 사용
+    if (strSocketPath == DAEMON_SOCKET_PATH && (bCoordinatorOption || bShardWorkerOption)) {
+        strSocketPath = COORDINATOR_SOCKET_PATH;
+    }
+    if (bCoordinatorOption) {
+        if (vecScanRoots.empty()) {
+            vecScanRoots.push_back(stScanOptions.TargetPath);
+        }
+        CScanCoordinator IScanCoordinator(strSocketPath, vecScanRoots, stScanOptions, nWorkerCount, nShardCount);
+        int nResult = IScanCoordinator.Run();
+        if (nResult != SUCCESS_CODE) {
+            exit(nResult);
+        }
+    }
+    if (bShardWorkerOption) {
+        CShardWorker IShardWorker(strSocketPath);
+        exit(IShardWorker.Run());
+    }
+    if (!strSubmitTarget.empty()) {
+        CScanClient IScanClient(strSocketPath);
+        exit(IScanClient.Submit(strSubmitTarget));
+    }
+}
+
+// --file-type 값 변환 (all/elf/ext 또는 1/2/3), 잘못된 값이면 0 반환
+int ParseFileTypeOption(const std::string& value) {
+    if (value == "all" || value == "1") return ALL_FILES;
+    if (value == "elf" || value == "2") return ELF_FILES;
+    if (value == "ext" || value == "3") return SPECIFIC_EXTENSION;
+    return 0;
+}
+
+// --engine 값 변환 (yara/hash 또는 1/2), 잘못된 값이면 0 반환
+int ParseEngineOption(const std::string& value) {
+    if (value == "yara" || value == "1") return YARA_RULE;
+    if (value == "hash" || value == "2") return HASH_COMPARISON;
+    return 0;
 }
 
 int main(int argc, char **argv){
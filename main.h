@@ -2,6 +2,8 @@
 
 #include <getopt.h>
 #include <iostream>
+#include <thread>
+#include "access_guard.h"
 #include "antidbg.h"
 #include "config.h"
 #include "event_monitor.h"
@@ -11,12 +13,48 @@
 #include "options_info.h"
 #include "packet_generator.h"
 #include "packet_handler.h"
+#include "process_scanner.h"
+#include "quarantine_vault.h"
+#include "scan_coordinator.h"
+#include "scan_daemon.h"
+#include "signature_bench.h"
 #include "usage_collector.h"
+#include "yara_profiler.h"
 #include "user_program.h"
 #include "email_sender.h"
 
 #define CONFIGPATH "./config.ini"
 
+// 짧은 옵션이 없는 long 옵션 식별값 (getopt_long 반환값으로 사용)
+enum ELongOption {
+    OPT_HEADLESS = 1000,
+    OPT_PATH,
+    OPT_FILE_TYPE,
+    OPT_EXTENSION,
+    OPT_ENGINE,
+    OPT_SUMMARY,
+    OPT_QUARANTINE,
+    OPT_RESUME,
+    OPT_PROFILE_JSON,
+    OPT_YARA_PROFILE,
+    OPT_DAEMON,
+    OPT_SOCKET,
+    OPT_WORKERS,
+    OPT_SUBMIT,
+    OPT_ON_ACCESS,
+    OPT_ON_ACCESS_OPEN,
+    OPT_ACCESS_TIMEOUT,
+    OPT_SIGNATURE_BENCH,
+    OPT_VAULT_LIST,
+    OPT_VAULT_RESTORE,
+    OPT_VAULT_PURGE,
+    OPT_PRIORITIZE,
+    OPT_COORDINATOR,
+    OPT_SHARD_WORKER,
+    OPT_SHARDS,
+    OPT_SCAN_PROCESSES
+};
+
 // 인자값 필요로 한다면 no_argument -> required_argument
 struct option options[] = {
     {"help", no_argument, 0, 'h'},
@@ -30,8 +68,36 @@ struct option options[] = {
     {"config", required_argument, 0, 'c'},
     {"firewall", no_argument, 0, 'f'},
     {"email", no_argument, 0, 'e'},
+    {"headless", no_argument, 0, OPT_HEADLESS},
+    {"path", required_argument, 0, OPT_PATH},
+    {"file-type", required_argument, 0, OPT_FILE_TYPE},
+    {"extension", required_argument, 0, OPT_EXTENSION},
+    {"engine", required_argument, 0, OPT_ENGINE},
+    {"summary", required_argument, 0, OPT_SUMMARY},
+    {"quarantine", no_argument, 0, OPT_QUARANTINE},
+    {"resume", no_argument, 0, OPT_RESUME},
+    {"profile-json", required_argument, 0, OPT_PROFILE_JSON},
+    {"yara-profile", required_argument, 0, OPT_YARA_PROFILE},
+    {"daemon", no_argument, 0, OPT_DAEMON},
+    {"socket", required_argument, 0, OPT_SOCKET},
+    {"workers", required_argument, 0, OPT_WORKERS},
+    {"submit", required_argument, 0, OPT_SUBMIT},
+    {"on-access", required_argument, 0, OPT_ON_ACCESS},
+    {"on-access-open", no_argument, 0, OPT_ON_ACCESS_OPEN},
+    {"access-timeout", required_argument, 0, OPT_ACCESS_TIMEOUT},
+    {"signature-bench", required_argument, 0, OPT_SIGNATURE_BENCH},
+    {"vault-list", no_argument, 0, OPT_VAULT_LIST},
+    {"vault-restore", required_argument, 0, OPT_VAULT_RESTORE},
+    {"vault-purge", required_argument, 0, OPT_VAULT_PURGE},
+    {"prioritize", no_argument, 0, OPT_PRIORITIZE},
+    {"coordinator", no_argument, 0, OPT_COORDINATOR},
+    {"shard-worker", no_argument, 0, OPT_SHARD_WORKER},
+    {"shards", required_argument, 0, OPT_SHARDS},
+    {"scan-processes", no_argument, 0, OPT_SCAN_PROCESSES},
     {0,0,0,0}
 };
 
 void CheckOption(int &argc, char** &argv);
+int ParseFileTypeOption(const std::string& value);
+int ParseEngineOption(const std::string& value);
 void LoadConfig(const std::string& configPath);
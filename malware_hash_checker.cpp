@@ -1,11 +1,12 @@
 #include <algorithm>
+#include <cctype>
 #include <iostream>
 #include <fstream>
 #include "ansi_color.h"
 #include "util.h"
 #include "malware_hash_checker.h"
 
-// hashes.txt의 내용을 vector로 변환
+// hashes.txt의 내용을 해시 집합으로 변환 (파일 하나당 O(1) 조회)
 int CMalwareHashChecker::LoadHashes(const std::string& hashListPath) {
     std::ifstream file(hashListPath);
     if (!file.is_open()) {
@@ -13,28 +14,39 @@ int CMalwareHashChecker::LoadHashes(const std::string& hashListPath) {
     }
     std::string strLine;
     while (std::getline(file, strLine)) {
-        m_vecHashes.push_back(strLine);
+        strLine = Trim(strLine);
+        if (strLine.empty()) {
+            continue;
+        }
+        std::transform(strLine.begin(), strLine.end(), strLine.begin(), [](unsigned char c) { return std::tolower(c); });
+        m_setHashes.insert(strLine);
     }
     file.close();
     return SUCCESS_CODE;
 }
 
-int CMalwareHashChecker::CompareByHash(FTSENT *node, std::vector<std::string>& detectedMalware, std::string& detectionCause) {
-    std::string strFileHash;
-    int result = ComputeSHA256(node->fts_path, strFileHash); // 파일의 해시값을 계산
-    if (result != SUCCESS_CODE) {
-        return ERROR_CANNOT_COMPUTE_HASH;
+bool CMalwareHashChecker::IsMalwareHash(const std::string& fileHash) const {
+    return m_setHashes.count(fileHash) > 0;
+}
+
+// 해시 집합이 차지하는 대략적인 메모리 (문자열 본문 + 노드 + 버킷)
+size_t CMalwareHashChecker::GetMemoryUsage() const {
+    size_t siBytes = m_setHashes.bucket_count() * sizeof(void*);
+    for (const auto& hash : m_setHashes) {
+        siBytes += sizeof(hash) + sizeof(void*) * 2 + hash.capacity();
     }
-    for (const auto& hash : m_vecHashes) {
-        if (strFileHash == hash) { //계산된 해시값을 저장된 해시값들과 비교
-            // 중복 검사
-            if (std::find(detectedMalware.begin(), detectedMalware.end(), node->fts_path) == detectedMalware.end()) {
-                detectedMalware.push_back(node->fts_path);
-                std::cout << "\n" << COLOR_RED << "[+] Malware detected: [" << node->fts_path << "]" << COLOR_RESET << "\n\n";
-            }
-            detectionCause = strFileHash;
-            break;
+    return siBytes;
+}
+
+// 스캔 단계에서 계산한 해시값을 악성 해시 목록과 비교
+int CMalwareHashChecker::CompareByHash(const std::string& filePath, const std::string& fileHash, std::vector<std::string>& detectedMalware, std::string& detectionCause) const {
+    if (IsMalwareHash(fileHash)) { //계산된 해시값을 저장된 해시값들과 비교
+        // 중복 검사
+        if (std::find(detectedMalware.begin(), detectedMalware.end(), filePath) == detectedMalware.end()) {
+            detectedMalware.push_back(filePath);
+            std::cout << "\n" << COLOR_RED << "[+] Malware detected: [" << filePath << "]" << COLOR_RESET << "\n\n";
         }
+        detectionCause = fileHash;
     }
     return SUCCESS_CODE;
-}
\ No newline at end of file
+}
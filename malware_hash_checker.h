@@ -1,15 +1,17 @@
 #pragma once
 
 #include <string>
+#include <unordered_set>
 #include <vector>
-#include <fts.h>
 
 class CMalwareHashChecker {
 public:
     int LoadHashes(const std::string& fileName);
-    int CompareByHash(FTSENT* node, std::vector<std::string>& detectedMalware, std::string& detectionCause);
-    const std::vector<std::string>& GetHashes() const;
+    int CompareByHash(const std::string& filePath, const std::string& fileHash, std::vector<std::string>& detectedMalware, std::string& detectionCause) const;
+    bool IsMalwareHash(const std::string& fileHash) const;
+    size_t GetHashCount() const { return m_setHashes.size(); }
+    size_t GetMemoryUsage() const;
 
 private:
-    std::vector<std::string> m_vecHashes;
-};
\ No newline at end of file
+    std::unordered_set<std::string> m_setHashes;
+};
@@ -0,0 +1,192 @@
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <mutex>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "error_codes.h"
+#include "mapped_file.h"
+
+namespace {
+
+// SIGBUS 처리기가 잠금 없이 확인하는 매핑 목록 (Start가 0이면 비어있음)
+struct ST_MappingGuard {
+    std::atomic<uintptr_t> Start{0};
+    std::atomic<size_t> Size{0};
+    std::atomic<bool> Truncated{false};
+};
+
+// 스레드마다 자신이 만든 매핑만 등록하고, 처리기는 신호를 받은 스레드의 목록만 확인
+// 매핑은 만든 스레드만 읽고 해제하므로, 처리기가 도는 동안 그 범위가 다른 스레드에서 해제되거나 재사용될 수 없음
+// (Map에서 먼저 등록하므로 처리기 안에서 처음 접근해 TLS를 할당하는 일은 없음)
+thread_local ST_MappingGuard t_mappingGuards[MAPPED_FILE_MAX_GUARDS];
+struct sigaction g_previousSigbusAction;
+uintptr_t g_ulPageSize = 4096;
+std::once_flag g_sigbusHandlerOnce;
+
+// 매핑이 파일 끝을 넘으면(검사 중 잘림) 그 페이지를 읽을 때 SIGBUS 발생
+// 잘린 위치 뒤는 모두 파일 밖이므로 매핑 끝까지 0으로 채운 익명 페이지로 바꾸고 돌아가 같은 명령을 다시 실행
+// (libyara 등 검사 코드 안에서 longjmp로 빠져나오면 잠금/자원과 C++ 소멸자가 건너뛰어지므로 실행 흐름은 건드리지 않음)
+void HandleSigbus(int signal, siginfo_t* info, void* context) {
+    uintptr_t address = reinterpret_cast<uintptr_t>(info->si_addr);
+    for (ST_MappingGuard& guard : t_mappingGuards) {
+        uintptr_t start = guard.Start.load(std::memory_order_acquire);
+        size_t size = guard.Size.load(std::memory_order_acquire);
+        if (start == 0 || address < start || address >= start + size) {
+            continue;
+        }
+        uintptr_t page = address & ~(g_ulPageSize - 1);
+        if (mmap(reinterpret_cast<void*>(page), start + size - page, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) != MAP_FAILED) {
+            guard.Truncated.store(true, std::memory_order_relaxed);
+            return;
+        }
+        break;
+    }
+    // 보호하는 매핑이 아니면 원래 처리기로 넘기고, 원래 기본 동작이면 기본 동작으로 되돌려 다시 발생시킴 (코어 덤프 후 종료)
+    if (g_previousSigbusAction.sa_flags & SA_SIGINFO) {
+        g_previousSigbusAction.sa_sigaction(signal, info, context);
+        return;
+    }
+    if (g_previousSigbusAction.sa_handler != SIG_DFL && g_previousSigbusAction.sa_handler != SIG_IGN) {
+        g_previousSigbusAction.sa_handler(signal);
+        return;
+    }
+    struct sigaction defaultAction = {};
+    defaultAction.sa_handler = SIG_DFL;
+    sigaction(SIGBUS, &defaultAction, nullptr);
+    raise(SIGBUS);
+}
+
+void InstallSigbusHandler() {
+    g_ulPageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    struct sigaction action = {};
+    action.sa_sigaction = HandleSigbus;
+    action.sa_flags = SA_SIGINFO;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGBUS, &action, &g_previousSigbusAction);
+}
+
+int AcquireGuard(const void* start, size_t size) {
+    for (int i = 0; i < MAPPED_FILE_MAX_GUARDS; i++) {
+        ST_MappingGuard& guard = t_mappingGuards[i];
+        if (guard.Start.load(std::memory_order_relaxed) != 0) {
+            continue;
+        }
+        guard.Truncated.store(false, std::memory_order_relaxed);
+        guard.Size.store(size, std::memory_order_relaxed);
+        guard.Start.store(reinterpret_cast<uintptr_t>(start), std::memory_order_release);
+        return i;
+    }
+    return -1;
+}
+
+void ReleaseGuard(int index) {
+    t_mappingGuards[index].Start.store(0, std::memory_order_release);
+}
+
+} // namespace
+
+CMappedFile::CMappedFile() : m_fd(-1), m_pData(nullptr), m_siSize(0), m_stat{}, m_nGuard(-1), m_bTruncated(false) {}
+
+CMappedFile::~CMappedFile() {
+    Close();
+}
+
+// FIFO는 쓰는 쪽이 나타날 때까지 open()이 멈추므로 O_NONBLOCK으로 열고, 일반 파일인지는 Attach에서 확인
+// (일반 파일의 읽기와 매핑에는 O_NONBLOCK이 영향을 주지 않음)
+int CMappedFile::Open(const std::string& filePath) {
+    Close();
+    m_fd = open(filePath.c_str(), O_RDONLY | O_CLOEXEC | O_NONBLOCK | O_NOATIME);
+    if (m_fd == -1) {
+        // O_NOATIME은 소유자가 아니면 EPERM이므로 플래그 없이 재시도
+        m_fd = open(filePath.c_str(), O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+    }
+    if (m_fd == -1) {
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+    return Attach(m_fd);
+}
+
+// 이미 열린 디스크립터(예: 소켓으로 전달받은 fd)의 소유권을 넘겨받음
+int CMappedFile::Attach(int fd) {
+    if (fd != m_fd) {
+        Close();
+        m_fd = fd;
+    }
+    if (fstat(m_fd, &m_stat) != 0 || !S_ISREG(m_stat.st_mode)) {
+        Close();
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+    m_siSize = static_cast<size_t>(m_stat.st_size);
+    return SUCCESS_CODE;
+}
+
+// 파일 전체를 매핑, 빈 파일은 매핑 없이 성공 처리
+// 큰 파일을 미리 전부 읽어 페이지 캐시를 밀어내지 않도록 MAP_POPULATE 없이 검사하면서 읽고, 순차 접근으로 알려 미리 읽기를 늘림
+// 매핑은 해제할 때까지 SIGBUS 처리기에 등록하여 검사 중 파일이 잘려도 프로세스가 종료되지 않게 함
+int CMappedFile::Map() {
+    if (m_fd == -1) {
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+    if (m_siSize == 0) {
+        return SUCCESS_CODE;
+    }
+    std::call_once(g_sigbusHandlerOnce, InstallSigbusHandler);
+    void* pData = mmap(nullptr, m_siSize, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (pData == MAP_FAILED) {
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+    m_nGuard = AcquireGuard(pData, m_siSize);
+    if (m_nGuard == -1) {
+        munmap(pData, m_siSize);
+        return ReadAll();
+    }
+    madvise(pData, m_siSize, MADV_SEQUENTIAL);
+    m_pData = static_cast<uint8_t*>(pData);
+    return SUCCESS_CODE;
+}
+
+// 보호할 칸이 모두 쓰이고 있으면 매핑하지 않고 버퍼로 읽음, 읽는 중 파일이 짧아지면 읽은 만큼만 사용
+int CMappedFile::ReadAll() {
+    m_vecBuffer.resize(m_siSize);
+    size_t siRead = 0;
+    while (siRead < m_siSize) {
+        ssize_t nRead = pread(m_fd, m_vecBuffer.data() + siRead, m_siSize - siRead, static_cast<off_t>(siRead));
+        if (nRead < 0 && errno == EINTR) {
+            continue;
+        }
+        if (nRead < 0) {
+            m_vecBuffer.clear();
+            return ERROR_CANNOT_OPEN_FILE;
+        }
+        if (nRead == 0) {
+            m_bTruncated = true;
+            break;
+        }
+        siRead += static_cast<size_t>(nRead);
+    }
+    m_siSize = siRead;
+    m_pData = m_vecBuffer.data();
+    return SUCCESS_CODE;
+}
+
+bool CMappedFile::WasTruncated() const {
+    return m_bTruncated || (m_nGuard != -1 && t_mappingGuards[m_nGuard].Truncated.load(std::memory_order_relaxed));
+}
+
+void CMappedFile::Close() {
+    if (m_nGuard != -1) {
+        ReleaseGuard(m_nGuard);
+        m_nGuard = -1;
+        munmap(m_pData, m_siSize);
+    }
+    m_pData = nullptr;
+    m_vecBuffer.clear();
+    m_bTruncated = false;
+    if (m_fd != -1) {
+        close(m_fd);
+        m_fd = -1;
+    }
+    m_siSize = 0;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+#define MAPPED_FILE_MAX_GUARDS 16 // 스레드 하나가 동시에 SIGBUS로부터 보호하는 매핑 수, 넘으면 매핑 대신 read()로 읽음
+
+// 스캔 대상 파일을 한 번만 읽어 해시/YARA 검사가 같은 메모리를 공유하도록 하는 읽기 전용 매핑
+// Open(열기)과 Map(매핑)을 분리하여 단계별 시간을 따로 측정할 수 있음, 실제 디스크 읽기는 검사 중 페이지 단위로 일어남
+// 검사 중에 다른 프로세스가 파일을 잘라내면 잘린 뒤쪽 페이지는 SIGBUS 대신 0으로 읽히고 WasTruncated()가 true
+// 매핑, 읽기, 해제는 모두 Map을 호출한 스레드에서 해야 함 (보호 목록이 스레드마다 따로 있음)
+class CMappedFile {
+public:
+    CMappedFile();
+    ~CMappedFile();
+    int Open(const std::string& filePath);
+    int Attach(int fd);
+    int Map();
+    void Close();
+
+    const uint8_t* Data() const { return m_pData; }
+    size_t Size() const { return m_siSize; }
+    int Fd() const { return m_fd; }
+    const struct stat& Stat() const { return m_stat; }
+    bool WasTruncated() const;
+
+    CMappedFile(const CMappedFile&) = delete;
+    CMappedFile& operator=(const CMappedFile&) = delete;
+
+private:
+    int m_fd;
+    uint8_t* m_pData;
+    size_t m_siSize;
+    struct stat m_stat;
+    int m_nGuard;                    // SIGBUS 처리기에 등록한 칸, -1이면 매핑하지 않았거나 read()로 읽음
+    bool m_bTruncated;               // read()로 읽는 동안 파일이 짧아짐
+    std::vector<uint8_t> m_vecBuffer; // 보호할 칸이 없을 때 read()로 읽은 내용
+
+    int ReadAll();
+};
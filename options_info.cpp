@@ -27,7 +27,47 @@ int CUdkdAgentOptions::DisplayHelpOption() {
               << "  -n, --network               Generates and sends packets in real-time, captures and analyzes them to detect malicious packets, and blocks any detected malicious packets.\n"
               << "  -f, --firewall              Network Control Using Firewall Rules.\n"
               << "  -c, --config                Scan Using Custom Rules.\n"
-              << "  -e, --email                 Send log records to your email.(event monitor, firewall, packet)\n\n"
+              << "  -e, --email                 Send log records to your email.(event monitor, firewall, packet)\n"
+              << " \n"
+              << "Headless scan options: \n"
+              << "  --headless                  Scan without prompts and print a throttled progress line (files/s, MB/s, ETA, detections).\n"
+              << "  --path <dir>                Directory to scan (Default is './').\n"
+              << "  --file-type <all|elf|ext>   File type filter (Default is 'all').\n"
+              << "  --extension <ext>           Scan only files with this extension (implies --file-type ext).\n"
+              << "  --engine <yara|hash>        Detection engine (Default is 'yara').\n"
+              << "  --summary <file>            Write a JSON scan summary to <file>.\n"
+              << "  --quarantine                Move detected files to the 'detected-malware' vault without asking.\n"
+              << "  --resume                    Continue an interrupted scan from its last checkpoint (logs/scan_checkpoint.json).\n"
+              << "  --prioritize                Scan recently changed, executable, world-writable and ELF/PE files first to shorten time to first detection.\n"
+              << "  --profile-json <file>       Write per-phase latency histograms (p50/p99/max) and the slowest files as JSON.\n"
+              << "  --yara-profile <dir>        Rank YARA rules by evaluation cost on a sample corpus and list slow-atom warnings.\n"
+              << "  --signature-bench <dir>     Compare the native signatures.ndb engine with equivalent YARA rules (compile time, memory, GB/s).\n"
+              << " \n"
+              << "Quarantine vault options: \n"
+              << "  --vault-list                List quarantined detections with their id, SHA-256 and original path, and the space saved.\n"
+              << "  --vault-restore <id>        Decompress a quarantined detection back to its original path and permissions.\n"
+              << "  --vault-purge <sha256>      Delete a quarantined sample and every detection that refers to it.\n"
+              << " \n"
+              << "Scan daemon options: \n"
+              << "  --daemon                    Keep rules and hashes loaded and serve scan requests on a Unix socket (uses --engine as default).\n"
+              << "  --socket <path>             Daemon socket path (Default is 'logs/scan_daemon.sock').\n"
+              << "  --workers <n>               Number of daemon worker threads (Default is the number of CPUs).\n"
+              << "  --submit <file|->           Ask a running daemon to scan <file> (passed as an fd) or stdin; prints the JSON result.\n"
+              << " \n"
+              << "Sharded scan options: \n"
+              << "  --coordinator               Split --path (repeatable) into balanced shards by directory size and scan them with --workers local processes.\n"
+              << "  --shards <n>                Number of shards (Default is 4 per worker); workers that finish early take the remaining shards.\n"
+              << "  --shard-worker              Take shards from a running coordinator on --socket (Default is 'logs/scan_coordinator.sock').\n"
+              << "                              Shards of failed workers are reassigned; the merged report goes to --summary or 'logs/shard_report.json'.\n"
+              << " \n"
+              << "Process memory scan options: \n"
+              << "  --scan-processes            Scan the memory of running processes with --workers threads (uses --engine and --summary).\n"
+              << "                              Mappings identical to an already verified clean file are skipped; other processes need root.\n"
+              << " \n"
+              << "On-access scan options (requires root): \n"
+              << "  --on-access <mount>         Scan files on <mount> before they are executed and deny detected ones (fanotify).\n"
+              << "  --on-access-open            Also scan files when they are opened, not only executed.\n"
+              << "  --access-timeout <ms>       Allow access if a scan takes longer than <ms> (Default is 1000).\n\n"
               << "  * -l(log) and -n(network) option requires sudo\n";
    
     return SUCCESS_CODE;
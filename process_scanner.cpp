@@ -0,0 +1,467 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <sys/uio.h>
+#include <thread>
+#include <unistd.h>
+#include "ansi_color.h"
+#include "file_scanner.h"
+#include "json_log_writer.h"
+#include "mapped_file.h"
+#include "process_scanner.h"
+#include "util.h"
+
+std::atomic<bool> CProcessScanner::m_bStopScanning(false);
+
+static void ProcessScannerSignalHandler(int signal) {
+    if (signal == SIGINT || signal == SIGTERM) {
+        CProcessScanner::m_bStopScanning = true;
+    }
+}
+
+// libyara는 동시에 검사하는 스레드를 YR_MAX_THREADS개까지만 허용하므로 작업자 수를 그 안으로 제한
+CProcessScanner::CProcessScanner(int workerCount, int scanType, const std::string& summaryPath)
+    : m_nWorkerCount(std::clamp(workerCount, 1, YR_MAX_THREADS)), m_nScanType(scanType), m_strSummaryPath(summaryPath),
+      m_engineManager(YARA_RULES_PATH, HASH_LIST_PATH), m_siNextPid(0) {}
+
+int CProcessScanner::Run() {
+    int nResult = m_engineManager.Load();
+    if (nResult != SUCCESS_CODE) {
+        PrintErrorMessage(nResult, HASH_LIST_PATH);
+        return nResult;
+    }
+    m_engine = m_engineManager.Acquire();
+
+    struct sigaction action = {};
+    action.sa_handler = ProcessScannerSignalHandler;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    auto start = std::chrono::steady_clock::now();
+    nResult = CollectProcesses();
+    if (nResult != SUCCESS_CODE) {
+        return nResult;
+    }
+    std::cout << COLOR_GREEN << "[+] Scanning memory of " << m_vecPids.size() << " processes (" << m_nWorkerCount << " workers, "
+              << (m_nScanType == YARA_RULE ? "Yara" : "Hash") << ")" << COLOR_RESET << "\n";
+
+    std::vector<std::thread> vecWorkers;
+    for (int i = 0; i < m_nWorkerCount; i++) {
+        vecWorkers.emplace_back(&CProcessScanner::RunWorker, this);
+    }
+    for (std::thread& worker : vecWorkers) {
+        worker.join();
+    }
+    double dElapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+
+    PrintResult(dElapsed);
+    if (!m_strSummaryPath.empty()) {
+        nResult = WriteSummary(dElapsed);
+        if (nResult != SUCCESS_CODE) {
+            return nResult;
+        }
+    }
+    return m_vecDetections.empty() ? SUCCESS_CODE : ERROR_DETECTED_MALICIOUS_ACTIVITY;
+}
+
+// /proc의 숫자 디렉토리를 모아 RSS가 큰 프로세스부터 배정 (큰 프로세스가 마지막에 남아 작업자 하나만 일하는 것을 방지)
+int CProcessScanner::CollectProcesses() {
+    DIR* dir = opendir("/proc");
+    if (dir == nullptr) {
+        PrintErrorMessage(ERROR_CANNOT_OPEN_DIRECTORY, "/proc");
+        return ERROR_CANNOT_OPEN_DIRECTORY;
+    }
+    std::vector<std::pair<long, pid_t>> vecProcesses;
+    pid_t selfPid = getpid();
+    struct dirent* ent;
+    while ((ent = readdir(dir)) != nullptr) {
+        char* pEnd = nullptr;
+        long lPid = strtol(ent->d_name, &pEnd, 10);
+        if (lPid <= 0 || *pEnd != '\0' || lPid == selfPid) {
+            continue; // 자기 자신은 컴파일된 룰이 메모리에 있으므로 제외
+        }
+        std::ifstream statm("/proc/" + std::string(ent->d_name) + "/statm");
+        long lPages = 0;
+        long lResidentPages = 0;
+        statm >> lPages >> lResidentPages;
+        vecProcesses.push_back({lResidentPages, static_cast<pid_t>(lPid)});
+    }
+    closedir(dir);
+
+    std::sort(vecProcesses.begin(), vecProcesses.end(), std::greater<std::pair<long, pid_t>>());
+    for (const auto& process : vecProcesses) {
+        m_vecPids.push_back(process.second);
+    }
+    return SUCCESS_CODE;
+}
+
+// 작업자마다 버퍼를 하나 할당하여 모든 영역 읽기에 재사용
+void CProcessScanner::RunWorker() {
+    std::vector<uint8_t> vecBuffer(PROCESS_READ_CHUNK);
+    while (!m_bStopScanning) {
+        size_t siIndex = m_siNextPid.fetch_add(1);
+        if (siIndex >= m_vecPids.size()) {
+            break;
+        }
+        ScanProcess(m_vecPids[siIndex], vecBuffer);
+    }
+}
+
+void CProcessScanner::ScanProcess(pid_t pid, std::vector<uint8_t>& buffer) {
+    std::vector<ST_MemoryRegion> vecRegions;
+    if (!ReadRegions(pid, vecRegions)) {
+        m_statistics.Inaccessible++;
+        return;
+    }
+    m_statistics.Processes++;
+    std::string strCommand = GetCommand(pid);
+    std::map<std::pair<dev_t, ino_t>, ST_BackingFileVerdict> mapBackingFiles;
+
+    for (const ST_MemoryRegion& region : vecRegions) {
+        if (m_bStopScanning) {
+            return;
+        }
+        if (region.Perms.empty() || region.Perms[0] != 'r' || region.Path == "[vvar]" || region.Path == "[vsyscall]") {
+            continue;
+        }
+
+        // 파일에서 바뀐 페이지가 없는 매핑은 파일 판정으로 대신함
+        bool bFileBacked = region.Inode != 0 && !region.Path.empty() && region.Path[0] == '/';
+        if (bFileBacked && region.DirtyKb == 0 && region.AnonymousKb == 0) {
+            // 같은 파일의 다른 영역은 처음 판정을 그대로 쓰고, 탐지는 처음 영역에서 한 번만 보고
+            auto key = std::make_pair(region.Device, region.Inode);
+            auto it = mapBackingFiles.find(key);
+            bool bFirst = it == mapBackingFiles.end();
+            if (bFirst) {
+                ST_BackingFileVerdict verdict = {};
+                verdict.Checked = CheckBackingFile(pid, region, verdict.DetectionCause);
+                it = mapBackingFiles.emplace(key, std::move(verdict)).first;
+            }
+            if (it->second.Checked) {
+                if (it->second.DetectionCause.empty()) {
+                    m_statistics.RegionsSkipped++;
+                } else if (bFirst) {
+                    AddDetection({pid, strCommand, FormatRegion(region), region.Path, it->second.DetectionCause, true});
+                }
+                continue;
+            }
+        }
+        // 해시 엔진은 파일 단위 판정만 의미가 있으므로 익명/수정된 메모리는 YARA 엔진에서만 검사
+        if (m_nScanType != YARA_RULE) {
+            continue;
+        }
+        // 한 번도 쓰이지 않은 익명 영역은 읽어도 0뿐이므로 건너뜀 (파일 매핑은 상주하지 않아도 파일 내용이 있음)
+        if (!bFileBacked && region.RssKb == 0 && region.SwapKb == 0) {
+            m_statistics.RegionsEmpty++;
+            continue;
+        }
+        ScanRegion(pid, strCommand, region, buffer);
+    }
+}
+
+// smaps는 매핑 줄 다음에 "이름: 값 kB" 형식의 필드가 이어짐
+bool CProcessScanner::ReadRegions(pid_t pid, std::vector<ST_MemoryRegion>& regions) {
+    std::ifstream smaps("/proc/" + std::to_string(pid) + "/smaps");
+    if (!smaps.is_open()) {
+        return false;
+    }
+    std::string strLine;
+    while (std::getline(smaps, strLine)) {
+        unsigned long ulStart = 0;
+        unsigned long ulEnd = 0;
+        char szPerms[5] = {};
+        unsigned long long ullOffset = 0;
+        unsigned int uMajor = 0;
+        unsigned int uMinor = 0;
+        unsigned long ulInode = 0;
+        int nPathOffset = 0;
+        if (sscanf(strLine.c_str(), "%lx-%lx %4s %llx %x:%x %lu %n", &ulStart, &ulEnd, szPerms, &ullOffset, &uMajor, &uMinor, &ulInode, &nPathOffset) >= 7) {
+            ST_MemoryRegion region = {};
+            region.Start = ulStart;
+            region.End = ulEnd;
+            region.Perms = szPerms;
+            region.Offset = ullOffset;
+            region.Device = makedev(uMajor, uMinor);
+            region.Inode = ulInode;
+            region.Path = nPathOffset > 0 ? Trim(strLine.substr(nPathOffset)) : "";
+            regions.push_back(region);
+            continue;
+        }
+        if (regions.empty()) {
+            continue;
+        }
+        unsigned long long ullValue = 0;
+        if (sscanf(strLine.c_str(), "Private_Dirty: %llu kB", &ullValue) == 1 || sscanf(strLine.c_str(), "Shared_Dirty: %llu kB", &ullValue) == 1) {
+            regions.back().DirtyKb += ullValue;
+        } else if (sscanf(strLine.c_str(), "Anonymous: %llu kB", &ullValue) == 1) {
+            regions.back().AnonymousKb = ullValue;
+        } else if (sscanf(strLine.c_str(), "Rss: %llu kB", &ullValue) == 1) {
+            regions.back().RssKb = ullValue;
+        } else if (sscanf(strLine.c_str(), "Swap: %llu kB", &ullValue) == 1) {
+            regions.back().SwapKb = ullValue;
+        }
+    }
+    // 커널 스레드는 매핑이 없음
+    return !regions.empty();
+}
+
+// 매핑된 파일을 프로세스의 루트 기준으로 열어 검사하고 (dev, inode, mtime, 크기)별로 판정을 기억
+// 파일이 지워졌거나 다른 파일로 바뀌어 inode가 다르면 false를 반환하여 메모리를 직접 검사하도록 함
+// 읽기 상한을 넘는 파일은 통째로 매핑하지 않고 false (메모리 검사에서 상한까지 읽음)
+bool CProcessScanner::CheckBackingFile(pid_t pid, const ST_MemoryRegion& region, std::string& detectionCause) {
+    if (region.Path.size() > 10 && region.Path.compare(region.Path.size() - 10, 10, " (deleted)") == 0) {
+        return false;
+    }
+    std::string strPath = "/proc/" + std::to_string(pid) + "/root" + region.Path;
+    struct stat fileStat;
+    if (stat(strPath.c_str(), &fileStat) != 0 || !S_ISREG(fileStat.st_mode) || fileStat.st_ino != region.Inode) {
+        return false;
+    }
+    if (fileStat.st_size > PROCESS_MAX_REGION_READ) {
+        return false;
+    }
+    ST_AccessKey key = {fileStat.st_dev, fileStat.st_ino,
+                        static_cast<int64_t>(fileStat.st_mtim.tv_sec) * 1000000000LL + fileStat.st_mtim.tv_nsec,
+                        static_cast<int64_t>(fileStat.st_ctim.tv_sec) * 1000000000LL + fileStat.st_ctim.tv_nsec, fileStat.st_size};
+    {
+        std::lock_guard<std::mutex> lock(m_verdictMutex);
+        auto it = m_mapFileVerdicts.find(key);
+        if (it != m_mapFileVerdicts.end()) {
+            detectionCause = it->second;
+            return true;
+        }
+    }
+
+    // 여러 작업자가 같은 라이브러리를 동시에 처음 만나면 중복 검사될 수 있으나 판정은 같으므로 잠금 밖에서 검사
+    CMappedFile file;
+    int nResult = file.Open(strPath);
+    if (nResult == SUCCESS_CODE) {
+        nResult = file.Map();
+    }
+    if (nResult != SUCCESS_CODE || file.Stat().st_ino != region.Inode) {
+        return false;
+    }
+    std::string strCause;
+    ST_YaraExternals externals = CYaraChecker::MakeExternals(region.Path, &file.Stat(), file.Data(), file.Size());
+    if (m_engine->Scan(m_nScanType, region.Path, file.Data(), file.Size(), strCause, nullptr, &externals) != SUCCESS_CODE) {
+        return false;
+    }
+    m_statistics.FilesScanned++;
+
+    std::lock_guard<std::mutex> lock(m_verdictMutex);
+    m_mapFileVerdicts[key] = strCause;
+    detectionCause = strCause;
+    return true;
+}
+
+// 영역을 버퍼 크기 단위로 읽어 검사, 큰 익명 영역은 내용이 있는 페이지 구간만 읽음
+// 영역 하나에서 PROCESS_MAX_REGION_READ를 넘게 읽지 않으며, 넘으면 앞부분만 검사한 영역으로 집계
+void CProcessScanner::ScanRegion(pid_t pid, const std::string& command, const ST_MemoryRegion& region, std::vector<uint8_t>& buffer) {
+    std::ostringstream name;
+    name << pid << ":" << command << "@" << FormatRegion(region);
+    std::string strName = name.str();
+
+    // 공유 메모리(inode 있음)는 다른 프로세스가 쓴 페이지가 이 프로세스에 매핑되어 있지 않을 수 있어 구간을 고르지 않음
+    std::vector<std::pair<uintptr_t, uintptr_t>> vecRanges;
+    bool bSparse = region.Inode == 0 && region.End - region.Start > PROCESS_SPARSE_REGION_SIZE;
+    if (!bSparse || !ReadPopulatedRanges(pid, region, vecRanges)) {
+        vecRanges.assign(1, {region.Start, region.End});
+    }
+    uint64_t ullBytesRead = 0;
+    for (const auto& range : vecRanges) {
+        if (!ScanRange(pid, command, region, strName, range.first, range.second, buffer, ullBytesRead)) {
+            break;
+        }
+    }
+    m_statistics.RegionsScanned++;
+}
+
+// 구간을 버퍼 크기 단위로 읽어 검사, 다음 청크는 경계에 걸친 문자열을 위해 앞 청크 끝부분과 겹치게 읽음
+// 읽을 수 없는 페이지(가드 페이지 등)를 만나면 읽은 부분까지만 검사하고 다음 청크로 넘어감
+// 탐지했거나 프로세스를 더 읽을 수 없거나 읽기 상한에 걸리면 false를 반환하여 영역의 나머지를 건너뜀
+bool CProcessScanner::ScanRange(pid_t pid, const std::string& command, const ST_MemoryRegion& region, const std::string& name, uintptr_t start, uintptr_t end,
+                                std::vector<uint8_t>& buffer, uint64_t& bytesRead) {
+    uintptr_t address = start;
+    while (address < end && !m_bStopScanning) {
+        if (bytesRead >= PROCESS_MAX_REGION_READ) {
+            m_statistics.RegionsOversized++;
+            return false;
+        }
+        size_t siLength = std::min<size_t>(buffer.size(), end - address);
+        struct iovec local = {buffer.data(), siLength};
+        struct iovec remote = {reinterpret_cast<void*>(address), siLength};
+        errno = 0;
+        ssize_t nRead = process_vm_readv(pid, &local, 1, &remote, 1, 0);
+        if (nRead <= 0) {
+            if (errno == ESRCH || errno == EPERM) {
+                return false; // 프로세스가 종료되었거나 ptrace 권한이 없음
+            }
+            address += siLength;
+            continue;
+        }
+        m_statistics.BytesRead += nRead;
+        bytesRead += nRead;
+
+        std::string strCause;
+        m_engine->Scan(m_nScanType, name, buffer.data(), nRead, strCause);
+        if (!strCause.empty()) {
+            AddDetection({pid, command, FormatRegion(region), region.Path, strCause, false});
+            return false; // 영역당 한 번만 보고
+        }
+        if (static_cast<size_t>(nRead) < siLength || address + nRead >= end) {
+            address += siLength;
+        } else {
+            address += nRead - PROCESS_CHUNK_OVERLAP;
+        }
+    }
+    return !m_bStopScanning;
+}
+
+// pagemap 항목(페이지당 8바이트)의 63번 비트는 메모리에 있음, 62번 비트는 스왑됨을 뜻함
+// 둘 다 없는 페이지는 쓰인 적이 없어 0으로만 읽히므로, 둘 중 하나라도 있는 연속 페이지를 구간으로 모음
+bool CProcessScanner::ReadPopulatedRanges(pid_t pid, const ST_MemoryRegion& region, std::vector<std::pair<uintptr_t, uintptr_t>>& ranges) {
+    int fd = open(("/proc/" + std::to_string(pid) + "/pagemap").c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return false;
+    }
+    uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    std::vector<uint64_t> vecEntries(PROCESS_PAGEMAP_BATCH);
+    uintptr_t page = region.Start;
+    while (page < region.End) {
+        size_t siCount = std::min<size_t>(vecEntries.size(), (region.End - page) / pageSize);
+        ssize_t nRead = pread(fd, vecEntries.data(), siCount * sizeof(uint64_t), static_cast<off_t>(page / pageSize * sizeof(uint64_t)));
+        if (nRead < static_cast<ssize_t>(sizeof(uint64_t))) {
+            close(fd);
+            return false;
+        }
+        for (size_t i = 0; i < static_cast<size_t>(nRead) / sizeof(uint64_t); i++, page += pageSize) {
+            if ((vecEntries[i] & (3ULL << 62)) == 0) {
+                continue;
+            }
+            if (!ranges.empty() && ranges.back().second == page) {
+                ranges.back().second += pageSize;
+            } else {
+                ranges.emplace_back(page, page + pageSize);
+            }
+        }
+    }
+    close(fd);
+    return true;
+}
+
+void CProcessScanner::AddDetection(const ST_ProcessDetection& detection) {
+    {
+        std::lock_guard<std::mutex> lock(m_detectionMutex);
+        m_vecDetections.push_back(detection);
+    }
+    std::cout << COLOR_RED << "[+] Malicious memory in pid " << detection.Pid << " (" << detection.Command << ") at " << detection.Region
+              << (detection.MappedPath.empty() ? "" : " " + detection.MappedPath) << " : " << detection.DetectionCause << COLOR_RESET << "\n";
+
+    Json::Value logEntry;
+    logEntry["timestamp"] = GetCurrentTimeWithMilliseconds();
+    logEntry["scan_type"] = m_nScanType == YARA_RULE ? "Yara" : "Hash";
+    logEntry["detected_file"] = detection.MappedPath.empty() ? "N/A" : detection.MappedPath;
+    logEntry["hash_value"] = m_nScanType == HASH_COMPARISON ? detection.DetectionCause : "N/A";
+    logEntry["yara_rule"] = m_nScanType == YARA_RULE ? detection.DetectionCause : "N/A";
+    logEntry["is_moved"] = "False";
+    logEntry["path_after_moving"] = "N/A";
+    logEntry["pid"] = detection.Pid;
+    logEntry["process"] = detection.Command;
+    logEntry["memory_region"] = detection.Region;
+    logEntry["from_backing_file"] = detection.FromBackingFile;
+    CJsonLogWriter::Instance().Append(logEntry, LOG_FILE_PATH);
+}
+
+void CProcessScanner::PrintResult(double elapsedSec) {
+    std::cout << "\n- Process Memory Scan Result -\n\n";
+    if (m_vecDetections.empty()) {
+        std::cout << COLOR_GREEN << "[+] No malicious memory found" << COLOR_RESET << "\n";
+    } else {
+        std::cout << COLOR_RED << "[+] Total Malicious Regions : " << m_vecDetections.size() << COLOR_RESET << "\n";
+        for (size_t i = 0; i < m_vecDetections.size(); i++) {
+            const ST_ProcessDetection& detection = m_vecDetections[i];
+            std::cout << COLOR_RED << "[" << i + 1 << "] : pid " << detection.Pid << " (" << detection.Command << ") " << detection.Region
+                      << " " << detection.DetectionCause << COLOR_RESET << "\n";
+        }
+    }
+    std::cout << "\n[+] Processes : " << m_statistics.Processes.load() << " scanned, " << m_statistics.Inaccessible.load() << " inaccessible\n";
+    std::cout << "[+] Regions : " << m_statistics.RegionsScanned.load() << " scanned, " << m_statistics.RegionsSkipped.load()
+              << " skipped (clean file-backed), " << m_statistics.RegionsEmpty.load() << " empty, "
+              << m_statistics.RegionsOversized.load() << " partially scanned (over read limit)\n";
+    std::cout << "[+] Memory read : " << std::fixed << std::setprecision(1) << m_statistics.BytesRead.load() / (1024.0 * 1024.0) << " MB, "
+              << m_statistics.FilesScanned.load() << " mapped files verified\n";
+    std::cout << "[+] Wall-clock time : " << std::setprecision(3) << elapsedSec << " sec ("
+              << std::setprecision(1) << (elapsedSec > 0 ? m_statistics.Processes.load() / elapsedSec : 0.0) << " processes/sec)\n";
+    std::cout.unsetf(std::ios::fixed);
+}
+
+int CProcessScanner::WriteSummary(double elapsedSec) {
+    Json::Value summary;
+    summary["timestamp"] = GetCurrentTimeWithMilliseconds();
+    summary["scan_type"] = m_nScanType == YARA_RULE ? "Yara" : "Hash";
+    summary["interrupted"] = m_bStopScanning.load();
+    summary["workers"] = m_nWorkerCount;
+    summary["processes_scanned"] = Json::UInt64(m_statistics.Processes.load());
+    summary["processes_inaccessible"] = Json::UInt64(m_statistics.Inaccessible.load());
+    summary["regions_scanned"] = Json::UInt64(m_statistics.RegionsScanned.load());
+    summary["regions_skipped_clean"] = Json::UInt64(m_statistics.RegionsSkipped.load());
+    summary["regions_empty"] = Json::UInt64(m_statistics.RegionsEmpty.load());
+    summary["regions_oversized"] = Json::UInt64(m_statistics.RegionsOversized.load());
+    summary["mapped_files_scanned"] = Json::UInt64(m_statistics.FilesScanned.load());
+    summary["bytes_read"] = Json::UInt64(m_statistics.BytesRead.load());
+    summary["scan_time_sec"] = elapsedSec;
+    summary["processes_per_sec"] = elapsedSec > 0 ? m_statistics.Processes.load() / elapsedSec : 0.0;
+    summary["detection_count"] = Json::UInt64(m_vecDetections.size());
+
+    Json::Value detections(Json::arrayValue);
+    for (const ST_ProcessDetection& detection : m_vecDetections) {
+        Json::Value entry;
+        entry["pid"] = detection.Pid;
+        entry["process"] = detection.Command;
+        entry["memory_region"] = detection.Region;
+        entry["mapped_path"] = detection.MappedPath;
+        entry["detection_cause"] = detection.DetectionCause;
+        entry["from_backing_file"] = detection.FromBackingFile;
+        detections.append(entry);
+    }
+    summary["detections"] = detections;
+
+    std::ofstream summaryFile(m_strSummaryPath, std::ios::out | std::ios::trunc);
+    if (!summaryFile.is_open()) {
+        PrintErrorMessage(ERROR_CANNOT_OPEN_FILE, m_strSummaryPath);
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+    Json::StreamWriterBuilder writer;
+    summaryFile << Json::writeString(writer, summary) << "\n";
+    if (!summaryFile.good()) {
+        return ERROR_CANNOT_WRITE_FILE;
+    }
+    std::cout << "[+] Summary saved to " << m_strSummaryPath << "\n";
+    return SUCCESS_CODE;
+}
+
+std::string CProcessScanner::GetCommand(pid_t pid) {
+    std::ifstream comm("/proc/" + std::to_string(pid) + "/comm");
+    std::string strCommand;
+    std::getline(comm, strCommand);
+    return strCommand.empty() ? "?" : strCommand;
+}
+
+std::string CProcessScanner::FormatRegion(const ST_MemoryRegion& region) {
+    std::ostringstream stream;
+    stream << std::hex << region.Start << "-" << region.End;
+    return stream.str();
+}
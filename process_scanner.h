@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <sys/types.h>
+#include "access_guard.h"
+#include "engine_manager.h"
+
+#define PROCESS_READ_CHUNK (16 * 1024 * 1024)          // 작업자마다 재사용하는 읽기 버퍼 크기, 큰 영역은 이 단위로 나눠 검사
+#define PROCESS_CHUNK_OVERLAP 4096                     // 청크 경계에 걸친 문자열을 놓치지 않도록 다음 청크에 겹쳐 읽는 크기
+#define PROCESS_MAX_REGION_READ (1024LL * 1024 * 1024)   // 영역 하나에서 읽는 최대 바이트, 넘으면 앞부분만 검사 (매핑 파일 판정도 이 크기까지만)
+#define PROCESS_SPARSE_REGION_SIZE (256LL * 1024 * 1024) // 이보다 큰 익명 영역(JVM 힙 예약 등)은 pagemap으로 내용이 있는 페이지만 골라 읽음
+#define PROCESS_PAGEMAP_BATCH 4096                        // pagemap을 한 번에 읽는 항목(페이지) 수
+
+// /proc/<pid>/smaps의 매핑 하나
+struct ST_MemoryRegion {
+    uintptr_t Start;
+    uintptr_t End;
+    std::string Perms;
+    uint64_t Offset;
+    dev_t Device;
+    ino_t Inode;
+    std::string Path;         // 파일 매핑이면 파일 경로, 익명이면 비어있거나 [heap]/[stack] 등
+    uint64_t DirtyKb;         // Private_Dirty + Shared_Dirty, 0이면 파일 내용에서 바뀐 페이지가 없음
+    uint64_t AnonymousKb;     // 파일 매핑 안에서 쓰기로 복사된(COW) 페이지
+    uint64_t RssKb;           // 메모리에 있는 페이지
+    uint64_t SwapKb;          // 스왑으로 나간 페이지
+};
+
+// 한 프로세스 안에서 이미 판정한 매핑 파일 (라이브러리 하나가 권한별로 여러 영역에 매핑되므로 (dev, inode)로 한 번만 확인)
+struct ST_BackingFileVerdict {
+    bool Checked;             // false면 파일로 판정하지 못해 메모리를 직접 검사해야 함
+    std::string DetectionCause;
+};
+
+struct ST_ProcessDetection {
+    pid_t Pid;
+    std::string Command;
+    std::string Region;       // 시작-끝 주소
+    std::string MappedPath;
+    std::string DetectionCause;
+    bool FromBackingFile;     // 메모리가 아니라 매핑된 파일 자체가 탐지된 경우
+};
+
+struct ST_ProcessScanStatistics {
+    std::atomic<uint64_t> Processes{0};
+    std::atomic<uint64_t> Inaccessible{0};     // 이미 종료되었거나 권한이 없어 읽지 못한 프로세스
+    std::atomic<uint64_t> RegionsScanned{0};
+    std::atomic<uint64_t> RegionsSkipped{0};   // 깨끗한 파일과 내용이 같은 매핑
+    std::atomic<uint64_t> RegionsEmpty{0};     // 메모리에도 스왑에도 페이지가 없어 0으로만 읽히는 익명 영역
+    std::atomic<uint64_t> RegionsOversized{0}; // 읽기 상한에 걸려 앞부분만 검사한 영역
+    std::atomic<uint64_t> BytesRead{0};
+    std::atomic<uint64_t> FilesScanned{0};     // 매핑 판정을 위해 검사한 파일 (같은 파일은 한 번만)
+};
+
+// 실행 중인 프로세스의 메모리를 검사하여 디스크에 남지 않는(fileless) 악성코드를 탐지
+// 작업자 풀이 프로세스를 하나씩 가져가 smaps로 매핑을 읽고, process_vm_readv로 작업자별 버퍼에 복사한 뒤 엔진으로 검사
+// 디스크 파일과 내용이 같은 매핑은 파일을 한 번 검사하여 깨끗하면 메모리 검사를 생략 (공유 라이브러리는 전체에서 한 번)
+class CProcessScanner {
+public:
+    static std::atomic<bool> m_bStopScanning;
+
+    CProcessScanner(int workerCount, int scanType, const std::string& summaryPath);
+    int Run();
+
+    CProcessScanner(const CProcessScanner&) = delete;
+    CProcessScanner& operator=(const CProcessScanner&) = delete;
+
+private:
+    int m_nWorkerCount;
+    int m_nScanType;
+    std::string m_strSummaryPath;
+    CEngineManager m_engineManager;
+    std::shared_ptr<const ST_EngineSnapshot> m_engine;
+
+    std::vector<pid_t> m_vecPids;
+    std::atomic<size_t> m_siNextPid;
+    std::unordered_map<ST_AccessKey, std::string, ST_AccessKeyHash> m_mapFileVerdicts; // 파일 키 -> 탐지 원인 (깨끗하면 빈 문자열)
+    std::mutex m_verdictMutex;
+    std::vector<ST_ProcessDetection> m_vecDetections;
+    std::mutex m_detectionMutex;
+    ST_ProcessScanStatistics m_statistics;
+
+    int CollectProcesses();
+    void RunWorker();
+    void ScanProcess(pid_t pid, std::vector<uint8_t>& buffer);
+    bool ReadRegions(pid_t pid, std::vector<ST_MemoryRegion>& regions);
+    bool CheckBackingFile(pid_t pid, const ST_MemoryRegion& region, std::string& detectionCause);
+    void ScanRegion(pid_t pid, const std::string& command, const ST_MemoryRegion& region, std::vector<uint8_t>& buffer);
+    bool ScanRange(pid_t pid, const std::string& command, const ST_MemoryRegion& region, const std::string& name, uintptr_t start, uintptr_t end,
+                   std::vector<uint8_t>& buffer, uint64_t& bytesRead);
+    static bool ReadPopulatedRanges(pid_t pid, const ST_MemoryRegion& region, std::vector<std::pair<uintptr_t, uintptr_t>>& ranges);
+    void AddDetection(const ST_ProcessDetection& detection);
+    void PrintResult(double elapsedSec);
+    int WriteSummary(double elapsedSec);
+    static std::string GetCommand(pid_t pid);
+    static std::string FormatRegion(const ST_MemoryRegion& region);
+};
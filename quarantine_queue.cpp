@@ -0,0 +1,274 @@
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "quarantine_queue.h"
+#include "util.h"
+
+CQuarantineQueue::CQuarantineQueue(const std::string& destinationDir, int workerCount)
+    : m_strDestinationDir(destinationDir), m_nWorkerCount(workerCount > 0 ? workerCount : 1), m_bClosing(false) {}
+
+CQuarantineQueue::~CQuarantineQueue() {
+    Finish();
+}
+
+int CQuarantineQueue::Start() {
+    if (!IsDirectory(m_strDestinationDir)) {
+        if (mkdir(m_strDestinationDir.c_str(), 0700) != 0 && errno != EEXIST) {  // 관리자만 접근 가능
+            return ERROR_CANNOT_OPEN_DIRECTORY;
+        }
+    }
+    m_strDestinationDir = GetAbsolutePath(m_strDestinationDir);
+    m_pVault.reset(new CQuarantineVault(m_strDestinationDir));
+    if (m_pVault->Open() != SUCCESS_CODE) {
+        PrintErrorMessage(ERROR_DATABASE_GENERAL, "Quarantine vault unavailable, moving files without deduplication");
+        m_pVault.reset();
+    }
+    for (int i = 0; i < m_nWorkerCount; i++) {
+        m_vecWorkers.emplace_back(&CQuarantineQueue::RunWorker, this);
+    }
+    return SUCCESS_CODE;
+}
+
+void CQuarantineQueue::Submit(const std::string& sourcePath, const std::string& scanType, const std::string& detectionCause) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_setSubmitted.insert(sourcePath).second) {
+            return;
+        }
+        m_queTasks.push_back({sourcePath, scanType, detectionCause});
+    }
+    m_condition.notify_one();
+}
+
+// 남은 작업을 모두 처리한 뒤 작업 스레드 종료
+void CQuarantineQueue::Finish() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bClosing = true;
+    }
+    m_condition.notify_all();
+    for (std::thread& worker : m_vecWorkers) {
+        worker.join();
+    }
+    m_vecWorkers.clear();
+}
+
+bool CQuarantineQueue::GetResult(const std::string& sourcePath, ST_QuarantineResult& result) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_mapResults.find(sourcePath);
+    if (it == m_mapResults.end()) {
+        return false;
+    }
+    result = it->second;
+    return true;
+}
+
+void CQuarantineQueue::RunWorker() {
+    CScanProfiler profiler;
+    while (true) {
+        ST_QuarantineTask task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_bClosing || !m_queTasks.empty(); });
+            if (m_queTasks.empty()) {
+                break;
+            }
+            task = std::move(m_queTasks.front());
+            m_queTasks.pop_front();
+        }
+
+        ST_QuarantineResult result = {SUCCESS_CODE, "", QUARANTINE_RENAME, 0};
+        {
+            CScopedTimer timer(&profiler, PHASE_QUARANTINE);
+            if (m_pVault) {
+                ST_VaultEntry entry;
+                bool bDeduplicated = false;
+                result.Result = m_pVault->Store(task.SourcePath, task.ScanType, task.DetectionCause, entry, bDeduplicated);
+                result.Destination = m_pVault->GetObjectPath(entry.Sha256);
+                result.Method = bDeduplicated ? QUARANTINE_VAULT_DEDUP : QUARANTINE_VAULT;
+                result.VaultId = entry.Id;
+            } else {
+                result.Result = QuarantineFile(task.SourcePath, m_strDestinationDir, result);
+            }
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_mapResults[task.SourcePath] = result;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_profiler.Merge(profiler);
+}
+
+// 이동 방법별 건수와 스캔 종료 후 추가로 기다린 시간 출력
+void CQuarantineQueue::PrintStatistics(double waitMs) const {
+    static const char* methodNames[QUARANTINE_METHOD_COUNT] = {"rename", "reflink", "copy_file_range", "read/write", "vault", "deduplicated"};
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t arrCounts[QUARANTINE_METHOD_COUNT] = {};
+    size_t siFailed = 0;
+    for (const auto& entry : m_mapResults) {
+        if (entry.second.Result == SUCCESS_CODE) {
+            arrCounts[entry.second.Method]++;
+        } else {
+            siFailed++;
+        }
+    }
+    std::cout << "\n[+] Quarantined " << m_mapResults.size() - siFailed << " files (";
+    for (int i = 0; i < QUARANTINE_METHOD_COUNT; i++) {
+        std::cout << (i ? ", " : "") << methodNames[i] << " " << arrCounts[i];
+    }
+    std::cout << "), " << siFailed << " failed, waited " << std::fixed << std::setprecision(1) << waitMs << " ms after scan\n";
+
+    ST_VaultStatistics statistics;
+    if (m_pVault && m_pVault->GetStatistics(statistics) == SUCCESS_CODE) {
+        std::cout << "[+] Vault: " << statistics.ObjectCount << " unique samples for " << statistics.EntryCount << " detections, "
+                  << statistics.StoredBytes << " bytes stored for " << statistics.OriginalBytes << " bytes detected\n";
+    }
+}
+
+int CQuarantineQueue::SyncDirectory(const std::string& directory) {
+    int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd == -1) {
+        return ERROR_CANNOT_OPEN_DIRECTORY;
+    }
+    int nResult = fsync(fd) == 0 ? SUCCESS_CODE : ERROR_CANNOT_WRITE_FILE;
+    close(fd);
+    return nResult;
+}
+
+// FICLONE -> copy_file_range -> read/write 순서로 시도, 앞의 방법이 지원되지 않을 때만 다음 방법 사용
+int CQuarantineQueue::CopyAcrossDevices(int sourceFd, int destinationFd, uint64_t size, int& method) {
+    if (ioctl(destinationFd, FICLONE, sourceFd) == 0) {
+        method = QUARANTINE_REFLINK;
+        return SUCCESS_CODE;
+    }
+
+    method = QUARANTINE_COPY_RANGE;
+    uint64_t ullCopied = 0;
+    while (ullCopied < size) {
+        ssize_t n = copy_file_range(sourceFd, nullptr, destinationFd, nullptr, QUARANTINE_COPY_CHUNK, 0);
+        if (n > 0) {
+            ullCopied += static_cast<uint64_t>(n);
+            continue;
+        }
+        if (n == 0) {
+            break; // 복사 중 원본이 줄어든 경우
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (ullCopied == 0 && (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP)) {
+            method = QUARANTINE_READ_WRITE;
+            break;
+        }
+        return ERROR_CANNOT_WRITE_FILE;
+    }
+    if (method == QUARANTINE_COPY_RANGE) {
+        return SUCCESS_CODE;
+    }
+
+    std::vector<char> vecBuffer(QUARANTINE_COPY_CHUNK);
+    while (true) {
+        ssize_t nRead = read(sourceFd, vecBuffer.data(), vecBuffer.size());
+        if (nRead < 0 && errno == EINTR) {
+            continue;
+        }
+        if (nRead < 0) {
+            return ERROR_CANNOT_OPEN_FILE;
+        }
+        if (nRead == 0) {
+            return SUCCESS_CODE;
+        }
+        for (ssize_t nWritten = 0; nWritten < nRead;) {
+            ssize_t n = write(destinationFd, vecBuffer.data() + nWritten, nRead - nWritten);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0) {
+                return ERROR_CANNOT_WRITE_FILE;
+            }
+            nWritten += n;
+        }
+    }
+}
+
+// 파일 하나를 격리 디렉토리로 옮기고 읽기 전용으로 만듦, 같은 이름이 있으면 덮어쓰지 않고 번호를 붙임
+int CQuarantineQueue::QuarantineFile(const std::string& sourcePath, const std::string& destinationDir, ST_QuarantineResult& result) {
+    std::string strFileName = sourcePath.substr(sourcePath.find_last_of('/') + 1);
+    std::string strDestination;
+    result.Method = QUARANTINE_RENAME;
+
+    bool bCrossDevice = false;
+    for (int i = 0; i < QUARANTINE_MAX_NAME_TRIES && !bCrossDevice; i++) {
+        strDestination = destinationDir + "/" + strFileName + (i ? "." + std::to_string(i) : "");
+        if (renameat2(AT_FDCWD, sourcePath.c_str(), AT_FDCWD, strDestination.c_str(), RENAME_NOREPLACE) == 0) {
+            if (chmod(strDestination.c_str(), S_IRUSR) != 0) {
+                return ERROR_CANNOT_CHANGE_PERMISSIONS;
+            }
+            result.Destination = strDestination;
+            return SyncDirectory(destinationDir);
+        }
+        if (errno == EXDEV) {
+            bCrossDevice = true;
+        } else if (errno == EINVAL && access(strDestination.c_str(), F_OK) != 0) {
+            // RENAME_NOREPLACE를 지원하지 않는 파일시스템
+            if (rename(sourcePath.c_str(), strDestination.c_str()) == 0) {
+                if (chmod(strDestination.c_str(), S_IRUSR) != 0) {
+                    return ERROR_CANNOT_CHANGE_PERMISSIONS;
+                }
+                result.Destination = strDestination;
+                return SyncDirectory(destinationDir);
+            }
+            bCrossDevice = errno == EXDEV;
+        }
+        if (!bCrossDevice && errno != EEXIST && errno != EINVAL) {
+            return ERROR_CANNOT_MOVE_FILE;
+        }
+    }
+    if (!bCrossDevice) {
+        return ERROR_CANNOT_MOVE_FILE;
+    }
+
+    // 다른 파일시스템: 새 파일에 복사하고 디스크에 반영된 뒤에만 원본 삭제
+    int sourceFd = open(sourcePath.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (sourceFd == -1) {
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+    struct stat sourceStat;
+    if (fstat(sourceFd, &sourceStat) != 0) {
+        close(sourceFd);
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+    int destinationFd = -1;
+    for (int i = 0; i < QUARANTINE_MAX_NAME_TRIES && destinationFd == -1; i++) {
+        strDestination = destinationDir + "/" + strFileName + (i ? "." + std::to_string(i) : "");
+        destinationFd = open(strDestination.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, S_IRUSR | S_IWUSR);
+        if (destinationFd == -1 && errno != EEXIST) {
+            break;
+        }
+    }
+    if (destinationFd == -1) {
+        close(sourceFd);
+        return ERROR_CANNOT_MOVE_FILE;
+    }
+
+    int nResult = CopyAcrossDevices(sourceFd, destinationFd, static_cast<uint64_t>(sourceStat.st_size), result.Method);
+    if (nResult == SUCCESS_CODE && (fchmod(destinationFd, S_IRUSR) != 0 || fsync(destinationFd) != 0)) {
+        nResult = ERROR_CANNOT_WRITE_FILE;
+    }
+    close(destinationFd);
+    close(sourceFd);
+    if (nResult == SUCCESS_CODE) {
+        nResult = SyncDirectory(destinationDir);
+    }
+    if (nResult != SUCCESS_CODE) {
+        unlink(strDestination.c_str());
+        return nResult;
+    }
+    result.Destination = strDestination;
+    return unlink(sourcePath.c_str()) == 0 ? SUCCESS_CODE : ERROR_CANNOT_REMOVE_FILE;
+}
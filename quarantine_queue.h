@@ -0,0 +1,80 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include "quarantine_vault.h"
+#include "scan_profiler.h"
+
+#define QUARANTINE_WORKER_COUNT 4           // 격리 작업 스레드 수
+#define QUARANTINE_COPY_CHUNK (1 << 20)     // copy_file_range / read-write 한 번에 복사하는 크기
+#define QUARANTINE_MAX_NAME_TRIES 1000      // 같은 이름이 있을 때 name.1, name.2 ... 로 시도하는 최대 횟수
+
+// 격리 파일을 옮긴 방법 (rename이 EXDEV로 실패하면 아래 순서로 시도)
+enum EQuarantineMethod {
+    QUARANTINE_RENAME = 0,
+    QUARANTINE_REFLINK,          // ioctl(FICLONE), 같은 파일시스템의 다른 마운트 지점 사이
+    QUARANTINE_COPY_RANGE,       // copy_file_range, 커널 안에서 복사
+    QUARANTINE_READ_WRITE,       // 위 방법을 지원하지 않는 파일시스템
+    QUARANTINE_VAULT,            // 보관소에 새 샘플로 압축 저장
+    QUARANTINE_VAULT_DEDUP,      // 이미 보관된 샘플, 인덱스 기록만 추가
+    QUARANTINE_METHOD_COUNT
+};
+
+struct ST_QuarantineResult {
+    int Result;
+    std::string Destination;     // 격리된 파일의 절대 경로 (보관소는 압축 객체 경로)
+    int Method;
+    int64_t VaultId;             // 보관소 기록 id (--vault-restore 인자), 보관소를 쓰지 않으면 0
+};
+
+struct ST_QuarantineTask {
+    std::string SourcePath;
+    std::string ScanType;
+    std::string DetectionCause;
+};
+
+// 탐지된 파일을 작업 스레드들이 격리 디렉토리로 옮기는 큐
+// 스캔 중 탐지되는 즉시 넣으면 스캔과 격리가 겹쳐서 진행되고, Finish()에서 남은 작업을 기다림
+// 탐지 파일은 보관소(CQuarantineVault)에 SHA-256 기준으로 한 번만 저장하고, 보관소를 열 수 없을 때만 파일을 그대로 옮김
+// 다른 파일시스템으로 옮길 때는 복사 -> fsync -> 원본 삭제 순서로 처리하여 중간에 중단되어도 원본이 남음
+class CQuarantineQueue {
+public:
+    CQuarantineQueue(const std::string& destinationDir, int workerCount = QUARANTINE_WORKER_COUNT);
+    ~CQuarantineQueue();
+    int Start();
+    void Submit(const std::string& sourcePath, const std::string& scanType = "", const std::string& detectionCause = "");
+    void Finish();
+    bool GetResult(const std::string& sourcePath, ST_QuarantineResult& result) const;
+    const CScanProfiler& GetProfiler() const { return m_profiler; }
+    void PrintStatistics(double waitMs) const;
+
+    static int QuarantineFile(const std::string& sourcePath, const std::string& destinationDir, ST_QuarantineResult& result);
+
+    CQuarantineQueue(const CQuarantineQueue&) = delete;
+    CQuarantineQueue& operator=(const CQuarantineQueue&) = delete;
+
+private:
+    std::string m_strDestinationDir;
+    int m_nWorkerCount;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<ST_QuarantineTask> m_queTasks;
+    std::unordered_set<std::string> m_setSubmitted;    // 압축 파일의 여러 멤버가 탐지되어도 컨테이너는 한 번만 이동
+    std::map<std::string, ST_QuarantineResult> m_mapResults;
+    std::vector<std::thread> m_vecWorkers;
+    bool m_bClosing;
+    std::unique_ptr<CQuarantineVault> m_pVault;
+    CScanProfiler m_profiler;                          // 작업 스레드가 끝날 때 각자의 기록을 합침
+
+    void RunWorker();
+    static int CopyAcrossDevices(int sourceFd, int destinationFd, uint64_t size, int& method);
+    static int SyncDirectory(const std::string& directory);
+};
@@ -0,0 +1,542 @@
+#include <cerrno>
+#include <fcntl.h>
+#include <iostream>
+#include <openssl/evp.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+#include "ansi_color.h"
+#include "quarantine_vault.h"
+#include "util.h"
+
+// 디렉토리 항목(새 객체 이름) 변경을 디스크에 반영
+static int SyncVaultDirectory(const std::string& directory) {
+    int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd == -1) {
+        return ERROR_CANNOT_OPEN_DIRECTORY;
+    }
+    int nResult = fsync(fd) == 0 ? SUCCESS_CODE : ERROR_CANNOT_WRITE_FILE;
+    close(fd);
+    return nResult;
+}
+
+static std::string ToHex(const unsigned char* digest, unsigned int length) {
+    static const char chHexDigits[] = "0123456789abcdef";
+    std::string strHex(length * 2, '0');
+    for (unsigned int i = 0; i < length; i++) {
+        strHex[i * 2] = chHexDigits[digest[i] >> 4];
+        strHex[i * 2 + 1] = chHexDigits[digest[i] & 0x0f];
+    }
+    return strHex;
+}
+
+static bool IsSha256(const std::string& value) {
+    if (value.size() != 64) {
+        return false;
+    }
+    for (char ch : value) {
+        if (!((ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'f'))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// NULL 열은 sqlite3_column_text가 nullptr을 반환하므로 빈 문자열로 바꿈
+static std::string ColumnText(sqlite3_stmt* stmt, int column) {
+    const unsigned char* pText = sqlite3_column_text(stmt, column);
+    return pText ? std::string(reinterpret_cast<const char*>(pText)) : std::string();
+}
+
+static bool WriteAll(int fd, const uint8_t* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = write(fd, data, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+CQuarantineVault::CQuarantineVault(const std::string& vaultDir) : m_strVaultDir(vaultDir), m_pDb(nullptr) {}
+
+CQuarantineVault::~CQuarantineVault() {
+    if (m_pDb) {
+        sqlite3_close(m_pDb);
+    }
+}
+
+// 보관소 디렉토리와 인덱스를 열고, 없으면 새로 생성
+int CQuarantineVault::Open() {
+    std::string strObjectsDir = m_strVaultDir + "/" + VAULT_OBJECTS_DIR;
+    for (const std::string& directory : {m_strVaultDir, strObjectsDir}) {
+        if (mkdir(directory.c_str(), 0700) != 0 && errno != EEXIST) {  // 관리자만 접근 가능
+            return ERROR_CANNOT_OPEN_DIRECTORY;
+        }
+    }
+    m_strVaultDir = GetAbsolutePath(m_strVaultDir);
+
+    std::string strDatabasePath = m_strVaultDir + "/" + VAULT_DATABASE_NAME;
+    if (sqlite3_open(strDatabasePath.c_str(), &m_pDb) != SQLITE_OK) {
+        PrintErrorMessage(ERROR_DATABASE_GENERAL, "Can't open database: " + std::string(sqlite3_errmsg(m_pDb)));
+        return ERROR_DATABASE_GENERAL;
+    }
+    sqlite3_busy_timeout(m_pDb, 5000); // 스캔 중 다른 프로세스에서 목록을 조회하는 경우
+
+    const char* chSql = R"(
+        CREATE TABLE IF NOT EXISTS objects (
+            sha256 TEXT PRIMARY KEY,
+            file_size INTEGER,
+            stored_size INTEGER,
+            ref_count INTEGER,
+            first_seen TEXT
+        );
+
+        CREATE TABLE IF NOT EXISTS entries (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            sha256 TEXT,
+            original_path TEXT,
+            detected_at TEXT,
+            scan_type TEXT,
+            detection_cause TEXT,
+            file_size INTEGER,
+            mode INTEGER,
+            restored INTEGER DEFAULT 0
+        );
+
+        CREATE INDEX IF NOT EXISTS entries_sha256 ON entries (sha256);
+    )";
+    return ExecuteSQL(chSql);
+}
+
+std::string CQuarantineVault::GetObjectPath(const std::string& sha256) const {
+    return m_strVaultDir + "/" + VAULT_OBJECTS_DIR + "/" + sha256.substr(0, 2) + "/" + sha256 + VAULT_OBJECT_SUFFIX;
+}
+
+// 파일을 보관소에 넣고 원본 삭제
+// 해시만 먼저 계산하여 이미 있는 샘플이면 압축하지 않고 인덱스 기록만 추가 (같은 샘플이 대량으로 탐지되는 경우)
+int CQuarantineVault::Store(const std::string& sourcePath, const std::string& scanType, const std::string& detectionCause, ST_VaultEntry& entry, bool& deduplicated) {
+    deduplicated = false;
+    int sourceFd = open(sourcePath.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (sourceFd == -1) {
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+    struct stat sourceStat;
+    if (fstat(sourceFd, &sourceStat) != 0 || !S_ISREG(sourceStat.st_mode)) {
+        close(sourceFd);
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+
+    std::string strSha256;
+    EVP_MD_CTX* pContext = EVP_MD_CTX_new();
+    EVP_DigestInit_ex(pContext, EVP_sha256(), nullptr);
+    std::vector<uint8_t> vecBuffer(VAULT_IO_CHUNK);
+    ssize_t nRead;
+    while ((nRead = read(sourceFd, vecBuffer.data(), vecBuffer.size())) != 0) {
+        if (nRead < 0 && errno == EINTR) {
+            continue;
+        }
+        if (nRead < 0) {
+            break;
+        }
+        EVP_DigestUpdate(pContext, vecBuffer.data(), static_cast<size_t>(nRead));
+    }
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int nDigestLength = 0;
+    EVP_DigestFinal_ex(pContext, digest, &nDigestLength);
+    EVP_MD_CTX_free(pContext);
+    if (nRead < 0) {
+        close(sourceFd);
+        return ERROR_CANNOT_COMPUTE_HASH;
+    }
+    strSha256 = ToHex(digest, nDigestLength);
+
+    int64_t llStoredSize = -1;
+    int nResult = SUCCESS_CODE;
+    if (HasObject(strSha256)) {
+        deduplicated = true;
+    } else if (lseek(sourceFd, 0, SEEK_SET) != 0) {
+        nResult = ERROR_CANNOT_OPEN_FILE;
+    } else {
+        // 압축하면서 해시를 다시 계산하므로 두 번 읽는 사이에 파일이 바뀌어도 저장된 내용과 이름이 일치
+        nResult = WriteObject(sourceFd, strSha256, llStoredSize);
+    }
+    close(sourceFd);
+    if (nResult != SUCCESS_CODE) {
+        return nResult;
+    }
+
+    entry.Id = 0;
+    entry.Sha256 = strSha256;
+    entry.OriginalPath = sourcePath;
+    entry.DetectedAt = GetCurrentTimeWithMilliseconds();
+    entry.ScanType = scanType;
+    entry.DetectionCause = detectionCause;
+    entry.FileSize = sourceStat.st_size;
+    entry.Mode = sourceStat.st_mode & 07777;
+    entry.Restored = false;
+    nResult = AddEntry(entry, llStoredSize);
+    if (nResult != SUCCESS_CODE) {
+        return nResult;
+    }
+    // 객체와 인덱스가 모두 디스크에 반영된 뒤에만 원본 삭제
+    return unlink(sourcePath.c_str()) == 0 ? SUCCESS_CODE : ERROR_CANNOT_REMOVE_FILE;
+}
+
+bool CQuarantineVault::HasObject(const std::string& sha256) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    sqlite3_stmt* stmt;
+    if (!PrepareSQL("SELECT 1 FROM objects WHERE sha256 = ?", &stmt)) {
+        return false;
+    }
+    sqlite3_bind_text(stmt, 1, sha256.c_str(), -1, SQLITE_STATIC);
+    bool bFound = sqlite3_step(stmt) == SQLITE_ROW;
+    sqlite3_finalize(stmt);
+    return bFound && access(GetObjectPath(sha256).c_str(), F_OK) == 0;
+}
+
+// gzip으로 압축하여 임시 파일에 쓰고, fsync 후 최종 이름으로 연결
+// 같은 새 샘플을 두 작업 스레드가 동시에 저장해도 link()가 EEXIST로 실패한 쪽은 임시 파일만 지움
+int CQuarantineVault::WriteObject(int sourceFd, std::string& sha256, int64_t& storedSize) {
+    std::string strObjectsDir = m_strVaultDir + "/" + VAULT_OBJECTS_DIR;
+    std::string strTempPath = strObjectsDir + "/.tmp.XXXXXX";
+    int tempFd = mkostemp(&strTempPath[0], O_CLOEXEC);
+    if (tempFd == -1) {
+        return ERROR_CANNOT_WRITE_FILE;
+    }
+
+    z_stream stream = {};
+    if (deflateInit2(&stream, VAULT_COMPRESSION_LEVEL, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        close(tempFd);
+        unlink(strTempPath.c_str());
+        return ERROR_CANNOT_WRITE_FILE;
+    }
+    EVP_MD_CTX* pContext = EVP_MD_CTX_new();
+    EVP_DigestInit_ex(pContext, EVP_sha256(), nullptr);
+
+    std::vector<uint8_t> vecInput(VAULT_IO_CHUNK);
+    std::vector<uint8_t> vecOutput(VAULT_IO_CHUNK);
+    int nResult = SUCCESS_CODE;
+    int nFlush = Z_NO_FLUSH;
+    while (nResult == SUCCESS_CODE && nFlush != Z_FINISH) {
+        ssize_t nRead = read(sourceFd, vecInput.data(), vecInput.size());
+        if (nRead < 0 && errno == EINTR) {
+            continue;
+        }
+        if (nRead < 0) {
+            nResult = ERROR_CANNOT_OPEN_FILE;
+            break;
+        }
+        EVP_DigestUpdate(pContext, vecInput.data(), static_cast<size_t>(nRead));
+        nFlush = nRead == 0 ? Z_FINISH : Z_NO_FLUSH;
+        stream.next_in = vecInput.data();
+        stream.avail_in = static_cast<uInt>(nRead);
+        do {
+            stream.next_out = vecOutput.data();
+            stream.avail_out = static_cast<uInt>(vecOutput.size());
+            deflate(&stream, nFlush);
+            if (!WriteAll(tempFd, vecOutput.data(), vecOutput.size() - stream.avail_out)) {
+                nResult = ERROR_CANNOT_WRITE_FILE;
+                break;
+            }
+        } while (stream.avail_out == 0);
+    }
+    deflateEnd(&stream);
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int nDigestLength = 0;
+    EVP_DigestFinal_ex(pContext, digest, &nDigestLength);
+    EVP_MD_CTX_free(pContext);
+
+    struct stat tempStat;
+    if (nResult == SUCCESS_CODE && (fchmod(tempFd, S_IRUSR) != 0 || fsync(tempFd) != 0 || fstat(tempFd, &tempStat) != 0)) {
+        nResult = ERROR_CANNOT_WRITE_FILE;
+    }
+    close(tempFd);
+    if (nResult != SUCCESS_CODE) {
+        unlink(strTempPath.c_str());
+        return nResult;
+    }
+
+    sha256 = ToHex(digest, nDigestLength);
+    std::string strShardDir = strObjectsDir + "/" + sha256.substr(0, 2);
+    std::string strObjectPath = GetObjectPath(sha256);
+    if (mkdir(strShardDir.c_str(), 0700) != 0 && errno != EEXIST) {
+        unlink(strTempPath.c_str());
+        return ERROR_CANNOT_OPEN_DIRECTORY;
+    }
+    storedSize = tempStat.st_size;
+    if (link(strTempPath.c_str(), strObjectPath.c_str()) != 0) {
+        struct stat objectStat;
+        if (errno != EEXIST || stat(strObjectPath.c_str(), &objectStat) != 0) {
+            unlink(strTempPath.c_str());
+            return ERROR_CANNOT_WRITE_FILE;
+        }
+        storedSize = objectStat.st_size;
+    }
+    unlink(strTempPath.c_str());
+    return SyncVaultDirectory(strShardDir);
+}
+
+// 객체 참조 수 증가와 탐지 기록 추가를 한 트랜잭션으로 처리
+int CQuarantineVault::AddEntry(ST_VaultEntry& entry, int64_t storedSize) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (ExecuteSQL("BEGIN IMMEDIATE") != SUCCESS_CODE) {
+        return ERROR_DATABASE_GENERAL;
+    }
+
+    sqlite3_stmt* stmt;
+    bool bSuccess = PrepareSQL(R"(
+        INSERT INTO objects (sha256, file_size, stored_size, ref_count, first_seen)
+        VALUES (?, ?, ?, 1, ?)
+        ON CONFLICT(sha256) DO UPDATE SET ref_count = ref_count + 1;
+    )", &stmt);
+    if (bSuccess) {
+        sqlite3_bind_text(stmt, 1, entry.Sha256.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int64(stmt, 2, entry.FileSize);
+        sqlite3_bind_int64(stmt, 3, storedSize);
+        sqlite3_bind_text(stmt, 4, entry.DetectedAt.c_str(), -1, SQLITE_STATIC);
+        bSuccess = sqlite3_step(stmt) == SQLITE_DONE;
+        sqlite3_finalize(stmt);
+    }
+
+    if (bSuccess && (bSuccess = PrepareSQL(R"(
+        INSERT INTO entries (sha256, original_path, detected_at, scan_type, detection_cause, file_size, mode)
+        VALUES (?, ?, ?, ?, ?, ?, ?);
+    )", &stmt))) {
+        sqlite3_bind_text(stmt, 1, entry.Sha256.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 2, entry.OriginalPath.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 3, entry.DetectedAt.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 4, entry.ScanType.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 5, entry.DetectionCause.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int64(stmt, 6, entry.FileSize);
+        sqlite3_bind_int64(stmt, 7, entry.Mode);
+        bSuccess = sqlite3_step(stmt) == SQLITE_DONE;
+        sqlite3_finalize(stmt);
+        entry.Id = sqlite3_last_insert_rowid(m_pDb);
+    }
+
+    if (!bSuccess) {
+        PrintErrorMessage(ERROR_DATABASE_GENERAL, "Failed to add vault entry: " + std::string(sqlite3_errmsg(m_pDb)));
+        ExecuteSQL("ROLLBACK");
+        return ERROR_DATABASE_GENERAL;
+    }
+    return ExecuteSQL("COMMIT");
+}
+
+// 기록 id로 샘플을 찾아 원래 경로에 원래 권한(rwx 비트만)으로 복원, 이미 파일이 있으면 덮어쓰지 않음
+// 해시나 경로가 비었거나 형식이 맞지 않는 기록(손상되었거나 직접 수정된 인덱스)은 복원하지 않음
+int CQuarantineVault::Restore(int64_t entryId, std::string& restoredPath) {
+    ST_VaultEntry entry;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        sqlite3_stmt* stmt;
+        if (!PrepareSQL("SELECT sha256, original_path, mode FROM entries WHERE id = ?", &stmt)) {
+            return ERROR_DATABASE_GENERAL;
+        }
+        sqlite3_bind_int64(stmt, 1, entryId);
+        bool bFound = sqlite3_step(stmt) == SQLITE_ROW;
+        if (bFound) {
+            entry.Sha256 = ColumnText(stmt, 0);
+            entry.OriginalPath = ColumnText(stmt, 1);
+            entry.Mode = static_cast<uint32_t>(sqlite3_column_int64(stmt, 2));
+        }
+        sqlite3_finalize(stmt);
+        if (!bFound) {
+            return ERROR_FILE_NOT_FOUND;
+        }
+    }
+    if (!IsSha256(entry.Sha256) || entry.OriginalPath.empty() || entry.OriginalPath[0] != '/') {
+        PrintErrorMessage(ERROR_DATABASE_GENERAL, "Invalid vault entry " + std::to_string(entryId));
+        return ERROR_DATABASE_GENERAL;
+    }
+    restoredPath = entry.OriginalPath;
+
+    gzFile object = gzopen(GetObjectPath(entry.Sha256).c_str(), "rb");
+    if (object == nullptr) {
+        return ERROR_FILE_NOT_FOUND;
+    }
+    int targetFd = open(restoredPath.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (targetFd == -1) {
+        gzclose(object);
+        return errno == EEXIST ? ERROR_CANNOT_WRITE_FILE : ERROR_PATH_NOT_FOUND;
+    }
+
+    // 해제한 내용의 해시가 객체 이름과 다르면 손상된 객체이므로 복원하지 않음
+    EVP_MD_CTX* pContext = EVP_MD_CTX_new();
+    EVP_DigestInit_ex(pContext, EVP_sha256(), nullptr);
+    std::vector<uint8_t> vecBuffer(VAULT_IO_CHUNK);
+    int nResult = SUCCESS_CODE;
+    int nRead;
+    while ((nRead = gzread(object, vecBuffer.data(), static_cast<unsigned>(vecBuffer.size()))) > 0) {
+        EVP_DigestUpdate(pContext, vecBuffer.data(), static_cast<size_t>(nRead));
+        if (!WriteAll(targetFd, vecBuffer.data(), static_cast<size_t>(nRead))) {
+            nResult = ERROR_CANNOT_WRITE_FILE;
+            break;
+        }
+    }
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int nDigestLength = 0;
+    EVP_DigestFinal_ex(pContext, digest, &nDigestLength);
+    EVP_MD_CTX_free(pContext);
+    gzclose(object);
+
+    if (nResult == SUCCESS_CODE && (nRead < 0 || ToHex(digest, nDigestLength) != entry.Sha256)) {
+        nResult = ERROR_CANNOT_COMPUTE_HASH;
+    }
+    // 소유자는 기록하지 않으므로 복원한 파일은 복원하는 사용자(보통 root) 소유, setuid/setgid/sticky 비트는 되살리지 않음
+    if (nResult == SUCCESS_CODE && (fchmod(targetFd, entry.Mode & 0777) != 0 || fsync(targetFd) != 0)) {
+        nResult = ERROR_CANNOT_CHANGE_PERMISSIONS;
+    }
+    close(targetFd);
+    if (nResult != SUCCESS_CODE) {
+        unlink(restoredPath.c_str());
+        return nResult;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    sqlite3_stmt* stmt;
+    if (!PrepareSQL("UPDATE entries SET restored = 1 WHERE id = ?", &stmt)) {
+        return ERROR_DATABASE_GENERAL;
+    }
+    sqlite3_bind_int64(stmt, 1, entryId);
+    nResult = sqlite3_step(stmt) == SQLITE_DONE ? SUCCESS_CODE : ERROR_DATABASE_GENERAL;
+    sqlite3_finalize(stmt);
+    return nResult;
+}
+
+// 샘플과 그 샘플을 가리키는 모든 탐지 기록 삭제
+int CQuarantineVault::Purge(const std::string& sha256, uint64_t& removedEntries) {
+    removedEntries = 0;
+    if (!IsSha256(sha256)) {
+        return ERROR_INVALID_INPUT;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (ExecuteSQL("BEGIN IMMEDIATE") != SUCCESS_CODE) {
+        return ERROR_DATABASE_GENERAL;
+    }
+    bool bSuccess = true;
+    uint64_t arrChanges[2] = {0, 0};
+    const char* arrSql[2] = {"DELETE FROM entries WHERE sha256 = ?", "DELETE FROM objects WHERE sha256 = ?"};
+    for (int i = 0; i < 2 && bSuccess; i++) {
+        sqlite3_stmt* stmt;
+        if (!PrepareSQL(arrSql[i], &stmt)) {
+            bSuccess = false;
+            break;
+        }
+        sqlite3_bind_text(stmt, 1, sha256.c_str(), -1, SQLITE_STATIC);
+        bSuccess = sqlite3_step(stmt) == SQLITE_DONE;
+        sqlite3_finalize(stmt);
+        arrChanges[i] = static_cast<uint64_t>(sqlite3_changes(m_pDb));
+    }
+    if (!bSuccess) {
+        ExecuteSQL("ROLLBACK");
+        return ERROR_DATABASE_GENERAL;
+    }
+    if (ExecuteSQL("COMMIT") != SUCCESS_CODE) {
+        return ERROR_DATABASE_GENERAL;
+    }
+    removedEntries = arrChanges[0];
+
+    std::string strObjectPath = GetObjectPath(sha256);
+    if (unlink(strObjectPath.c_str()) != 0) {
+        if (errno != ENOENT) {
+            return ERROR_CANNOT_REMOVE_FILE;
+        }
+        return arrChanges[1] > 0 ? SUCCESS_CODE : ERROR_FILE_NOT_FOUND;
+    }
+    return SyncVaultDirectory(strObjectPath.substr(0, strObjectPath.find_last_of('/')));
+}
+
+int CQuarantineVault::List(std::vector<ST_VaultEntry>& entries) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    sqlite3_stmt* stmt;
+    if (!PrepareSQL(R"(
+        SELECT id, sha256, original_path, detected_at, scan_type, detection_cause, file_size, mode, restored
+        FROM entries ORDER BY id;
+    )", &stmt)) {
+        return ERROR_DATABASE_GENERAL;
+    }
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        ST_VaultEntry entry;
+        entry.Id = sqlite3_column_int64(stmt, 0);
+        entry.Sha256 = ColumnText(stmt, 1);
+        entry.OriginalPath = ColumnText(stmt, 2);
+        entry.DetectedAt = ColumnText(stmt, 3);
+        entry.ScanType = ColumnText(stmt, 4);
+        entry.DetectionCause = ColumnText(stmt, 5);
+        entry.FileSize = sqlite3_column_int64(stmt, 6);
+        entry.Mode = static_cast<uint32_t>(sqlite3_column_int64(stmt, 7));
+        entry.Restored = sqlite3_column_int(stmt, 8) != 0;
+        entries.push_back(entry);
+    }
+    sqlite3_finalize(stmt);
+    return SUCCESS_CODE;
+}
+
+// 중복 제거와 압축으로 절약한 용량 확인용
+int CQuarantineVault::GetStatistics(ST_VaultStatistics& statistics) {
+    statistics = {0, 0, 0, 0};
+    std::lock_guard<std::mutex> lock(m_mutex);
+    sqlite3_stmt* stmt;
+    if (!PrepareSQL(R"(
+        SELECT (SELECT COUNT(*) FROM objects), (SELECT COUNT(*) FROM entries),
+               (SELECT IFNULL(SUM(file_size), 0) FROM entries), (SELECT IFNULL(SUM(stored_size), 0) FROM objects);
+    )", &stmt)) {
+        return ERROR_DATABASE_GENERAL;
+    }
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        statistics.ObjectCount = static_cast<uint64_t>(sqlite3_column_int64(stmt, 0));
+        statistics.EntryCount = static_cast<uint64_t>(sqlite3_column_int64(stmt, 1));
+        statistics.OriginalBytes = static_cast<uint64_t>(sqlite3_column_int64(stmt, 2));
+        statistics.StoredBytes = static_cast<uint64_t>(sqlite3_column_int64(stmt, 3));
+    }
+    sqlite3_finalize(stmt);
+    return SUCCESS_CODE;
+}
+
+// --vault-list 옵션 입력 시 실행되는 함수
+int CQuarantineVault::PrintEntries() {
+    std::vector<ST_VaultEntry> vecEntries;
+    ST_VaultStatistics statistics;
+    int nResult = List(vecEntries);
+    if (nResult == SUCCESS_CODE) {
+        nResult = GetStatistics(statistics);
+    }
+    if (nResult != SUCCESS_CODE) {
+        return nResult;
+    }
+
+    std::cout << "\n- Quarantine Vault (" << m_strVaultDir << ") -\n\n";
+    for (const ST_VaultEntry& entry : vecEntries) {
+        std::cout << (entry.Restored ? COLOR_GREEN : COLOR_RED) << "[" << entry.Id << "] " << entry.OriginalPath << COLOR_RESET << "\n"
+                  << "    sha256 : " << entry.Sha256 << "\n"
+                  << "    " << entry.DetectedAt << ", " << entry.ScanType << ", " << entry.DetectionCause << ", " << entry.FileSize << " bytes"
+                  << (entry.Restored ? ", restored" : "") << "\n";
+    }
+    std::cout << "\n[+] " << statistics.ObjectCount << " unique samples for " << statistics.EntryCount << " detections, "
+              << statistics.StoredBytes << " bytes stored for " << statistics.OriginalBytes << " bytes detected\n";
+    return SUCCESS_CODE;
+}
+
+bool CQuarantineVault::PrepareSQL(const std::string& sql, sqlite3_stmt** stmt) {
+    if (sqlite3_prepare_v2(m_pDb, sql.c_str(), -1, stmt, nullptr) != SQLITE_OK) {
+        PrintErrorMessage(ERROR_DATABASE_GENERAL, "Failed to prepare statement: " + std::string(sqlite3_errmsg(m_pDb)));
+        return false;
+    }
+    return true;
+}
+
+int CQuarantineVault::ExecuteSQL(const std::string& sql) {
+    char* errMsg = nullptr;
+    if (sqlite3_exec(m_pDb, sql.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        PrintErrorMessage(ERROR_DATABASE_GENERAL, "Failed to execute SQL: " + std::string(errMsg ? errMsg : ""));
+        sqlite3_free(errMsg);
+        return ERROR_DATABASE_GENERAL;
+    }
+    return SUCCESS_CODE;
+}
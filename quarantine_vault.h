@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <sqlite3.h>
+#include <string>
+#include <vector>
+
+#define VAULT_DATABASE_NAME "vault.db"
+#define VAULT_OBJECTS_DIR "objects"
+#define VAULT_OBJECT_SUFFIX ".gz"         // 표준 gzip 형식이라 격리 디렉토리 밖에서도 gunzip으로 확인 가능
+#define VAULT_COMPRESSION_LEVEL 6
+#define VAULT_IO_CHUNK (1 << 20)          // 압축/해제 시 한 번에 읽는 크기
+
+// 보관소 인덱스의 탐지 기록 하나 (같은 샘플이 여러 경로에서 탐지되면 기록만 늘고 객체는 하나)
+struct ST_VaultEntry {
+    int64_t Id;
+    std::string Sha256;
+    std::string OriginalPath;
+    std::string DetectedAt;
+    std::string ScanType;
+    std::string DetectionCause;   // YARA 룰, 해시, 시그니처 이름 또는 유사 해시 매치
+    int64_t FileSize;
+    uint32_t Mode;                // 원본 권한, 복원 시에는 rwx 비트(0777)만 되돌림
+    bool Restored;
+};
+
+struct ST_VaultStatistics {
+    uint64_t ObjectCount;
+    uint64_t EntryCount;
+    uint64_t OriginalBytes;       // 탐지된 파일 크기의 합 (보관소가 없을 때 필요한 용량)
+    uint64_t StoredBytes;         // 실제로 저장된 압축 객체 크기의 합
+};
+
+// 탐지된 파일을 SHA-256 기준으로 한 번만 압축 저장하는 격리 보관소
+// objects/<앞 2자리>/<sha256>.gz 에 샘플을 두고, vault.db 인덱스가 원래 경로/시간/탐지 원인을 객체와 연결
+// 복원(기록 id)과 삭제(sha256)는 모두 기본 키 조회라 보관된 샘플 수와 관계없이 일정한 시간에 처리
+class CQuarantineVault {
+public:
+    CQuarantineVault(const std::string& vaultDir);
+    ~CQuarantineVault();
+    int Open();
+    int Store(const std::string& sourcePath, const std::string& scanType, const std::string& detectionCause, ST_VaultEntry& entry, bool& deduplicated);
+    int Restore(int64_t entryId, std::string& restoredPath);
+    int Purge(const std::string& sha256, uint64_t& removedEntries);
+    int List(std::vector<ST_VaultEntry>& entries);
+    int GetStatistics(ST_VaultStatistics& statistics);
+    int PrintEntries();
+    std::string GetObjectPath(const std::string& sha256) const;
+
+    CQuarantineVault(const CQuarantineVault&) = delete;
+    CQuarantineVault& operator=(const CQuarantineVault&) = delete;
+
+private:
+    std::string m_strVaultDir;
+    sqlite3* m_pDb;
+    std::mutex m_mutex;            // 격리 작업 스레드들이 연결 하나를 나눠 씀
+
+    bool HasObject(const std::string& sha256);
+    int WriteObject(int sourceFd, std::string& sha256, int64_t& storedSize);
+    int AddEntry(ST_VaultEntry& entry, int64_t storedSize);
+    bool PrepareSQL(const std::string& sql, sqlite3_stmt** stmt);
+    int ExecuteSQL(const std::string& sql);
+};
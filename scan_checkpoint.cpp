@@ -0,0 +1,211 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <jsoncpp/json/json.h>
+#include "scan_checkpoint.h"
+
+CScanCheckpoint::CScanCheckpoint(const std::string& checkpointPath) : m_strCheckpointPath(checkpointPath) {}
+
+// 임시 파일에 기록 후 fsync + rename으로 교체하여 중간에 끊겨도 이전 체크포인트가 유지되도록 함
+int CScanCheckpoint::Save(const ST_ScanCheckpoint& checkpoint) {
+    Json::Value root;
+    root["target_path"] = checkpoint.TargetPath;
+    root["file_type_option"] = checkpoint.FileTypeOption;
+    root["extension"] = checkpoint.Extension;
+    root["scan_type_option"] = checkpoint.ScanTypeOption;
+    root["last_path"] = checkpoint.LastPath;
+    root["file_count"] = checkpoint.FileCount;
+    root["total_size"] = Json::Int64(checkpoint.TotalSize);
+    root["scan_time"] = checkpoint.ScanTime;
+    root["saved_at"] = GetCurrentTimeWithMilliseconds();
+
+    Json::Value detected(Json::arrayValue);
+    for (const std::string& path : checkpoint.DetectedMalware) {
+        detected.append(path);
+    }
+    root["detected_malware"] = detected;
+
+    root["prioritize"] = checkpoint.Prioritize;
+    root["first_detection_time"] = checkpoint.FirstDetectionTime;
+    Json::Value priorityScanned(Json::arrayValue);
+    for (const std::string& path : checkpoint.PriorityScanned) {
+        priorityScanned.append(path);
+    }
+    root["priority_scanned"] = priorityScanned;
+
+    Json::Value scanData(Json::arrayValue);
+    for (const ST_ScanData& data : checkpoint.ScanData) {
+        Json::Value entry;
+        entry["detected_file"] = data.DetectedFile;
+        entry["archive_member"] = data.ArchiveMember;
+        entry["scan_type"] = data.ScanType;
+        entry["yara_rule"] = data.YaraRule;
+        entry["hash_value"] = data.HashValue;
+        entry["signature_name"] = data.SignatureName;
+        entry["fuzzy_match"] = data.FuzzyMatch;
+        entry["similarity_score"] = data.SimilarityScore;
+        entry["file_size"] = data.FileSize;
+        entry["timestamp"] = data.Timestamp;
+        entry["is_moved"] = data.IsMoved;
+        entry["path_after_moving"] = data.PathAfterMoving;
+        scanData.append(entry);
+    }
+    root["scan_data"] = scanData;
+
+    Json::StreamWriterBuilder writer;
+    writer["indentation"] = "";
+    std::string strContent = Json::writeString(writer, root) + "\n";
+
+    std::string strTempPath = m_strCheckpointPath + ".tmp";
+    int fd = open(strTempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd == -1) {
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+    size_t siWritten = 0;
+    while (siWritten < strContent.size()) {
+        ssize_t n = write(fd, strContent.data() + siWritten, strContent.size() - siWritten);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            close(fd);
+            unlink(strTempPath.c_str());
+            return ERROR_CANNOT_WRITE_FILE;
+        }
+        siWritten += static_cast<size_t>(n);
+    }
+    if (fsync(fd) != 0) {
+        close(fd);
+        unlink(strTempPath.c_str());
+        return ERROR_CANNOT_WRITE_FILE;
+    }
+    close(fd);
+
+    if (rename(strTempPath.c_str(), m_strCheckpointPath.c_str()) != 0) {
+        unlink(strTempPath.c_str());
+        return ERROR_CANNOT_MOVE_FILE;
+    }
+
+    // rename 자체가 디스크에 반영되도록 디렉토리도 fsync
+    std::string strDir = m_strCheckpointPath.find('/') == std::string::npos
+        ? "." : m_strCheckpointPath.substr(0, m_strCheckpointPath.find_last_of('/'));
+    int dirFd = open(strDir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd != -1) {
+        fsync(dirFd);
+        close(dirFd);
+    }
+    return SUCCESS_CODE;
+}
+
+int CScanCheckpoint::Load(ST_ScanCheckpoint& checkpoint) {
+    std::ifstream file(m_strCheckpointPath);
+    if (!file.is_open()) {
+        return ERROR_FILE_NOT_FOUND;
+    }
+
+    Json::Value root;
+    Json::CharReaderBuilder reader;
+    std::string errs;
+    if (!Json::parseFromStream(reader, file, &root, &errs) || !root.isObject()) {
+        PrintError("Failed to parse scan checkpoint: " + errs);
+        return ERROR_INVALID_INPUT;
+    }
+
+    checkpoint.TargetPath = root["target_path"].asString();
+    checkpoint.FileTypeOption = root["file_type_option"].asInt();
+    checkpoint.Extension = root["extension"].asString();
+    checkpoint.ScanTypeOption = root["scan_type_option"].asInt();
+    checkpoint.LastPath = root["last_path"].asString();
+    checkpoint.FileCount = root["file_count"].asInt();
+    checkpoint.TotalSize = root["total_size"].asInt64();
+    checkpoint.ScanTime = root["scan_time"].asDouble();
+
+    checkpoint.DetectedMalware.clear();
+    for (const auto& path : root["detected_malware"]) {
+        checkpoint.DetectedMalware.push_back(path.asString());
+    }
+
+    // 우선 스캔 항목이 없는 이전 형식의 체크포인트는 일반 순회로 재개
+    checkpoint.Prioritize = root.get("prioritize", false).asBool();
+    checkpoint.FirstDetectionTime = root.get("first_detection_time", -1.0).asDouble();
+    checkpoint.PriorityScanned.clear();
+    for (const auto& path : root["priority_scanned"]) {
+        checkpoint.PriorityScanned.push_back(path.asString());
+    }
+
+    checkpoint.ScanData.clear();
+    for (const auto& entry : root["scan_data"]) {
+        ST_ScanData data = {
+            .DetectedFile = entry["detected_file"].asString(),
+            .ArchiveMember = entry.get("archive_member", "N/A").asString(),
+            .ScanType = entry["scan_type"].asString(),
+            .YaraRule = entry["yara_rule"].asString(),
+            .HashValue = entry["hash_value"].asString(),
+            .SignatureName = entry.get("signature_name", "N/A").asString(),
+            .FuzzyMatch = entry.get("fuzzy_match", "N/A").asString(),
+            .SimilarityScore = entry.get("similarity_score", 0).asInt(),
+            .FileSize = entry["file_size"].asString(),
+            .Timestamp = entry["timestamp"].asString(),
+            .IsMoved = entry.get("is_moved", false).asBool(),
+            .PathAfterMoving = entry.get("path_after_moving", "N/A").asString()
+        };
+        checkpoint.ScanData.push_back(data);
+    }
+    return SUCCESS_CODE;
+}
+
+int CScanCheckpoint::Remove() {
+    if (unlink(m_strCheckpointPath.c_str()) != 0 && errno != ENOENT) {
+        return ERROR_CANNOT_REMOVE_FILE;
+    }
+    return SUCCESS_CODE;
+}
+
+bool CScanCheckpoint::Exists() const {
+    struct stat info;
+    return stat(m_strCheckpointPath.c_str(), &info) == 0;
+}
+
+// fts 이름순 전위 순회에서의 선후 관계 비교 (음수: lhs가 먼저, 0: 같음, 양수: rhs가 먼저)
+int CScanCheckpoint::ComparePathOrder(const std::string& lhs, const std::string& rhs) {
+    std::vector<std::string> vecLhs = SplitPath(lhs);
+    std::vector<std::string> vecRhs = SplitPath(rhs);
+    size_t siCommon = std::min(vecLhs.size(), vecRhs.size());
+    for (size_t i = 0; i < siCommon; ++i) {
+        int nCompare = strcmp(vecLhs[i].c_str(), vecRhs[i].c_str());
+        if (nCompare != 0) {
+            return nCompare;
+        }
+    }
+    // 한쪽이 다른 쪽의 상위 경로면 상위 디렉토리가 먼저 방문됨
+    if (vecLhs.size() == vecRhs.size()) {
+        return 0;
+    }
+    return vecLhs.size() < vecRhs.size() ? -1 : 1;
+}
+
+bool CScanCheckpoint::IsAncestorPath(const std::string& ancestor, const std::string& path) {
+    std::vector<std::string> vecAncestor = SplitPath(ancestor);
+    std::vector<std::string> vecPath = SplitPath(path);
+    if (vecAncestor.size() >= vecPath.size()) {
+        return false;
+    }
+    return std::equal(vecAncestor.begin(), vecAncestor.end(), vecPath.begin());
+}
+
+std::vector<std::string> CScanCheckpoint::SplitPath(const std::string& path) {
+    std::vector<std::string> vecComponents;
+    std::stringstream ss(path);
+    std::string strComponent;
+    while (std::getline(ss, strComponent, '/')) {
+        if (!strComponent.empty()) {
+            vecComponents.push_back(strComponent);
+        }
+    }
+    return vecComponents;
+}
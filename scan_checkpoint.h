@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "file_scanner.h"
+
+#define CHECKPOINT_FILE_PATH "logs/scan_checkpoint.json"
+#define CHECKPOINT_INTERVAL_FILES 5000 // 이 파일 수마다 체크포인트 저장
+#define CHECKPOINT_INTERVAL_SEC 30     // 또는 이 시간(초)마다 체크포인트 저장
+
+// 중단된 스캔을 이어서 진행하기 위한 상태
+// 순회 순서가 이름순으로 고정되어 있으므로 마지막으로 처리한 경로 하나가 순회 경계(frontier)가 됨
+// 우선 스캔 모드에서 먼저 검사한 파일은 순서가 정해져 있지 않으므로 경로 목록으로 따로 저장
+struct ST_ScanCheckpoint {
+    std::string TargetPath;
+    int FileTypeOption;
+    std::string Extension;
+    int ScanTypeOption;
+    std::string LastPath;
+    int FileCount;
+    long long TotalSize;
+    double ScanTime;
+    std::vector<std::string> DetectedMalware;
+    std::vector<ST_ScanData> ScanData;
+    bool Prioritize;                          // 우선 스캔 모드로 시작한 스캔
+    std::vector<std::string> PriorityScanned; // 우선 스캔에서 이미 검사한 파일 (순회 경계와 별도로 건너뜀)
+    double FirstDetectionTime;
+};
+
+class CScanCheckpoint {
+public:
+    CScanCheckpoint(const std::string& checkpointPath);
+    int Save(const ST_ScanCheckpoint& checkpoint);
+    int Load(ST_ScanCheckpoint& checkpoint);
+    int Remove();
+    bool Exists() const;
+
+    static int ComparePathOrder(const std::string& lhs, const std::string& rhs);
+    static bool IsAncestorPath(const std::string& ancestor, const std::string& path);
+
+private:
+    std::string m_strCheckpointPath;
+
+    static std::vector<std::string> SplitPath(const std::string& path);
+};
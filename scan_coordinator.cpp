@@ -0,0 +1,731 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <poll.h>
+#include <queue>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "ansi_color.h"
+#include "scan_coordinator.h"
+#include "scan_daemon.h"
+#include "util.h"
+
+std::atomic<bool> CScanCoordinator::m_bStopCoordinator(false);
+
+static void CoordinatorSignalHandler(int signal) {
+    if (signal == SIGINT || signal == SIGTERM) {
+        CScanCoordinator::m_bStopCoordinator = true;
+    }
+}
+
+// 디렉토리 하나의 크기 추정치 (SHARD_MAX_DEPTH보다 깊은 내용은 가장 가까운 집계 디렉토리의 Own에 합산)
+struct ST_DirEstimate {
+    std::string Path;
+    int Parent;
+    uint64_t OwnFiles;
+    uint64_t OwnBytes;
+    uint64_t SubtreeFiles;
+    uint64_t SubtreeBytes;
+    std::vector<int> Children;
+};
+
+static uint64_t GetWeight(uint64_t files, uint64_t bytes) {
+    return bytes + files * SHARD_FILE_COST_BYTES;
+}
+
+// 작업자가 보낸 값은 형식을 믿지 않고, 기대한 타입이 아니면 기본값을 씀 (as*()는 타입이 다르면 예외를 던짐)
+static int GetShardId(const Json::Value& request) {
+    const Json::Value& shard = request["shard"];
+    return shard.isInt() ? shard.asInt() : -1;
+}
+
+static std::string GetStringField(const Json::Value& request, const char* key, const std::string& defaultValue) {
+    const Json::Value& value = request[key];
+    return value.isString() ? value.asString() : defaultValue;
+}
+
+static std::string GetWorkerName() {
+    char hostname[256] = {};
+    gethostname(hostname, sizeof(hostname) - 1);
+    return std::to_string(getpid()) + "@" + hostname;
+}
+
+CScanCoordinator::CScanCoordinator(const std::string& socketPath, const std::vector<std::string>& roots, const ST_ScanOptions& options, int localWorkers, int shardCount)
+    : m_strSocketPath(socketPath), m_options(options), m_nLocalWorkers(localWorkers),
+      m_nShardCount(shardCount > 0 ? shardCount : std::max(1, localWorkers) * SHARDS_PER_WORKER),
+      m_listenFd(-1), m_nActiveConnections(0), m_ullReassigned(0) {
+    // 다른 작업 디렉토리에서 실행된 작업자도 같은 경로를 쓰도록 절대 경로로 배정
+    for (const std::string& root : roots) {
+        m_vecRoots.push_back(GetAbsolutePath(root));
+    }
+}
+
+CScanCoordinator::~CScanCoordinator() {
+    if (m_listenFd != -1) {
+        close(m_listenFd);
+        unlink(m_strSocketPath.c_str());
+    }
+}
+
+// 메타데이터만 순회하여 디렉토리별 크기를 집계하고, 큰 하위 트리를 나눈 뒤 무거운 단위부터 가장 가벼운 샤드에 배정(LPT)
+int CScanCoordinator::PlanShards() {
+    std::vector<ST_DirEstimate> vecDirs;
+    std::vector<int> vecRootDirs;
+    std::string strDestination = GetAbsolutePath(DESTINATION_PATH);
+
+    for (const std::string& root : m_vecRoots) {
+        if (!IsDirectory(root)) {
+            PrintErrorMessage(ERROR_PATH_NOT_FOUND, root);
+            return ERROR_PATH_NOT_FOUND;
+        }
+        char * const paths[] = {const_cast<char *>(root.c_str()), nullptr};
+        FTS *fileSystem = fts_open(paths, FTS_NOCHDIR | FTS_PHYSICAL, nullptr);
+        if (fileSystem == nullptr) {
+            return ERROR_CANNOT_OPEN_DIRECTORY;
+        }
+        FTSENT *node;
+        while ((node = fts_read(fileSystem)) != nullptr && !m_bStopCoordinator) {
+            if (node->fts_info == FTS_D) {
+                if (GetAbsolutePath(node->fts_path) == strDestination) {
+                    fts_set(fileSystem, node, FTS_SKIP);
+                } else if (node->fts_level <= SHARD_MAX_DEPTH) {
+                    int nParent = node->fts_level > FTS_ROOTLEVEL ? static_cast<int>(node->fts_parent->fts_number) : -1;
+                    node->fts_number = static_cast<long>(vecDirs.size());
+                    vecDirs.push_back({node->fts_path, nParent, 0, 0, 0, 0, {}});
+                    if (nParent >= 0) {
+                        vecDirs[nParent].Children.push_back(static_cast<int>(node->fts_number));
+                    } else {
+                        vecRootDirs.push_back(static_cast<int>(node->fts_number));
+                    }
+                } else {
+                    node->fts_number = node->fts_parent->fts_number;
+                }
+            } else if (node->fts_info == FTS_F && node->fts_level > FTS_ROOTLEVEL) {
+                ST_DirEstimate& dir = vecDirs[node->fts_parent->fts_number];
+                dir.OwnFiles++;
+                dir.OwnBytes += node->fts_statp->st_size;
+            }
+        }
+        fts_close(fileSystem);
+    }
+    if (m_bStopCoordinator) {
+        return ERROR_UNKNOWN;
+    }
+
+    // 전위 순회 순서로 추가했으므로 뒤에서부터 더하면 하위 트리 합계가 됨
+    for (size_t i = vecDirs.size(); i-- > 0;) {
+        vecDirs[i].SubtreeFiles += vecDirs[i].OwnFiles;
+        vecDirs[i].SubtreeBytes += vecDirs[i].OwnBytes;
+        if (vecDirs[i].Parent >= 0) {
+            vecDirs[vecDirs[i].Parent].SubtreeFiles += vecDirs[i].SubtreeFiles;
+            vecDirs[vecDirs[i].Parent].SubtreeBytes += vecDirs[i].SubtreeBytes;
+        }
+    }
+
+    uint64_t ullTotalWeight = 0;
+    for (int nRoot : vecRootDirs) {
+        ullTotalWeight += GetWeight(vecDirs[nRoot].SubtreeFiles, vecDirs[nRoot].SubtreeBytes);
+    }
+    uint64_t ullSplitWeight = ullTotalWeight / m_nShardCount / SHARD_SPLIT_RATIO;
+
+    // 기준보다 무거운 하위 트리는 하위 디렉토리 단위와, 바로 아래 파일만 검사하는 단위로 나눔
+    std::vector<ST_ScanUnit> vecUnits;
+    std::vector<int> vecStack(vecRootDirs.rbegin(), vecRootDirs.rend());
+    while (!vecStack.empty()) {
+        const ST_DirEstimate& dir = vecDirs[vecStack.back()];
+        vecStack.pop_back();
+        if (dir.Children.empty() || GetWeight(dir.SubtreeFiles, dir.SubtreeBytes) <= ullSplitWeight) {
+            vecUnits.push_back({dir.Path, true, dir.SubtreeFiles, dir.SubtreeBytes});
+            continue;
+        }
+        if (dir.OwnFiles > 0) {
+            vecUnits.push_back({dir.Path, false, dir.OwnFiles, dir.OwnBytes});
+        }
+        vecStack.insert(vecStack.end(), dir.Children.rbegin(), dir.Children.rend());
+    }
+
+    std::stable_sort(vecUnits.begin(), vecUnits.end(), [](const ST_ScanUnit& lhs, const ST_ScanUnit& rhs) {
+        return GetWeight(lhs.Files, lhs.Bytes) > GetWeight(rhs.Files, rhs.Bytes);
+    });
+    m_vecShards.assign(std::min<size_t>(m_nShardCount, std::max<size_t>(vecUnits.size(), 1)), ST_ScanShard());
+    using ShardLoad = std::pair<uint64_t, size_t>;
+    std::priority_queue<ShardLoad, std::vector<ShardLoad>, std::greater<ShardLoad>> queLoads;
+    for (size_t i = 0; i < m_vecShards.size(); i++) {
+        m_vecShards[i] = {static_cast<int>(i), {}, 0, 0, SHARD_PENDING, 0, "", "", 0.0, -1, {}, 0, 0};
+        queLoads.push({0, i});
+    }
+    for (const ST_ScanUnit& unit : vecUnits) {
+        ShardLoad load = queLoads.top();
+        queLoads.pop();
+        ST_ScanShard& shard = m_vecShards[load.second];
+        shard.Units.push_back(unit);
+        shard.EstimatedFiles += unit.Files;
+        shard.EstimatedWeight += GetWeight(unit.Files, unit.Bytes);
+        queLoads.push({shard.EstimatedWeight, load.second});
+    }
+    for (const ST_ScanShard& shard : m_vecShards) {
+        m_quePending.push_back(shard.Id);
+    }
+
+    uint64_t ullMaxWeight = 0;
+    for (const ST_ScanShard& shard : m_vecShards) {
+        ullMaxWeight = std::max(ullMaxWeight, shard.EstimatedWeight);
+    }
+    double dAverage = static_cast<double>(ullTotalWeight) / m_vecShards.size();
+    std::cout << "[-] Planned " << m_vecShards.size() << " shards from " << vecUnits.size() << " units ("
+              << vecDirs.size() << " directories, " << ullTotalWeight << " weighted bytes), largest shard "
+              << std::fixed << std::setprecision(2) << (dAverage > 0 ? ullMaxWeight / dAverage : 1.0) << "x average\n";
+    return SUCCESS_CODE;
+}
+
+// 남아있는 소켓 파일은 이전 실행의 흔적이므로 지우고 새로 바인드
+int CScanCoordinator::OpenSocket() {
+    struct stat socketStat;
+    if (lstat(m_strSocketPath.c_str(), &socketStat) == 0 && S_ISSOCK(socketStat.st_mode)) {
+        unlink(m_strSocketPath.c_str());
+    }
+    m_listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_listenFd == -1) {
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+    int nResult = BindUnixSocket(m_listenFd, m_strSocketPath, 0660);
+    if (nResult != SUCCESS_CODE || listen(m_listenFd, SOMAXCONN) != 0) {
+        close(m_listenFd);
+        m_listenFd = -1;
+        return nResult != SUCCESS_CODE ? nResult : ERROR_CANNOT_OPEN_FILE;
+    }
+    return SUCCESS_CODE;
+}
+
+// 같은 실행 파일을 --shard-worker로 실행, 출력은 작업자별 로그 파일로 보냄
+int CScanCoordinator::SpawnLocalWorkers() {
+    for (int i = 0; i < m_nLocalWorkers; i++) {
+        std::string strLogPath = std::string(SHARD_LOG_DIR) + "/worker_" + std::to_string(i) + ".log";
+        pid_t pid = fork();
+        if (pid == -1) {
+            return ERROR_UNKNOWN;
+        }
+        if (pid == 0) {
+            int logFd = open(strLogPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+            if (logFd != -1) {
+                dup2(logFd, STDOUT_FILENO);
+                dup2(logFd, STDERR_FILENO);
+                close(logFd);
+            }
+            signal(SIGINT, SIG_IGN); // 터미널의 Ctrl+C는 코디네이터만 받고 작업자는 연결 종료로 정리
+            execl("/proc/self/exe", "UdkdAgent", "--shard-worker", "--socket", m_strSocketPath.c_str(), static_cast<char*>(nullptr));
+            _exit(127);
+        }
+        m_vecChildren.push_back(pid);
+    }
+    return SUCCESS_CODE;
+}
+
+// --coordinator 옵션 입력 시 실행되는 함수
+int CScanCoordinator::Run() {
+    auto start = std::chrono::steady_clock::now();
+    if (mkdir(SHARD_LOG_DIR, 0700) != 0 && errno != EEXIST) {
+        PrintErrorMessage(ERROR_CANNOT_OPEN_DIRECTORY, SHARD_LOG_DIR);
+        return ERROR_CANNOT_OPEN_DIRECTORY;
+    }
+
+    struct sigaction action = {};
+    action.sa_handler = CoordinatorSignalHandler;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    int nResult = PlanShards();
+    if (nResult == SUCCESS_CODE) {
+        nResult = OpenSocket();
+        if (nResult != SUCCESS_CODE) {
+            PrintErrorMessage(nResult, m_strSocketPath);
+        }
+    }
+    if (nResult == SUCCESS_CODE) {
+        nResult = SpawnLocalWorkers();
+    }
+    if (nResult != SUCCESS_CODE) {
+        signal(SIGINT, SIG_DFL);
+        signal(SIGTERM, SIG_DFL);
+        return nResult;
+    }
+    std::cout << COLOR_GREEN << "[+] Scan coordinator listening on " << m_strSocketPath << " (" << m_nLocalWorkers << " local workers)" << COLOR_RESET << "\n";
+
+    while (!m_bStopCoordinator && !IsFinished()) {
+        struct pollfd pfd = {m_listenFd, POLLIN, 0};
+        if (poll(&pfd, 1, COORDINATOR_POLL_MS) > 0) {
+            int clientFd = accept4(m_listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+            // 소켓 권한은 그룹까지 열려 있으므로, 샤드 경로와 결과를 다루는 작업자는 코디네이터와 같은 사용자만 받음
+            struct ucred credentials = {};
+            socklen_t length = sizeof(credentials);
+            if (clientFd != -1 && (getsockopt(clientFd, SOL_SOCKET, SO_PEERCRED, &credentials, &length) != 0 || credentials.uid != geteuid())) {
+                PrintError("Rejected shard worker connection from uid " + std::to_string(credentials.uid));
+                close(clientFd);
+                clientFd = -1;
+            }
+            if (clientFd != -1) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_nActiveConnections++;
+                m_vecConnectionFds.push_back(clientFd);
+                m_vecConnections.emplace_back(&CScanCoordinator::ServeWorker, this, clientFd);
+            }
+        }
+
+        ExpireLeases();
+
+        // 로컬 작업자가 모두 종료되었고 연결된 작업자도 없으면 남은 샤드를 처리할 수 없음
+        size_t siAlive = 0;
+        for (pid_t& pid : m_vecChildren) {
+            if (pid > 0 && waitpid(pid, nullptr, WNOHANG) == pid) {
+                pid = -1;
+            }
+            siAlive += pid > 0 ? 1 : 0;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_vecChildren.empty() && siAlive == 0 && m_nActiveConnections == 0 && !m_quePending.empty()) {
+            PrintError("All shard workers exited before the scan finished");
+            nResult = ERROR_UNKNOWN;
+            break;
+        }
+    }
+
+    // 대기 중인 작업자 연결을 끊어 작업자 프로세스와 연결 스레드를 종료
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (int fd : m_vecConnectionFds) {
+            shutdown(fd, SHUT_RDWR);
+        }
+    }
+    for (std::thread& connection : m_vecConnections) {
+        connection.join();
+    }
+    // 스캔이 멈춰 샤드를 회수당한 작업자는 스스로 끝나지 않으므로 임대 시간만큼 기다린 뒤 강제로 종료
+    auto childDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(SHARD_LEASE_SEC);
+    for (pid_t pid : m_vecChildren) {
+        if (pid > 0) {
+            if (m_bStopCoordinator) {
+                kill(pid, SIGTERM); // 스캔 중인 작업자도 현재 파일까지만 처리하고 종료
+            }
+            while (waitpid(pid, nullptr, WNOHANG) == 0) {
+                if (std::chrono::steady_clock::now() >= childDeadline) {
+                    kill(pid, SIGKILL);
+                    waitpid(pid, nullptr, 0);
+                    break;
+                }
+                usleep(COORDINATOR_POLL_MS * 100);
+            }
+        }
+    }
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+
+    double dElapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    int nMergeResult = MergeReports(dElapsed);
+    return nResult != SUCCESS_CODE ? nResult : nMergeResult;
+}
+
+bool CScanCoordinator::IsFinished() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const ST_ScanShard& shard : m_vecShards) {
+        if (shard.State != SHARD_DONE && shard.State != SHARD_FAILED) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 대기열의 다음 샤드를 작업자에게 배정, 남은 샤드가 없지만 다른 작업자가 처리 중이면 나중에 다시 요청하도록 함
+Json::Value CScanCoordinator::AssignShard(const std::string& worker, int ownerFd, int& shardId, int& attempt) {
+    Json::Value response;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_quePending.empty()) {
+        bool bRunning = std::any_of(m_vecShards.begin(), m_vecShards.end(), [](const ST_ScanShard& shard) { return shard.State == SHARD_RUNNING; });
+        response["status"] = bRunning ? "wait" : "done";
+        return response;
+    }
+    ST_ScanShard& shard = m_vecShards[m_quePending.front()];
+    m_quePending.pop_front();
+    shard.State = SHARD_RUNNING;
+    shard.Attempts++;
+    shard.Worker = worker;
+    shard.OwnerFd = ownerFd;
+    shard.LeaseExpiry = std::chrono::steady_clock::now() + std::chrono::seconds(SHARD_LEASE_SEC);
+    shard.Progress = 0;
+    shard.StalledHeartbeats = 0;
+    shard.LogPath = GetAbsolutePath(SHARD_LOG_DIR) + "/shard_" + std::to_string(shard.Id) + "." + std::to_string(shard.Attempts) + ".json";
+    shardId = shard.Id;
+    attempt = shard.Attempts;
+
+    response["status"] = "ok";
+    response["shard"] = shard.Id;
+    response["log"] = shard.LogPath;
+    response["engine"] = m_options.ScanTypeOption;
+    response["file_type"] = m_options.FileTypeOption;
+    response["extension"] = m_options.Extension;
+    response["prioritize"] = m_options.Prioritize;
+    response["quarantine"] = m_options.AutoQuarantine;
+    Json::Value paths(Json::arrayValue);
+    Json::Value shallow(Json::arrayValue);
+    for (const ST_ScanUnit& unit : shard.Units) {
+        paths.append(unit.Path);
+        if (!unit.Recursive) {
+            shallow.append(unit.Path);
+        }
+    }
+    response["paths"] = paths;
+    response["shallow"] = shallow;
+    return response;
+}
+
+// 하트비트만 보내고 진행하지 않는 작업자(하트비트 스레드는 살아 있지만 스캔이 멈춘 경우)는 임대를 계속 연장하지 않음
+// 진행 카운터가 SHARD_STALL_HEARTBEATS번 연속 그대로이면 연장을 멈춰 ExpireLeases가 회수하게 함
+void CScanCoordinator::RenewLease(int shardId, int attempt, const Json::Value& progress) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ST_ScanShard& shard = m_vecShards[shardId];
+    if (shard.State != SHARD_RUNNING || shard.Attempts != attempt) {
+        return;
+    }
+    uint64_t ullProgress = progress.isUInt64() ? progress.asUInt64() : shard.Progress;
+    if (ullProgress != shard.Progress) {
+        shard.Progress = ullProgress;
+        shard.StalledHeartbeats = 0;
+    } else if (++shard.StalledHeartbeats >= SHARD_STALL_HEARTBEATS) {
+        return;
+    }
+    shard.LeaseExpiry = std::chrono::steady_clock::now() + std::chrono::seconds(SHARD_LEASE_SEC);
+}
+
+// 작업자가 샤드를 끝내지 못한 경우 다시 대기열 앞에 넣음, 같은 샤드가 계속 실패하면 포기
+// 이미 회수되어 다른 시도로 넘어간 샤드(attempt가 다름)는 무시
+void CScanCoordinator::ReleaseShard(int shardId, int attempt, const std::string& reason) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ReleaseShardLocked(shardId, attempt, reason);
+}
+
+void CScanCoordinator::ReleaseShardLocked(int shardId, int attempt, const std::string& reason) {
+    ST_ScanShard& shard = m_vecShards[shardId];
+    if (shard.State != SHARD_RUNNING || shard.Attempts != attempt) {
+        return;
+    }
+    if (shard.Attempts >= SHARD_MAX_ATTEMPTS) {
+        shard.State = SHARD_FAILED;
+        std::cout << COLOR_RED << "[+] Shard " << shardId << " failed " << shard.Attempts << " times (" << reason << "), giving up" << COLOR_RESET << "\n";
+        return;
+    }
+    shard.State = SHARD_PENDING;
+    m_quePending.push_front(shardId);
+    m_ullReassigned++;
+    std::cout << COLOR_YELLOW << "[+] Shard " << shardId << " released by " << shard.Worker << " (" << reason << "), reassigning" << COLOR_RESET << "\n";
+}
+
+// 연결은 살아 있지만 하트비트가 끊긴 작업자(멈춘 스캔, 응답 없는 원격 파일 시스템)의 샤드를 회수하고
+// 연결을 끊어 작업자가 늦게 보내는 결과가 새 시도와 섞이지 않게 함
+void CScanCoordinator::ExpireLeases() {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (ST_ScanShard& shard : m_vecShards) {
+        if (shard.State == SHARD_RUNNING && now > shard.LeaseExpiry) {
+            // 연결 스레드가 "worker disconnected"로 먼저 회수하지 않도록 잠금 안에서 회수한 뒤 연결을 끊음
+            int ownerFd = shard.OwnerFd;
+            ReleaseShardLocked(shard.Id, shard.Attempts, shard.StalledHeartbeats >= SHARD_STALL_HEARTBEATS
+                ? "no progress for " + std::to_string(SHARD_STALL_HEARTBEATS * SHARD_HEARTBEAT_SEC) + " sec" : "lease expired");
+            shutdown(ownerFd, SHUT_RDWR);
+        }
+    }
+}
+
+// 작업자 연결 하나를 처리, 요청과 응답은 데몬과 같은 JSON 한 줄 형식 (heartbeat에는 응답하지 않음)
+void CScanCoordinator::ServeWorker(int clientFd) {
+    std::unique_ptr<CDaemonConnection> pConnection(new CDaemonConnection(clientFd));
+    Json::CharReaderBuilder readerBuilder;
+    std::unique_ptr<Json::CharReader> reader(readerBuilder.newCharReader());
+    Json::StreamWriterBuilder writerBuilder;
+    writerBuilder["indentation"] = "";
+
+    std::string strWorker = "unknown";
+    int nCurrentShard = -1;
+    int nCurrentAttempt = 0;
+    auto shardStart = std::chrono::steady_clock::now();
+    std::string strLine;
+    while (pConnection->ReadLine(strLine)) {
+        Json::Value request;
+        Json::Value response;
+        std::string strErrors;
+        if (!reader->parse(strLine.data(), strLine.data() + strLine.size(), &request, &strErrors) || !request.isObject()) {
+            response["status"] = "error";
+            response["error"] = "Malformed request";
+        } else if (GetStringField(request, "type", "") == "hello") {
+            strWorker = GetStringField(request, "worker", strWorker);
+            response["status"] = "ok";
+        } else if (GetStringField(request, "type", "") == "next" && nCurrentShard == -1) {
+            response = AssignShard(strWorker, clientFd, nCurrentShard, nCurrentAttempt);
+            shardStart = std::chrono::steady_clock::now();
+        } else if (GetStringField(request, "type", "") == "heartbeat") {
+            if (nCurrentShard != -1 && GetShardId(request) == nCurrentShard) {
+                RenewLease(nCurrentShard, nCurrentAttempt, request["progress"]);
+            }
+            continue;
+        } else if (GetStringField(request, "type", "") == "result" && GetShardId(request) == nCurrentShard && nCurrentShard != -1) {
+            if (GetStringField(request, "status", "") == "ok") {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                ST_ScanShard& shard = m_vecShards[nCurrentShard];
+                if (shard.State == SHARD_RUNNING && shard.Attempts == nCurrentAttempt) {
+                    shard.State = SHARD_DONE;
+                    shard.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - shardStart).count();
+                }
+            } else {
+                ReleaseShard(nCurrentShard, nCurrentAttempt, GetStringField(request, "error", "scan failed"));
+            }
+            nCurrentShard = -1;
+            response["status"] = "ok";
+        } else {
+            response["status"] = "error";
+            response["error"] = "Unexpected request";
+        }
+        if (!pConnection->WriteLine(Json::writeString(writerBuilder, response))) {
+            break;
+        }
+    }
+
+    // 결과를 보내기 전에 연결이 끊긴 작업자의 샤드는 다른 작업자에게 다시 배정
+    if (nCurrentShard != -1) {
+        ReleaseShard(nCurrentShard, nCurrentAttempt, "worker disconnected");
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_vecConnectionFds.erase(std::remove(m_vecConnectionFds.begin(), m_vecConnectionFds.end(), clientFd), m_vecConnectionFds.end());
+    pConnection.reset();
+    m_nActiveConnections--;
+}
+
+// 완료된 샤드의 마지막 시도 요약만 읽어 탐지 목록과 통계를 하나의 보고서로 합침
+int CScanCoordinator::MergeReports(double elapsedSec) {
+    Json::Value report;
+    Json::Value detections(Json::arrayValue);
+    Json::Value shards(Json::arrayValue);
+    uint64_t ullFiles = 0;
+    uint64_t ullBytes = 0;
+    size_t siDone = 0;
+    size_t siFailed = 0;
+    Json::CharReaderBuilder readerBuilder;
+
+    for (const ST_ScanShard& shard : m_vecShards) {
+        Json::Value entry;
+        entry["id"] = shard.Id;
+        entry["state"] = shard.State == SHARD_DONE ? "done" : shard.State == SHARD_FAILED ? "failed" : "incomplete";
+        entry["attempts"] = shard.Attempts;
+        entry["worker"] = shard.Worker;
+        entry["units"] = Json::UInt64(shard.Units.size());
+        entry["estimated_files"] = Json::UInt64(shard.EstimatedFiles);
+        entry["seconds"] = shard.Seconds;
+
+        Json::Value summary;
+        std::ifstream summaryFile(shard.LogPath);
+        std::string strErrors;
+        if (shard.State == SHARD_DONE && summaryFile.is_open() && Json::parseFromStream(readerBuilder, summaryFile, &summary, &strErrors)) {
+            siDone++;
+            ullFiles += summary["files_scanned"].asUInt64();
+            ullBytes += summary["bytes_scanned"].asUInt64();
+            entry["files_scanned"] = summary["files_scanned"];
+            entry["log"] = shard.LogPath;
+            for (const Json::Value& detection : summary["detections"]) {
+                detections.append(detection);
+            }
+        } else {
+            siFailed++;
+        }
+        shards.append(entry);
+    }
+
+    report["timestamp"] = GetCurrentTimeWithMilliseconds();
+    Json::Value roots(Json::arrayValue);
+    for (const std::string& root : m_vecRoots) {
+        roots.append(root);
+    }
+    report["scan_paths"] = roots;
+    report["scan_type"] = m_options.ScanTypeOption == YARA_RULE ? "Yara" : "Hash";
+    report["interrupted"] = m_bStopCoordinator.load();
+    report["shard_count"] = Json::UInt64(m_vecShards.size());
+    report["shards_done"] = Json::UInt64(siDone);
+    report["shards_failed"] = Json::UInt64(siFailed);
+    report["shards_reassigned"] = Json::UInt64(m_ullReassigned);
+    report["files_scanned"] = Json::UInt64(ullFiles);
+    report["bytes_scanned"] = Json::UInt64(ullBytes);
+    report["scan_time_sec"] = elapsedSec;
+    report["files_per_sec"] = elapsedSec > 0 ? ullFiles / elapsedSec : 0.0;
+    report["mb_per_sec"] = elapsedSec > 0 ? ullBytes / elapsedSec / (1024.0 * 1024.0) : 0.0;
+    report["detection_count"] = Json::UInt64(detections.size());
+    report["detections"] = detections;
+    report["shards"] = shards;
+
+    std::cout << "\n- Sharded Scan Result -\n\n"
+              << COLOR_RED << "[+] Total Malware File : " << detections.size() << " files" << COLOR_RESET << "\n";
+    for (Json::ArrayIndex i = 0; i < detections.size(); i++) {
+        std::cout << COLOR_RED << "[" << i + 1 << "] : " << detections[i]["detected_file"].asString() << COLOR_RESET << "\n";
+    }
+    std::cout << "\n[+] Total Scan File : " << ullFiles << " files " << ullBytes << " bytes\n"
+              << "\n[+] Shards : " << siDone << " done, " << siFailed << " failed, " << m_ullReassigned << " reassigned\n"
+              << "\n[+] File scan time :  " << std::fixed << std::setprecision(3) << elapsedSec << " sec\n";
+
+    std::string strReportPath = m_options.SummaryPath.empty() ? SHARD_REPORT_PATH : m_options.SummaryPath;
+    std::ofstream reportFile(strReportPath, std::ios::out | std::ios::trunc);
+    if (!reportFile.is_open()) {
+        PrintErrorMessage(ERROR_CANNOT_OPEN_FILE, strReportPath);
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+    Json::StreamWriterBuilder writer;
+    reportFile << Json::writeString(writer, report) << "\n";
+    std::cout << "\n[+] Merged report saved to " << strReportPath << "\n";
+    if (!reportFile.good()) {
+        return ERROR_CANNOT_WRITE_FILE;
+    }
+    return siFailed > 0 ? ERROR_UNKNOWN : SUCCESS_CODE;
+}
+
+CShardWorker::CShardWorker(const std::string& socketPath) : m_strSocketPath(socketPath), m_bShardFinished(false), m_ullProgress(0) {}
+
+int CShardWorker::Connect() {
+    struct sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (m_strSocketPath.size() >= sizeof(address.sun_path)) {
+        return -1;
+    }
+    strncpy(address.sun_path, m_strSocketPath.c_str(), sizeof(address.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd != -1 && connect(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+// 배정된 경로들을 헤드리스 스캔으로 검사하고 요약을 샤드 로그 경로에 저장
+int CShardWorker::ScanShard(const Json::Value& shard) {
+    ST_ScanOptions options;
+    options.Headless = true;
+    options.ScanTypeOption = shard.get("engine", YARA_RULE).asInt();
+    options.FileTypeOption = shard.get("file_type", ALL_FILES).asInt();
+    options.Extension = shard.get("extension", "").asString();
+    options.Prioritize = shard.get("prioritize", false).asBool();
+    options.AutoQuarantine = shard.get("quarantine", false).asBool();
+    options.SummaryPath = shard["log"].asString();
+    options.Checkpoint = false;
+    options.Progress = &m_ullProgress;
+    for (const Json::Value& path : shard["paths"]) {
+        options.ShardPaths.push_back(path.asString());
+    }
+    for (const Json::Value& path : shard["shallow"]) {
+        options.ShallowPaths.push_back(path.asString());
+    }
+    if (options.ShardPaths.empty()) {
+        return ERROR_INVALID_INPUT;
+    }
+    options.TargetPath = options.ShardPaths.front();
+
+    CFileScanner IFileScanner;
+    IFileScanner.SetOptions(options);
+    return IFileScanner.StartScan();
+}
+
+// 샤드를 스캔하는 동안 코디네이터가 작업자를 멈춘 것으로 보지 않도록 주기적으로 알림 (코디네이터는 응답하지 않음)
+// 진행 카운터를 함께 보내 스캔 스레드가 멈추면 하트비트가 와도 코디네이터가 샤드를 회수할 수 있게 함
+void CShardWorker::SendHeartbeats(CDaemonConnection& connection, const Json::Value& shardId) {
+    Json::StreamWriterBuilder writerBuilder;
+    writerBuilder["indentation"] = "";
+    Json::Value request;
+    request["type"] = "heartbeat";
+    request["shard"] = shardId;
+    std::unique_lock<std::mutex> lock(m_heartbeatMutex);
+    while (!m_cvHeartbeat.wait_for(lock, std::chrono::seconds(SHARD_HEARTBEAT_SEC), [this] { return m_bShardFinished; })) {
+        request["progress"] = Json::UInt64(m_ullProgress.load(std::memory_order_relaxed));
+        if (!connection.WriteLine(Json::writeString(writerBuilder, request))) {
+            // 코디네이터가 샤드를 회수했거나 종료되어 결과를 보낼 곳이 없음
+            // 스캔이 멈춘 채로 남아 있으면 코디네이터가 로컬 작업자를 끝까지 기다리므로 프로세스를 바로 끝냄
+            PrintErrorMessage(ERROR_SEND_FAILED, m_strSocketPath);
+            _exit(ERROR_SEND_FAILED);
+        }
+    }
+}
+
+// --shard-worker 옵션 입력 시 실행되는 함수, 코디네이터가 "done"을 보내거나 연결이 끊기면 종료
+int CShardWorker::Run() {
+    int socketFd = Connect();
+    if (socketFd == -1) {
+        PrintErrorMessage(ERROR_CANNOT_OPEN_FILE, m_strSocketPath);
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+    CDaemonConnection connection(socketFd);
+    Json::StreamWriterBuilder writerBuilder;
+    writerBuilder["indentation"] = "";
+    Json::CharReaderBuilder readerBuilder;
+    std::unique_ptr<Json::CharReader> reader(readerBuilder.newCharReader());
+
+    Json::Value request;
+    request["type"] = "hello";
+    request["worker"] = GetWorkerName();
+    std::string strLine;
+    if (!connection.WriteLine(Json::writeString(writerBuilder, request)) || !connection.ReadLine(strLine)) {
+        return ERROR_SEND_FAILED;
+    }
+
+    uint64_t ullShards = 0;
+    while (!CFileScanner::m_bStopScanning) {
+        request = Json::Value();
+        request["type"] = "next";
+        Json::Value response;
+        std::string strErrors;
+        if (!connection.WriteLine(Json::writeString(writerBuilder, request)) || !connection.ReadLine(strLine)
+            || !reader->parse(strLine.data(), strLine.data() + strLine.size(), &response, &strErrors)) {
+            break; // 코디네이터 종료
+        }
+        std::string strStatus = response.get("status", "").asString();
+        if (strStatus == "done") {
+            break;
+        }
+        if (strStatus == "wait") {
+            sleep(1);
+            continue;
+        }
+        if (strStatus != "ok") {
+            return ERROR_INVALID_INPUT;
+        }
+
+        m_bShardFinished = false;
+        m_ullProgress = 0;
+        std::thread heartbeat(&CShardWorker::SendHeartbeats, this, std::ref(connection), response["shard"]);
+        int nResult = ScanShard(response);
+        {
+            std::lock_guard<std::mutex> lock(m_heartbeatMutex);
+            m_bShardFinished = true;
+        }
+        m_cvHeartbeat.notify_one();
+        heartbeat.join();
+        if (CFileScanner::m_bStopScanning) {
+            break; // 결과를 보내지 않고 끊으면 코디네이터가 샤드를 다시 배정
+        }
+        request = Json::Value();
+        request["type"] = "result";
+        request["shard"] = response["shard"];
+        request["status"] = nResult == SUCCESS_CODE ? "ok" : "error";
+        if (nResult != SUCCESS_CODE) {
+            request["error"] = GetErrorMessage(nResult);
+        }
+        if (!connection.WriteLine(Json::writeString(writerBuilder, request)) || !connection.ReadLine(strLine)) {
+            break;
+        }
+        ullShards++;
+    }
+    std::cout << "\n[+] Shard worker finished after " << ullShards << " shards.\n";
+    return SUCCESS_CODE;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <jsoncpp/json/json.h>
+#include <sys/types.h>
+#include "file_scanner.h"
+
+class CDaemonConnection; //전방 선언
+
+#define COORDINATOR_SOCKET_PATH "logs/scan_coordinator.sock"
+#define SHARD_LOG_DIR "logs/shards"                // 샤드별 스캔 요약과 로컬 작업자 출력
+#define SHARD_REPORT_PATH "logs/shard_report.json" // --summary가 없을 때 합친 결과를 저장하는 경로
+#define SHARDS_PER_WORKER 4                        // 작업자보다 샤드를 많이 만들어 먼저 끝난 작업자가 남은 샤드를 가져감
+#define SHARD_SPLIT_RATIO 4                        // 샤드 목표 크기의 1/N보다 큰 하위 트리는 더 잘게 나눔
+#define SHARD_MAX_DEPTH 8                          // 크기를 따로 집계하는 최대 디렉토리 깊이, 더 깊은 곳은 상위 디렉토리에 합산
+#define SHARD_FILE_COST_BYTES (64 * 1024)          // 파일 하나를 열고 닫는 비용을 바이트로 환산한 값 (작은 파일이 많은 트리 보정)
+#define SHARD_MAX_ATTEMPTS 3                       // 이 횟수만큼 작업자가 실패한 샤드는 포기하고 보고서에 표시
+#define COORDINATOR_POLL_MS 1000
+#define SHARD_HEARTBEAT_SEC 10                     // 작업자가 샤드를 처리하는 동안 하트비트를 보내는 간격
+#define SHARD_LEASE_SEC 60                         // 이 시간 동안 하트비트가 없으면 작업자가 멈춘 것으로 보고 샤드를 회수
+#define SHARD_STALL_HEARTBEATS 60                  // 진행 카운터가 그대로인 하트비트가 이만큼 이어지면 임대를 연장하지 않음 (10분)
+
+// 샤드를 이루는 순회 단위, 하위 디렉토리를 다른 단위로 나눈 경우 Recursive = false (바로 아래 파일만)
+struct ST_ScanUnit {
+    std::string Path;
+    bool Recursive;
+    uint64_t Files;
+    uint64_t Bytes;
+};
+
+enum EShardState {
+    SHARD_PENDING = 0,
+    SHARD_RUNNING,
+    SHARD_DONE,
+    SHARD_FAILED
+};
+
+struct ST_ScanShard {
+    int Id;
+    std::vector<ST_ScanUnit> Units;
+    uint64_t EstimatedFiles;
+    uint64_t EstimatedWeight;
+    int State;
+    int Attempts;
+    std::string Worker;       // 마지막으로 배정된 작업자 (pid@host)
+    std::string LogPath;      // 마지막 시도의 샤드 요약 경로
+    double Seconds;
+    int OwnerFd;              // 처리 중인 작업자 연결 (SHARD_RUNNING일 때만 유효)
+    std::chrono::steady_clock::time_point LeaseExpiry;
+    uint64_t Progress;        // 마지막 하트비트의 진행 카운터 (집계/검사한 파일 수)
+    int StalledHeartbeats;    // 진행 카운터가 바뀌지 않은 채 연속으로 받은 하트비트 수
+};
+
+// 스캔 경로를 디렉토리 크기 추정치로 균형 잡힌 샤드로 나누고 Unix 소켓으로 작업자 프로세스에 배정
+// 작업자 연결이 샤드를 끝내기 전에 끊기면 그 샤드를 다시 대기열에 넣고, 모두 끝나면 샤드별 요약을 하나의 보고서로 합침
+class CScanCoordinator {
+public:
+    static std::atomic<bool> m_bStopCoordinator;
+
+    CScanCoordinator(const std::string& socketPath, const std::vector<std::string>& roots, const ST_ScanOptions& options, int localWorkers, int shardCount);
+    ~CScanCoordinator();
+    int Run();
+
+private:
+    std::string m_strSocketPath;
+    std::vector<std::string> m_vecRoots;
+    ST_ScanOptions m_options;
+    int m_nLocalWorkers;
+    int m_nShardCount;
+    int m_listenFd;
+    std::vector<ST_ScanShard> m_vecShards;
+    std::deque<int> m_quePending;
+    std::vector<pid_t> m_vecChildren;
+    std::vector<std::thread> m_vecConnections;
+    std::vector<int> m_vecConnectionFds;
+    std::mutex m_mutex;
+    int m_nActiveConnections;
+    uint64_t m_ullReassigned;
+
+    int PlanShards();
+    int OpenSocket();
+    int SpawnLocalWorkers();
+    void ServeWorker(int clientFd);
+    Json::Value AssignShard(const std::string& worker, int ownerFd, int& shardId, int& attempt);
+    void RenewLease(int shardId, int attempt, const Json::Value& progress);
+    void ReleaseShard(int shardId, int attempt, const std::string& reason);
+    void ReleaseShardLocked(int shardId, int attempt, const std::string& reason);
+    void ExpireLeases();
+    bool IsFinished();
+    int MergeReports(double elapsedSec);
+};
+
+// 코디네이터에서 샤드를 하나씩 받아 스캔하고 결과 요약 경로를 돌려주는 작업자
+class CShardWorker {
+public:
+    explicit CShardWorker(const std::string& socketPath);
+    int Run();
+
+private:
+    std::string m_strSocketPath;
+
+    std::mutex m_heartbeatMutex;
+    std::condition_variable m_cvHeartbeat;
+    bool m_bShardFinished;
+    std::atomic<uint64_t> m_ullProgress; // 스캔 중인 샤드에서 집계/검사를 마친 파일 수, 하트비트에 실어 보냄
+
+    int Connect();
+    int ScanShard(const Json::Value& shard);
+    void SendHeartbeats(CDaemonConnection& connection, const Json::Value& shardId);
+};
@@ -0,0 +1,532 @@
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <memory>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "ansi_color.h"
+#include "file_scanner.h"
+#include "json_log_writer.h"
+#include "mapped_file.h"
+#include "scan_daemon.h"
+#include "util.h"
+
+std::atomic<bool> CScanDaemon::m_bStopDaemon(false);
+
+// 연결 시점의 상대 프로세스 uid/gid와 보조 그룹을 읽음
+static bool ReadPeerCredentials(int fd, ST_DaemonPeer& peer) {
+    struct ucred credentials = {};
+    socklen_t length = sizeof(credentials);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &length) != 0) {
+        return false;
+    }
+    peer.Pid = credentials.pid;
+    peer.Uid = credentials.uid;
+    peer.Gid = credentials.gid;
+    peer.Groups.resize(NGROUPS_MAX);
+    length = static_cast<socklen_t>(peer.Groups.size() * sizeof(gid_t));
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERGROUPS, peer.Groups.data(), &length) != 0) {
+        return false;
+    }
+    peer.Groups.resize(length / sizeof(gid_t));
+    return true;
+}
+
+// 데몬이 읽을 수 있어도 호출자가 읽을 수 없는 파일의 해시나 탐지 결과가 새지 않도록 호출자 자격으로 파일을 염
+// 같은 사용자면 그대로 열고, root 데몬이면 이 작업자 스레드의 파일 시스템 uid/gid와 보조 그룹만 잠시 바꿈
+// (glibc 래퍼는 모든 스레드에 적용하므로 시스템 콜을 직접 호출해 스레드 단위로만 바꿈)
+static int OpenAsPeer(const ST_DaemonPeer& peer, const std::string& path, CMappedFile& file) {
+    if (peer.Uid == geteuid()) {
+        return file.Open(path);
+    }
+    if (geteuid() != 0) {
+        return ERROR_ACCESS_DENIED;
+    }
+    std::vector<gid_t> vecOwnGroups(NGROUPS_MAX);
+    int nOwnGroups = getgroups(static_cast<int>(vecOwnGroups.size()), vecOwnGroups.data());
+    if (nOwnGroups < 0 || syscall(SYS_setgroups, peer.Groups.size(), peer.Groups.data()) != 0) {
+        return ERROR_ACCESS_DENIED;
+    }
+    syscall(SYS_setfsgid, peer.Gid);
+    syscall(SYS_setfsuid, peer.Uid);
+    int nResult = ERROR_ACCESS_DENIED;
+    // setfsuid는 실패해도 이전 값을 반환하므로 다시 호출해 실제로 바뀌었는지 확인
+    if (static_cast<uid_t>(syscall(SYS_setfsuid, -1)) == peer.Uid && static_cast<gid_t>(syscall(SYS_setfsgid, -1)) == peer.Gid) {
+        nResult = file.Open(path);
+    }
+    syscall(SYS_setfsuid, geteuid());
+    syscall(SYS_setfsgid, getegid());
+    syscall(SYS_setgroups, static_cast<size_t>(nOwnGroups), vecOwnGroups.data());
+    return nResult;
+}
+
+static void DaemonSignalHandler(int signal) {
+    if (signal == SIGINT || signal == SIGTERM) {
+        CScanDaemon::m_bStopDaemon = true;
+    }
+}
+
+CDaemonConnection::CDaemonConnection(int fd) : m_fd(fd) {}
+
+CDaemonConnection::~CDaemonConnection() {
+    for (int fd : m_queFds) {
+        close(fd);
+    }
+    close(m_fd);
+}
+
+// 소켓에서 한 번 읽어 대기 버퍼에 추가, 함께 전달된 디스크립터는 순서대로 보관
+// deadline까지 아무것도 오지 않으면 실패로 돌려 유휴 연결이 작업자를 계속 붙잡지 않게 함
+bool CDaemonConnection::Receive(std::chrono::steady_clock::time_point deadline) {
+    char buffer[BUFFER_SIZE];
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int) * 4)];
+    while (true) {
+        struct iovec iov = {buffer, sizeof(buffer)};
+        struct msghdr message = {};
+        message.msg_iov = &iov;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        ssize_t length = recvmsg(m_fd, &message, MSG_CMSG_CLOEXEC);
+        if (length > 0) {
+            for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg != nullptr; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+                if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+                    size_t siCount = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                    const int* fds = reinterpret_cast<const int*>(CMSG_DATA(cmsg));
+                    m_queFds.insert(m_queFds.end(), fds, fds + siCount);
+                }
+            }
+            m_strPending.append(buffer, length);
+            return true;
+        }
+        if (length == 0) {
+            return false;
+        }
+        // 수신 대기 시간 초과는 종료 요청과 유휴 제한을 확인한 뒤 계속 대기
+        if ((errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) && !CScanDaemon::m_bStopDaemon
+            && std::chrono::steady_clock::now() < deadline) {
+            continue;
+        }
+        return false;
+    }
+}
+
+// 한 바이트씩 흘려보내는 클라이언트도 막도록 줄 전체가 DAEMON_IDLE_TIMEOUT_SEC 안에 도착해야 함
+bool CDaemonConnection::ReadLine(std::string& line) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(DAEMON_IDLE_TIMEOUT_SEC);
+    size_t siNewline;
+    while ((siNewline = m_strPending.find('\n')) == std::string::npos) {
+        if (m_strPending.size() > DAEMON_MAX_LINE_LENGTH || !Receive(deadline)) {
+            return false;
+        }
+    }
+    line.assign(m_strPending, 0, siNewline);
+    m_strPending.erase(0, siNewline + 1);
+    return true;
+}
+
+// 헤더 뒤에 이어지는 바이트를 읽음, 이미 받아둔 부분을 먼저 쓰고 나머지는 버퍼로 바로 수신
+// 본문은 클 수 있으므로 유휴 제한은 전체가 아니라 조각 사이의 간격에 적용
+bool CDaemonConnection::ReadExact(size_t size, std::vector<uint8_t>& buffer) {
+    buffer.resize(size);
+    size_t siCopied = std::min(size, m_strPending.size());
+    memcpy(buffer.data(), m_strPending.data(), siCopied);
+    m_strPending.erase(0, siCopied);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(DAEMON_IDLE_TIMEOUT_SEC);
+    while (siCopied < size) {
+        ssize_t length = recv(m_fd, buffer.data() + siCopied, size - siCopied, 0);
+        if (length > 0) {
+            siCopied += length;
+            deadline = std::chrono::steady_clock::now() + std::chrono::seconds(DAEMON_IDLE_TIMEOUT_SEC);
+        } else if (length == 0 || ((errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) || CScanDaemon::m_bStopDaemon)
+                   || std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int CDaemonConnection::TakeDescriptor() {
+    if (m_queFds.empty()) {
+        return -1;
+    }
+    int fd = m_queFds.front();
+    m_queFds.pop_front();
+    return fd;
+}
+
+bool CDaemonConnection::WriteLine(const std::string& line) {
+    return SendLine(line, -1);
+}
+
+// 한 줄을 전송, passFd가 있으면 첫 바이트와 함께 SCM_RIGHTS로 전달
+bool CDaemonConnection::SendLine(const std::string& line, int passFd) {
+    std::string strMessage = line + "\n";
+    size_t siSent = 0;
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+    while (siSent < strMessage.size()) {
+        struct iovec iov = {&strMessage[siSent], strMessage.size() - siSent};
+        struct msghdr message = {};
+        message.msg_iov = &iov;
+        message.msg_iovlen = 1;
+        if (passFd != -1 && siSent == 0) {
+            memset(control, 0, sizeof(control));
+            message.msg_control = control;
+            message.msg_controllen = sizeof(control);
+            struct cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_RIGHTS;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+            memcpy(CMSG_DATA(cmsg), &passFd, sizeof(int));
+        }
+        ssize_t length = sendmsg(m_fd, &message, MSG_NOSIGNAL);
+        if (length < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        siSent += length;
+    }
+    return true;
+}
+
+CScanDaemon::CScanDaemon(const std::string& socketPath, int workerCount, int defaultScanType)
+    : m_strSocketPath(socketPath), m_nWorkerCount(workerCount > 0 ? workerCount : 1), m_nDefaultScanType(defaultScanType),
+      m_listenFd(-1), m_engineManager(YARA_RULES_PATH, HASH_LIST_PATH), m_ullRequestCount(0) {}
+
+CScanDaemon::~CScanDaemon() {
+    if (m_listenFd != -1) {
+        close(m_listenFd);
+        unlink(m_strSocketPath.c_str());
+    }
+}
+
+// 남아있는 소켓 파일은 이전 실행의 흔적이므로 지우고 새로 바인드, 접근은 소유자/그룹으로 제한
+int CScanDaemon::OpenSocket() {
+    struct stat socketStat;
+    if (lstat(m_strSocketPath.c_str(), &socketStat) == 0 && S_ISSOCK(socketStat.st_mode)) {
+        unlink(m_strSocketPath.c_str());
+    }
+
+    m_listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_listenFd == -1) {
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+    int nResult = BindUnixSocket(m_listenFd, m_strSocketPath, 0660);
+    if (nResult != SUCCESS_CODE || listen(m_listenFd, SOMAXCONN) != 0) {
+        close(m_listenFd);
+        m_listenFd = -1;
+        return nResult != SUCCESS_CODE ? nResult : ERROR_CANNOT_OPEN_FILE;
+    }
+    return SUCCESS_CODE;
+}
+
+int CScanDaemon::Run() {
+    int nResult = m_engineManager.Load();
+    if (nResult != SUCCESS_CODE) {
+        PrintErrorMessage(nResult, HASH_LIST_PATH);
+        return nResult;
+    }
+    m_engineManager.StartWatching();
+
+    nResult = OpenSocket();
+    if (nResult != SUCCESS_CODE) {
+        PrintErrorMessage(nResult, m_strSocketPath);
+        return nResult;
+    }
+
+    // SA_RESTART 없이 등록해 poll이 신호로 깨어나도록 함
+    struct sigaction action = {};
+    action.sa_handler = DaemonSignalHandler;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    for (int i = 0; i < m_nWorkerCount; i++) {
+        m_vecWorkers.emplace_back(&CScanDaemon::RunWorker, this);
+    }
+    std::cout << COLOR_GREEN << "[+] Scan daemon listening on " << m_strSocketPath << " (" << m_nWorkerCount << " workers)" << COLOR_RESET << "\n";
+
+    while (!m_bStopDaemon) {
+        struct pollfd pfd = {m_listenFd, POLLIN, 0};
+        if (poll(&pfd, 1, DAEMON_RECEIVE_TIMEOUT_SEC * 1000) <= 0) {
+            continue;
+        }
+        int clientFd = accept4(m_listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (clientFd == -1) {
+            continue;
+        }
+        struct timeval timeout = {DAEMON_RECEIVE_TIMEOUT_SEC, 0};
+        setsockopt(clientFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queClients.push_back(clientFd);
+        }
+        m_cv.notify_one();
+    }
+
+    m_cv.notify_all();
+    for (std::thread& worker : m_vecWorkers) {
+        worker.join();
+    }
+    for (int clientFd : m_queClients) {
+        close(clientFd);
+    }
+    m_queClients.clear();
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+    std::cout << "\n[+] Scan daemon stopped after " << m_ullRequestCount.load() << " requests.\n";
+    return SUCCESS_CODE;
+}
+
+void CScanDaemon::RunWorker() {
+    while (true) {
+        int clientFd;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] { return m_bStopDaemon || !m_queClients.empty(); });
+            if (m_bStopDaemon) {
+                return;
+            }
+            clientFd = m_queClients.front();
+            m_queClients.pop_front();
+        }
+        ServeConnection(clientFd);
+    }
+}
+
+// 연결이 끊기거나 데몬이 종료될 때까지 요청을 한 줄씩 처리하고 결과도 한 줄의 JSON으로 응답
+void CScanDaemon::ServeConnection(int clientFd) {
+    CDaemonConnection connection(clientFd);
+    ST_DaemonPeer peer;
+    if (!ReadPeerCredentials(clientFd, peer)) {
+        return;
+    }
+    Json::CharReaderBuilder readerBuilder;
+    std::unique_ptr<Json::CharReader> reader(readerBuilder.newCharReader());
+    Json::StreamWriterBuilder writerBuilder;
+    writerBuilder["indentation"] = "";
+    std::vector<uint8_t> buffer; // buffer 요청용, 연결 동안 재사용
+
+    std::string strLine;
+    while (!m_bStopDaemon && connection.ReadLine(strLine)) {
+        auto start = std::chrono::steady_clock::now();
+        Json::Value request;
+        Json::Value response;
+        std::string strErrors;
+        if (!reader->parse(strLine.data(), strLine.data() + strLine.size(), &request, &strErrors) || !request.isObject()) {
+            response["status"] = "error";
+            response["error"] = "Malformed request";
+        } else {
+            response = HandleRequest(connection, peer, request, buffer);
+            if (request.isMember("id")) {
+                response["id"] = request["id"];
+            }
+        }
+        m_ullRequestCount++;
+        bool bClose = response.get("close", false).asBool();
+        response.removeMember("close");
+        response["latency_us"] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        if (!connection.WriteLine(Json::writeString(writerBuilder, response))) {
+            break;
+        }
+        // 헤더만 받고 본문을 읽지 못한 buffer 요청은 스트림이 어긋나므로 연결을 종료
+        if (bClose) {
+            break;
+        }
+    }
+}
+
+Json::Value CScanDaemon::HandleRequest(CDaemonConnection& connection, const ST_DaemonPeer& peer, const Json::Value& request,
+                                       std::vector<uint8_t>& buffer) {
+    Json::Value response;
+    std::shared_ptr<const ST_EngineSnapshot> engine = m_engineManager.Acquire();
+    std::string strType = request.get("type", "").asString();
+
+    int nScanType = m_nDefaultScanType;
+    std::string strEngine = request.get("engine", "").asString();
+    if (strEngine == "yara") {
+        nScanType = YARA_RULE;
+    } else if (strEngine == "hash") {
+        nScanType = HASH_COMPARISON;
+    } else if (!strEngine.empty()) {
+        response["status"] = "error";
+        response["error"] = "Unknown engine: " + strEngine;
+        return response;
+    }
+
+    if (strType == "ping") {
+        response["status"] = "ok";
+        response["generation"] = Json::UInt64(engine->Generation);
+        return response;
+    }
+
+    if (strType == "buffer") {
+        Json::UInt64 ullSize = request.get("size", 0).asUInt64();
+        if (ullSize > DAEMON_MAX_BUFFER_SIZE || !connection.ReadExact(ullSize, buffer)) {
+            response["status"] = "error";
+            response["error"] = "Cannot read buffer of " + std::to_string(ullSize) + " bytes";
+            response["close"] = true;
+            return response;
+        }
+        return ScanData(*engine, nScanType, request.get("name", "<buffer>").asString(), buffer.data(), buffer.size());
+    }
+
+    CMappedFile file;
+    std::string strName;
+    int nResult;
+    if (strType == "path") {
+        strName = request.get("path", "").asString();
+        nResult = OpenAsPeer(peer, strName, file);
+    } else if (strType == "fd") {
+        int fd = connection.TakeDescriptor();
+        strName = request.get("name", "<fd>").asString();
+        nResult = fd == -1 ? ERROR_INVALID_INPUT : file.Attach(fd);
+    } else {
+        response["status"] = "error";
+        response["error"] = "Unknown request type: " + strType;
+        return response;
+    }
+
+    if (nResult == SUCCESS_CODE) {
+        nResult = file.Map();
+    }
+    if (nResult != SUCCESS_CODE) {
+        response["status"] = "error";
+        response["error"] = GetErrorMessage(nResult);
+        return response;
+    }
+    if (nScanType == YARA_RULE && engine->YaraChecker->IsRuleFile(file.Stat())) {
+        response["status"] = "skipped";
+        response["error"] = "YARA rule file";
+        return response;
+    }
+    return ScanData(*engine, nScanType, strName, file.Data(), file.Size(), &file.Stat());
+}
+
+Json::Value CScanDaemon::ScanData(const ST_EngineSnapshot& engine, int scanType, const std::string& name, const uint8_t* data, size_t size,
+                                  const struct stat* fileStat) {
+    Json::Value response;
+    std::string strDetectionCause;
+    std::string strFileHash;
+    ST_YaraExternals externals = CYaraChecker::MakeExternals(name, fileStat, data, size);
+    int nResult = engine.Scan(scanType, name, data, size, strDetectionCause, &strFileHash, &externals);
+    if (!strFileHash.empty()) {
+        response["sha256"] = strFileHash;
+    }
+
+    response["status"] = nResult == SUCCESS_CODE ? "ok" : "error";
+    if (nResult != SUCCESS_CODE) {
+        response["error"] = GetErrorMessage(nResult);
+    }
+    response["engine"] = scanType == YARA_RULE ? "yara" : "hash";
+    response["name"] = name;
+    response["size"] = Json::UInt64(size);
+    response["generation"] = Json::UInt64(engine.Generation);
+    response["detected"] = !strDetectionCause.empty();
+    if (!strDetectionCause.empty()) {
+        response["cause"] = strDetectionCause;
+        LogDetection(name, scanType, strDetectionCause, size);
+    }
+    return response;
+}
+
+// 탐지 결과를 일반 스캔과 같은 형식으로 스캔 로그에 기록
+void CScanDaemon::LogDetection(const std::string& name, int scanType, const std::string& cause, size_t size) {
+    Json::Value logEntry;
+    logEntry["timestamp"] = GetCurrentTimeWithMilliseconds();
+    logEntry["scan_type"] = scanType == YARA_RULE ? "Yara" : "Hash";
+    logEntry["detected_file"] = name;
+    logEntry["hash_value"] = scanType == HASH_COMPARISON ? cause : "N/A";
+    logEntry["yara_rule"] = scanType == YARA_RULE ? cause : "N/A";
+    logEntry["is_moved"] = "False";
+    logEntry["path_after_moving"] = "N/A";
+    logEntry["file_size"] = Json::UInt64(size);
+    CJsonLogWriter::Instance().Append(logEntry, LOG_FILE_PATH);
+}
+
+CScanClient::CScanClient(const std::string& socketPath) : m_strSocketPath(socketPath) {}
+
+int CScanClient::Connect() {
+    struct sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (m_strSocketPath.size() >= sizeof(address.sun_path)) {
+        return -1;
+    }
+    strncpy(address.sun_path, m_strSocketPath.c_str(), sizeof(address.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd != -1 && connect(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+// 파일은 열린 디스크립터를 넘기고(데몬이 경로 권한과 무관하게 읽을 수 있음), "-"는 표준 입력을 버퍼로 전송
+// 응답 JSON을 그대로 출력하고, 탐지 시 ERROR_DETECTED_MALICIOUS_ACTIVITY를 반환
+int CScanClient::Submit(const std::string& target) {
+    int socketFd = Connect();
+    if (socketFd == -1) {
+        PrintErrorMessage(ERROR_CANNOT_OPEN_FILE, m_strSocketPath);
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+    CDaemonConnection connection(socketFd);
+    Json::StreamWriterBuilder writerBuilder;
+    writerBuilder["indentation"] = "";
+    Json::Value request;
+    bool bSent;
+
+    if (target == "-") {
+        std::string strData;
+        char buffer[BUFFER_SIZE];
+        ssize_t length;
+        while ((length = read(STDIN_FILENO, buffer, sizeof(buffer))) > 0) {
+            strData.append(buffer, length);
+        }
+        request["type"] = "buffer";
+        request["name"] = "<stdin>";
+        request["size"] = Json::UInt64(strData.size());
+        bSent = connection.WriteLine(Json::writeString(writerBuilder, request))
+            && send(socketFd, strData.data(), strData.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(strData.size());
+    } else {
+        int fd = open(target.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1) {
+            PrintErrorMessage(ERROR_CANNOT_OPEN_FILE, target);
+            return ERROR_CANNOT_OPEN_FILE;
+        }
+        request["type"] = "fd";
+        request["name"] = GetAbsolutePath(target);
+        bSent = connection.SendLine(Json::writeString(writerBuilder, request), fd);
+        close(fd);
+    }
+
+    std::string strLine;
+    if (!bSent || !connection.ReadLine(strLine)) {
+        PrintErrorMessage(ERROR_SEND_FAILED, m_strSocketPath);
+        return ERROR_SEND_FAILED;
+    }
+    std::cout << strLine << "\n";
+
+    Json::Value response;
+    Json::CharReaderBuilder readerBuilder;
+    std::unique_ptr<Json::CharReader> reader(readerBuilder.newCharReader());
+    std::string strErrors;
+    if (!reader->parse(strLine.data(), strLine.data() + strLine.size(), &response, &strErrors)) {
+        return ERROR_INVALID_INPUT;
+    }
+    if (response.get("status", "").asString() == "error") {
+        return ERROR_UNKNOWN;
+    }
+    return response.get("detected", false).asBool() ? ERROR_DETECTED_MALICIOUS_ACTIVITY : SUCCESS_CODE;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/types.h>
+#include <jsoncpp/json/json.h>
+#include "engine_manager.h"
+
+#define DAEMON_SOCKET_PATH "logs/scan_daemon.sock"
+#define DAEMON_MAX_BUFFER_SIZE (64 * 1024 * 1024) // 메모리 버퍼 요청의 최대 크기
+#define DAEMON_MAX_LINE_LENGTH 65536              // 요청 헤더(JSON 한 줄)의 최대 길이
+#define DAEMON_RECEIVE_TIMEOUT_SEC 1              // 종료 요청을 확인하기 위한 수신 대기 간격
+#define DAEMON_IDLE_TIMEOUT_SEC 30                // 요청 한 줄이나 본문의 다음 조각을 기다리는 최대 시간, 넘으면 연결을 끊음
+
+// 클라이언트 연결 하나의 송수신 상태
+// 요청은 JSON 한 줄이며, buffer 요청은 그 뒤에 size 바이트가 이어지고 fd 요청은 SCM_RIGHTS로 디스크립터가 함께 전달됨
+class CDaemonConnection {
+public:
+    explicit CDaemonConnection(int fd);
+    ~CDaemonConnection();
+    bool ReadLine(std::string& line);
+    bool ReadExact(size_t size, std::vector<uint8_t>& buffer);
+    int TakeDescriptor();
+    bool WriteLine(const std::string& line);
+    bool SendLine(const std::string& line, int passFd);
+
+    CDaemonConnection(const CDaemonConnection&) = delete;
+    CDaemonConnection& operator=(const CDaemonConnection&) = delete;
+
+private:
+    int m_fd;
+    std::string m_strPending; // 수신했지만 아직 처리하지 않은 바이트
+    std::deque<int> m_queFds; // 수신했지만 아직 요청에 쓰이지 않은 디스크립터
+
+    bool Receive(std::chrono::steady_clock::time_point deadline);
+};
+
+// 연결한 프로세스의 자격 (SO_PEERCRED/SO_PEERGROUPS), path 요청은 이 자격으로 파일을 염
+struct ST_DaemonPeer {
+    pid_t Pid;
+    uid_t Uid;
+    gid_t Gid;
+    std::vector<gid_t> Groups;
+};
+
+// 룰/해시를 메모리에 유지한 채 Unix 도메인 소켓으로 검사 요청을 받는 상주 스캐너
+// 연결은 작업자 풀에 분배되고, 각 작업자는 연결이 끊길 때까지 요청을 순서대로 처리
+class CScanDaemon {
+public:
+    static std::atomic<bool> m_bStopDaemon;
+
+    CScanDaemon(const std::string& socketPath, int workerCount, int defaultScanType);
+    ~CScanDaemon();
+    int Run();
+
+private:
+    std::string m_strSocketPath;
+    int m_nWorkerCount;
+    int m_nDefaultScanType;
+    int m_listenFd;
+    CEngineManager m_engineManager;
+    std::vector<std::thread> m_vecWorkers;
+    std::deque<int> m_queClients;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::atomic<uint64_t> m_ullRequestCount;
+
+    int OpenSocket();
+    void RunWorker();
+    void ServeConnection(int clientFd);
+    Json::Value HandleRequest(CDaemonConnection& connection, const ST_DaemonPeer& peer, const Json::Value& request,
+                              std::vector<uint8_t>& buffer);
+    Json::Value ScanData(const ST_EngineSnapshot& engine, int scanType, const std::string& name, const uint8_t* data, size_t size,
+                         const struct stat* fileStat = nullptr);
+    void LogDetection(const std::string& name, int scanType, const std::string& cause, size_t size);
+};
+
+// 실행 중인 데몬에 파일 하나를 검사 요청하는 클라이언트
+class CScanClient {
+public:
+    explicit CScanClient(const std::string& socketPath);
+    int Submit(const std::string& target);
+
+private:
+    std::string m_strSocketPath;
+
+    int Connect();
+};
@@ -0,0 +1,63 @@
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include "scan_priority.h"
+
+// 메타데이터 점수 계산, 파일 내용은 ELF/PE 여부 확인에 필요한 4바이트만 읽음
+int CScanPriority::ComputeScore(const std::string& path, const struct stat& fileStat, const struct stat* parentStat, time_t now) {
+    int nScore = 0;
+    time_t changeTime = std::max(fileStat.st_mtime, fileStat.st_ctime);
+    double dAge = difftime(now, changeTime);
+    if (dAge < 24 * 3600) {
+        nScore += PRIORITY_SCORE_RECENT_DAY;
+    } else if (dAge < 7 * 24 * 3600) {
+        nScore += PRIORITY_SCORE_RECENT_WEEK;
+    } else if (dAge < 30 * 24 * 3600) {
+        nScore += PRIORITY_SCORE_RECENT_MONTH;
+    }
+    if (fileStat.st_mode & (S_IXUSR | S_IXGRP | S_IXOTH)) {
+        nScore += PRIORITY_SCORE_EXECUTABLE;
+    }
+    if ((fileStat.st_mode & S_IWOTH) || (parentStat != nullptr && (parentStat->st_mode & S_IWOTH))) {
+        nScore += PRIORITY_SCORE_WRITABLE;
+    }
+    if (nScore < PRIORITY_MIN_SCORE && nScore + PRIORITY_SCORE_BINARY >= PRIORITY_MIN_SCORE && HasBinaryMagic(path)) {
+        nScore += PRIORITY_SCORE_BINARY;
+    } else if (nScore >= PRIORITY_MIN_SCORE && (fileStat.st_mode & (S_IXUSR | S_IXGRP | S_IXOTH)) && HasBinaryMagic(path)) {
+        nScore += PRIORITY_SCORE_BINARY; // 이미 대상이면 실행 파일만 확인하여 대상 안에서의 순서를 정함
+    }
+    return nScore;
+}
+
+bool CScanPriority::HasBinaryMagic(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY | O_NOFOLLOW | O_NONBLOCK | O_CLOEXEC);
+    if (fd == -1) {
+        return false;
+    }
+    unsigned char magic[4] = {};
+    ssize_t nRead = pread(fd, magic, sizeof(magic), 0);
+    close(fd);
+    if (nRead == 4 && magic[0] == 0x7f && magic[1] == 'E' && magic[2] == 'L' && magic[3] == 'F') {
+        return true;
+    }
+    return nRead >= 2 && magic[0] == 'M' && magic[1] == 'Z';
+}
+
+// 점수가 높은 순, 같은 점수면 최근에 바뀐 파일부터
+// 목록이 너무 크면 점수가 낮은 쪽을 잘라내며, 잘린 파일은 일반 순회에서 스캔됨
+void CScanPriority::SortCandidates(std::vector<ST_ScanCandidate>& candidates) {
+    auto Compare = [](const ST_ScanCandidate& lhs, const ST_ScanCandidate& rhs) {
+        if (lhs.Score != rhs.Score) {
+            return lhs.Score > rhs.Score;
+        }
+        if (lhs.ChangeTime != rhs.ChangeTime) {
+            return lhs.ChangeTime > rhs.ChangeTime;
+        }
+        return lhs.Path < rhs.Path;
+    };
+    if (candidates.size() > PRIORITY_MAX_CANDIDATES) {
+        std::nth_element(candidates.begin(), candidates.begin() + PRIORITY_MAX_CANDIDATES, candidates.end(), Compare);
+        candidates.resize(PRIORITY_MAX_CANDIDATES);
+    }
+    std::sort(candidates.begin(), candidates.end(), Compare);
+}
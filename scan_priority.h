@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+#define PRIORITY_SCORE_RECENT_DAY 40      // mtime/ctime이 24시간 이내
+#define PRIORITY_SCORE_RECENT_WEEK 20     // 7일 이내
+#define PRIORITY_SCORE_RECENT_MONTH 10    // 30일 이내
+#define PRIORITY_SCORE_EXECUTABLE 15      // 실행 권한 비트
+#define PRIORITY_SCORE_WRITABLE 25        // 누구나 쓸 수 있는 위치 (/tmp, /dev/shm 등) 또는 누구나 쓸 수 있는 파일
+#define PRIORITY_SCORE_BINARY 20          // ELF 또는 PE(MZ) 매직
+#define PRIORITY_MIN_SCORE 40             // 이 점수 이상인 파일만 먼저 스캔 (오래된 시스템 바이너리는 35점으로 제외)
+#define PRIORITY_MAX_CANDIDATES 200000    // 먼저 스캔할 목록의 최대 크기, 넘으면 점수가 낮은 쪽을 일반 순서로 넘김
+
+// 우선 스캔 대상 파일 하나 (메타데이터만으로 계산)
+struct ST_ScanCandidate {
+    std::string Path;
+    long long Size;
+    time_t ChangeTime;    // mtime과 ctime 중 최근 값
+    int Score;
+};
+
+// 침해 대응 시 최근에 떨어진 실행 파일을 먼저 찾도록 파일별 위험 점수를 계산하고 스캔 순서를 정함
+// 점수는 stat 결과와 파일 앞 4바이트만 사용하며, 매직은 나머지 점수만으로 기준을 넘을 수 있을 때만 읽음
+class CScanPriority {
+public:
+    static int ComputeScore(const std::string& path, const struct stat& fileStat, const struct stat* parentStat, time_t now);
+    static void SortCandidates(std::vector<ST_ScanCandidate>& candidates);
+
+private:
+    static bool HasBinaryMagic(const std::string& path);
+};
@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include "scan_profiler.h"
+#include "util.h"
+
+#define HISTOGRAM_SUB_BUCKETS (1ULL << HISTOGRAM_SUB_BUCKET_BITS)
+#define HISTOGRAM_BUCKET_COUNT ((HISTOGRAM_MAX_EXPONENT - HISTOGRAM_SUB_BUCKET_BITS + 1) * HISTOGRAM_SUB_BUCKETS)
+
+CLatencyHistogram::CLatencyHistogram()
+    : m_vecBuckets(HISTOGRAM_BUCKET_COUNT, 0), m_ullCount(0), m_ullTotal(0), m_ullMax(0), m_ullBytes(0) {}
+
+// 값 v의 최상위 비트 위치를 지수로, 그 아래 SUB_BUCKET_BITS 비트를 하위 버킷으로 사용
+size_t CLatencyHistogram::GetBucketIndex(uint64_t valueNs) {
+    if (valueNs < HISTOGRAM_SUB_BUCKETS) {
+        return static_cast<size_t>(valueNs);
+    }
+    valueNs = std::min<uint64_t>(valueNs, (1ULL << HISTOGRAM_MAX_EXPONENT) - 1);
+    int nExponent = 63 - __builtin_clzll(valueNs);
+    uint64_t ullSubBucket = (valueNs >> (nExponent - HISTOGRAM_SUB_BUCKET_BITS)) - HISTOGRAM_SUB_BUCKETS;
+    return static_cast<size_t>((nExponent - HISTOGRAM_SUB_BUCKET_BITS + 1) * HISTOGRAM_SUB_BUCKETS + ullSubBucket);
+}
+
+uint64_t CLatencyHistogram::GetBucketUpperBound(size_t index) {
+    if (index < HISTOGRAM_SUB_BUCKETS) {
+        return index;
+    }
+    int nExponent = static_cast<int>(index / HISTOGRAM_SUB_BUCKETS) + HISTOGRAM_SUB_BUCKET_BITS - 1;
+    uint64_t ullSubBucket = index % HISTOGRAM_SUB_BUCKETS;
+    uint64_t ullWidth = 1ULL << (nExponent - HISTOGRAM_SUB_BUCKET_BITS);
+    return (HISTOGRAM_SUB_BUCKETS + ullSubBucket) * ullWidth + ullWidth - 1;
+}
+
+void CLatencyHistogram::Record(uint64_t valueNs, uint64_t bytes) {
+    m_vecBuckets[GetBucketIndex(valueNs)]++;
+    m_ullCount++;
+    m_ullTotal += valueNs;
+    m_ullBytes += bytes;
+    m_ullMax = std::max(m_ullMax, valueNs);
+}
+
+void CLatencyHistogram::Merge(const CLatencyHistogram& other) {
+    for (size_t i = 0; i < m_vecBuckets.size(); ++i) {
+        m_vecBuckets[i] += other.m_vecBuckets[i];
+    }
+    m_ullCount += other.m_ullCount;
+    m_ullTotal += other.m_ullTotal;
+    m_ullBytes += other.m_ullBytes;
+    m_ullMax = std::max(m_ullMax, other.m_ullMax);
+}
+
+uint64_t CLatencyHistogram::GetPercentile(double percentile) const {
+    if (m_ullCount == 0) {
+        return 0;
+    }
+    uint64_t ullTarget = static_cast<uint64_t>(std::ceil(percentile / 100.0 * m_ullCount));
+    ullTarget = std::max<uint64_t>(ullTarget, 1);
+    uint64_t ullSeen = 0;
+    for (size_t i = 0; i < m_vecBuckets.size(); ++i) {
+        ullSeen += m_vecBuckets[i];
+        if (ullSeen >= ullTarget) {
+            return std::min(GetBucketUpperBound(i), m_ullMax);
+        }
+    }
+    return m_ullMax;
+}
+
+Json::Value CLatencyHistogram::ToJson() const {
+    Json::Value value;
+    value["count"] = Json::UInt64(m_ullCount);
+    value["total_ns"] = Json::UInt64(m_ullTotal);
+    value["p50_ns"] = Json::UInt64(GetPercentile(50.0));
+    value["p90_ns"] = Json::UInt64(GetPercentile(90.0));
+    value["p99_ns"] = Json::UInt64(GetPercentile(99.0));
+    value["max_ns"] = Json::UInt64(m_ullMax);
+    value["bytes"] = Json::UInt64(m_ullBytes);
+    value["mb_per_sec"] = m_ullTotal > 0 ? m_ullBytes / (m_ullTotal / 1e9) / (1024.0 * 1024.0) : 0.0;
+    return value;
+}
+
+void CScanProfiler::Record(EScanPhase phase, uint64_t valueNs, uint64_t bytes) {
+    m_phases[phase].Record(valueNs, bytes);
+}
+
+void CScanProfiler::RecordFile(const std::string& filePath, uint64_t valueNs, uint64_t bytes) {
+    if (m_slowFiles.size() < SLOWEST_FILE_COUNT) {
+        m_slowFiles.push({valueNs, bytes, filePath});
+    } else if (valueNs > m_slowFiles.top().ElapsedNs) {
+        m_slowFiles.pop();
+        m_slowFiles.push({valueNs, bytes, filePath});
+    }
+}
+
+void CScanProfiler::Merge(const CScanProfiler& other) {
+    for (int i = 0; i < PHASE_COUNT; ++i) {
+        m_phases[i].Merge(other.m_phases[i]);
+    }
+    for (const ST_SlowFile& file : other.GetSlowestFiles()) {
+        RecordFile(file.FilePath, file.ElapsedNs, file.Bytes);
+    }
+}
+
+const char* CScanProfiler::GetPhaseName(EScanPhase phase) {
+    switch (phase) {
+        case PHASE_TRAVERSAL: return "traversal";
+        case PHASE_OPEN: return "open";
+        case PHASE_READ: return "read";
+        case PHASE_HASH: return "hash";
+        case PHASE_FUZZY: return "fuzzy";
+        case PHASE_YARA: return "yara";
+        case PHASE_SIGNATURE: return "signature";
+        case PHASE_ARCHIVE: return "archive";
+        case PHASE_QUARANTINE: return "quarantine";
+        case PHASE_LOGGING: return "logging";
+        default: return "unknown";
+    }
+}
+
+// 느린 순서로 정렬된 상위 N개 파일
+std::vector<CScanProfiler::ST_SlowFile> CScanProfiler::GetSlowestFiles() const {
+    auto heap = m_slowFiles;
+    std::vector<ST_SlowFile> vecFiles;
+    while (!heap.empty()) {
+        vecFiles.push_back(heap.top());
+        heap.pop();
+    }
+    std::reverse(vecFiles.begin(), vecFiles.end());
+    return vecFiles;
+}
+
+void CScanProfiler::PrintRow(const std::string& name, const CLatencyHistogram& histogram) {
+    double dTotalSec = histogram.GetTotal() / 1e9;
+    std::cout << "  " << std::left << std::setw(24) << name << std::right
+              << std::setw(10) << histogram.GetCount()
+              << std::setw(12) << std::fixed << std::setprecision(1) << histogram.GetPercentile(50.0) / 1000.0
+              << std::setw(12) << histogram.GetPercentile(99.0) / 1000.0
+              << std::setw(12) << histogram.GetMax() / 1000.0
+              << std::setw(11) << std::setprecision(3) << dTotalSec;
+    if (histogram.GetBytes() > 0 && dTotalSec > 0) {
+        std::cout << std::setw(11) << std::setprecision(1) << histogram.GetBytes() / dTotalSec / (1024.0 * 1024.0);
+    } else {
+        std::cout << std::setw(11) << "-";
+    }
+    std::cout << "\n";
+}
+
+void CScanProfiler::PrintHeader(const std::string& title) {
+    std::cout << "\n- " << title << " -\n\n"
+              << "  " << std::left << std::setw(24) << "phase" << std::right
+              << std::setw(10) << "count" << std::setw(12) << "p50(us)" << std::setw(12) << "p99(us)"
+              << std::setw(12) << "max(us)" << std::setw(11) << "total(s)" << std::setw(11) << "MB/s" << "\n";
+}
+
+void CScanProfiler::Print() const {
+    PrintHeader("Scan Phase Timing");
+    for (int i = 0; i < PHASE_COUNT; ++i) {
+        if (m_phases[i].GetCount() > 0) {
+            PrintRow(GetPhaseName(static_cast<EScanPhase>(i)), m_phases[i]);
+        }
+    }
+
+    std::vector<ST_SlowFile> vecSlowest = GetSlowestFiles();
+    if (!vecSlowest.empty()) {
+        std::cout << "\n[+] Slowest files :\n";
+        for (size_t i = 0; i < vecSlowest.size(); ++i) {
+            std::cout << "[" << i + 1 << "] " << std::fixed << std::setprecision(3) << vecSlowest[i].ElapsedNs / 1e6 << " ms, "
+                      << vecSlowest[i].Bytes << " bytes : " << vecSlowest[i].FilePath << "\n";
+        }
+    }
+}
+
+Json::Value CScanProfiler::ToJson() const {
+    Json::Value root;
+    Json::Value phases;
+    for (int i = 0; i < PHASE_COUNT; ++i) {
+        phases[GetPhaseName(static_cast<EScanPhase>(i))] = m_phases[i].ToJson();
+    }
+    root["phases"] = phases;
+
+    Json::Value slowest(Json::arrayValue);
+    for (const ST_SlowFile& file : GetSlowestFiles()) {
+        Json::Value entry;
+        entry["file"] = file.FilePath;
+        entry["elapsed_ns"] = Json::UInt64(file.ElapsedNs);
+        entry["bytes"] = Json::UInt64(file.Bytes);
+        slowest.append(entry);
+    }
+    root["slowest_files"] = slowest;
+    return root;
+}
+
+int CScanProfiler::SaveJson(const std::string& filePath) const {
+    std::ofstream file(filePath, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+    Json::StreamWriterBuilder writer;
+    file << Json::writeString(writer, ToJson()) << "\n";
+    return file.good() ? SUCCESS_CODE : ERROR_CANNOT_WRITE_FILE;
+}
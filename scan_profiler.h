@@ -0,0 +1,104 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <queue>
+#include <string>
+#include <vector>
+#include <jsoncpp/json/json.h>
+
+#define HISTOGRAM_SUB_BUCKET_BITS 4   // 버킷당 하위 구간 2^4개 -> 상대 오차 약 6%
+#define HISTOGRAM_MAX_EXPONENT 48     // 2^48 ns(약 3일)까지 기록
+#define SLOWEST_FILE_COUNT 10         // 결과에 표시할 가장 느린 파일 수
+
+enum EScanPhase {
+    PHASE_TRAVERSAL = 0,
+    PHASE_OPEN,
+    PHASE_READ,         // 매핑 생성 (페이지를 읽는 시간은 처음 접근하는 hash/yara에 포함됨)
+    PHASE_HASH,
+    PHASE_FUZZY,
+    PHASE_YARA,
+    PHASE_SIGNATURE,
+    PHASE_ARCHIVE,      // 압축 해제 + 멤버 검사 (멤버 검사 시간은 hash/yara에도 함께 기록됨)
+    PHASE_QUARANTINE,
+    PHASE_LOGGING,
+    PHASE_COUNT
+};
+
+// HDR 방식의 로그-선형 지연시간 히스토그램 (나노초 단위)
+// 2의 거듭제곱 구간마다 고정 개수의 하위 버킷을 두어 메모리는 일정하고 상대 오차는 유한함
+class CLatencyHistogram {
+public:
+    CLatencyHistogram();
+    void Record(uint64_t valueNs, uint64_t bytes);
+    void Merge(const CLatencyHistogram& other);
+    uint64_t GetPercentile(double percentile) const;
+    uint64_t GetCount() const { return m_ullCount; }
+    uint64_t GetMax() const { return m_ullMax; }
+    uint64_t GetTotal() const { return m_ullTotal; }
+    uint64_t GetBytes() const { return m_ullBytes; }
+    Json::Value ToJson() const;
+
+private:
+    std::vector<uint64_t> m_vecBuckets;
+    uint64_t m_ullCount;
+    uint64_t m_ullTotal;
+    uint64_t m_ullMax;
+    uint64_t m_ullBytes;
+
+    static size_t GetBucketIndex(uint64_t valueNs);
+    static uint64_t GetBucketUpperBound(size_t index);
+};
+
+// 스캔 단계별 소요 시간 집계기 (단일 스레드 사용 기준)
+class CScanProfiler {
+public:
+    void Record(EScanPhase phase, uint64_t valueNs, uint64_t bytes = 0);
+    void RecordFile(const std::string& filePath, uint64_t valueNs, uint64_t bytes);
+    void Merge(const CScanProfiler& other);
+    void Print() const;
+    Json::Value ToJson() const;
+    int SaveJson(const std::string& filePath) const;
+
+    static const char* GetPhaseName(EScanPhase phase);
+    static void PrintHeader(const std::string& title);
+    static void PrintRow(const std::string& name, const CLatencyHistogram& histogram);
+
+private:
+    struct ST_SlowFile {
+        uint64_t ElapsedNs;
+        uint64_t Bytes;
+        std::string FilePath;
+        bool operator>(const ST_SlowFile& other) const { return ElapsedNs > other.ElapsedNs; }
+    };
+
+    CLatencyHistogram m_phases[PHASE_COUNT];
+    // 최소 힙으로 상위 N개의 느린 파일만 유지
+    std::priority_queue<ST_SlowFile, std::vector<ST_SlowFile>, std::greater<ST_SlowFile>> m_slowFiles;
+
+    std::vector<ST_SlowFile> GetSlowestFiles() const;
+};
+
+// 생성부터 소멸까지의 시간을 지정한 단계에 기록하는 RAII 타이머, profiler가 nullptr이면 아무것도 하지 않음
+class CScopedTimer {
+public:
+    CScopedTimer(CScanProfiler* profiler, EScanPhase phase, uint64_t bytes = 0)
+        : m_pProfiler(profiler), m_phase(phase), m_ullBytes(bytes),
+          m_start(profiler ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point()) {}
+    ~CScopedTimer() {
+        if (m_pProfiler) {
+            auto elapsed = std::chrono::steady_clock::now() - m_start;
+            m_pProfiler->Record(m_phase, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), m_ullBytes);
+        }
+    }
+    void SetBytes(uint64_t bytes) { m_ullBytes = bytes; }
+
+    CScopedTimer(const CScopedTimer&) = delete;
+    CScopedTimer& operator=(const CScopedTimer&) = delete;
+
+private:
+    CScanProfiler* m_pProfiler;
+    EScanPhase m_phase;
+    uint64_t m_ullBytes;
+    std::chrono::steady_clock::time_point m_start;
+};
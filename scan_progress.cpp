@@ -0,0 +1,81 @@
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+#include "scan_progress.h"
+
+CScanProgress::CScanProgress()
+    : m_bIsTty(isatty(STDERR_FILENO) == 1), m_ullTotalFiles(0), m_ullTotalBytes(0),
+      m_interval(m_bIsTty ? PROGRESS_INTERVAL_TTY_MS : PROGRESS_INTERVAL_STREAM_MS) {}
+
+// 전체 작업량(사전 집계 결과)을 기록하고 타이머 시작, 0이면 ETA를 표시하지 않음
+void CScanProgress::Start(uint64_t totalFiles, uint64_t totalBytes) {
+    m_ullTotalFiles = totalFiles;
+    m_ullTotalBytes = totalBytes;
+    m_startTime = std::chrono::steady_clock::now();
+    m_lastPrintTime = m_startTime;
+}
+
+// 갱신 주기가 지났을 때만 진행률 한 줄 출력
+void CScanProgress::Update(uint64_t scannedFiles, uint64_t scannedBytes, uint64_t detections) {
+    auto now = std::chrono::steady_clock::now();
+    if (now - m_lastPrintTime < m_interval) {
+        return;
+    }
+    m_lastPrintTime = now;
+    PrintLine(scannedFiles, scannedBytes, detections, false);
+}
+
+void CScanProgress::Finish(uint64_t scannedFiles, uint64_t scannedBytes, uint64_t detections) {
+    PrintLine(scannedFiles, scannedBytes, detections, true);
+}
+
+void CScanProgress::PrintLine(uint64_t scannedFiles, uint64_t scannedBytes, uint64_t detections, bool bFinal) {
+    double dElapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+    double dFilesPerSec = dElapsed > 0 ? scannedFiles / dElapsed : 0.0;
+    double dMBPerSec = dElapsed > 0 ? scannedBytes / dElapsed / (1024.0 * 1024.0) : 0.0;
+
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(1)
+         << "[scan] " << scannedFiles;
+    if (m_ullTotalFiles > 0) {
+        line << "/" << m_ullTotalFiles;
+    }
+    line << " files, " << scannedBytes / (1024 * 1024) << " MB"
+         << " | " << dFilesPerSec << " files/s, " << dMBPerSec << " MB/s"
+         << " | detections: " << detections;
+
+    // ETA는 바이트 기준이 더 정확하므로 우선 사용, 없으면 파일 수 기준
+    if (!bFinal) {
+        double dEta = -1.0;
+        if (m_ullTotalBytes > 0 && scannedBytes > 0 && scannedBytes < m_ullTotalBytes) {
+            dEta = (m_ullTotalBytes - scannedBytes) / (scannedBytes / dElapsed);
+        } else if (m_ullTotalFiles > 0 && scannedFiles > 0 && scannedFiles < m_ullTotalFiles) {
+            dEta = (m_ullTotalFiles - scannedFiles) / dFilesPerSec;
+        }
+        line << " | ETA: " << (dEta >= 0 ? FormatDuration(dEta) : "--:--:--");
+    } else {
+        line << " | elapsed: " << FormatDuration(dElapsed);
+    }
+
+    // 터미널이면 같은 줄을 덮어쓰고, 스트림이면 줄 단위로 출력
+    if (m_bIsTty) {
+        std::cerr << "\r\033[K" << line.str();
+        if (bFinal) {
+            std::cerr << "\n";
+        }
+    } else {
+        std::cerr << line.str() << "\n";
+    }
+    std::cerr.flush();
+}
+
+std::string CScanProgress::FormatDuration(double seconds) {
+    long long llTotal = static_cast<long long>(seconds + 0.5);
+    std::ostringstream ss;
+    ss << std::setfill('0') << std::setw(2) << llTotal / 3600 << ":"
+       << std::setw(2) << (llTotal / 60) % 60 << ":"
+       << std::setw(2) << llTotal % 60;
+    return ss.str();
+}
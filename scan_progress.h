@@ -0,0 +1,29 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#define PROGRESS_INTERVAL_TTY_MS 500     // 터미널 출력 시 진행률 갱신 주기
+#define PROGRESS_INTERVAL_STREAM_MS 5000 // 파이프/journald 출력 시 진행률 갱신 주기
+
+// 헤드리스 스캔용 진행률 출력기
+// 파일마다 출력하지 않고 일정 주기마다 한 줄(files/s, MB/s, ETA, 탐지 수)만 stderr로 출력
+class CScanProgress {
+public:
+    CScanProgress();
+    void Start(uint64_t totalFiles, uint64_t totalBytes);
+    void Update(uint64_t scannedFiles, uint64_t scannedBytes, uint64_t detections);
+    void Finish(uint64_t scannedFiles, uint64_t scannedBytes, uint64_t detections);
+
+private:
+    bool m_bIsTty;
+    uint64_t m_ullTotalFiles;
+    uint64_t m_ullTotalBytes;
+    std::chrono::milliseconds m_interval;
+    std::chrono::steady_clock::time_point m_startTime;
+    std::chrono::steady_clock::time_point m_lastPrintTime;
+
+    void PrintLine(uint64_t scannedFiles, uint64_t scannedBytes, uint64_t detections, bool bFinal);
+    static std::string FormatDuration(double seconds);
+};
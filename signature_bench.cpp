@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <jsoncpp/json/json.h>
+#include <unistd.h>
+#include <yara.h>
+#include "ansi_color.h"
+#include "signature_bench.h"
+#include "util.h"
+#include "yara_checker.h"
+#include "yara_profiler.h"
+
+CSignatureBenchmark::CSignatureBenchmark(const std::string& databasePath) : m_strDatabasePath(databasePath), m_ullCorpusBytes(0) {}
+
+// --signature-bench 옵션 입력 시 실행되는 함수
+int CSignatureBenchmark::Run(const std::string& corpusPath) {
+    int nResult = CYaraProfiler::LoadCorpus(corpusPath, m_vecCorpus, m_ullCorpusBytes);
+    if (nResult != SUCCESS_CODE) {
+        return nResult;
+    }
+    std::cout << "\n### Signature Engine Benchmark Start ! (Database : " << m_strDatabasePath << ", Corpus : "
+              << m_vecCorpus.size() << " files, " << m_ullCorpusBytes << " bytes) ###\n\n";
+
+    // 캐시 없이 빌드, 빌드 후 캐시 기록, 기록된 캐시 매핑의 세 경우를 따로 측정
+    unlink((m_strDatabasePath + SIGNATURE_CACHE_SUFFIX).c_str());
+    std::string strYaraSource;
+    for (bool bUseCache : {false, true, true}) {
+        nResult = BenchNative(bUseCache, strYaraSource);
+        if (nResult != SUCCESS_CODE) {
+            return nResult;
+        }
+    }
+    nResult = BenchYara(strYaraSource);
+    if (nResult != SUCCESS_CODE) {
+        return nResult;
+    }
+
+    PrintReport();
+    return SaveReport(SIGNATURE_BENCH_REPORT_PATH);
+}
+
+int CSignatureBenchmark::BenchNative(bool useCache, std::string& yaraSource) {
+    CSignatureChecker checker(m_strDatabasePath, useCache);
+    if (checker.GetLoadResult() != SUCCESS_CODE) {
+        return checker.GetLoadResult();
+    }
+    if (checker.GetRejectedCount() > 0 && !useCache) {
+        std::cout << COLOR_YELLOW << "[+] " << checker.GetRejectedCount() << " unsupported signatures skipped" << COLOR_RESET << "\n";
+    }
+
+    ST_EngineBenchResult result = {
+        .Engine = useCache ? (checker.IsFromCache() ? "native (mmap cache)" : "native (cache write)") : "native (build)",
+        .CompileMs = checker.GetBuildTimeMs(),
+        .MemoryKb = static_cast<long>(checker.GetMemoryUsage() / 1024),
+        .ScanMs = 0,
+        .Matches = 0
+    };
+    uint64_t ullBest = UINT64_MAX;
+    for (int i = 0; i < SIGNATURE_BENCH_REPETITIONS; ++i) {
+        uint64_t ullMatches = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& content : m_vecCorpus) {
+            uint32_t ulSignature;
+            ullMatches += checker.Match(content.data(), content.size(), ulSignature) ? 1 : 0;
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        ullBest = std::min<uint64_t>(ullBest, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        result.Matches = ullMatches;
+    }
+    result.ScanMs = ullBest / 1e6;
+    m_vecResults.push_back(result);
+    yaraSource = checker.ExportYaraRules();
+    return SUCCESS_CODE;
+}
+
+static int CountMatchCallback(YR_SCAN_CONTEXT* context, int message, void* messageData, void* userData) {
+    (void)context;
+    (void)messageData;
+    if (message == CALLBACK_MSG_RULE_MATCHING) {
+        *static_cast<bool*>(userData) = true;
+        return CALLBACK_ABORT;
+    }
+    return CALLBACK_CONTINUE;
+}
+
+int CSignatureBenchmark::BenchYara(const std::string& yaraSource) {
+    if (CYaraChecker::InitializeLibrary() != SUCCESS_CODE) {
+        return ERROR_YARA_LIBRARY;
+    }
+    long lRssBefore = GetResidentMemoryKb();
+    auto compileStart = std::chrono::steady_clock::now();
+    YR_COMPILER* compiler = nullptr;
+    YR_RULES* rules = nullptr;
+    if (yr_compiler_create(&compiler) != ERROR_SUCCESS) {
+        return ERROR_YARA_LIBRARY;
+    }
+    if (yr_compiler_add_string(compiler, yaraSource.c_str(), nullptr) > 0 || yr_compiler_get_rules(compiler, &rules) != ERROR_SUCCESS) {
+        yr_compiler_destroy(compiler);
+        return ERROR_YARA_LIBRARY;
+    }
+    yr_compiler_destroy(compiler);
+
+    ST_EngineBenchResult result = {
+        .Engine = "yara",
+        .CompileMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - compileStart).count(),
+        .MemoryKb = GetResidentMemoryKb() - lRssBefore,
+        .ScanMs = 0,
+        .Matches = 0
+    };
+    uint64_t ullBest = UINT64_MAX;
+    for (int i = 0; i < SIGNATURE_BENCH_REPETITIONS; ++i) {
+        uint64_t ullMatches = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& content : m_vecCorpus) {
+            bool bMatched = false;
+            yr_rules_scan_mem(rules, content.data(), content.size(), SCAN_FLAGS_FAST_MODE, CountMatchCallback, &bMatched, 0);
+            ullMatches += bMatched ? 1 : 0;
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        ullBest = std::min<uint64_t>(ullBest, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        result.Matches = ullMatches;
+    }
+    result.ScanMs = ullBest / 1e6;
+    m_vecResults.push_back(result);
+
+    yr_rules_destroy(rules);
+    return SUCCESS_CODE;
+}
+
+void CSignatureBenchmark::PrintReport() const {
+    std::cout << "\n- Signature Engine Comparison -\n\n"
+              << "  " << std::left << std::setw(24) << "engine" << std::right << std::setw(14) << "compile(ms)"
+              << std::setw(14) << "memory(KB)" << std::setw(12) << "scan(ms)" << std::setw(10) << "GB/s"
+              << std::setw(10) << "matches" << "\n";
+    for (const ST_EngineBenchResult& result : m_vecResults) {
+        double dGBPerSec = result.ScanMs > 0 ? m_ullCorpusBytes / (result.ScanMs / 1000.0) / 1e9 : 0.0;
+        std::cout << "  " << std::left << std::setw(24) << result.Engine << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(14) << result.CompileMs << std::setw(14) << result.MemoryKb << std::setw(12) << result.ScanMs
+                  << std::setprecision(3) << std::setw(10) << dGBPerSec << std::setw(10) << result.Matches << "\n";
+    }
+    std::cout << "\n";
+}
+
+int CSignatureBenchmark::SaveReport(const std::string& reportPath) const {
+    Json::Value root;
+    root["timestamp"] = GetCurrentTimeWithMilliseconds();
+    root["database"] = m_strDatabasePath;
+    root["corpus_files"] = Json::UInt64(m_vecCorpus.size());
+    root["corpus_bytes"] = Json::UInt64(m_ullCorpusBytes);
+    root["repetitions"] = SIGNATURE_BENCH_REPETITIONS;
+
+    Json::Value engines(Json::arrayValue);
+    for (const ST_EngineBenchResult& result : m_vecResults) {
+        Json::Value entry;
+        entry["engine"] = result.Engine;
+        entry["compile_ms"] = result.CompileMs;
+        entry["memory_kb"] = Json::Int64(result.MemoryKb);
+        entry["scan_ms"] = result.ScanMs;
+        entry["gb_per_sec"] = result.ScanMs > 0 ? m_ullCorpusBytes / (result.ScanMs / 1000.0) / 1e9 : 0.0;
+        entry["matches"] = Json::UInt64(result.Matches);
+        engines.append(entry);
+    }
+    root["engines"] = engines;
+
+    std::ofstream file(reportPath, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        PrintErrorMessage(ERROR_CANNOT_OPEN_FILE, reportPath);
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+    Json::StreamWriterBuilder writer;
+    file << Json::writeString(writer, root) << "\n";
+    std::cout << "[+] Signature benchmark report saved to " << reportPath << "\n";
+    return file.good() ? SUCCESS_CODE : ERROR_CANNOT_WRITE_FILE;
+}
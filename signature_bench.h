@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "signature_checker.h"
+
+#define SIGNATURE_BENCH_REPORT_PATH "logs/signature_bench.json"
+#define SIGNATURE_BENCH_REPETITIONS 3   // 처리량 측정 반복 횟수 (최솟값 사용)
+
+struct ST_EngineBenchResult {
+    std::string Engine;
+    double CompileMs;      // 시그니처 DB 또는 룰 소스를 검사 가능한 형태로 만드는 시간
+    long MemoryKb;         // 컴파일 전후 RSS 차이 (네이티브 엔진은 이미지 크기)
+    double ScanMs;         // 코퍼스 전체 1회 스캔 최소 시간
+    uint64_t Matches;      // 탐지된 코퍼스 파일 수
+};
+
+// signatures.ndb를 네이티브 Aho-Corasick 엔진과, 같은 조건으로 변환한 YARA 룰로 각각 컴파일/스캔하여 비교
+class CSignatureBenchmark {
+public:
+    CSignatureBenchmark(const std::string& databasePath);
+    int Run(const std::string& corpusPath);
+
+private:
+    std::string m_strDatabasePath;
+    std::vector<std::vector<uint8_t>> m_vecCorpus;
+    uint64_t m_ullCorpusBytes;
+    std::vector<ST_EngineBenchResult> m_vecResults;
+
+    int BenchNative(bool useCache, std::string& yaraSource);
+    int BenchYara(const std::string& yaraSource);
+    void PrintReport() const;
+    int SaveReport(const std::string& reportPath) const;
+};
@@ -0,0 +1,832 @@
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "ansi_color.h"
+#include "signature_checker.h"
+#include "util.h"
+
+#define SIGNATURE_PAIR_BITMAP_WORDS (65536 / 64)
+#define SIGNATURE_QUAD_BITMAP_WORDS ((1u << SIGNATURE_QUAD_FILTER_BITS) / 64)
+
+// 캐시 이미지의 각 구간은 8바이트 경계에 맞춰 배치
+static size_t AlignSection(size_t offset) {
+    return (offset + 7) & ~static_cast<size_t>(7);
+}
+
+static uint32_t HashQuad(const uint8_t* data) {
+    uint32_t ulQuad;
+    memcpy(&ulQuad, data, sizeof(ulQuad));
+    return (ulQuad * 2654435761u) >> (32 - SIGNATURE_QUAD_FILTER_BITS);
+}
+
+static int HexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+namespace {
+
+// 빌드 중에만 쓰는 시그니처 표현
+struct ST_ParsedSignature {
+    std::string Name;
+    int32_t OffsetType;
+    int64_t OffsetValue;
+    std::vector<ST_SignatureToken> Tokens;
+    std::vector<uint8_t> Bytes;
+    std::vector<uint8_t> Masks;
+    std::vector<uint8_t> Anchor;
+    uint32_t AnchorPrefix;
+};
+
+bool ParseOffset(const std::string& field, ST_ParsedSignature& signature) {
+    char* end = nullptr;
+    if (field == "*") {
+        signature.OffsetType = OFFSET_ANY;
+        signature.OffsetValue = 0;
+        return true;
+    }
+    if (field.compare(0, 4, "EOF-") == 0) {
+        signature.OffsetType = OFFSET_FROM_END;
+        signature.OffsetValue = strtoll(field.c_str() + 4, &end, 10);
+        return end && *end == '\0' && end != field.c_str() + 4;
+    }
+    signature.OffsetType = OFFSET_ABSOLUTE;
+    signature.OffsetValue = strtoll(field.c_str(), &end, 10);
+    return !field.empty() && end && *end == '\0';
+}
+
+// 16진 문자열을 바이트/점프 토큰으로 변환, 대안 (a|b) 등 지원하지 않는 문법이면 false
+bool ParseHexSignature(const std::string& hex, ST_ParsedSignature& signature) {
+    auto appendByte = [&](uint8_t value, uint8_t mask) {
+        if (signature.Tokens.empty() || signature.Tokens.back().Type != TOKEN_BYTES) {
+            signature.Tokens.push_back({TOKEN_BYTES, static_cast<uint32_t>(signature.Bytes.size()), 0, 0});
+        }
+        signature.Bytes.push_back(value & mask);
+        signature.Masks.push_back(mask);
+        signature.Tokens.back().Length++;
+        signature.Tokens.back().Max++;
+    };
+    auto appendJump = [&](uint32_t minimum, uint32_t maximum) {
+        if (signature.Tokens.empty() || minimum > maximum) {
+            return false;
+        }
+        if (signature.Tokens.back().Type == TOKEN_JUMP) {
+            ST_SignatureToken& previous = signature.Tokens.back();
+            previous.Length += minimum;
+            previous.Max = (previous.Max == UINT32_MAX || maximum == UINT32_MAX) ? UINT32_MAX : previous.Max + maximum;
+        } else {
+            signature.Tokens.push_back({TOKEN_JUMP, 0, minimum, maximum});
+        }
+        return true;
+    };
+
+    for (size_t i = 0; i < hex.size();) {
+        char c = hex[i];
+        if (c == '*') {
+            if (!appendJump(0, UINT32_MAX)) return false;
+            i++;
+        } else if (c == '{') {
+            size_t siClose = hex.find('}', i);
+            if (siClose == std::string::npos) return false;
+            std::string strRange = hex.substr(i + 1, siClose - i - 1);
+            size_t siDash = strRange.find('-');
+            uint32_t ulMin, ulMax;
+            if (siDash == std::string::npos) {
+                ulMin = ulMax = static_cast<uint32_t>(strtoul(strRange.c_str(), nullptr, 10));
+            } else {
+                ulMin = siDash == 0 ? 0 : static_cast<uint32_t>(strtoul(strRange.c_str(), nullptr, 10));
+                ulMax = siDash + 1 == strRange.size() ? UINT32_MAX : static_cast<uint32_t>(strtoul(strRange.c_str() + siDash + 1, nullptr, 10));
+            }
+            if (!appendJump(ulMin, ulMax)) return false;
+            i = siClose + 1;
+        } else if (i + 1 < hex.size()) {
+            char c2 = hex[i + 1];
+            int nHigh = HexValue(c);
+            int nLow = HexValue(c2);
+            if (c == '?' && c2 == '?') {
+                appendByte(0, 0x00);
+            } else if (c == '?' && nLow >= 0) {
+                appendByte(static_cast<uint8_t>(nLow), 0x0F);
+            } else if (nHigh >= 0 && c2 == '?') {
+                appendByte(static_cast<uint8_t>(nHigh << 4), 0xF0);
+            } else if (nHigh >= 0 && nLow >= 0) {
+                appendByte(static_cast<uint8_t>((nHigh << 4) | nLow), 0xFF);
+            } else {
+                return false;
+            }
+            i += 2;
+        } else {
+            return false;
+        }
+    }
+    return !signature.Tokens.empty() && signature.Tokens.front().Type == TOKEN_BYTES && signature.Tokens.back().Type == TOKEN_BYTES;
+}
+
+// 가변 점프 이전 구간에서 가장 긴 완전 고정 바이트열을 앵커로 선택 (앵커 앞부분 길이가 고정이어야 시작 위치를 역산 가능)
+bool SelectAnchor(ST_ParsedSignature& signature) {
+    uint32_t ulPrefix = 0;
+    size_t siBestStart = 0;
+    size_t siBestLength = 0;
+    uint32_t ulBestPrefix = 0;
+    for (const ST_SignatureToken& token : signature.Tokens) {
+        if (token.Type == TOKEN_JUMP) {
+            if (token.Length != token.Max) {
+                break;
+            }
+            ulPrefix += token.Length;
+            continue;
+        }
+        size_t siRun = 0;
+        for (uint32_t i = 0; i < token.Length; i++) {
+            siRun = signature.Masks[token.ByteStart + i] == 0xFF ? siRun + 1 : 0;
+            if (siRun > siBestLength) {
+                siBestLength = siRun;
+                siBestStart = token.ByteStart + i + 1 - siRun;
+                ulBestPrefix = ulPrefix + i + 1 - static_cast<uint32_t>(siRun);
+            }
+        }
+        ulPrefix += token.Length;
+    }
+    if (siBestLength < SIGNATURE_MIN_ANCHOR) {
+        return false;
+    }
+    signature.Anchor.assign(signature.Bytes.begin() + siBestStart, signature.Bytes.begin() + siBestStart + siBestLength);
+    signature.AnchorPrefix = ulBestPrefix;
+    return true;
+}
+
+} // namespace
+
+CSignatureChecker::CSignatureChecker(const std::string& databasePath, bool useCache)
+    : m_strDatabasePath(databasePath), m_nLoadResult(SUCCESS_CODE), m_dBuildTimeMs(0), m_bFromCache(false),
+      m_pMapped(nullptr), m_siMappedSize(0), m_pHeader(nullptr), m_pPairBitmap(nullptr), m_pQuadBitmap(nullptr), m_pRootTable(nullptr), m_pStates(nullptr),
+      m_pTransitions(nullptr), m_pOutputs(nullptr), m_pSignatures(nullptr), m_pTokens(nullptr), m_pBytes(nullptr), m_pMasks(nullptr),
+      m_pNames(nullptr) {
+    auto start = std::chrono::steady_clock::now();
+    m_nLoadResult = Load(useCache);
+    m_dBuildTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+CSignatureChecker::~CSignatureChecker() {
+    if (m_pMapped) {
+        munmap(m_pMapped, m_siMappedSize);
+    }
+}
+
+// 원본보다 새 캐시가 있으면 매핑만 하고, 없으면 빌드 후 캐시를 쓰고 다시 매핑 (캐시를 쓸 수 없으면 메모리 이미지 사용)
+int CSignatureChecker::Load(bool useCache) {
+    struct stat sourceStat;
+    if (stat(m_strDatabasePath.c_str(), &sourceStat) != 0) {
+        return ERROR_FILE_NOT_FOUND;
+    }
+    int64_t llMtimeNs = sourceStat.st_mtim.tv_sec * 1000000000LL + sourceStat.st_mtim.tv_nsec;
+    std::string strCachePath = m_strDatabasePath + SIGNATURE_CACHE_SUFFIX;
+
+    if (useCache && MapCache(strCachePath, llMtimeNs, sourceStat.st_size) == SUCCESS_CODE) {
+        m_bFromCache = true;
+        return SUCCESS_CODE;
+    }
+
+    std::vector<uint8_t> vecImage;
+    int nResult = Build(vecImage, llMtimeNs, sourceStat.st_size);
+    if (nResult != SUCCESS_CODE) {
+        return nResult;
+    }
+    if (useCache && WriteCache(strCachePath, vecImage) == SUCCESS_CODE
+        && MapCache(strCachePath, llMtimeNs, sourceStat.st_size) == SUCCESS_CODE) {
+        return SUCCESS_CODE;
+    }
+    m_vecOwned = std::move(vecImage);
+    m_siMappedSize = m_vecOwned.size();
+    return AttachImage(m_vecOwned.data(), m_vecOwned.size()) ? SUCCESS_CODE : ERROR_UNKNOWN;
+}
+
+int CSignatureChecker::Build(std::vector<uint8_t>& image, int64_t sourceMtimeNs, uint64_t sourceSize) {
+    std::ifstream file(m_strDatabasePath);
+    if (!file.is_open()) {
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+
+    std::vector<ST_ParsedSignature> vecSignatures;
+    uint32_t ulRejected = 0;
+    std::string strLine;
+    while (std::getline(file, strLine)) {
+        strLine = Trim(strLine);
+        if (strLine.empty() || strLine[0] == '#') {
+            continue;
+        }
+        std::vector<std::string> vecFields;
+        std::stringstream stream(strLine);
+        std::string strField;
+        while (std::getline(stream, strField, ':')) {
+            vecFields.push_back(strField);
+        }
+        ST_ParsedSignature signature;
+        if (vecFields.size() < 4 || vecFields[0].empty() || !ParseOffset(vecFields[2], signature)
+            || !ParseHexSignature(vecFields[3], signature) || !SelectAnchor(signature)) {
+            ulRejected++;
+            continue;
+        }
+        signature.Name = vecFields[0];
+        vecSignatures.push_back(std::move(signature));
+    }
+    file.close();
+
+    // 앵커 트라이 (상태 0이 루트), 자식은 바이트 순으로 정렬해 두어 스캔 시 이진 탐색
+    std::vector<std::vector<ST_AcTransition>> vecChildren(1);
+    std::vector<std::vector<uint32_t>> vecOutputs(1);
+    auto findChild = [&](uint32_t state, uint8_t byte) -> uint32_t {
+        const auto& children = vecChildren[state];
+        auto it = std::lower_bound(children.begin(), children.end(), byte, [](const ST_AcTransition& t, uint32_t b) { return t.Byte < b; });
+        return (it != children.end() && it->Byte == byte) ? it->Next : 0;
+    };
+    for (uint32_t i = 0; i < vecSignatures.size(); i++) {
+        uint32_t ulState = 0;
+        for (uint8_t byte : vecSignatures[i].Anchor) {
+            uint32_t ulNext = findChild(ulState, byte);
+            if (ulNext == 0) {
+                ulNext = static_cast<uint32_t>(vecChildren.size());
+                auto& children = vecChildren[ulState];
+                auto it = std::lower_bound(children.begin(), children.end(), byte, [](const ST_AcTransition& t, uint32_t b) { return t.Byte < b; });
+                children.insert(it, {ulNext, byte});
+                vecChildren.emplace_back();
+                vecOutputs.emplace_back();
+            }
+            ulState = ulNext;
+        }
+        vecOutputs[ulState].push_back(i);
+    }
+
+    // 너비 우선으로 실패 링크를 만들고, 실패 경로의 출력도 합쳐 스캔 중에는 링크를 따라가지 않아도 되게 함
+    std::vector<uint32_t> vecFail(vecChildren.size(), 0);
+    std::deque<uint32_t> queStates;
+    for (const ST_AcTransition& child : vecChildren[0]) {
+        queStates.push_back(child.Next);
+    }
+    while (!queStates.empty()) {
+        uint32_t ulState = queStates.front();
+        queStates.pop_front();
+        for (const ST_AcTransition& child : vecChildren[ulState]) {
+            uint32_t ulFail = vecFail[ulState];
+            while (ulFail != 0 && findChild(ulFail, child.Byte) == 0) {
+                ulFail = vecFail[ulFail];
+            }
+            uint32_t ulTarget = findChild(ulFail, child.Byte);
+            vecFail[child.Next] = ulTarget != child.Next ? ulTarget : 0;
+            const auto& inherited = vecOutputs[vecFail[child.Next]];
+            vecOutputs[child.Next].insert(vecOutputs[child.Next].end(), inherited.begin(), inherited.end());
+            queStates.push_back(child.Next);
+        }
+    }
+
+    // 이미지 크기 계산
+    ST_AcHeader header = {};
+    memcpy(header.Magic, SIGNATURE_CACHE_MAGIC, sizeof(header.Magic));
+    header.SourceMtimeNs = sourceMtimeNs;
+    header.SourceSize = sourceSize;
+    header.StateCount = static_cast<uint32_t>(vecChildren.size());
+    header.SignatureCount = static_cast<uint32_t>(vecSignatures.size());
+    header.RejectedCount = ulRejected;
+    for (uint32_t i = 0; i < header.StateCount; i++) {
+        header.TransitionCount += static_cast<uint32_t>(vecChildren[i].size());
+        header.OutputCount += static_cast<uint32_t>(vecOutputs[i].size());
+    }
+    for (const ST_ParsedSignature& signature : vecSignatures) {
+        header.TokenCount += static_cast<uint32_t>(signature.Tokens.size());
+        header.ByteCount += static_cast<uint32_t>(signature.Bytes.size());
+        header.NameBytes += static_cast<uint32_t>(signature.Name.size());
+    }
+
+    // 앵커 첫 바이트 종류가 적으면 SSE2 건너뛰기에 사용
+    std::vector<uint8_t> vecFirstBytes;
+    for (const ST_AcTransition& child : vecChildren[0]) {
+        vecFirstBytes.push_back(static_cast<uint8_t>(child.Byte));
+    }
+    if (vecFirstBytes.size() <= SIGNATURE_FIRST_BYTE_SIMD_LIMIT) {
+        header.FirstByteCount = static_cast<uint32_t>(vecFirstBytes.size());
+        std::copy(vecFirstBytes.begin(), vecFirstBytes.end(), header.FirstBytes);
+    }
+
+    size_t siOffset = AlignSection(sizeof(ST_AcHeader));
+    size_t siPairOffset = siOffset;      siOffset = AlignSection(siOffset + SIGNATURE_PAIR_BITMAP_WORDS * sizeof(uint64_t));
+    size_t siQuadOffset = siOffset;      siOffset = AlignSection(siOffset + SIGNATURE_QUAD_BITMAP_WORDS * sizeof(uint64_t));
+    size_t siRootOffset = siOffset;      siOffset = AlignSection(siOffset + 256 * sizeof(uint32_t));
+    size_t siStateOffset = siOffset;     siOffset = AlignSection(siOffset + header.StateCount * sizeof(ST_AcState));
+    size_t siTransOffset = siOffset;     siOffset = AlignSection(siOffset + header.TransitionCount * sizeof(ST_AcTransition));
+    size_t siOutputOffset = siOffset;    siOffset = AlignSection(siOffset + header.OutputCount * sizeof(uint32_t));
+    size_t siSigOffset = siOffset;       siOffset = AlignSection(siOffset + header.SignatureCount * sizeof(ST_SignatureRecord));
+    size_t siTokenOffset = siOffset;     siOffset = AlignSection(siOffset + header.TokenCount * sizeof(ST_SignatureToken));
+    size_t siByteOffset = siOffset;      siOffset = AlignSection(siOffset + header.ByteCount);
+    size_t siMaskOffset = siOffset;      siOffset = AlignSection(siOffset + header.ByteCount);
+    size_t siNameOffset = siOffset;      siOffset = AlignSection(siOffset + header.NameBytes);
+    image.assign(siOffset, 0);
+    memcpy(image.data(), &header, sizeof(header));
+
+    auto* pairBitmap = reinterpret_cast<uint64_t*>(image.data() + siPairOffset);
+    auto* quadBitmap = reinterpret_cast<uint64_t*>(image.data() + siQuadOffset);
+    auto* rootTable = reinterpret_cast<uint32_t*>(image.data() + siRootOffset);
+    auto* states = reinterpret_cast<ST_AcState*>(image.data() + siStateOffset);
+    auto* transitions = reinterpret_cast<ST_AcTransition*>(image.data() + siTransOffset);
+    auto* outputs = reinterpret_cast<uint32_t*>(image.data() + siOutputOffset);
+    auto* records = reinterpret_cast<ST_SignatureRecord*>(image.data() + siSigOffset);
+    auto* tokens = reinterpret_cast<ST_SignatureToken*>(image.data() + siTokenOffset);
+
+    for (const ST_AcTransition& child : vecChildren[0]) {
+        rootTable[child.Byte] = child.Next;
+    }
+    uint32_t ulTransition = 0;
+    uint32_t ulOutput = 0;
+    for (uint32_t i = 0; i < header.StateCount; i++) {
+        states[i] = {vecFail[i], ulTransition, static_cast<uint32_t>(vecChildren[i].size()), ulOutput, static_cast<uint32_t>(vecOutputs[i].size())};
+        std::copy(vecChildren[i].begin(), vecChildren[i].end(), transitions + ulTransition);
+        std::copy(vecOutputs[i].begin(), vecOutputs[i].end(), outputs + ulOutput);
+        ulTransition += states[i].TransitionCount;
+        ulOutput += states[i].OutputCount;
+    }
+
+    uint32_t ulToken = 0;
+    uint32_t ulByte = 0;
+    uint32_t ulName = 0;
+    for (uint32_t i = 0; i < header.SignatureCount; i++) {
+        const ST_ParsedSignature& signature = vecSignatures[i];
+        records[i] = {ulName, static_cast<uint32_t>(signature.Name.size()), ulToken, static_cast<uint32_t>(signature.Tokens.size()),
+                      signature.OffsetType, static_cast<uint32_t>(signature.Anchor.size()), signature.OffsetValue, signature.AnchorPrefix, 0};
+        for (ST_SignatureToken token : signature.Tokens) {
+            if (token.Type == TOKEN_BYTES) {
+                token.ByteStart += ulByte;
+            }
+            tokens[ulToken++] = token;
+        }
+        memcpy(image.data() + siByteOffset + ulByte, signature.Bytes.data(), signature.Bytes.size());
+        memcpy(image.data() + siMaskOffset + ulByte, signature.Masks.data(), signature.Masks.size());
+        ulByte += static_cast<uint32_t>(signature.Bytes.size());
+        memcpy(image.data() + siNameOffset + ulName, signature.Name.data(), signature.Name.size());
+        ulName += static_cast<uint32_t>(signature.Name.size());
+
+        if (signature.Anchor.size() >= 4) {
+            uint32_t ulHash = HashQuad(signature.Anchor.data());
+            quadBitmap[ulHash >> 6] |= 1ULL << (ulHash & 63);
+        } else {
+            uint32_t ulPair = (static_cast<uint32_t>(signature.Anchor[0]) << 8) | signature.Anchor[1];
+            pairBitmap[ulPair >> 6] |= 1ULL << (ulPair & 63);
+        }
+    }
+    return SUCCESS_CODE;
+}
+
+int CSignatureChecker::MapCache(const std::string& cachePath, int64_t sourceMtimeNs, uint64_t sourceSize) {
+    int fd = open(cachePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+    struct stat cacheStat;
+    if (fstat(fd, &cacheStat) != 0 || static_cast<size_t>(cacheStat.st_size) < sizeof(ST_AcHeader)) {
+        close(fd);
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+    size_t siSize = static_cast<size_t>(cacheStat.st_size);
+    void* pMapped = mmap(nullptr, siSize, PROT_READ, MAP_SHARED | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (pMapped == MAP_FAILED) {
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+
+    const auto* header = static_cast<const ST_AcHeader*>(pMapped);
+    if (memcmp(header->Magic, SIGNATURE_CACHE_MAGIC, sizeof(header->Magic)) != 0 || header->SourceMtimeNs != sourceMtimeNs
+        || header->SourceSize != sourceSize || !AttachImage(static_cast<const uint8_t*>(pMapped), siSize)) {
+        munmap(pMapped, siSize);
+        return ERROR_INVALID_INPUT;
+    }
+    if (m_pMapped) {
+        munmap(m_pMapped, m_siMappedSize);
+    }
+    m_pMapped = pMapped;
+    m_siMappedSize = siSize;
+    return SUCCESS_CODE;
+}
+
+int CSignatureChecker::WriteCache(const std::string& cachePath, const std::vector<uint8_t>& image) const {
+    std::string strTempPath = cachePath + ".tmp";
+    int fd = open(strTempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+    size_t siWritten = 0;
+    while (siWritten < image.size()) {
+        ssize_t n = write(fd, image.data() + siWritten, image.size() - siWritten);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            close(fd);
+            unlink(strTempPath.c_str());
+            return ERROR_CANNOT_WRITE_FILE;
+        }
+        siWritten += static_cast<size_t>(n);
+    }
+    // 내용이 디스크에 닿기 전에 이름을 바꾸면 전원이 꺼졌을 때 잘린 캐시가 남을 수 있음
+    if (fsync(fd) != 0) {
+        close(fd);
+        unlink(strTempPath.c_str());
+        return ERROR_CANNOT_WRITE_FILE;
+    }
+    close(fd);
+    if (rename(strTempPath.c_str(), cachePath.c_str()) != 0) {
+        unlink(strTempPath.c_str());
+        return ERROR_CANNOT_MOVE_FILE;
+    }
+    return SUCCESS_CODE;
+}
+
+// 헤더의 개수로 각 구간의 위치를 계산하고 전체 크기와 맞는지 확인한 뒤 구간 안의 인덱스를 검사
+bool CSignatureChecker::AttachImage(const uint8_t* image, size_t size) {
+    if (size < sizeof(ST_AcHeader)) {
+        return false;
+    }
+    const auto* header = reinterpret_cast<const ST_AcHeader*>(image);
+    size_t siOffset = AlignSection(sizeof(ST_AcHeader));
+    auto section = [&](size_t bytes) {
+        size_t siStart = siOffset;
+        siOffset = AlignSection(siOffset + bytes);
+        return image + siStart;
+    };
+    const uint8_t* pairBitmap = section(SIGNATURE_PAIR_BITMAP_WORDS * sizeof(uint64_t));
+    const uint8_t* quadBitmap = section(SIGNATURE_QUAD_BITMAP_WORDS * sizeof(uint64_t));
+    const uint8_t* rootTable = section(256 * sizeof(uint32_t));
+    const uint8_t* states = section(static_cast<size_t>(header->StateCount) * sizeof(ST_AcState));
+    const uint8_t* transitions = section(static_cast<size_t>(header->TransitionCount) * sizeof(ST_AcTransition));
+    const uint8_t* outputs = section(static_cast<size_t>(header->OutputCount) * sizeof(uint32_t));
+    const uint8_t* signatures = section(static_cast<size_t>(header->SignatureCount) * sizeof(ST_SignatureRecord));
+    const uint8_t* tokens = section(static_cast<size_t>(header->TokenCount) * sizeof(ST_SignatureToken));
+    const uint8_t* bytes = section(header->ByteCount);
+    const uint8_t* masks = section(header->ByteCount);
+    const uint8_t* names = section(header->NameBytes);
+    if (siOffset != size || header->StateCount == 0) {
+        return false;
+    }
+    m_pHeader = header;
+    m_pPairBitmap = reinterpret_cast<const uint64_t*>(pairBitmap);
+    m_pQuadBitmap = reinterpret_cast<const uint64_t*>(quadBitmap);
+    m_pRootTable = reinterpret_cast<const uint32_t*>(rootTable);
+    m_pStates = reinterpret_cast<const ST_AcState*>(states);
+    m_pTransitions = reinterpret_cast<const ST_AcTransition*>(transitions);
+    m_pOutputs = reinterpret_cast<const uint32_t*>(outputs);
+    m_pSignatures = reinterpret_cast<const ST_SignatureRecord*>(signatures);
+    m_pTokens = reinterpret_cast<const ST_SignatureToken*>(tokens);
+    m_pBytes = bytes;
+    m_pMasks = masks;
+    m_pNames = reinterpret_cast<const char*>(names);
+    if (!ValidateImage()) {
+        m_pHeader = nullptr;
+        return false;
+    }
+    return true;
+}
+
+// 캐시 파일이 깨졌거나 조작되었어도 스캔 중 범위 밖을 읽거나 실패 링크를 끝없이 돌지 않도록 모든 인덱스를 헤더의 개수와 비교
+// 실패하면 호출자가 원본에서 다시 빌드함
+bool CSignatureChecker::ValidateImage() const {
+    const ST_AcHeader& header = *m_pHeader;
+    if (header.FirstByteCount > SIGNATURE_FIRST_BYTE_SIMD_LIMIT) {
+        return false;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        if (m_pRootTable[i] >= header.StateCount) {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < header.TransitionCount; i++) {
+        if (m_pTransitions[i].Next == 0 || m_pTransitions[i].Next >= header.StateCount || m_pTransitions[i].Byte > 0xFF) {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < header.OutputCount; i++) {
+        if (m_pOutputs[i] >= header.SignatureCount) {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < header.StateCount; i++) {
+        const ST_AcState& state = m_pStates[i];
+        if (state.Fail >= header.StateCount
+            || static_cast<uint64_t>(state.TransitionStart) + state.TransitionCount > header.TransitionCount
+            || static_cast<uint64_t>(state.OutputStart) + state.OutputCount > header.OutputCount) {
+            return false;
+        }
+    }
+
+    // 전이는 루트에서 시작하는 트리여야 하고, 실패 링크는 항상 더 얕은 상태를 가리켜야 NextState가 끝남
+    std::vector<uint32_t> vecDepth(header.StateCount, UINT32_MAX);
+    std::vector<uint32_t> vecQueue{0};
+    vecDepth[0] = 0;
+    for (size_t q = 0; q < vecQueue.size(); q++) {
+        const ST_AcState& state = m_pStates[vecQueue[q]];
+        for (uint32_t j = 0; j < state.TransitionCount; j++) {
+            uint32_t ulNext = m_pTransitions[state.TransitionStart + j].Next;
+            if (vecDepth[ulNext] != UINT32_MAX) {
+                return false;
+            }
+            vecDepth[ulNext] = vecDepth[vecQueue[q]] + 1;
+            vecQueue.push_back(ulNext);
+        }
+    }
+    for (uint32_t i = 1; i < header.StateCount; i++) {
+        if (vecDepth[i] == UINT32_MAX || vecDepth[m_pStates[i].Fail] >= vecDepth[i]) {
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < header.SignatureCount; i++) {
+        const ST_SignatureRecord& signature = m_pSignatures[i];
+        if (static_cast<uint64_t>(signature.NameOffset) + signature.NameLength > header.NameBytes
+            || static_cast<uint64_t>(signature.TokenStart) + signature.TokenCount > header.TokenCount
+            || signature.TokenCount == 0 || signature.AnchorLength == 0) {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < header.TokenCount; i++) {
+        const ST_SignatureToken& token = m_pTokens[i];
+        if (token.Type == TOKEN_BYTES) {
+            if (static_cast<uint64_t>(token.ByteStart) + token.Length > header.ByteCount) {
+                return false;
+            }
+        } else if (token.Type != TOKEN_JUMP || token.Length > token.Max) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 실패 링크를 따라가며 전이를 찾고, 루트까지 내려가면 0을 반환하여 호출자가 후보 위치부터 다시 시작하도록 함
+uint32_t CSignatureChecker::NextState(uint32_t state, uint8_t byte) const {
+    while (state != 0) {
+        const ST_AcState& current = m_pStates[state];
+        const ST_AcTransition* begin = m_pTransitions + current.TransitionStart;
+        const ST_AcTransition* end = begin + current.TransitionCount;
+        const ST_AcTransition* it = std::lower_bound(begin, end, byte, [](const ST_AcTransition& t, uint32_t b) { return t.Byte < b; });
+        if (it != end && it->Byte == byte) {
+            return it->Next;
+        }
+        state = current.Fail;
+    }
+    return 0;
+}
+
+// 루트 상태에서는 앵커가 시작할 수 없는 위치를 건너뜀
+// 앵커 첫 바이트 종류가 적으면 SSE2로 16바이트씩 비교하고, 후보 위치에서는 2바이트 쌍 / 4바이트 해시 비트맵으로 다시 거름
+size_t CSignatureChecker::SkipToCandidate(const uint8_t* data, size_t size, size_t position) const {
+    while (position + 1 < size) {
+#ifdef __SSE2__
+        if (m_pHeader->FirstByteCount > 0) {
+            while (position + 16 <= size) {
+                __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position));
+                __m128i hits = _mm_setzero_si128();
+                for (uint32_t i = 0; i < m_pHeader->FirstByteCount; i++) {
+                    hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, _mm_set1_epi8(static_cast<char>(m_pHeader->FirstBytes[i]))));
+                }
+                int nMask = _mm_movemask_epi8(hits);
+                if (nMask != 0) {
+                    position += __builtin_ctz(nMask);
+                    break;
+                }
+                position += 16;
+            }
+            if (position + 1 >= size) {
+                break;
+            }
+        }
+#endif
+        uint32_t ulPair = (static_cast<uint32_t>(data[position]) << 8) | data[position + 1];
+        if (m_pPairBitmap[ulPair >> 6] & (1ULL << (ulPair & 63))) {
+            return position;
+        }
+        if (position + 4 <= size) {
+            uint32_t ulHash = HashQuad(data + position);
+            if (m_pQuadBitmap[ulHash >> 6] & (1ULL << (ulHash & 63))) {
+                return position;
+            }
+        }
+        position++;
+    }
+    return size;
+}
+
+bool CSignatureChecker::Verify(const ST_SignatureRecord& signature, const uint8_t* data, size_t size, size_t anchorEnd,
+                               std::unordered_map<uint32_t, size_t>& failedFrom) const {
+    size_t siAnchorStart = anchorEnd + 1 - signature.AnchorLength;
+    if (siAnchorStart < signature.AnchorPrefix) {
+        return false;
+    }
+    size_t siStart = siAnchorStart - signature.AnchorPrefix;
+    if (signature.OffsetType == OFFSET_ABSOLUTE && static_cast<int64_t>(siStart) != signature.OffsetValue) {
+        return false;
+    }
+    if (signature.OffsetType == OFFSET_FROM_END && static_cast<int64_t>(size) - signature.OffsetValue != static_cast<int64_t>(siStart)) {
+        return false;
+    }
+    return MatchTokens(signature.TokenStart, signature.TokenCount, data, size, siStart, failedFrom);
+}
+
+bool CSignatureChecker::MatchBytes(const ST_SignatureToken& token, const uint8_t* data, size_t size, size_t position) const {
+    if (position > size || size - position < token.Length) {
+        return false;
+    }
+    const uint8_t* bytes = m_pBytes + token.ByteStart;
+    const uint8_t* masks = m_pMasks + token.ByteStart;
+    for (uint32_t i = 0; i < token.Length; i++) {
+        if ((data[position + i] & masks[i]) != bytes[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 토큰마다 시작 가능한 위치 집합을 겹치지 않는 구간 목록으로 넘겨가며 확인 (백트래킹 없이 토큰 수 x 입력 크기에 비례)
+// 고정 길이 구간까지는 위치가 하나뿐이므로 구간 목록 없이 바로 비교
+// * 뒤의 위치 집합은 [x, size] 꼴이라 결과가 x에만 달려 있으므로, 같은 Match 안에서 이미 실패한 x 이상이면 바로 실패
+// (앵커가 자주 맞는 입력에서도 시그니처당 입력을 한 번만 훑음)
+bool CSignatureChecker::MatchTokens(uint32_t tokenStart, uint32_t count, const uint8_t* data, size_t size, size_t position,
+                                    std::unordered_map<uint32_t, size_t>& failedFrom) const {
+    const ST_SignatureToken* tokens = m_pTokens + tokenStart;
+    uint32_t k = 0;
+    for (; k < count; k++) {
+        const ST_SignatureToken& token = tokens[k];
+        if (token.Type == TOKEN_JUMP) {
+            if (token.Length != token.Max) {
+                break;
+            }
+            position += token.Length;
+        } else {
+            if (!MatchBytes(token, data, size, position)) {
+                return false;
+            }
+            position += token.Length;
+        }
+    }
+    if (k == count) {
+        return true;
+    }
+
+    std::vector<std::pair<size_t, size_t>> vecReachable{{position, position}};
+    std::vector<std::pair<size_t, size_t>> vecNext;
+    auto appendRange = [&vecNext](size_t low, size_t high) {
+        if (!vecNext.empty() && low <= vecNext.back().second + 1) {
+            vecNext.back().second = std::max(vecNext.back().second, high);
+        } else {
+            vecNext.emplace_back(low, high);
+        }
+    };
+    for (; k < count; k++) {
+        const ST_SignatureToken& token = tokens[k];
+        vecNext.clear();
+        if (token.Type == TOKEN_JUMP) {
+            for (const auto& range : vecReachable) {
+                if (range.first + token.Length > size) {
+                    break;
+                }
+                size_t siHigh = token.Max == UINT32_MAX ? size : std::min<size_t>(size, range.second + token.Max);
+                appendRange(range.first + token.Length, siHigh);
+            }
+            if (token.Max == UINT32_MAX && !vecNext.empty()) {
+                // 여기서 일치하면 Match가 바로 끝나므로 미리 실패로 기록해도 됨
+                auto result = failedFrom.emplace(tokenStart + k, vecNext.front().first);
+                if (!result.second) {
+                    if (result.first->second <= vecNext.front().first) {
+                        return false;
+                    }
+                    result.first->second = vecNext.front().first;
+                }
+            }
+        } else {
+            for (const auto& range : vecReachable) {
+                if (range.first > size || size - range.first < token.Length) {
+                    break;
+                }
+                size_t siLast = std::min<size_t>(range.second, size - token.Length);
+                for (size_t p = range.first; p <= siLast; p++) {
+                    if (MatchBytes(token, data, size, p)) {
+                        if (k + 1 == count) {
+                            return true;
+                        }
+                        appendRange(p + token.Length, p + token.Length);
+                    }
+                }
+            }
+        }
+        if (vecNext.empty()) {
+            return false;
+        }
+        vecReachable.swap(vecNext);
+    }
+    return false;
+}
+
+bool CSignatureChecker::Match(const uint8_t* data, size_t size, uint32_t& signatureIndex) const {
+    if (!m_pHeader || m_pHeader->SignatureCount == 0) {
+        return false;
+    }
+    std::unordered_map<uint32_t, size_t> mapFailedFrom; // 토큰 위치 -> * 뒤에서 이미 실패한 가장 앞 위치
+    uint32_t ulState = 0;
+    size_t i = 0;
+    while (i < size) {
+        if (ulState == 0) {
+            // 루트에서는 앵커 첫 두 바이트가 나올 수 있는 위치까지 건너뛴 뒤 바로 깊이 1 상태로 진입
+            i = SkipToCandidate(data, size, i);
+            if (i >= size) {
+                break;
+            }
+            ulState = m_pRootTable[data[i]];
+        } else {
+            ulState = NextState(ulState, data[i]);
+            if (ulState == 0) {
+                continue; // 같은 바이트를 루트에서 다시 처리
+            }
+        }
+        const ST_AcState& state = m_pStates[ulState];
+        for (uint32_t j = 0; j < state.OutputCount; j++) {
+            uint32_t ulSignature = m_pOutputs[state.OutputStart + j];
+            if (Verify(m_pSignatures[ulSignature], data, size, i, mapFailedFrom)) {
+                signatureIndex = ulSignature;
+                return true;
+            }
+        }
+        i++;
+    }
+    return false;
+}
+
+// YARA 검사와 같은 형식으로 탐지를 보고하고 detectionCause에 시그니처 이름을 채움
+int CSignatureChecker::CheckSignatures(const std::string& filePath, const uint8_t* data, size_t size, std::vector<std::string>& detectedMalware,
+                                       std::string& detectionCause) const {
+    uint32_t ulSignature;
+    if (!Match(data, size, ulSignature)) {
+        return SUCCESS_CODE;
+    }
+    detectionCause = GetSignatureName(ulSignature);
+    if (std::find(detectedMalware.begin(), detectedMalware.end(), filePath) == detectedMalware.end()) {
+        detectedMalware.push_back(filePath);
+        std::cout << "\n" << COLOR_RED << "[+] Malware detected: [" << filePath << "]" << COLOR_RESET << "\n";
+        std::cout << COLOR_RED << "[+] Detected by signature: [" << detectionCause << "]" << COLOR_RESET << "\n\n";
+    }
+    return SUCCESS_CODE;
+}
+
+std::string CSignatureChecker::GetSignatureName(uint32_t index) const {
+    if (!m_pHeader || index >= m_pHeader->SignatureCount) {
+        return "";
+    }
+    return std::string(m_pNames + m_pSignatures[index].NameOffset, m_pSignatures[index].NameLength);
+}
+
+// 같은 조건의 YARA 룰 소스로 변환 (성능 비교용)
+std::string CSignatureChecker::ExportYaraRules() const {
+    std::ostringstream rules;
+    static const char* hexDigits = "0123456789abcdef";
+    for (uint32_t i = 0; m_pHeader && i < m_pHeader->SignatureCount; i++) {
+        const ST_SignatureRecord& signature = m_pSignatures[i];
+        rules << "rule sig_" << i << " {\n  strings:\n    $a = {";
+        for (uint32_t t = 0; t < signature.TokenCount; t++) {
+            const ST_SignatureToken& token = m_pTokens[signature.TokenStart + t];
+            if (token.Type == TOKEN_JUMP) {
+                if (token.Max == UINT32_MAX) {
+                    rules << " [" << token.Length << "-]";
+                } else if (token.Length == token.Max) {
+                    rules << " [" << token.Length << "]";
+                } else {
+                    rules << " [" << token.Length << "-" << token.Max << "]";
+                }
+                continue;
+            }
+            for (uint32_t b = 0; b < token.Length; b++) {
+                uint8_t value = m_pBytes[token.ByteStart + b];
+                uint8_t mask = m_pMasks[token.ByteStart + b];
+                rules << ' ' << ((mask & 0xF0) ? hexDigits[value >> 4] : '?') << ((mask & 0x0F) ? hexDigits[value & 0x0F] : '?');
+            }
+        }
+        rules << " }\n  condition:\n    ";
+        if (signature.OffsetType == OFFSET_ABSOLUTE) {
+            rules << "$a at " << signature.OffsetValue;
+        } else if (signature.OffsetType == OFFSET_FROM_END) {
+            rules << "$a at filesize - " << signature.OffsetValue;
+        } else {
+            rules << "$a";
+        }
+        rules << "\n}\n";
+    }
+    return rules.str();
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define SIGNATURE_DB_PATH "signatures.ndb"
+#define SIGNATURE_CACHE_SUFFIX ".ac"                 // 컴파일된 오토마톤 캐시 (signatures.ndb.ac)
+#define SIGNATURE_CACHE_MAGIC "UDKDAC02"
+#define SIGNATURE_MIN_ANCHOR 2                       // 오토마톤에 넣는 고정 바이트 구간의 최소 길이
+#define SIGNATURE_FIRST_BYTE_SIMD_LIMIT 4            // 첫 바이트 종류가 이 이하이면 SSE2로 16바이트씩 건너뜀
+#define SIGNATURE_QUAD_FILTER_BITS 19                // 4바이트 이상 앵커의 첫 4바이트 해시 비트맵 크기 (2^19비트 = 64KB)
+
+// 시그니처 패턴을 이루는 토큰 (고정 바이트열 또는 점프)
+enum ESignatureToken : uint32_t {
+    TOKEN_BYTES = 0,   // Bytes/Masks[ByteStart, ByteStart+Length)와 비교 (마스크 0x00은 ??, 0x0F/0xF0은 니블 와일드카드)
+    TOKEN_JUMP = 1     // Length ~ Max 바이트 건너뜀 ({n}, {n-m}, *)
+};
+
+enum ESignatureOffset : int32_t {
+    OFFSET_ANY = 0,    // *
+    OFFSET_ABSOLUTE,   // n
+    OFFSET_FROM_END    // EOF-n
+};
+
+// 캐시 파일에 그대로 저장되는 고정 크기 레코드들
+struct ST_AcHeader {
+    char Magic[8];
+    int64_t SourceMtimeNs;
+    uint64_t SourceSize;
+    uint32_t StateCount;
+    uint32_t TransitionCount;
+    uint32_t OutputCount;
+    uint32_t SignatureCount;
+    uint32_t TokenCount;
+    uint32_t ByteCount;
+    uint32_t NameBytes;
+    uint32_t FirstByteCount;
+    uint8_t FirstBytes[SIGNATURE_FIRST_BYTE_SIMD_LIMIT];
+    uint32_t RejectedCount;  // 지원하지 않는 문법으로 건너뛴 시그니처 수
+};
+
+struct ST_AcState {
+    uint32_t Fail;
+    uint32_t TransitionStart;
+    uint32_t TransitionCount;
+    uint32_t OutputStart;
+    uint32_t OutputCount;
+};
+
+struct ST_AcTransition {
+    uint32_t Next;
+    uint32_t Byte;
+};
+
+struct ST_SignatureRecord {
+    uint32_t NameOffset;
+    uint32_t NameLength;
+    uint32_t TokenStart;
+    uint32_t TokenCount;
+    int32_t OffsetType;
+    uint32_t AnchorLength;
+    int64_t OffsetValue;
+    uint32_t AnchorPrefix;   // 패턴 시작부터 앵커 시작까지의 고정 길이
+    uint32_t Reserved;
+};
+
+struct ST_SignatureToken {
+    uint32_t Type;
+    uint32_t ByteStart;
+    uint32_t Length;
+    uint32_t Max;
+};
+
+// ClamAV .ndb 형식(Name:TargetType:Offset:HexSignature) 바이트 시그니처 검사기
+// 각 시그니처의 가장 긴 고정 바이트 구간(앵커)으로 Aho-Corasick 오토마톤을 만들고, 앵커가 맞으면 전체 패턴을 확인
+// 오토마톤은 평탄한 배열로 캐시 파일에 저장하여 다음 실행부터는 mmap으로 바로 사용
+class CSignatureChecker {
+public:
+    explicit CSignatureChecker(const std::string& databasePath, bool useCache = true);
+    ~CSignatureChecker();
+
+    int CheckSignatures(const std::string& filePath, const uint8_t* data, size_t size, std::vector<std::string>& detectedMalware,
+                        std::string& detectionCause) const;
+    bool Match(const uint8_t* data, size_t size, uint32_t& signatureIndex) const;
+    int GetLoadResult() const { return m_nLoadResult; }
+    size_t GetSignatureCount() const { return m_pHeader ? m_pHeader->SignatureCount : 0; }
+    size_t GetRejectedCount() const { return m_pHeader ? m_pHeader->RejectedCount : 0; }
+    size_t GetStateCount() const { return m_pHeader ? m_pHeader->StateCount : 0; }
+    size_t GetMemoryUsage() const { return m_siMappedSize; }
+    double GetBuildTimeMs() const { return m_dBuildTimeMs; }
+    bool IsFromCache() const { return m_bFromCache; }
+    std::string GetSignatureName(uint32_t index) const;
+    std::string ExportYaraRules() const;
+
+    CSignatureChecker(const CSignatureChecker&) = delete;
+    CSignatureChecker& operator=(const CSignatureChecker&) = delete;
+
+private:
+    std::string m_strDatabasePath;
+    int m_nLoadResult;
+    double m_dBuildTimeMs;
+    bool m_bFromCache;
+
+    // 캐시 파일 매핑 (또는 캐시를 쓸 수 없을 때 메모리 버퍼) 위의 구간들
+    void* m_pMapped;
+    size_t m_siMappedSize;
+    std::vector<uint8_t> m_vecOwned;
+    const ST_AcHeader* m_pHeader;
+    const uint64_t* m_pPairBitmap;           // 2~3바이트 앵커의 첫 두 바이트 쌍 65536비트
+    const uint64_t* m_pQuadBitmap;           // 4바이트 이상 앵커의 첫 4바이트 해시
+    const uint32_t* m_pRootTable;            // 루트 상태의 256개 전이
+    const ST_AcState* m_pStates;
+    const ST_AcTransition* m_pTransitions;
+    const uint32_t* m_pOutputs;
+    const ST_SignatureRecord* m_pSignatures;
+    const ST_SignatureToken* m_pTokens;
+    const uint8_t* m_pBytes;
+    const uint8_t* m_pMasks;
+    const char* m_pNames;
+
+    int Load(bool useCache);
+    int Build(std::vector<uint8_t>& image, int64_t sourceMtimeNs, uint64_t sourceSize);
+    int MapCache(const std::string& cachePath, int64_t sourceMtimeNs, uint64_t sourceSize);
+    int WriteCache(const std::string& cachePath, const std::vector<uint8_t>& image) const;
+    bool AttachImage(const uint8_t* image, size_t size);
+    bool ValidateImage() const;
+    uint32_t NextState(uint32_t state, uint8_t byte) const;
+    size_t SkipToCandidate(const uint8_t* data, size_t size, size_t position) const;
+    bool Verify(const ST_SignatureRecord& signature, const uint8_t* data, size_t size, size_t anchorEnd,
+                std::unordered_map<uint32_t, size_t>& failedFrom) const;
+    bool MatchBytes(const ST_SignatureToken& token, const uint8_t* data, size_t size, size_t position) const;
+    bool MatchTokens(uint32_t tokenStart, uint32_t count, const uint8_t* data, size_t size, size_t position,
+                     std::unordered_map<uint32_t, size_t>& failedFrom) const;
+};
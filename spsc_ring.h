@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// 생산자 하나, 소비자 하나가 잠금 없이 주고받는 고정 크기 링 버퍼
+// 각 쪽이 자기 인덱스만 쓰고 상대 인덱스는 읽기만 하므로 acquire/release 순서만으로 동기화
+template <typename T>
+class CSpscRing {
+public:
+    explicit CSpscRing(size_t capacity) : m_siHead(0), m_siTail(0) {
+        size_t siCapacity = 1;
+        while (siCapacity < capacity) {
+            siCapacity <<= 1;
+        }
+        m_vecSlots.resize(siCapacity);
+        m_siMask = siCapacity - 1;
+    }
+
+    // 가득 차면 false (생산자 스레드에서만 호출)
+    bool TryPush(T&& item) {
+        size_t siTail = m_siTail.load(std::memory_order_relaxed);
+        if (siTail - m_siHead.load(std::memory_order_acquire) > m_siMask) {
+            return false;
+        }
+        m_vecSlots[siTail & m_siMask] = std::move(item);
+        m_siTail.store(siTail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 비어 있으면 false (소비자 스레드에서만 호출)
+    bool TryPop(T& item) {
+        size_t siHead = m_siHead.load(std::memory_order_relaxed);
+        if (siHead == m_siTail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = std::move(m_vecSlots[siHead & m_siMask]);
+        m_siHead.store(siHead + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t Size() const { return m_siTail.load(std::memory_order_acquire) - m_siHead.load(std::memory_order_acquire); }
+    size_t Capacity() const { return m_siMask + 1; }
+
+    CSpscRing(const CSpscRing&) = delete;
+    CSpscRing& operator=(const CSpscRing&) = delete;
+
+private:
+    std::vector<T> m_vecSlots;
+    size_t m_siMask;
+    alignas(64) std::atomic<size_t> m_siHead; // 소비자가 다음에 읽을 위치
+    alignas(64) std::atomic<size_t> m_siTail; // 생산자가 다음에 쓸 위치
+};
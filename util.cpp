@@ -4,10 +4,13 @@
 #include <jsoncpp/json/json.h>
 #include <limits.h>
 #include <sstream>
+#include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/un.h>
 #include <openssl/sha.h>
 #include <iomanip>
+#include <unistd.h>
 #include "ansi_color.h"
 #include "util.h"
 
@@ -91,6 +94,22 @@ int ComputeSHA256(const std::string& fileName, std::string& fileHash) {
     return SUCCESS_CODE;
 }
 
+// 이미 메모리에 읽어둔 데이터의 SHA256 해시값 계산
+int ComputeSHA256(const uint8_t* data, size_t size, std::string& fileHash) {
+    unsigned char hash[SHA256_DIGEST_LENGTH];
+    if (SHA256(data, size, hash) == nullptr) {
+        return ERROR_CANNOT_COMPUTE_HASH;
+    }
+
+    static const char chHexDigits[] = "0123456789abcdef";
+    fileHash.resize(SHA256_DIGEST_LENGTH * 2);
+    for (int i = 0; i < SHA256_DIGEST_LENGTH; i++) {
+        fileHash[i * 2] = chHexDigits[hash[i] >> 4];
+        fileHash[i * 2 + 1] = chHexDigits[hash[i] & 0x0f];
+    }
+    return SUCCESS_CODE;
+}
+
 std::time_t GetCurrentTime() {
     auto now = std::chrono::system_clock::now();
     auto currentTime = std::chrono::system_clock::to_time_t(now);
@@ -123,43 +142,43 @@ std::string GetAbsolutePath(std::string path) {
     }
 }
 
-void SaveLogInJson(Json::Value logEntry, std::string logFilePath) {
-    
-    Json::StreamWriterBuilder writer;
-    
-    // 수정 및 추가: 기존 로그 파일을 읽고 JSON 배열로 변환하는 부분
-    std::ifstream logFileIn(logFilePath);
-    std::vector<Json::Value> logEntries;
-
-    if (logFileIn.is_open()) {
-        Json::CharReaderBuilder reader;
-        Json::Value existingLog;
-        std::string errs;
-        if (Json::parseFromStream(reader, logFileIn, &existingLog, &errs)) {
-            if (existingLog.isArray()) {
-                for (const auto &entry : existingLog) {
-                    logEntries.push_back(entry);
-                }
-            }
-        }
-        logFileIn.close();
+// 현재 프로세스의 상주 메모리(RSS) 크기 (KB)
+long GetResidentMemoryKb() {
+    std::ifstream statm("/proc/self/statm");
+    long lPages = 0;
+    long lResidentPages = 0;
+    if (!(statm >> lPages >> lResidentPages)) {
+        return -1;
     }
+    return lResidentPages * (sysconf(_SC_PAGESIZE) / 1024);
+}
 
-    logEntries.push_back(logEntry);
-
-    // 수정 및 추가: JSON 배열 형식으로 로그 파일에 저장하는 부분
-    std::ofstream logFileOut(logFilePath, std::ios::out);
-    if (!logFileOut.is_open()) {
-        HandleError(ERROR_CANNOT_OPEN_FILE, logFilePath);
+// 유닉스 소켓을 path에 바인드하되 처음부터 mode 권한으로만 보이도록 함
+// bind 후 chmod하면 그 사이 umask 기본 권한으로 열려 있고, umask는 프로세스 전체에 적용되어 다른 스레드가 만드는 파일에도 영향을 주므로
+// 같은 디렉토리에 0700 임시 디렉토리를 만들어 그 안에서 바인드와 chmod를 마친 뒤 link로 제자리에 둠 (bind처럼 이미 있는 파일은 덮어쓰지 않음)
+int BindUnixSocket(int socketFd, const std::string& path, mode_t mode) {
+    size_t siSlash = path.find_last_of('/');
+    std::string strDirectory = siSlash == std::string::npos ? "." : path.substr(0, siSlash == 0 ? 1 : siSlash);
+    std::string strTemplate = strDirectory + "/.sockXXXXXX";
+    if (!mkdtemp(&strTemplate[0])) {
+        return ERROR_CANNOT_OPEN_FILE;
     }
-    logFileOut << "[\n";
-    for (size_t i = 0; i < logEntries.size(); ++i) {
-        logFileOut << Json::writeString(writer, logEntries[i]);
-        if (i != logEntries.size() - 1) {
-            logFileOut << ","; // 수정: 각 JSON 객체 사이에 쉼표 추가
+    std::string strTempPath = strTemplate + "/s";
+
+    struct sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    int nResult = SUCCESS_CODE;
+    if (path.size() >= sizeof(address.sun_path) || strTempPath.size() >= sizeof(address.sun_path)) {
+        nResult = ERROR_INVALID_INPUT;
+    } else {
+        strncpy(address.sun_path, strTempPath.c_str(), sizeof(address.sun_path) - 1);
+        if (bind(socketFd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0) {
+            nResult = ERROR_CANNOT_OPEN_FILE;
+        } else if (chmod(strTempPath.c_str(), mode) != 0 || link(strTempPath.c_str(), path.c_str()) != 0) {
+            nResult = ERROR_CANNOT_OPEN_FILE;
         }
-        logFileOut << "\n";
+        unlink(strTempPath.c_str());
     }
-    logFileOut << "]";
-    logFileOut.close();
-}
\ No newline at end of file
+    rmdir(strTemplate.c_str());
+    return nResult;
+}
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <ctime>
+#include <sys/types.h>
 #include <jsoncpp/json/json.h>
 #include "error_codes.h"
 
@@ -15,8 +17,10 @@ void HandleError(int code, const std::string& context = "");
 bool IsExtension(const std::string& filePath, const std::string& extension);
 bool IsELFFile(const std::string& filePath);
 int ComputeSHA256(const std::string& fileName, std::string& fileHash);
+int ComputeSHA256(const uint8_t* data, size_t size, std::string& fileHash);
 std::time_t GetCurrentTime();
 std::string GetCurrentTimeWithMilliseconds();
 std::string Trim(const std::string& str);
 std::string GetAbsolutePath(std::string path);
-void SaveLogInJson(Json::Value logEntry, std::string logFilePath);
\ No newline at end of file
+long GetResidentMemoryKb();
+int BindUnixSocket(int socketFd, const std::string& path, mode_t mode);
\ No newline at end of file
@@ -0,0 +1,170 @@
+#include "watch_tree.h"
+
+CWatchTree::CWatchTree() : m_siWatchCount(0), m_siUnusedNameBytes(0) {}
+
+uint32_t CWatchTree::Add(uint32_t parent, const std::string& name, int wd) {
+    uint32_t node;
+    if (!m_vecFreeNodes.empty()) {
+        node = m_vecFreeNodes.back();
+        m_vecFreeNodes.pop_back();
+    } else {
+        node = static_cast<uint32_t>(m_vecNodes.size());
+        m_vecNodes.emplace_back();
+    }
+    ST_WatchNode& watchNode = m_vecNodes[node];
+    watchNode.Wd = wd;
+    watchNode.FirstChild = WATCH_NO_NODE;
+    watchNode.NameOffset = StoreName(name);
+    watchNode.NameLength = static_cast<uint32_t>(name.size());
+    Link(node, parent);
+
+    m_mapWdIndex[wd] = node;
+    m_siWatchCount++;
+    return node;
+}
+
+// 노드와 하위 트리 전체를 테이블에서 제거하고 제거된 wd를 돌려줌 (호출자가 아직 살아있는 watch를 inotify에서 해제)
+void CWatchTree::Remove(uint32_t node, std::vector<int>& removedWds) {
+    Unlink(node);
+    std::vector<uint32_t> vecStack = {node};
+    while (!vecStack.empty()) {
+        uint32_t current = vecStack.back();
+        vecStack.pop_back();
+        for (uint32_t child = m_vecNodes[current].FirstChild; child != WATCH_NO_NODE; child = m_vecNodes[child].NextSibling) {
+            vecStack.push_back(child);
+        }
+        ST_WatchNode& watchNode = m_vecNodes[current];
+        removedWds.push_back(watchNode.Wd);
+        m_mapWdIndex[watchNode.Wd] = WATCH_REMOVED_NODE;
+        m_siUnusedNameBytes += watchNode.NameLength;
+        watchNode.Wd = -1;
+        m_vecFreeNodes.push_back(current);
+        m_siWatchCount--;
+    }
+    if (m_siUnusedNameBytes * WATCH_COMPACT_RATIO > m_strNames.size()) {
+        CompactNames();
+    }
+}
+
+// 디렉토리 이름 변경/이동, 하위 노드는 부모를 따라가므로 그대로 둠
+void CWatchTree::Move(uint32_t node, uint32_t newParent, const std::string& newName) {
+    Unlink(node);
+    ST_WatchNode& watchNode = m_vecNodes[node];
+    m_siUnusedNameBytes += watchNode.NameLength;
+    watchNode.NameOffset = StoreName(newName);
+    watchNode.NameLength = static_cast<uint32_t>(newName.size());
+    Link(node, newParent);
+    if (m_siUnusedNameBytes * WATCH_COMPACT_RATIO > m_strNames.size()) {
+        CompactNames();
+    }
+}
+
+uint32_t CWatchTree::Find(int wd) const {
+    auto it = m_mapWdIndex.find(wd);
+    if (it == m_mapWdIndex.end() || it->second == WATCH_REMOVED_NODE) {
+        return WATCH_NO_NODE;
+    }
+    return it->second;
+}
+
+bool CWatchTree::WasRemoved(int wd) const {
+    auto it = m_mapWdIndex.find(wd);
+    return it != m_mapWdIndex.end() && it->second == WATCH_REMOVED_NODE;
+}
+
+// 커널이 wd의 마지막 이벤트(IN_IGNORED)를 보낸 뒤 해제 표시를 지움 (표시가 해제된 wd 수만큼 쌓이지 않도록)
+void CWatchTree::Forget(int wd) {
+    auto it = m_mapWdIndex.find(wd);
+    if (it != m_mapWdIndex.end() && it->second == WATCH_REMOVED_NODE) {
+        m_mapWdIndex.erase(it);
+    }
+}
+
+uint32_t CWatchTree::FindChild(uint32_t parent, const std::string& name) const {
+    for (uint32_t child = m_vecNodes[parent].FirstChild; child != WATCH_NO_NODE; child = m_vecNodes[child].NextSibling) {
+        const ST_WatchNode& watchNode = m_vecNodes[child];
+        if (m_strNames.compare(watchNode.NameOffset, watchNode.NameLength, name) == 0) {
+            return child;
+        }
+    }
+    return WATCH_NO_NODE;
+}
+
+// 부모를 따라 올라가며 이름을 모은 뒤 루트부터 이어 붙임
+std::string CWatchTree::GetPath(uint32_t node) const {
+    std::vector<uint32_t> vecChain;
+    size_t siLength = 0;
+    for (uint32_t current = node; current != WATCH_NO_NODE; current = m_vecNodes[current].Parent) {
+        vecChain.push_back(current);
+        siLength += m_vecNodes[current].NameLength + 1;
+    }
+    std::string strPath;
+    strPath.reserve(siLength);
+    for (auto it = vecChain.rbegin(); it != vecChain.rend(); ++it) {
+        if (it != vecChain.rbegin() && strPath.back() != '/') {
+            strPath += '/';
+        }
+        strPath.append(m_strNames, m_vecNodes[*it].NameOffset, m_vecNodes[*it].NameLength);
+    }
+    return strPath;
+}
+
+// 노드 배열, 이름 저장소, wd 색인이 실제로 차지하는 메모리 (할당된 용량 기준, 해시 맵은 버킷 + 항목마다 노드 하나로 추정)
+size_t CWatchTree::GetMemoryUsage() const {
+    return m_vecNodes.capacity() * sizeof(ST_WatchNode) + m_vecFreeNodes.capacity() * sizeof(uint32_t)
+        + m_mapWdIndex.bucket_count() * sizeof(void*) + m_mapWdIndex.size() * (sizeof(std::pair<const int, uint32_t>) + 2 * sizeof(void*))
+        + m_strNames.capacity();
+}
+
+uint32_t CWatchTree::StoreName(const std::string& name) {
+    uint32_t offset = static_cast<uint32_t>(m_strNames.size());
+    m_strNames += name;
+    return offset;
+}
+
+void CWatchTree::Link(uint32_t node, uint32_t parent) {
+    ST_WatchNode& watchNode = m_vecNodes[node];
+    watchNode.Parent = parent;
+    watchNode.PrevSibling = WATCH_NO_NODE;
+    watchNode.NextSibling = WATCH_NO_NODE;
+    if (parent == WATCH_NO_NODE) {
+        return;
+    }
+    uint32_t firstChild = m_vecNodes[parent].FirstChild;
+    watchNode.NextSibling = firstChild;
+    if (firstChild != WATCH_NO_NODE) {
+        m_vecNodes[firstChild].PrevSibling = node;
+    }
+    m_vecNodes[parent].FirstChild = node;
+}
+
+void CWatchTree::Unlink(uint32_t node) {
+    ST_WatchNode& watchNode = m_vecNodes[node];
+    if (watchNode.PrevSibling != WATCH_NO_NODE) {
+        m_vecNodes[watchNode.PrevSibling].NextSibling = watchNode.NextSibling;
+    } else if (watchNode.Parent != WATCH_NO_NODE) {
+        m_vecNodes[watchNode.Parent].FirstChild = watchNode.NextSibling;
+    }
+    if (watchNode.NextSibling != WATCH_NO_NODE) {
+        m_vecNodes[watchNode.NextSibling].PrevSibling = watchNode.PrevSibling;
+    }
+    watchNode.Parent = WATCH_NO_NODE;
+    watchNode.PrevSibling = WATCH_NO_NODE;
+    watchNode.NextSibling = WATCH_NO_NODE;
+}
+
+// 삭제/이름 변경으로 쓰이지 않는 이름을 빼고 저장소를 다시 채움
+void CWatchTree::CompactNames() {
+    std::string strNames;
+    strNames.reserve(m_strNames.size() - m_siUnusedNameBytes);
+    for (ST_WatchNode& watchNode : m_vecNodes) {
+        if (watchNode.Wd == -1) {
+            continue;
+        }
+        uint32_t offset = static_cast<uint32_t>(strNames.size());
+        strNames.append(m_strNames, watchNode.NameOffset, watchNode.NameLength);
+        watchNode.NameOffset = offset;
+    }
+    m_strNames.swap(strNames);
+    m_siUnusedNameBytes = 0;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define WATCH_NO_NODE UINT32_MAX
+#define WATCH_REMOVED_NODE (UINT32_MAX - 1) // 해제된 wd 표시 (해제 후 도착한 이벤트를 알 수 없는 wd와 구분)
+#define WATCH_COMPACT_RATIO 2 // 이름 저장소에서 쓰이지 않는 바이트가 1/2을 넘으면 다시 채움
+
+// 감시 디렉토리 하나, 경로 전체 대신 부모 노드와 자기 이름만 저장하여 상위 경로를 공유
+// 형제/자식 연결로 하위 트리 이동(이름 변경)과 삭제를 전체 경로 갱신 없이 처리
+struct ST_WatchNode {
+    int Wd;                 // -1이면 비어있는 노드 (재사용 대기)
+    uint32_t Parent;        // 감시 루트면 WATCH_NO_NODE
+    uint32_t FirstChild;
+    uint32_t PrevSibling;
+    uint32_t NextSibling;
+    uint32_t NameOffset;    // 이름 저장소 안의 위치, 루트는 절대 경로 전체를 이름으로 가짐
+    uint32_t NameLength;
+};
+
+// inotify watch descriptor -> 경로 테이블
+// 수십만 디렉토리를 감시할 때 wd마다 전체 경로 문자열을 두는 대신 노드 배열 + 이름 저장소 + wd 색인만 사용
+class CWatchTree {
+public:
+    CWatchTree();
+    uint32_t Add(uint32_t parent, const std::string& name, int wd);
+    void Remove(uint32_t node, std::vector<int>& removedWds);
+    void Move(uint32_t node, uint32_t newParent, const std::string& newName);
+    uint32_t Find(int wd) const;
+    bool WasRemoved(int wd) const;
+    void Forget(int wd);
+    uint32_t FindChild(uint32_t parent, const std::string& name) const;
+    std::string GetPath(uint32_t node) const;
+    int GetWd(uint32_t node) const { return m_vecNodes[node].Wd; }
+    bool IsRoot(uint32_t node) const { return m_vecNodes[node].Parent == WATCH_NO_NODE; }
+    size_t GetWatchCount() const { return m_siWatchCount; }
+    size_t GetMemoryUsage() const;
+
+private:
+    std::vector<ST_WatchNode> m_vecNodes;
+    std::vector<uint32_t> m_vecFreeNodes;
+    std::unordered_map<int, uint32_t> m_mapWdIndex; // wd -> 노드, 커널은 해제된 wd를 바로 재사용하지 않고 계속 증가시키므로 배열이면 감시 수가 아닌 누적 wd만큼 커짐
+    std::string m_strNames;
+    size_t m_siWatchCount;
+    size_t m_siUnusedNameBytes;
+
+    uint32_t StoreName(const std::string& name);
+    void Link(uint32_t node, uint32_t parent);
+    void Unlink(uint32_t node);
+    void CompactNames();
+};
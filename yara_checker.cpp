@@ -1,16 +1,49 @@
 #include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstring>
 #include <dirent.h>
 #include <iostream>
+#include <mutex>
+#include <pwd.h>
+#include <unistd.h>
+#include <unordered_map>
 #include "ansi_color.h"
 #include "util.h"
 #include "yara_checker.h"
 
-CYaraChecker::CYaraChecker(const std::string& rulesDirectory) : m_strRulesDirectory(rulesDirectory) {
-    GetRuleFiles();
+// yr_initialize/yr_finalize는 내부 참조 카운트를 잠금 없이 갱신하므로 스레드 안전하지 않음
+// 스냅샷은 감시 스레드에서 만들어지고 마지막 참조를 놓은 스캔 스레드에서 해제되므로 프로세스에서 한 번만 초기화하고 종료 시까지 유지
+int CYaraChecker::InitializeLibrary() {
+    static std::once_flag s_initOnce;
+    static int s_nResult = ERROR_YARA_LIBRARY;
+    std::call_once(s_initOnce, [] {
+        s_nResult = yr_initialize() == ERROR_SUCCESS ? SUCCESS_CODE : ERROR_YARA_LIBRARY;
+    });
+    return s_nResult;
+}
+
+// 룰 파일은 객체 생성 시 한 번만 컴파일하고, 파일마다 컴파일된 룰을 재사용
+CYaraChecker::CYaraChecker(const std::string& rulesDirectory)
+    : m_strRulesDirectory(rulesDirectory), m_pRules(nullptr), m_nLoadResult(SUCCESS_CODE) {
+    m_nLoadResult = GetRuleFiles();
+    if (m_nLoadResult == SUCCESS_CODE) {
+        m_nLoadResult = CompileRuleFiles();
+    }
+}
+
+CYaraChecker::~CYaraChecker() {
+    for (YR_SCANNER* scanner : m_vecScannerPool) {
+        yr_scanner_destroy(scanner);
+    }
+    if (m_pRules) {
+        yr_rules_destroy(m_pRules);
+    }
 }
 
 // YARA 룰 매칭 콜백 함수
 int CYaraChecker::YaraCallbackFunction(YR_SCAN_CONTEXT* context, int message, void* messageData, void* yaraData) {
+    (void)context;
     if (message == CALLBACK_MSG_RULE_MATCHING) {
         auto* data = static_cast<ST_YaraData*>(yaraData);        
         std::vector<std::string>* detectedMalware = data->DetectedMalware;
@@ -27,6 +60,28 @@ int CYaraChecker::YaraCallbackFunction(YR_SCAN_CONTEXT* context, int message, vo
     return CALLBACK_CONTINUE;
 }
 
+// 컴파일 오류/경고 수집 콜백, 경고 중 "slow"가 포함된 것은 짧거나 흔한 atom으로 인한 성능 경고
+void CYaraChecker::CompilerCallbackFunction(int errorLevel, const char* fileName, int lineNumber, const YR_RULE* rule, const char* message, void* userData) {
+    auto* checker = static_cast<CYaraChecker*>(userData);
+    std::string strFileName = fileName ? fileName : "";
+    std::string strRuleSet = strFileName.substr(strFileName.find_last_of('/') + 1);
+
+    if (errorLevel == YARA_ERROR_LEVEL_ERROR) {
+        PrintError(strRuleSet + ":" + std::to_string(lineNumber) + " : " + message);
+        return;
+    }
+
+    std::string strMessage = message ? message : "";
+    ST_RuleWarning warning = {
+        .RuleSet = strRuleSet,
+        .Rule = (rule && rule->identifier) ? rule->identifier : "",
+        .Line = lineNumber,
+        .Message = strMessage,
+        .IsSlowAtom = strMessage.find("slow") != std::string::npos
+    };
+    checker->m_vecCompileWarnings.push_back(warning);
+}
+
 // 디렉토리 내 YARA 룰 파일들을 가져오는 함수
 int CYaraChecker::GetRuleFiles() {
     DIR* dir;
@@ -36,9 +91,16 @@ int CYaraChecker::GetRuleFiles() {
             if (ent->d_type == DT_REG) { // regular file
                 std::string strFilePath = m_strRulesDirectory + "/" + ent->d_name;
                 m_vecRuleFiles.push_back(GetAbsolutePath(strFilePath));
+
+                // 스캔 중 룰 파일 자신을 건너뛰기 위해 (장치, inode)로 기억
+                struct stat ruleStat;
+                if (stat(strFilePath.c_str(), &ruleStat) == 0) {
+                    m_setRuleFileIds.insert({ruleStat.st_dev, ruleStat.st_ino});
+                }
             }
         }
         closedir(dir);
+        std::sort(m_vecRuleFiles.begin(), m_vecRuleFiles.end());
         return SUCCESS_CODE;
     } else {
         PrintError("Could not open directory " + m_strRulesDirectory );
@@ -46,77 +108,255 @@ int CYaraChecker::GetRuleFiles() {
     }
 }
 
-int CYaraChecker::CheckYaraRule(const std::string& filePath, std::vector<std::string>& detectedMalware, std::string& detectionCause) {
-    YR_COMPILER* compiler = nullptr;
-    YR_RULES* rules = nullptr;
-
+// 모든 룰 파일을 하나의 컴파일러로 컴파일하여 파일당 한 번만 스캔하도록 함
+// 룰 파일끼리 서로의 룰을 참조할 수 있도록 모두 기본 네임스페이스에 넣음 (YARA는 같은 네임스페이스 안에서만 룰 참조를 허용)
+// 오류가 난 파일은 알리고 제외한 뒤 처음부터 다시 컴파일 (오류가 난 컴파일러에는 더 이상 파일을 추가할 수 없음)
+int CYaraChecker::CompileRuleFiles() {
     // YARA 룰 파일 리스트
     if (m_vecRuleFiles.empty()) {
         PrintError("No YARA rules files found.");
     }
-    
-    // filePath가 ruleFiles에 있는지 확인
-    if (std::find(m_vecRuleFiles.begin(), m_vecRuleFiles.end(), GetAbsolutePath(filePath)) != m_vecRuleFiles.end()) {
-        std::cout << "\n" << COLOR_YELLOW << "[+] Skipping YARA rule check for file : " << filePath << COLOR_RESET << "\n\n";
-        return SUCCESS_CODE;
-    }
 
-    // yara 라이브러리 초기화
-    if (yr_initialize() != ERROR_SUCCESS) {
+    // yara 라이브러리 초기화 (프로세스에서 한 번만)
+    if (InitializeLibrary() != SUCCESS_CODE) {
         PrintError("Failed to initialize YARA.");
         return ERROR_YARA_LIBRARY;
     }
+
+    std::set<std::string> setFailedFiles;
+    int nResult = SUCCESS_CODE;
+    do {
+        m_vecRuleSets.clear();
+        m_vecCompileWarnings.clear();
+    } while (!TryCompileRuleFiles(setFailedFiles, nResult));
+    if (nResult == SUCCESS_CODE && !setFailedFiles.empty()) {
+        nResult = ERROR_YARA_LIBRARY;
+    }
+    return nResult;
+}
+
+// failedFiles를 뺀 룰 파일을 컴파일하여 result에 결과를 남김, 새로 오류가 난 파일이 있으면 failedFiles에 더하고 false (다시 시도)
+bool CYaraChecker::TryCompileRuleFiles(std::set<std::string>& failedFiles, int& result) {
+    YR_COMPILER* compiler = nullptr;
     // yara 컴파일러 객체 생성
     if (yr_compiler_create(&compiler) != ERROR_SUCCESS) {
         PrintError("Failed to create YARA compiler.");
-        yr_finalize();
-        return ERROR_YARA_LIBRARY;
+        result = ERROR_YARA_LIBRARY;
+        return true;
+    }
+    yr_compiler_set_callback(compiler, CompilerCallbackFunction, this);
+    if (DefineExternals(compiler) != ERROR_SUCCESS) {
+        PrintError("Failed to define YARA external variables.");
+        yr_compiler_destroy(compiler);
+        result = ERROR_YARA_LIBRARY;
+        return true;
     }
 
-    int nResult = SUCCESS_CODE;
-
-    // YARA 룰 파일들 추가
     for (const auto& ruleFile : m_vecRuleFiles) {
+        if (failedFiles.count(ruleFile) > 0) {
+            continue;
+        }
         FILE* ruleFilePtr = fopen(ruleFile.c_str(), "r");
         if (!ruleFilePtr) {
-            PrintError("Failed to open YARA rules file.");
-            nResult = ERROR_CANNOT_OPEN_FILE;
-            break;
-        }
-        // yara rule 컴파일
-        if (yr_compiler_add_file(compiler, ruleFilePtr, nullptr, ruleFile.c_str()) != 0) {
-            PrintError("Failed to compile YARA rules.");
-            fclose(ruleFilePtr);
-            nResult = ERROR_YARA_LIBRARY;
-            break;
+            PrintError("Failed to open YARA rules file : " + ruleFile);
+            failedFiles.insert(ruleFile);
+            continue;
         }
+        // yara rule 컴파일, 컴파일러는 룰을 추가한 순서대로 룰 테이블에 배치하므로 추가 전후의 인덱스로 파일별 범위를 기록
+        uint32_t uFirstRule = compiler->next_rule_idx;
+        int nErrors = yr_compiler_add_file(compiler, ruleFilePtr, nullptr, ruleFile.c_str());
         fclose(ruleFilePtr);
+        if (nErrors != 0) {
+            PrintError("Failed to compile YARA rules : " + ruleFile);
+            failedFiles.insert(ruleFile);
+            yr_compiler_destroy(compiler);
+            return false;
+        }
+        m_vecRuleSets.push_back({ruleFile.substr(ruleFile.find_last_of('/') + 1), uFirstRule, compiler->next_rule_idx - uFirstRule});
     }
-    
-    if(nResult == SUCCESS_CODE) {
-        // 컴파일된 룰 가져오기
-        if (yr_compiler_get_rules(compiler, &rules) != ERROR_SUCCESS) {
-            PrintError("Failed to get compiled YARA rules.");
-            nResult =  ERROR_YARA_LIBRARY;
-        } else {
-            ST_YaraData yaraData { &detectedMalware, &filePath, "" };
-
-            // 스캔
-            int scanResult = yr_rules_scan_file(rules, filePath.c_str(), 0, YaraCallbackFunction, &yaraData, 0);
-            if (scanResult != ERROR_SUCCESS && scanResult != CALLBACK_MSG_RULE_NOT_MATCHING) {
-                PrintError("Error scanning file " + filePath);
-                nResult = ERROR_YARA_LIBRARY;
-            }
-            detectionCause = yaraData.NameOfYaraRule;
+
+    result = SUCCESS_CODE;
+    // 컴파일된 룰 가져오기
+    if (yr_compiler_get_rules(compiler, &m_pRules) != ERROR_SUCCESS) {
+        PrintError("Failed to get compiled YARA rules.");
+        m_pRules = nullptr;
+        m_vecRuleSets.clear();
+        result = ERROR_YARA_LIBRARY;
+    }
+    yr_compiler_destroy(compiler);
+    return true;
+}
+
+// 외부 변수는 컴파일 시 기본값으로 선언해야 룰에서 참조할 수 있음
+int CYaraChecker::DefineExternals(YR_COMPILER* compiler) {
+    int nResult = yr_compiler_define_string_variable(compiler, YARA_EXTERNAL_FILENAME, "");
+    nResult = nResult != ERROR_SUCCESS ? nResult : yr_compiler_define_string_variable(compiler, YARA_EXTERNAL_EXTENSION, "");
+    nResult = nResult != ERROR_SUCCESS ? nResult : yr_compiler_define_string_variable(compiler, YARA_EXTERNAL_FILETYPE, "");
+    nResult = nResult != ERROR_SUCCESS ? nResult : yr_compiler_define_integer_variable(compiler, YARA_EXTERNAL_PATH_DEPTH, 0);
+    nResult = nResult != ERROR_SUCCESS ? nResult : yr_compiler_define_string_variable(compiler, YARA_EXTERNAL_OWNER, "");
+    nResult = nResult != ERROR_SUCCESS ? nResult : yr_compiler_define_boolean_variable(compiler, YARA_EXTERNAL_IS_EXECUTABLE, 0);
+    return nResult;
+}
+
+YR_SCANNER* CYaraChecker::AcquireScanner() const {
+    {
+        std::lock_guard<std::mutex> lock(m_scannerMutex);
+        if (!m_vecScannerPool.empty()) {
+            YR_SCANNER* scanner = m_vecScannerPool.back();
+            m_vecScannerPool.pop_back();
+            return scanner;
         }
     }
+    YR_SCANNER* scanner = nullptr;
+    if (yr_scanner_create(m_pRules, &scanner) != ERROR_SUCCESS) {
+        return nullptr;
+    }
+    return scanner;
+}
 
-    if (rules) {
-        yr_rules_destroy(rules);
+void CYaraChecker::ReleaseScanner(YR_SCANNER* scanner) const {
+    std::lock_guard<std::mutex> lock(m_scannerMutex);
+    m_vecScannerPool.push_back(scanner);
+}
+
+// 스캐너를 재사용하므로 이전 파일의 값이 남지 않도록 매번 모든 변수를 설정
+void CYaraChecker::SetExternals(YR_SCANNER* scanner, const ST_YaraExternals& externals) {
+    yr_scanner_define_string_variable(scanner, YARA_EXTERNAL_FILENAME, externals.FileName.c_str());
+    yr_scanner_define_string_variable(scanner, YARA_EXTERNAL_EXTENSION, externals.Extension.c_str());
+    yr_scanner_define_string_variable(scanner, YARA_EXTERNAL_FILETYPE, externals.FileType.c_str());
+    yr_scanner_define_integer_variable(scanner, YARA_EXTERNAL_PATH_DEPTH, externals.PathDepth);
+    yr_scanner_define_string_variable(scanner, YARA_EXTERNAL_OWNER, externals.Owner.c_str());
+    yr_scanner_define_boolean_variable(scanner, YARA_EXTERNAL_IS_EXECUTABLE, externals.IsExecutable ? 1 : 0);
+}
+
+// 스캐너가 이미 가진 경로/stat/내용으로 외부 변수 값 계산 (추가 시스템 호출은 uid별 첫 사용자 이름 조회뿐)
+ST_YaraExternals CYaraChecker::MakeExternals(const std::string& filePath, const struct stat* fileStat, const uint8_t* data, size_t size) {
+    ST_YaraExternals externals = {"", "", "", 0, "", false};
+    size_t siSlash = filePath.find_last_of('/');
+    externals.FileName = siSlash == std::string::npos ? filePath : filePath.substr(siSlash + 1);
+    size_t siDot = externals.FileName.find_last_of('.');
+    if (siDot != std::string::npos && siDot > 0 && siDot + 1 < externals.FileName.size()) {
+        externals.Extension = externals.FileName.substr(siDot + 1);
+        std::transform(externals.Extension.begin(), externals.Extension.end(), externals.Extension.begin(), ::tolower);
     }
-    if (compiler) {
-        yr_compiler_destroy(compiler);
+    externals.FileType = data != nullptr ? DetectFileType(data, size) : "";
+
+    // 상대 경로는 작업 디렉토리 깊이를 더해 절대 경로 기준으로 맞춤 (스캐너는 작업 디렉토리를 바꾸지 않음)
+    static const int64_t s_llWorkingDirectoryDepth = []() {
+        char szCwd[PATH_MAX];
+        return getcwd(szCwd, sizeof(szCwd)) != nullptr ? static_cast<int64_t>(std::count(szCwd, szCwd + strlen(szCwd), '/')) - (strcmp(szCwd, "/") == 0 ? 1 : 0) : 0;
+    }();
+    int64_t llComponents = 0;
+    size_t siStart = 0;
+    while (siStart < filePath.size()) {
+        size_t siEnd = filePath.find('/', siStart);
+        if (siEnd == std::string::npos) {
+            siEnd = filePath.size();
+        }
+        std::string strComponent = filePath.substr(siStart, siEnd - siStart);
+        if (!strComponent.empty() && strComponent != ".") {
+            llComponents += strComponent == ".." ? -1 : 1;
+        }
+        siStart = siEnd + 1;
+    }
+    externals.PathDepth = std::max<int64_t>(0, llComponents - 1 + (filePath.empty() || filePath[0] != '/' ? s_llWorkingDirectoryDepth : 0));
+
+    if (fileStat != nullptr) {
+        externals.IsExecutable = (fileStat->st_mode & (S_IXUSR | S_IXGRP | S_IXOTH)) != 0;
+        thread_local std::unordered_map<uid_t, std::string> s_mapOwners;
+        auto it = s_mapOwners.find(fileStat->st_uid);
+        if (it == s_mapOwners.end()) {
+            struct passwd pwd;
+            struct passwd* pResult = nullptr;
+            char szBuffer[1024];
+            std::string strOwner = getpwuid_r(fileStat->st_uid, &pwd, szBuffer, sizeof(szBuffer), &pResult) == 0 && pResult != nullptr
+                ? pwd.pw_name : std::to_string(fileStat->st_uid);
+            it = s_mapOwners.emplace(fileStat->st_uid, strOwner).first;
+        }
+        externals.Owner = it->second;
+    }
+    return externals;
+}
+
+// 앞부분 매직으로 형식 판별, 알 수 없으면 앞 512바이트에 NUL이 없을 때 text
+std::string CYaraChecker::DetectFileType(const uint8_t* data, size_t size) {
+    if (size >= 4 && memcmp(data, "\x7f" "ELF", 4) == 0) {
+        return "elf";
+    }
+    if (size >= 2 && data[0] == 'M' && data[1] == 'Z') {
+        return "pe";
+    }
+    if (size >= 4) {
+        uint32_t uMagic = static_cast<uint32_t>(data[0]) << 24 | static_cast<uint32_t>(data[1]) << 16 | static_cast<uint32_t>(data[2]) << 8 | data[3];
+        if (uMagic == 0xfeedface || uMagic == 0xfeedfacf || uMagic == 0xcefaedfe || uMagic == 0xcffaedfe) {
+            return "macho";
+        }
+        if (memcmp(data, "%PDF", 4) == 0) {
+            return "pdf";
+        }
+        if (memcmp(data, "PK\x03\x04", 4) == 0) {
+            return "zip";
+        }
+    }
+    if (size >= 2 && data[0] == '#' && data[1] == '!') {
+        return "script";
+    }
+    if (size >= 2 && data[0] == 0x1f && data[1] == 0x8b) {
+        return "gzip";
+    }
+    return memchr(data, 0, std::min<size_t>(size, 512)) == nullptr ? "text" : "data";
+}
+
+bool CYaraChecker::IsRuleFile(const struct stat& fileStat) const {
+    return m_setRuleFileIds.count({fileStat.st_dev, fileStat.st_ino}) > 0;
+}
+
+// 파일 경로로 직접 검사 (YARA가 파일을 직접 읽음)
+int CYaraChecker::CheckYaraRule(const std::string& filePath, std::vector<std::string>& detectedMalware, std::string& detectionCause) const {
+    // filePath가 ruleFiles에 있는지 확인
+    if (std::find(m_vecRuleFiles.begin(), m_vecRuleFiles.end(), GetAbsolutePath(filePath)) != m_vecRuleFiles.end()) {
+        std::cout << "\n" << COLOR_YELLOW << "[+] Skipping YARA rule check for file : " << filePath << COLOR_RESET << "\n\n";
+        return SUCCESS_CODE;
+    }
+
+    if (m_pRules == nullptr) {
+        return ERROR_YARA_LIBRARY;
+    }
+    int nResult = SUCCESS_CODE;
+    ST_YaraData yaraData { &detectedMalware, &filePath, "" };
+    // 스캔
+    int scanResult = yr_rules_scan_file(m_pRules, filePath.c_str(), 0, YaraCallbackFunction, &yaraData, 0);
+    if (scanResult != ERROR_SUCCESS && scanResult != CALLBACK_MSG_RULE_NOT_MATCHING) {
+        PrintError("Error scanning file " + filePath);
+        nResult = ERROR_YARA_LIBRARY;
+    }
+    detectionCause = yaraData.NameOfYaraRule;
+    return nResult;
+}
+
+// 스캐너가 이미 읽어둔 메모리를 모든 룰로 한 번에 검사
+// 풀에서 빌린 YR_SCANNER에 외부 변수를 설정하여 검사 (스캔마다 스캐너를 만들고 없애는 비용 제거)
+int CYaraChecker::CheckYaraRule(const std::string& filePath, const uint8_t* data, size_t size, std::vector<std::string>& detectedMalware,
+                                std::string& detectionCause, const ST_YaraExternals* externals) const {
+    if (m_pRules == nullptr) {
+        return ERROR_YARA_LIBRARY;
+    }
+    YR_SCANNER* scanner = AcquireScanner();
+    if (scanner == nullptr) {
+        PrintError("Failed to create YARA scanner.");
+        return ERROR_YARA_LIBRARY;
+    }
+    int nResult = SUCCESS_CODE;
+    ST_YaraData yaraData { &detectedMalware, &filePath, "" };
+    static const ST_YaraExternals s_emptyExternals = {"", "", "", 0, "", false};
+    yr_scanner_set_callback(scanner, YaraCallbackFunction, &yaraData);
+    SetExternals(scanner, externals != nullptr ? *externals : s_emptyExternals);
+    int scanResult = yr_scanner_scan_mem(scanner, data, size);
+    ReleaseScanner(scanner);
+    if (scanResult != ERROR_SUCCESS && scanResult != CALLBACK_MSG_RULE_NOT_MATCHING) {
+        PrintError("Error scanning file " + filePath);
+        nResult = ERROR_YARA_LIBRARY;
     }
-    yr_finalize();
+    detectionCause = yaraData.NameOfYaraRule;
     return nResult;
 }
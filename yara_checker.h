@@ -1,13 +1,67 @@
 #pragma once
 
+#include <cstdint>
+#include <mutex>
+#include <set>
 #include <string>
+#include <utility>
 #include <vector>
+#include <sys/stat.h>
 #include <yara.h>
 
+// 룰에서 조건 앞부분에 값싼 검사로 쓸 수 있는 외부 변수 (예: filetype == "elf" and $expensive)
+// 모든 룰 파일이 이 변수들이 정의된 상태로 컴파일되며, 값을 모르는 경우 빈 문자열/0/false
+#define YARA_EXTERNAL_FILENAME "filename"           // 경로를 뺀 파일 이름
+#define YARA_EXTERNAL_EXTENSION "extension"         // 소문자 확장자 (점 제외), 없으면 ""
+#define YARA_EXTERNAL_FILETYPE "filetype"           // 매직으로 판별한 형식: elf, pe, macho, script, pdf, zip, gzip, text, data
+#define YARA_EXTERNAL_PATH_DEPTH "path_depth"       // 절대 경로의 디렉토리 깊이 (/bin/ls = 1)
+#define YARA_EXTERNAL_OWNER "owner"                 // 소유자 사용자 이름, 조회 실패 시 uid 문자열
+#define YARA_EXTERNAL_IS_EXECUTABLE "is_executable" // 실행 권한 비트가 하나라도 있으면 true
+
+// 룰 파일 하나에서 나온 룰의 범위 (모든 룰 파일은 하나의 YR_RULES로 컴파일되며, 룰 테이블에서 연속된 구간을 차지함)
+struct ST_RuleSet {
+    std::string Name;
+    uint32_t FirstRule; // 룰 테이블에서의 시작 인덱스 (include한 파일의 룰도 포함)
+    uint32_t RuleCount;
+};
+
+// 컴파일 시 YARA가 보고한 경고 (짧은 atom 등 스캔을 느리게 만드는 문자열 포함)
+struct ST_RuleWarning {
+    std::string RuleSet;
+    std::string Rule;
+    int Line;
+    std::string Message;
+    bool IsSlowAtom;
+};
+
+// 스캔 한 번에 넘기는 외부 변수 값
+struct ST_YaraExternals {
+    std::string FileName;
+    std::string Extension;
+    std::string FileType;
+    int64_t PathDepth;
+    std::string Owner;
+    bool IsExecutable;
+};
+
 class CYaraChecker {
 public:
     CYaraChecker(const std::string& rulesDirectory);
-    int CheckYaraRule(const std::string& filePath, std::vector<std::string>& detectedMalware, std::string& detectionCause);
+    ~CYaraChecker();
+    int CheckYaraRule(const std::string& filePath, std::vector<std::string>& detectedMalware, std::string& detectionCause) const;
+    int CheckYaraRule(const std::string& filePath, const uint8_t* data, size_t size, std::vector<std::string>& detectedMalware,
+                      std::string& detectionCause, const ST_YaraExternals* externals = nullptr) const;
+    static ST_YaraExternals MakeExternals(const std::string& filePath, const struct stat* fileStat, const uint8_t* data, size_t size);
+    static std::string DetectFileType(const uint8_t* data, size_t size);
+    bool IsRuleFile(const struct stat& fileStat) const;
+    int GetLoadResult() const { return m_nLoadResult; }
+    YR_RULES* GetRules() const { return m_pRules; }
+    const std::vector<ST_RuleSet>& GetRuleSets() const { return m_vecRuleSets; }
+    const std::vector<ST_RuleWarning>& GetCompileWarnings() const { return m_vecCompileWarnings; }
+    static int InitializeLibrary();
+
+    CYaraChecker(const CYaraChecker&) = delete;
+    CYaraChecker& operator=(const CYaraChecker&) = delete;
 
 private:
     struct ST_YaraData {
@@ -18,7 +72,22 @@ private:
 
     std::string m_strRulesDirectory;
     std::vector<std::string> m_vecRuleFiles;
+    std::set<std::pair<dev_t, ino_t>> m_setRuleFileIds;
+    YR_RULES* m_pRules;
+    std::vector<ST_RuleSet> m_vecRuleSets;
+    std::vector<ST_RuleWarning> m_vecCompileWarnings;
+    int m_nLoadResult;
+    // 재사용하는 YR_SCANNER, 스냅샷을 여러 스레드가 함께 쓰므로 빌려 쓰고 돌려놓음
+    mutable std::vector<YR_SCANNER*> m_vecScannerPool;
+    mutable std::mutex m_scannerMutex;
 
     static int YaraCallbackFunction(YR_SCAN_CONTEXT* context, int message, void* messageData, void* yaraData);
-    int GetRuleFiles();    
-};
\ No newline at end of file
+    static void CompilerCallbackFunction(int errorLevel, const char* fileName, int lineNumber, const YR_RULE* rule, const char* message, void* userData);
+    int GetRuleFiles();
+    int CompileRuleFiles();
+    bool TryCompileRuleFiles(std::set<std::string>& failedFiles, int& result);
+    static int DefineExternals(YR_COMPILER* compiler);
+    YR_SCANNER* AcquireScanner() const;
+    void ReleaseScanner(YR_SCANNER* scanner) const;
+    static void SetExternals(YR_SCANNER* scanner, const ST_YaraExternals& externals);
+};
@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <fts.h>
+#include <iomanip>
+#include <iostream>
+#include <jsoncpp/json/json.h>
+#include "ansi_color.h"
+#include "util.h"
+#include "yara_profiler.h"
+
+CYaraProfiler::CYaraProfiler(const CYaraChecker& checker) : m_checker(checker), m_ullCorpusBytes(0) {}
+
+// --yara-profile 옵션 입력 시 실행되는 함수
+int CYaraProfiler::StartProfiling(const std::string& corpusPath) {
+    if (m_checker.GetRules() == nullptr) {
+        return ERROR_YARA_LIBRARY;
+    }
+    int nResult = LoadCorpus(corpusPath, m_vecCorpus, m_ullCorpusBytes);
+    if (nResult != SUCCESS_CODE) {
+        return nResult;
+    }
+    std::cout << "\n### YARA Rule Profiling Start ! (Corpus : " << m_vecCorpus.size() << " files, "
+              << m_ullCorpusBytes << " bytes) ###\n\n";
+
+    for (const ST_RuleSet& ruleSet : m_checker.GetRuleSets()) {
+        std::cout << "[-] Profiling rule set : " << ruleSet.Name << "\n";
+        ProfileRuleSet(ruleSet);
+    }
+
+    // 비용이 큰 룰(룰 파일)이 먼저 오도록 정렬
+    std::sort(m_vecProfiles.begin(), m_vecProfiles.end(), [](const ST_RuleProfile& lhs, const ST_RuleProfile& rhs) {
+        return lhs.CostMs > rhs.CostMs;
+    });
+    std::sort(m_vecRuleSetProfiles.begin(), m_vecRuleSetProfiles.end(), [](const ST_RuleSetProfile& lhs, const ST_RuleSetProfile& rhs) {
+        return lhs.CostMs > rhs.CostMs;
+    });
+
+    PrintReport();
+    return SaveReport(YARA_PROFILE_REPORT_PATH);
+}
+
+// 코퍼스 파일을 메모리에 올려 측정 중 디스크 I/O가 섞이지 않도록 함
+int CYaraProfiler::LoadCorpus(const std::string& corpusPath, std::vector<std::vector<uint8_t>>& corpus, uint64_t& corpusBytes) {
+    char * const paths[] = {const_cast<char *>(corpusPath.c_str()), nullptr};
+    FTS *fileSystem = fts_open(paths, FTS_NOCHDIR | FTS_PHYSICAL, nullptr);
+    if (fileSystem == nullptr) {
+        return ERROR_CANNOT_OPEN_DIRECTORY;
+    }
+
+    FTSENT *node;
+    while ((node = fts_read(fileSystem)) != nullptr && corpus.size() < YARA_PROFILE_MAX_FILES
+           && corpusBytes < YARA_PROFILE_MAX_CORPUS_SIZE) {
+        if (node->fts_info != FTS_F) {
+            continue;
+        }
+        std::ifstream file(node->fts_path, std::ios::binary);
+        if (!file) {
+            continue;
+        }
+        size_t siSize = std::min<size_t>(node->fts_statp->st_size, YARA_PROFILE_MAX_FILE_SIZE);
+        std::vector<uint8_t> vecContent(siSize);
+        file.read(reinterpret_cast<char*>(vecContent.data()), siSize);
+        vecContent.resize(file.gcount());
+        corpusBytes += vecContent.size();
+        corpus.push_back(std::move(vecContent));
+    }
+    fts_close(fileSystem);
+
+    if (corpus.empty()) {
+        PrintError("No files found in profiling corpus " + corpusPath);
+        return ERROR_FILE_NOT_FOUND;
+    }
+    return SUCCESS_CODE;
+}
+
+int CYaraProfiler::CountMatchesCallback(YR_SCAN_CONTEXT* context, int message, void* messageData, void* userData) {
+    (void)context;
+    if (message == CALLBACK_MSG_RULE_MATCHING && userData) {
+        auto* matches = static_cast<std::map<std::string, uint64_t>*>(userData);
+        (*matches)[static_cast<YR_RULE*>(messageData)->identifier]++;
+    }
+    return CALLBACK_CONTINUE;
+}
+
+// 코퍼스 전체를 반복 스캔하여 가장 짧은 소요 시간(ns) 반환, matches가 있으면 룰별 매칭 수도 집계
+uint64_t CYaraProfiler::TimeCorpusScan(std::map<std::string, uint64_t>* matches) {
+    uint64_t ullBest = UINT64_MAX;
+    int nRepetitions = matches ? 1 : YARA_PROFILE_REPETITIONS;
+    for (int i = 0; i < nRepetitions; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& content : m_vecCorpus) {
+            yr_rules_scan_mem(m_checker.GetRules(), content.data(), content.size(), 0, CountMatchesCallback, matches, 0);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        ullBest = std::min<uint64_t>(ullBest, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+    return ullBest;
+}
+
+void CYaraProfiler::SetAllRulesEnabled(bool enabled) {
+    YR_RULE* rule;
+    yr_rules_foreach(m_checker.GetRules(), rule) {
+        enabled ? yr_rule_enable(rule) : yr_rule_disable(rule);
+    }
+}
+
+// 모든 룰을 끈 상태를 기준으로, 룰 파일의 룰만 켰을 때와 룰을 하나씩만 켰을 때 추가되는 스캔 시간을 각각의 비용으로 기록
+// 모든 룰 파일이 하나의 YR_RULES에 있으므로 다른 룰 파일의 룰도 함께 꺼야 격리됨
+void CYaraProfiler::ProfileRuleSet(const ST_RuleSet& ruleSet) {
+    YR_RULE* rulesTable = m_checker.GetRules()->rules_table;
+    std::vector<YR_RULE*> vecRules;
+    for (uint32_t i = 0; i < ruleSet.RuleCount; ++i) {
+        vecRules.push_back(&rulesTable[ruleSet.FirstRule + i]);
+    }
+
+    SetAllRulesEnabled(false);
+    uint64_t ullBaseline = TimeCorpusScan(nullptr);
+
+    for (YR_RULE* target : vecRules) {
+        yr_rule_enable(target);
+    }
+    std::map<std::string, uint64_t> mapMatches;
+    TimeCorpusScan(&mapMatches);
+    uint64_t ullRuleSetElapsed = TimeCorpusScan(nullptr);
+    m_vecRuleSetProfiles.push_back({ruleSet.Name, ruleSet.RuleCount, ullRuleSetElapsed > ullBaseline ? (ullRuleSetElapsed - ullBaseline) / 1e6 : 0.0});
+    for (YR_RULE* target : vecRules) {
+        yr_rule_disable(target);
+    }
+
+    std::map<std::string, int> mapSlowAtoms;
+    for (const ST_RuleWarning& warning : m_checker.GetCompileWarnings()) {
+        if (warning.IsSlowAtom && warning.RuleSet == ruleSet.Name) {
+            mapSlowAtoms[warning.Rule]++;
+        }
+    }
+
+    for (YR_RULE* target : vecRules) {
+        yr_rule_enable(target);
+        uint64_t ullElapsed = TimeCorpusScan(nullptr);
+        yr_rule_disable(target);
+
+        ST_RuleProfile profile = {
+            .RuleSet = ruleSet.Name,
+            .Rule = target->identifier,
+            .CostMs = ullElapsed > ullBaseline ? (ullElapsed - ullBaseline) / 1e6 : 0.0,
+            .Matches = mapMatches[target->identifier],
+            .SlowAtomWarnings = mapSlowAtoms[target->identifier]
+        };
+        m_vecProfiles.push_back(profile);
+    }
+
+    SetAllRulesEnabled(true);
+}
+
+void CYaraProfiler::PrintReport() const {
+    std::cout << "\n- YARA Rule Cost Ranking -\n\n"
+              << "  " << std::right << std::setw(4) << "#" << "  " << std::left << std::setw(40) << "rule"
+              << std::setw(32) << "rule set" << std::right << std::setw(12) << "cost(ms)"
+              << std::setw(10) << "MB/s" << std::setw(10) << "matches" << std::setw(12) << "slow atoms" << "\n";
+    for (size_t i = 0; i < m_vecProfiles.size(); ++i) {
+        const ST_RuleProfile& profile = m_vecProfiles[i];
+        double dMBPerSec = profile.CostMs > 0 ? m_ullCorpusBytes / (profile.CostMs / 1000.0) / (1024.0 * 1024.0) : 0.0;
+        std::cout << (profile.SlowAtomWarnings > 0 ? COLOR_YELLOW : "")
+                  << "  " << std::right << std::setw(4) << i + 1 << "  " << std::left << std::setw(40) << profile.Rule
+                  << std::setw(32) << profile.RuleSet << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(12) << profile.CostMs << std::setprecision(1) << std::setw(10) << dMBPerSec
+                  << std::setw(10) << profile.Matches << std::setw(12) << profile.SlowAtomWarnings
+                  << (profile.SlowAtomWarnings > 0 ? COLOR_RESET : "") << "\n";
+    }
+
+    std::cout << "\n- YARA Rule Set Cost Ranking -\n\n"
+              << "  " << std::right << std::setw(4) << "#" << "  " << std::left << std::setw(40) << "rule set"
+              << std::right << std::setw(8) << "rules" << std::setw(12) << "cost(ms)" << std::setw(10) << "MB/s" << "\n";
+    for (size_t i = 0; i < m_vecRuleSetProfiles.size(); ++i) {
+        const ST_RuleSetProfile& profile = m_vecRuleSetProfiles[i];
+        double dMBPerSec = profile.CostMs > 0 ? m_ullCorpusBytes / (profile.CostMs / 1000.0) / (1024.0 * 1024.0) : 0.0;
+        std::cout << "  " << std::right << std::setw(4) << i + 1 << "  " << std::left << std::setw(40) << profile.RuleSet
+                  << std::right << std::setw(8) << profile.Rules << std::fixed << std::setprecision(3) << std::setw(12) << profile.CostMs
+                  << std::setprecision(1) << std::setw(10) << dMBPerSec << "\n";
+    }
+
+    bool bHasWarning = false;
+    for (const ST_RuleWarning& warning : m_checker.GetCompileWarnings()) {
+        if (!bHasWarning) {
+            std::cout << "\n[+] Compile-time warnings :\n";
+            bHasWarning = true;
+        }
+        std::cout << (warning.IsSlowAtom ? COLOR_YELLOW : "") << "  " << warning.RuleSet << ":" << warning.Line
+                  << " [" << warning.Rule << "] " << warning.Message << (warning.IsSlowAtom ? COLOR_RESET : "") << "\n";
+    }
+}
+
+int CYaraProfiler::SaveReport(const std::string& reportPath) const {
+    Json::Value root;
+    root["timestamp"] = GetCurrentTimeWithMilliseconds();
+    root["corpus_files"] = Json::UInt64(m_vecCorpus.size());
+    root["corpus_bytes"] = Json::UInt64(m_ullCorpusBytes);
+    root["repetitions"] = YARA_PROFILE_REPETITIONS;
+
+    Json::Value rules(Json::arrayValue);
+    for (const ST_RuleProfile& profile : m_vecProfiles) {
+        Json::Value entry;
+        entry["rule"] = profile.Rule;
+        entry["rule_set"] = profile.RuleSet;
+        entry["cost_ms"] = profile.CostMs;
+        entry["matches"] = Json::UInt64(profile.Matches);
+        entry["slow_atom_warnings"] = profile.SlowAtomWarnings;
+        rules.append(entry);
+    }
+    root["rules"] = rules;
+
+    Json::Value ruleSets(Json::arrayValue);
+    for (const ST_RuleSetProfile& profile : m_vecRuleSetProfiles) {
+        Json::Value entry;
+        entry["rule_set"] = profile.RuleSet;
+        entry["rules"] = profile.Rules;
+        entry["cost_ms"] = profile.CostMs;
+        ruleSets.append(entry);
+    }
+    root["rule_sets"] = ruleSets;
+
+    Json::Value warnings(Json::arrayValue);
+    for (const ST_RuleWarning& warning : m_checker.GetCompileWarnings()) {
+        Json::Value entry;
+        entry["rule_set"] = warning.RuleSet;
+        entry["rule"] = warning.Rule;
+        entry["line"] = warning.Line;
+        entry["message"] = warning.Message;
+        entry["slow_atom"] = warning.IsSlowAtom;
+        warnings.append(entry);
+    }
+    root["compile_warnings"] = warnings;
+
+    std::ofstream file(reportPath, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        PrintErrorMessage(ERROR_CANNOT_OPEN_FILE, reportPath);
+        return ERROR_CANNOT_OPEN_FILE;
+    }
+    Json::StreamWriterBuilder writer;
+    file << Json::writeString(writer, root) << "\n";
+    std::cout << "\n[+] YARA profile report saved to " << reportPath << "\n";
+    return file.good() ? SUCCESS_CODE : ERROR_CANNOT_WRITE_FILE;
+}
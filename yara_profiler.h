@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "yara_checker.h"
+
+#define YARA_PROFILE_REPORT_PATH "logs/yara_profile.json"
+#define YARA_PROFILE_MAX_FILES 500                          // 샘플 코퍼스 최대 파일 수
+#define YARA_PROFILE_MAX_FILE_SIZE (16 * 1024 * 1024)       // 이보다 큰 파일은 앞부분만 사용
+#define YARA_PROFILE_MAX_CORPUS_SIZE (256 * 1024 * 1024)    // 코퍼스 전체 최대 크기
+#define YARA_PROFILE_REPETITIONS 3                          // 측정 반복 횟수 (최솟값 사용)
+
+struct ST_RuleProfile {
+    std::string RuleSet;
+    std::string Rule;
+    double CostMs;        // 해당 룰만 활성화했을 때 코퍼스 스캔 시간 - 모든 룰 비활성화 시 시간
+    uint64_t Matches;     // 코퍼스에서 매칭된 파일 수
+    int SlowAtomWarnings; // 컴파일 시 보고된 느린 atom 경고 수
+};
+
+// 룰 파일 하나의 룰만 활성화했을 때의 비용 (모든 룰을 한 번에 스캔하므로 룰 파일별 시간은 격리 측정으로만 알 수 있음)
+struct ST_RuleSetProfile {
+    std::string RuleSet;
+    uint32_t Rules;
+    double CostMs;
+};
+
+// 샘플 코퍼스에 대해 룰을 하나씩만 활성화하여 룰별 평가 비용을 측정하는 프로파일러
+// (배포판 libyara는 YR_PROFILING_ENABLED 없이 빌드되므로 내장 프로파일링 대신 룰 단위 격리 측정을 사용)
+class CYaraProfiler {
+public:
+    CYaraProfiler(const CYaraChecker& checker);
+    int StartProfiling(const std::string& corpusPath);
+    static int LoadCorpus(const std::string& corpusPath, std::vector<std::vector<uint8_t>>& corpus, uint64_t& corpusBytes);
+
+private:
+    const CYaraChecker& m_checker;
+    std::vector<std::vector<uint8_t>> m_vecCorpus;
+    uint64_t m_ullCorpusBytes;
+    std::vector<ST_RuleProfile> m_vecProfiles;
+    std::vector<ST_RuleSetProfile> m_vecRuleSetProfiles;
+
+    void ProfileRuleSet(const ST_RuleSet& ruleSet);
+    uint64_t TimeCorpusScan(std::map<std::string, uint64_t>* matches);
+    void SetAllRulesEnabled(bool enabled);
+    void PrintReport() const;
+    int SaveReport(const std::string& reportPath) const;
+
+    static int CountMatchesCallback(YR_SCAN_CONTEXT* context, int message, void* messageData, void* userData);
+};